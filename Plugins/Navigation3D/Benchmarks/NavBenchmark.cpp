@@ -0,0 +1,543 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+// Runs path queries over generated obstacle layouts for every combination of grid size, MinSharedNeighborAxes setting and
+// search mode, and writes the results as JSON. Run with --help for the options.
+
+#include "NavBenchmarkScenarios.h"
+#include "NavAStar.h"
+#include "NavBidirectionalAStar.h"
+#include "NavClusterGraph.h"
+#include "NavGrid.h"
+#include "NavJumpPointSearch.h"
+#include "NavLineOfSight.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include "NavSparseOctree.h"
+#include "NavThetaStar.h"
+#include "NavWeightedAStar.h"
+#include "NavCostLayers.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace
+{
+	// Bumped whenever the meaning of a result field changes, so results of different versions aren't compared blindly
+	constexpr int32 ResultsFormatVersion = 1;
+
+	// The search modes of the volume that can be benchmarked
+	enum class ENavBenchmarkMode : uint8
+	{
+		AStar,
+		JumpPointSearch,
+		Hierarchical,
+		SparseOctree,
+		SmoothedAStar,
+		ThetaStar,
+		LazyThetaStar,
+		BidirectionalAStar,
+		WeightedAStar,
+		CostAStar,
+
+		Count
+	};
+
+	const char* GetModeName(ENavBenchmarkMode mode)
+	{
+		switch (mode)
+		{
+		case ENavBenchmarkMode::AStar:
+			return "astar";
+		case ENavBenchmarkMode::JumpPointSearch:
+			return "jps";
+		case ENavBenchmarkMode::Hierarchical:
+			return "hierarchical";
+		case ENavBenchmarkMode::SparseOctree:
+			return "octree";
+		case ENavBenchmarkMode::SmoothedAStar:
+			return "astar_smoothed";
+		case ENavBenchmarkMode::ThetaStar:
+			return "theta";
+		case ENavBenchmarkMode::LazyThetaStar:
+			return "lazy_theta";
+		case ENavBenchmarkMode::BidirectionalAStar:
+			return "astar_bidirectional";
+		case ENavBenchmarkMode::WeightedAStar:
+			return "astar_weighted";
+		case ENavBenchmarkMode::CostAStar:
+			return "astar_costs";
+		default:
+			return "unknown";
+		}
+	}
+
+	struct NavBenchmarkOptions
+	{
+		std::vector<int32> Sizes = { 10, 32, 64, 128 };
+		std::vector<int32> Axes = { 0, 1, 2 };
+		std::vector<ENavBenchmarkScenario> Scenarios = { ENavBenchmarkScenario::RandomFill, ENavBenchmarkScenario::Maze, ENavBenchmarkScenario::Pillars, ENavBenchmarkScenario::CitySkyline };
+		std::vector<ENavBenchmarkMode> Modes = { ENavBenchmarkMode::AStar, ENavBenchmarkMode::JumpPointSearch, ENavBenchmarkMode::Hierarchical, ENavBenchmarkMode::SparseOctree,
+			ENavBenchmarkMode::SmoothedAStar, ENavBenchmarkMode::ThetaStar, ENavBenchmarkMode::LazyThetaStar, ENavBenchmarkMode::BidirectionalAStar, ENavBenchmarkMode::WeightedAStar,
+			ENavBenchmarkMode::CostAStar };
+		int32 Queries = 100;
+		int32 ClusterSize = 16;
+		float HeuristicWeight = 2.0f;
+		double MaxSecondsPerRun = 10.0;
+		uint32 Seed = 1;
+		const char* OutputPath = nullptr;
+	};
+
+	// The measurements of one mode over one generated layout
+	struct NavBenchmarkResult
+	{
+		ENavBenchmarkScenario Scenario;
+		int32 Size;
+		int32 Axes;
+		ENavBenchmarkMode Mode;
+		double GenerateMs = 0.0;
+		double SetupMs = 0.0;
+		int32 Queries = 0;
+		int32 Found = 0;
+		uint64 Expanded = 0;
+		int32 OpenListPeak = 0;
+		double TotalMs = 0.0;
+		double P50Us = 0.0;
+		double P99Us = 0.0;
+		double MaxUs = 0.0;
+		double MeanPathLength = 0.0;
+		SIZE_T DataBytes = 0;
+		SIZE_T ContextBytes = 0;
+		int64 PeakRssKb = 0;
+	};
+
+	using Clock = std::chrono::steady_clock;
+
+	double GetElapsedMs(const Clock::time_point& start)
+	{
+		return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	}
+
+	// Gets the peak resident memory of the process so far, in kilobytes
+	int64 GetPeakRssKb()
+	{
+#if defined(_WIN32)
+		PROCESS_MEMORY_COUNTERS counters;
+		return GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) ? static_cast<int64>(counters.PeakWorkingSetSize / 1024) : 0;
+#else
+		rusage usage;
+		return getrusage(RUSAGE_SELF, &usage) == 0 ? static_cast<int64>(usage.ru_maxrss) : 0;
+#endif
+	}
+
+	double GetPercentile(std::vector<double>& values, double percentile)
+	{
+		if (values.empty())
+			return 0.0;
+
+		const size_t rank = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+		std::nth_element(values.begin(), values.begin() + rank, values.end());
+		return values[rank];
+	}
+
+	FVector GetCellCenter(const FIntVector& coordinates)
+	{
+		return FVector(coordinates) + FVector(0.5f);
+	}
+
+	// Tests if any cell of a cube is blocked, for building the octree from the generated occupancy
+	bool IsRegionBlocked(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& min, int32 size)
+	{
+		for (int32 z = min.Z; z < min.Z + size; ++z)
+			for (int32 y = min.Y; y < min.Y + size; ++y)
+				for (int32 x = min.X; x < min.X + size; ++x)
+					if (occupancy.IsBlocked(grid.GetIndex(FIntVector(x, y, z))))
+						return true;
+		return false;
+	}
+
+	// Picks the free start and end cells of every query, the same for each mode so their results can be compared
+	std::vector<std::pair<int32, int32> > PickQueries(const NavGrid& grid, const NavOccupancy& occupancy, int32 count, uint32 seed)
+	{
+		std::vector<std::pair<int32, int32> > queries;
+		std::mt19937 rng(seed);
+		auto pickFreeCell = [&]()
+		{
+			for (int32 attempt = 0; attempt < 1000; ++attempt)
+			{
+				const int32 index = static_cast<int32>(rng() % static_cast<uint32>(grid.Num()));
+				if (occupancy.IsBlocked(index) == false)
+					return index;
+			}
+			return static_cast<int32>(INDEX_NONE);
+		};
+
+		for (int32 query = 0; query < count; ++query)
+		{
+			const int32 start = pickFreeCell();
+			const int32 end = pickFreeCell();
+			if (start == INDEX_NONE || end == INDEX_NONE)
+				break;
+
+			queries.push_back(std::make_pair(start, end));
+		}
+		return queries;
+	}
+
+	void RunMode(const NavBenchmarkOptions& options, const NavGrid& grid, const NavOccupancy& generated, const std::vector<std::pair<int32, int32> >& queries, NavBenchmarkResult& result)
+	{
+		// Setup covers what the volume does before it can answer queries: sizing the grid and building the navigation data
+		Clock::time_point start = Clock::now();
+		NavGrid setupGrid;
+		setupGrid.Init(grid.GetDivisions(), result.Axes);
+		NavOccupancy occupancy = generated;
+		occupancy.BuildNearBlocked(setupGrid);
+
+		NavClusterGraph clusterGraph;
+		NavSparseOctree octree;
+		if (result.Mode == ENavBenchmarkMode::Hierarchical)
+		{
+			clusterGraph.Build(setupGrid, occupancy, options.ClusterSize);
+		}
+		else if (result.Mode == ENavBenchmarkMode::SparseOctree)
+		{
+			octree.Build(setupGrid.GetDivisions(), [&](const FIntVector& min, int32 size) { return IsRegionBlocked(setupGrid, occupancy, min, size); });
+		}
+
+		// Two cost layers, noise growing towards the ground and danger in slabs across the grid
+		NavCostLayers costLayers;
+		if (result.Mode == ENavBenchmarkMode::CostAStar)
+		{
+			costLayers.Init(setupGrid.Num(), 2);
+			const FIntVector& divisions = setupGrid.GetDivisions();
+			for (int32 index = 0; index < setupGrid.Num(); ++index)
+			{
+				const FIntVector coordinates = setupGrid.GetCoordinates(index);
+				costLayers.SetCost(index, 0, static_cast<uint8>(255 - ((255 * coordinates.Z) / FMath::Max(divisions.Z - 1, 1))));
+				costLayers.SetCost(index, 1, (coordinates.X / 8) % 3 == 1 ? 255 : 0);
+			}
+		}
+		const float costWeights[2] = { 1.0f, 4.0f };
+		const NavCostProfile costProfile(costLayers, costWeights, 2);
+		result.SetupMs = GetElapsedMs(start);
+
+		result.DataBytes = result.Mode == ENavBenchmarkMode::SparseOctree ? octree.GetAllocatedSize() : occupancy.GetAllocatedSize() + clusterGraph.GetAllocatedSize() + costLayers.GetAllocatedSize();
+
+		NavSearchContext context;
+		std::vector<int32> path;
+		std::vector<double> latencies;
+		latencies.reserve(queries.size());
+		double pathLength = 0.0;
+		auto isBlocked = [&occupancy](int32 index) { return occupancy.IsBlocked(index); };
+
+		const Clock::time_point runStart = Clock::now();
+		for (const std::pair<int32, int32>& query : queries)
+		{
+			const FIntVector startCoordinates = setupGrid.GetCoordinates(query.first);
+			const FIntVector endCoordinates = setupGrid.GetCoordinates(query.second);
+
+			context.ResetPeakOpenNum();
+			start = Clock::now();
+			bool found = false;
+			switch (result.Mode)
+			{
+			case ENavBenchmarkMode::AStar:
+				found = NavAStar::FindPath(setupGrid, query.first, query.second, isBlocked, context, path);
+				break;
+			case ENavBenchmarkMode::JumpPointSearch:
+				found = NavJumpPointSearch::FindPath(setupGrid, occupancy, query.first, query.second, context, path);
+				break;
+			case ENavBenchmarkMode::Hierarchical:
+				// Same fallback as the volume, the graph can miss paths that need diagonal moves across cluster borders
+				found = clusterGraph.FindPath(setupGrid, occupancy, query.first, query.second, context, path);
+				if (found == false && result.Axes < 2)
+				{
+					found = NavAStar::FindPath(setupGrid, query.first, query.second, isBlocked, context, path);
+				}
+				break;
+			case ENavBenchmarkMode::SparseOctree:
+				found = octree.FindPath(startCoordinates, endCoordinates, result.Axes, context, path);
+				break;
+			case ENavBenchmarkMode::SmoothedAStar:
+				found = NavAStar::FindPath(setupGrid, query.first, query.second, isBlocked, context, path);
+				if (found)
+				{
+					NavLineOfSight::SmoothPath(setupGrid, occupancy, path);
+				}
+				break;
+			case ENavBenchmarkMode::ThetaStar:
+			case ENavBenchmarkMode::LazyThetaStar:
+				found = NavThetaStar::FindPath(setupGrid, occupancy, query.first, query.second, result.Mode == ENavBenchmarkMode::LazyThetaStar, context, path);
+				break;
+			case ENavBenchmarkMode::BidirectionalAStar:
+				found = NavBidirectionalAStar::FindPath(setupGrid, occupancy, query.first, query.second, context, path);
+				break;
+			case ENavBenchmarkMode::WeightedAStar:
+				found = NavWeightedAStar::FindPath(setupGrid, occupancy, query.first, query.second, options.HeuristicWeight, context, path);
+				break;
+			case ENavBenchmarkMode::CostAStar:
+				found = NavAStar::FindPathWithCosts(setupGrid, query.first, query.second, isBlocked, [&costProfile](int32 index) { return costProfile.GetCellCost(index); },
+					costProfile.GetMinCellCost(), context, path);
+				break;
+			default:
+				break;
+			}
+			latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+			result.OpenListPeak = FMath::Max(result.OpenListPeak, context.GetPeakOpenNum());
+
+			if (found)
+			{
+				++result.Found;
+
+				// Measure the path through the center of each cell or octree node
+				FVector last = GetCellCenter(startCoordinates);
+				for (const int32 node : path)
+				{
+					const FVector location = result.Mode == ENavBenchmarkMode::SparseOctree ? octree.GetGraphNodeCenter(node) : GetCellCenter(setupGrid.GetCoordinates(node));
+					pathLength += FVector::Distance(last, location);
+					last = location;
+				}
+				pathLength += FVector::Distance(last, GetCellCenter(endCoordinates));
+			}
+
+			if (GetElapsedMs(runStart) > options.MaxSecondsPerRun * 1000.0)
+				break;
+		}
+
+		result.TotalMs = GetElapsedMs(runStart);
+		result.Queries = static_cast<int32>(latencies.size());
+		result.Expanded = context.GetTotalExpandedNum();
+		result.MeanPathLength = result.Found > 0 ? pathLength / result.Found : 0.0;
+		result.MaxUs = latencies.empty() ? 0.0 : *std::max_element(latencies.begin(), latencies.end());
+		result.P50Us = GetPercentile(latencies, 0.5);
+		result.P99Us = GetPercentile(latencies, 0.99);
+		result.ContextBytes = context.GetAllocatedSize();
+		result.PeakRssKb = GetPeakRssKb();
+	}
+
+	void WriteResults(FILE* file, const NavBenchmarkOptions& options, const std::vector<NavBenchmarkResult>& results)
+	{
+#if defined(NDEBUG)
+		const char* buildType = "release";
+#else
+		const char* buildType = "debug";
+#endif
+
+		std::fprintf(file, "{\n  \"format_version\": %d,\n  \"build\": \"%s\",\n  \"seed\": %u,\n  \"queries_per_run\": %d,\n  \"cluster_size\": %d,\n  \"results\": [",
+			ResultsFormatVersion, buildType, options.Seed, options.Queries, options.ClusterSize);
+
+		for (size_t i = 0; i < results.size(); ++i)
+		{
+			const NavBenchmarkResult& result = results[i];
+			const double queriesPerSecond = result.TotalMs > 0.0 ? result.Queries / (result.TotalMs / 1000.0) : 0.0;
+			std::fprintf(file,
+				"%s\n    {\"scenario\": \"%s\", \"size\": %d, \"min_shared_neighbor_axes\": %d, \"mode\": \"%s\", "
+				"\"generate_ms\": %.3f, \"setup_ms\": %.3f, \"queries\": %d, \"found\": %d, "
+				"\"nodes_expanded\": %llu, \"nodes_expanded_per_query\": %.1f, \"open_list_peak\": %d, \"queries_per_second\": %.2f, "
+				"\"p50_us\": %.2f, \"p99_us\": %.2f, \"max_us\": %.2f, \"mean_path_length\": %.3f, "
+				"\"data_bytes\": %llu, \"context_bytes\": %llu, \"peak_rss_kb\": %lld}",
+				i == 0 ? "" : ",", GetNavBenchmarkScenarioName(result.Scenario), result.Size, result.Axes, GetModeName(result.Mode),
+				result.GenerateMs, result.SetupMs, result.Queries, result.Found,
+				static_cast<unsigned long long>(result.Expanded), result.Queries > 0 ? static_cast<double>(result.Expanded) / result.Queries : 0.0, result.OpenListPeak, queriesPerSecond,
+				result.P50Us, result.P99Us, result.MaxUs, result.MeanPathLength,
+				static_cast<unsigned long long>(result.DataBytes), static_cast<unsigned long long>(result.ContextBytes), static_cast<long long>(result.PeakRssKb));
+		}
+		std::fprintf(file, "\n  ]\n}\n");
+	}
+
+	void PrintUsage()
+	{
+		std::fprintf(stderr,
+			"Usage: Navigation3DBenchmark [options]\n"
+			"  --sizes 10,32,64,128       Cells along each axis of the cubic grids (up to 512)\n"
+			"  --axes 0,1,2               MinSharedNeighborAxes settings\n"
+			"  --scenarios random,maze,pillars,city\n"
+			"  --modes astar,jps,hierarchical,octree,astar_smoothed,theta,lazy_theta,astar_bidirectional,astar_weighted,astar_costs\n"
+			"  --queries 100              Queries per run\n"
+			"  --cluster-size 16          Cluster size of the hierarchical mode\n"
+			"  --weight 2                 Heuristic weight of the weighted mode\n"
+			"  --max-seconds 10           Stop a run's queries early after this long\n"
+			"  --seed 1                   Seed of the obstacle generators and the queries\n"
+			"  --output results.json      Write the results to a file instead of stdout\n");
+	}
+
+	// Splits a comma separated list, calling parse on each item
+	template<typename ParseFuncType>
+	bool ParseList(const char* list, ParseFuncType&& parse)
+	{
+		std::string item;
+		for (const char* c = list;; ++c)
+		{
+			if (*c == ',' || *c == '\0')
+			{
+				if (item.empty() || parse(item.c_str()) == false)
+					return false;
+
+				item.clear();
+				if (*c == '\0')
+					return true;
+			}
+			else
+			{
+				item += *c;
+			}
+		}
+	}
+
+	bool ParseOptions(int argc, char** argv, NavBenchmarkOptions& out_options)
+	{
+		for (int i = 1; i < argc; ++i)
+		{
+			const char* option = argv[i];
+			if (std::strcmp(option, "--help") == 0 || i + 1 >= argc)
+				return false;
+
+			const char* value = argv[++i];
+			bool valid = true;
+			if (std::strcmp(option, "--sizes") == 0)
+			{
+				out_options.Sizes.clear();
+				valid = ParseList(value, [&](const char* item) { const int32 size = std::atoi(item); out_options.Sizes.push_back(size); return size >= 2 && size <= 512; });
+			}
+			else if (std::strcmp(option, "--axes") == 0)
+			{
+				out_options.Axes.clear();
+				valid = ParseList(value, [&](const char* item) { const int32 axes = std::atoi(item); out_options.Axes.push_back(axes); return axes >= 0 && axes <= 2; });
+			}
+			else if (std::strcmp(option, "--scenarios") == 0)
+			{
+				out_options.Scenarios.clear();
+				valid = ParseList(value, [&](const char* item)
+				{
+					out_options.Scenarios.push_back(ENavBenchmarkScenario::Count);
+					return ParseNavBenchmarkScenario(item, out_options.Scenarios.back());
+				});
+			}
+			else if (std::strcmp(option, "--modes") == 0)
+			{
+				out_options.Modes.clear();
+				valid = ParseList(value, [&](const char* item)
+				{
+					for (int32 mode = 0; mode < static_cast<int32>(ENavBenchmarkMode::Count); ++mode)
+					{
+						if (std::strcmp(item, GetModeName(static_cast<ENavBenchmarkMode>(mode))) == 0)
+						{
+							out_options.Modes.push_back(static_cast<ENavBenchmarkMode>(mode));
+							return true;
+						}
+					}
+					return false;
+				});
+			}
+			else if (std::strcmp(option, "--queries") == 0)
+			{
+				out_options.Queries = std::atoi(value);
+				valid = out_options.Queries > 0;
+			}
+			else if (std::strcmp(option, "--cluster-size") == 0)
+			{
+				out_options.ClusterSize = std::atoi(value);
+				valid = out_options.ClusterSize >= 2;
+			}
+			else if (std::strcmp(option, "--weight") == 0)
+			{
+				out_options.HeuristicWeight = static_cast<float>(std::atof(value));
+				valid = out_options.HeuristicWeight >= 1.0f;
+			}
+			else if (std::strcmp(option, "--max-seconds") == 0)
+			{
+				out_options.MaxSecondsPerRun = std::atof(value);
+				valid = out_options.MaxSecondsPerRun > 0.0;
+			}
+			else if (std::strcmp(option, "--seed") == 0)
+			{
+				out_options.Seed = static_cast<uint32>(std::strtoul(value, nullptr, 10));
+			}
+			else if (std::strcmp(option, "--output") == 0)
+			{
+				out_options.OutputPath = value;
+			}
+			else
+			{
+				valid = false;
+			}
+
+			if (valid == false)
+			{
+				std::fprintf(stderr, "Invalid option %s %s\n", option, value);
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	NavBenchmarkOptions options;
+	if (ParseOptions(argc, argv, options) == false)
+	{
+		PrintUsage();
+		return 1;
+	}
+
+	std::vector<NavBenchmarkResult> results;
+	for (const int32 size : options.Sizes)
+	{
+		for (const ENavBenchmarkScenario scenario : options.Scenarios)
+		{
+			// The layout only depends on the size, so it's generated once for every setting and mode
+			NavGrid grid;
+			grid.Init(FIntVector(size), 0);
+			NavOccupancy occupancy;
+			const Clock::time_point start = Clock::now();
+			GenerateNavBenchmarkScenario(scenario, grid, options.Seed, occupancy);
+			const double generateMs = GetElapsedMs(start);
+			const std::vector<std::pair<int32, int32> > queries = PickQueries(grid, occupancy, options.Queries, options.Seed + static_cast<uint32>(size));
+
+			for (const int32 axes : options.Axes)
+			{
+				for (const ENavBenchmarkMode mode : options.Modes)
+				{
+					NavBenchmarkResult result;
+					result.Scenario = scenario;
+					result.Size = size;
+					result.Axes = axes;
+					result.Mode = mode;
+					result.GenerateMs = generateMs;
+					RunMode(options, grid, occupancy, queries, result);
+					results.push_back(result);
+
+					std::fprintf(stderr, "%-8s %4d^3 axes %d %-12s setup %9.2f ms  %4d/%-4d found  p50 %10.1f us  p99 %10.1f us  %8.1f expanded/query\n",
+						GetNavBenchmarkScenarioName(scenario), size, axes, GetModeName(mode), result.SetupMs, result.Found, result.Queries,
+						result.P50Us, result.P99Us, result.Queries > 0 ? static_cast<double>(result.Expanded) / result.Queries : 0.0);
+				}
+			}
+		}
+	}
+
+	FILE* file = options.OutputPath != nullptr ? std::fopen(options.OutputPath, "w") : stdout;
+	if (file == nullptr)
+	{
+		std::fprintf(stderr, "Could not open %s\n", options.OutputPath);
+		return 1;
+	}
+	WriteResults(file, options, results);
+	if (file != stdout)
+	{
+		std::fclose(file);
+	}
+	return 0;
+}
@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavBenchmarkScenarios.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+	// The fraction of cells blocked by the random fill scenario
+	constexpr float RandomFillDensity = 0.2f;
+
+	// Blocks or frees every cell of a box, with inclusive max coordinates clamped to the grid
+	void FillBox(const NavGrid& grid, NavOccupancy& occupancy, const FIntVector& min, const FIntVector& max, bool blocked)
+	{
+		const FIntVector& divisions = grid.GetDivisions();
+		for (int32 z = FMath::Max(min.Z, 0); z <= FMath::Min(max.Z, divisions.Z - 1); ++z)
+			for (int32 y = FMath::Max(min.Y, 0); y <= FMath::Min(max.Y, divisions.Y - 1); ++y)
+				for (int32 x = FMath::Max(min.X, 0); x <= FMath::Min(max.X, divisions.X - 1); ++x)
+					occupancy.SetBlocked(grid.GetIndex(FIntVector(x, y, z)), blocked);
+	}
+
+	void GenerateRandomFill(const NavGrid& grid, std::mt19937& rng, NavOccupancy& occupancy)
+	{
+		std::bernoulli_distribution blocked(RandomFillDensity);
+		for (int32 index = 0; index < grid.Num(); ++index)
+		{
+			if (blocked(rng))
+			{
+				occupancy.SetBlocked(index, true);
+			}
+		}
+	}
+
+	void GenerateMaze(const NavGrid& grid, std::mt19937& rng, NavOccupancy& occupancy)
+	{
+		const FIntVector& divisions = grid.GetDivisions();
+		FillBox(grid, occupancy, FIntVector::ZeroValue, divisions - FIntVector(1), true);
+
+		// Rooms sit on the odd coordinates, and the walls between two rooms are knocked down as the depth first walk goes
+		const FIntVector rooms(FMath::Max((divisions.X - 1) / 2, 1), FMath::Max((divisions.Y - 1) / 2, 1), FMath::Max((divisions.Z - 1) / 2, 1));
+		auto getRoomCell = [](const FIntVector& room) { return FIntVector((room.X * 2) + 1, (room.Y * 2) + 1, (room.Z * 2) + 1); };
+		auto getRoomIndex = [&rooms](const FIntVector& room) { return (room.Z * rooms.X * rooms.Y) + (room.Y * rooms.X) + room.X; };
+
+		std::vector<uint8> visited(rooms.X * rooms.Y * rooms.Z, 0);
+		std::vector<FIntVector> stack;
+		stack.push_back(FIntVector::ZeroValue);
+		visited[0] = 1;
+		FillBox(grid, occupancy, getRoomCell(FIntVector::ZeroValue), getRoomCell(FIntVector::ZeroValue), false);
+
+		while (stack.empty() == false)
+		{
+			const FIntVector room = stack.back();
+
+			FIntVector unvisited[6];
+			int32 unvisitedCount = 0;
+			for (int32 face = 0; face < 6; ++face)
+			{
+				const NavNeighborOffset& offset = NavNeighborOffsets[face];
+				const FIntVector next(room.X + offset.X, room.Y + offset.Y, room.Z + offset.Z);
+				if (next.X >= 0 && next.X < rooms.X && next.Y >= 0 && next.Y < rooms.Y && next.Z >= 0 && next.Z < rooms.Z && visited[getRoomIndex(next)] == 0)
+				{
+					unvisited[unvisitedCount++] = next;
+				}
+			}
+
+			if (unvisitedCount == 0)
+			{
+				stack.pop_back();
+				continue;
+			}
+
+			const FIntVector next = unvisited[rng() % unvisitedCount];
+			visited[getRoomIndex(next)] = 1;
+			const FIntVector from = getRoomCell(room);
+			const FIntVector to = getRoomCell(next);
+			FillBox(grid, occupancy, FIntVector(FMath::Min(from.X, to.X), FMath::Min(from.Y, to.Y), FMath::Min(from.Z, to.Z)), FIntVector(FMath::Max(from.X, to.X), FMath::Max(from.Y, to.Y), FMath::Max(from.Z, to.Z)), false);
+			stack.push_back(next);
+		}
+	}
+
+	void GeneratePillars(const NavGrid& grid, std::mt19937& rng, NavOccupancy& occupancy)
+	{
+		const FIntVector& divisions = grid.GetDivisions();
+
+		// Enough pillars to cover about a sixth of the floor
+		const int32 pillarCount = FMath::Max((divisions.X * divisions.Y) / 24, 1);
+		for (int32 pillar = 0; pillar < pillarCount; ++pillar)
+		{
+			const int32 width = 1 + (rng() % 3);
+			const int32 depth = 1 + (rng() % 3);
+			const int32 height = 1 + (rng() % divisions.Z);
+			const FIntVector min(rng() % divisions.X, rng() % divisions.Y, 0);
+			FillBox(grid, occupancy, min, FIntVector(min.X + width - 1, min.Y + depth - 1, height - 1), true);
+		}
+	}
+
+	void GenerateCitySkyline(const NavGrid& grid, std::mt19937& rng, NavOccupancy& occupancy)
+	{
+		const FIntVector& divisions = grid.GetDivisions();
+		const int32 streetWidth = FMath::Max(divisions.X / 32, 1);
+
+		// Split the ground into blocks of random size along each axis, leaving a street after each one
+		auto splitAxis = [&rng, streetWidth](int32 length, std::vector<FIntVector>& out_spans)
+		{
+			for (int32 start = streetWidth; start < length;)
+			{
+				const int32 size = FMath::Max(length / 16, 2) + (rng() % FMath::Max(length / 8, 1));
+				out_spans.push_back(FIntVector(start, FMath::Min(start + size, length) - 1, 0));
+				start += size + streetWidth;
+			}
+		};
+
+		std::vector<FIntVector> spansX;
+		std::vector<FIntVector> spansY;
+		splitAxis(divisions.X, spansX);
+		splitAxis(divisions.Y, spansY);
+
+		// Most buildings are low and a few reach most of the way up, leaving open sky above all of them
+		std::exponential_distribution<float> heights(4.0f);
+		for (const FIntVector& spanY : spansY)
+		{
+			for (const FIntVector& spanX : spansX)
+			{
+				const int32 height = FMath::Clamp(static_cast<int32>(heights(rng) * divisions.Z), 1, (divisions.Z * 4) / 5);
+				FillBox(grid, occupancy, FIntVector(spanX.X, spanY.X, 0), FIntVector(spanX.Y, spanY.Y, height - 1), true);
+			}
+		}
+	}
+}
+
+const char* GetNavBenchmarkScenarioName(ENavBenchmarkScenario scenario)
+{
+	switch (scenario)
+	{
+	case ENavBenchmarkScenario::RandomFill:
+		return "random";
+	case ENavBenchmarkScenario::Maze:
+		return "maze";
+	case ENavBenchmarkScenario::Pillars:
+		return "pillars";
+	case ENavBenchmarkScenario::CitySkyline:
+		return "city";
+	default:
+		return "unknown";
+	}
+}
+
+bool ParseNavBenchmarkScenario(const char* name, ENavBenchmarkScenario& out_scenario)
+{
+	for (int32 scenario = 0; scenario < static_cast<int32>(ENavBenchmarkScenario::Count); ++scenario)
+	{
+		if (std::strcmp(name, GetNavBenchmarkScenarioName(static_cast<ENavBenchmarkScenario>(scenario))) == 0)
+		{
+			out_scenario = static_cast<ENavBenchmarkScenario>(scenario);
+			return true;
+		}
+	}
+	return false;
+}
+
+void GenerateNavBenchmarkScenario(ENavBenchmarkScenario scenario, const NavGrid& grid, uint32 seed, NavOccupancy& out_occupancy)
+{
+	out_occupancy.Init(grid.Num());
+
+	// Mix the scenario into the seed so each layout draws its own numbers
+	std::mt19937 rng(seed ^ (static_cast<uint32>(scenario) * 0x9e3779b9u));
+	switch (scenario)
+	{
+	case ENavBenchmarkScenario::RandomFill:
+		GenerateRandomFill(grid, rng, out_occupancy);
+		break;
+	case ENavBenchmarkScenario::Maze:
+		GenerateMaze(grid, rng, out_occupancy);
+		break;
+	case ENavBenchmarkScenario::Pillars:
+		GeneratePillars(grid, rng, out_occupancy);
+		break;
+	case ENavBenchmarkScenario::CitySkyline:
+		GenerateCitySkyline(grid, rng, out_occupancy);
+		break;
+	default:
+		break;
+	}
+}
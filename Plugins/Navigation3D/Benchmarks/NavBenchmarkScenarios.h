@@ -0,0 +1,41 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+
+class NavGrid;
+class NavOccupancy;
+
+// The obstacle layouts the benchmark can generate
+enum class ENavBenchmarkScenario : uint8
+{
+	// Every cell is blocked independently with a fixed probability
+	RandomFill,
+
+	// A perfect maze carved through solid rock, with corridors one cell wide along every axis
+	Maze,
+
+	// Vertical columns of random footprint and height standing on the floor
+	Pillars,
+
+	// Buildings of random height on city blocks separated by streets
+	CitySkyline,
+
+	Count
+};
+
+// Gets the name used for a scenario on the command line and in the results
+const char* GetNavBenchmarkScenarioName(ENavBenchmarkScenario scenario);
+
+// Finds the scenario with the specified name, returns false if there is none
+bool ParseNavBenchmarkScenario(const char* name, ENavBenchmarkScenario& out_scenario);
+
+/**
+* Fills an occupancy with one of the obstacle layouts. The same scenario, grid and seed always generate the same occupancy.
+* @param	scenario			The layout to generate
+* @param	grid				The grid to fill
+* @param	seed				The seed of the random generator
+* @param	out_occupancy		Initialized for the grid and filled, without its near blocked bits
+*/
+void GenerateNavBenchmarkScenario(ENavBenchmarkScenario scenario, const NavGrid& grid, uint32 seed, NavOccupancy& out_occupancy);
@@ -0,0 +1,56 @@
+#!/usr/bin/env python3
+"""Compares two result files written by Navigation3DBenchmark and reports the runs that got slower.
+
+    compare_results.py baseline.json candidate.json [--threshold 0.1]
+
+Runs are matched on scenario, size, MinSharedNeighborAxes and mode. Exits with 1 when a run's p50 or p99 latency, or its
+nodes expanded per query, grew by more than the threshold, or when it finds fewer paths than the baseline.
+"""
+
+import argparse
+import json
+import sys
+
+METRICS = ("p50_us", "p99_us", "nodes_expanded_per_query")
+
+
+def load(path):
+    with open(path) as file:
+        results = json.load(file)
+    if results.get("format_version") != 1:
+        sys.exit(f"{path}: unsupported format version {results.get('format_version')}")
+    return {(r["scenario"], r["size"], r["min_shared_neighbor_axes"], r["mode"]): r for r in results["results"]}
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("baseline")
+    parser.add_argument("candidate")
+    parser.add_argument("--threshold", type=float, default=0.1, help="relative increase reported as a regression")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    candidate = load(args.candidate)
+
+    regressions = 0
+    for key in sorted(baseline.keys() & candidate.keys()):
+        old, new = baseline[key], candidate[key]
+        name = "{} {}^3 axes {} {}".format(*key)
+        if new["found"] < old["found"]:
+            print(f"{name}: found {new['found']} paths, baseline found {old['found']}")
+            regressions += 1
+        for metric in METRICS:
+            if old[metric] > 0 and (new[metric] - old[metric]) / old[metric] > args.threshold:
+                print(f"{name}: {metric} {old[metric]:.1f} -> {new[metric]:.1f} ({(new[metric] / old[metric] - 1) * 100:+.1f}%)")
+                regressions += 1
+
+    missing = len(baseline.keys() - candidate.keys())
+    if missing:
+        print(f"{missing} baseline runs are missing from the candidate")
+
+    print(f"{regressions} regressions over {len(baseline.keys() & candidate.keys())} runs")
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -36,6 +36,7 @@ public class Navigation3D : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"PhysicsCore",
 				"Slate",
 				"SlateCore",
 				"ProceduralMeshComponent",
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include "NavGrid.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+#include <vector>
+
+/**
+* A* over the cells of the grid, moving to every neighbor allowed by the grid's MinSharedNeighborAxes at the cost of its
+* distance, optionally scaled by per cell costs. Cells are tested with is_blocked(int32 index) as they are reached, so the
+* same search runs over a prebuilt occupancy or a callback querying physics.
+*/
+class NavAStar
+{
+public:
+	/**
+	* Finds the shortest path between two cells.
+	* @param	grid				The grid to search
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	is_blocked			Tests if the cell at a flat index is blocked
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	template<typename BlockedFuncType>
+	static bool FindPath(const NavGrid& grid, int32 start_index, int32 end_index, BlockedFuncType&& is_blocked, NavSearchContext& context, std::vector<int32>& out_path)
+	{
+		// Every cell costs the same, the constant is folded away
+		return FindPathWithCosts(grid, start_index, end_index, is_blocked, [](int32) { return 1.0f; }, 1.0f, context, out_path);
+	}
+
+	/**
+	* Finds the cheapest path between two cells, where moving between two cells costs the distance times the average of their costs.
+	* @param	grid				The grid to search
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	is_blocked			Tests if the cell at a flat index is blocked
+	* @param	get_cell_cost		Gets the cost of the cell at a flat index, relative to the distance
+	* @param	min_cell_cost		The lowest cost of any cell, scaling the distance heuristic so it stays admissible
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	template<typename BlockedFuncType, typename CostFuncType>
+	static bool FindPathWithCosts(const NavGrid& grid, int32 start_index, int32 end_index, BlockedFuncType&& is_blocked, CostFuncType&& get_cell_cost, float min_cell_cost, NavSearchContext& context, std::vector<int32>& out_path)
+	{
+		NAV_TRACE_SCOPE(NavAStar::FindPath);
+
+		out_path.clear();
+		context.Reset(grid.Num());
+
+		const FIntVector endCoordinates = grid.GetCoordinates(end_index);
+		auto h = [&endCoordinates, min_cell_cost](const FIntVector& coordinates)
+		{
+			return FVector::Distance(FVector(endCoordinates), FVector(coordinates)) * min_cell_cost;
+		};
+
+		context.Open(start_index, INDEX_NONE, 0.0f, h(grid.GetCoordinates(start_index)));
+
+		while (context.IsOpenEmpty() == false)
+		{
+			const int32 current = context.PopOpen();
+
+			if (current == end_index)
+			{
+				// Rebuild the path from the end, then flip it
+				for (int32 node = current; node != INDEX_NONE; node = context.GetParent(node))
+				{
+					out_path.push_back(node);
+				}
+				std::reverse(out_path.begin(), out_path.end());
+				return true;
+			}
+
+			const FIntVector currentCoordinates = grid.GetCoordinates(current);
+			const float currentGScore = context.GetGScore(current);
+			const float currentCost = get_cell_cost(current);
+
+			grid.ForEachNeighbor(currentCoordinates, [&](int32 neighbor, int32 offsetIndex)
+			{
+				if (context.IsClosed(neighbor))
+					return;
+
+				// A move costs its length times the average of the costs of both cells
+				const float tentative_gScore = currentGScore + (NavNeighborDistances[offsetIndex] * 0.5f * (currentCost + get_cell_cost(neighbor)));
+
+				if (tentative_gScore < context.GetGScore(neighbor) && is_blocked(neighbor) == false)
+				{
+					context.Open(neighbor, current, tentative_gScore, tentative_gScore + h(grid.GetCoordinates(neighbor)));
+				}
+			});
+		}
+
+		// Failed to find path
+		return false;
+	}
+};
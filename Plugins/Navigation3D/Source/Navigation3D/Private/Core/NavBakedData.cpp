@@ -0,0 +1,226 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavBakedData.h"
+#include "NavOccupancy.h"
+#include <cstddef>
+#include <cstring>
+
+namespace
+{
+	// The number of header bytes covered by the checksum, every field before it
+	constexpr SIZE_T ChecksummedHeaderSize = offsetof(NavBakedDataHeader, Checksum);
+
+	uint32 CountBits(uint32 value)
+	{
+		value = value - ((value >> 1) & 0x55555555u);
+		value = (value & 0x33333333u) + ((value >> 2) & 0x33333333u);
+		return (((value + (value >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+	}
+
+	// Finds the first cell at or after index whose bit differs from blocked, or cell_count if the run reaches the end
+	int32 FindRunEnd(const uint32* words, int32 index, int32 cell_count, bool blocked)
+	{
+		while (index < cell_count)
+		{
+			const uint32 word = blocked ? ~words[index >> 5] : words[index >> 5];
+			const uint32 differentBits = word & (~0u << (index & 31));
+			if (differentBits != 0)
+				return FMath::Min(static_cast<int32>((index & ~31) + FMath::CountTrailingZeros(differentBits)), cell_count);
+
+			index = (index & ~31) + 32;
+		}
+		return cell_count;
+	}
+
+	// Appends an unsigned integer 7 bits at a time, low bits first, with the high bit of each byte set when more follow
+	void WriteVarInt(uint32 value, std::vector<uint8>& out_data)
+	{
+		while (value >= 0x80u)
+		{
+			out_data.push_back(static_cast<uint8>(value | 0x80u));
+			value >>= 7;
+		}
+		out_data.push_back(static_cast<uint8>(value));
+	}
+
+	// Reads an integer written by WriteVarInt, returning false if it runs past the end or doesn't fit in 32 bits
+	bool ReadVarInt(const uint8*& data, const uint8* end, uint32& out_value)
+	{
+		out_value = 0;
+		for (int32 shift = 0; shift < 35; shift += 7)
+		{
+			if (data == end)
+				return false;
+
+			const uint8 byte = *data++;
+			if (shift == 28 && byte > 0x0Fu)
+				return false;
+
+			out_value |= static_cast<uint32>(byte & 0x7Fu) << shift;
+			if ((byte & 0x80u) == 0)
+				return true;
+		}
+		return false;
+	}
+}
+
+void NavBakedData::Write(const FIntVector& divisions, const NavOccupancy& occupancy, uint64 level_checksum, ENavBakedCompression compression, std::vector<uint8>& out_data)
+{
+	NAV_TRACE_SCOPE(NavBakedData::Write);
+
+	const int32 cellCount = occupancy.Num();
+	const uint32* words = occupancy.GetWords();
+	const SIZE_T packedSize = occupancy.GetWordCount() * sizeof(uint32);
+
+	NavBakedDataHeader header = {};
+	header.Magic = Magic;
+	header.Version = Version;
+	header.Divisions[0] = divisions.X;
+	header.Divisions[1] = divisions.Y;
+	header.Divisions[2] = divisions.Z;
+	header.CellCount = static_cast<uint32>(cellCount);
+	header.LevelChecksum = level_checksum;
+	for (int32 i = 0; i < occupancy.GetWordCount(); ++i)
+	{
+		header.BlockedCellCount += CountBits(words[i]);
+	}
+
+	out_data.assign(sizeof(NavBakedDataHeader), 0);
+
+	if (compression == ENavBakedCompression::RunLength)
+	{
+		bool blocked = false;
+		for (int32 index = 0; index < cellCount && out_data.size() - sizeof(NavBakedDataHeader) < packedSize; blocked = !blocked)
+		{
+			const int32 runEnd = FindRunEnd(words, index, cellCount, blocked);
+			WriteVarInt(static_cast<uint32>(runEnd - index), out_data);
+			index = runEnd;
+		}
+
+		// Noisy occupancies encode to more bytes than the bits themselves
+		if (out_data.size() - sizeof(NavBakedDataHeader) >= packedSize)
+		{
+			compression = ENavBakedCompression::BitPacked;
+			out_data.resize(sizeof(NavBakedDataHeader));
+		}
+	}
+
+	if (compression == ENavBakedCompression::BitPacked)
+	{
+		out_data.resize(sizeof(NavBakedDataHeader) + packedSize);
+		std::memcpy(out_data.data() + sizeof(NavBakedDataHeader), words, packedSize);
+	}
+
+	header.Compression = static_cast<uint8>(compression);
+	header.PayloadSize = static_cast<uint32>(out_data.size() - sizeof(NavBakedDataHeader));
+	header.Checksum = Hash(out_data.data() + sizeof(NavBakedDataHeader), header.PayloadSize, Hash(&header, ChecksummedHeaderSize));
+	std::memcpy(out_data.data(), &header, sizeof(NavBakedDataHeader));
+}
+
+ENavBakedDataResult NavBakedData::ReadHeader(const uint8* data, SIZE_T size, NavBakedDataHeader& out_header)
+{
+	if (data == nullptr || size < sizeof(NavBakedDataHeader))
+		return ENavBakedDataResult::Truncated;
+
+	std::memcpy(&out_header, data, sizeof(NavBakedDataHeader));
+	if (out_header.Magic != Magic)
+		return ENavBakedDataResult::InvalidFormat;
+
+	if (out_header.Version != Version)
+		return ENavBakedDataResult::UnsupportedVersion;
+
+	const int64 cellCount = static_cast<int64>(out_header.Divisions[0]) * out_header.Divisions[1] * out_header.Divisions[2];
+	if (out_header.Divisions[0] <= 0 || out_header.Divisions[1] <= 0 || out_header.Divisions[2] <= 0 || cellCount != out_header.CellCount || cellCount > 0x7FFFFFFF)
+		return ENavBakedDataResult::InvalidFormat;
+
+	if (out_header.Compression > static_cast<uint8>(ENavBakedCompression::RunLength))
+		return ENavBakedDataResult::InvalidFormat;
+
+	if (size - sizeof(NavBakedDataHeader) < out_header.PayloadSize)
+		return ENavBakedDataResult::Truncated;
+
+	return ENavBakedDataResult::Success;
+}
+
+ENavBakedDataResult NavBakedData::Read(const uint8* data, SIZE_T size, NavOccupancy& out_occupancy, NavBakedDataHeader* out_header)
+{
+	NAV_TRACE_SCOPE(NavBakedData::Read);
+
+	out_occupancy.Reset();
+
+	NavBakedDataHeader header;
+	ENavBakedDataResult result = ReadHeader(data, size, header);
+	if (out_header != nullptr)
+	{
+		*out_header = header;
+	}
+	if (result != ENavBakedDataResult::Success)
+		return result;
+
+	const uint8* payload = data + sizeof(NavBakedDataHeader);
+	const uint8* payloadEnd = payload + header.PayloadSize;
+	if (Hash(payload, header.PayloadSize, Hash(&header, ChecksummedHeaderSize)) != header.Checksum)
+		return ENavBakedDataResult::Corrupt;
+
+	const int32 cellCount = static_cast<int32>(header.CellCount);
+	out_occupancy.Init(cellCount);
+
+	if (header.Compression == static_cast<uint8>(ENavBakedCompression::BitPacked))
+	{
+		if (header.PayloadSize != out_occupancy.GetWordCount() * sizeof(uint32))
+		{
+			out_occupancy.Reset();
+			return ENavBakedDataResult::InvalidFormat;
+		}
+
+		uint32* words = out_occupancy.GetMutableWords();
+		std::memcpy(words, payload, header.PayloadSize);
+
+		// Keep the bits past the last cell clear, as the occupancy itself does
+		if ((cellCount & 31) != 0)
+		{
+			words[out_occupancy.GetWordCount() - 1] &= (1u << (cellCount & 31)) - 1u;
+		}
+		return ENavBakedDataResult::Success;
+	}
+
+	// Runs alternate between free and blocked cells and must cover the grid exactly
+	int64 index = 0;
+	bool blocked = false;
+	while (payload != payloadEnd)
+	{
+		uint32 runLength;
+		if (ReadVarInt(payload, payloadEnd, runLength) == false || index + runLength > cellCount)
+		{
+			out_occupancy.Reset();
+			return ENavBakedDataResult::InvalidFormat;
+		}
+
+		if (blocked)
+		{
+			out_occupancy.SetBlockedRange(static_cast<int32>(index), static_cast<int32>(runLength));
+		}
+		index += runLength;
+		blocked = !blocked;
+	}
+
+	if (index != cellCount)
+	{
+		out_occupancy.Reset();
+		return ENavBakedDataResult::InvalidFormat;
+	}
+	return ENavBakedDataResult::Success;
+}
+
+uint64 NavBakedData::Hash(const void* data, SIZE_T size, uint64 seed)
+{
+	const uint8* bytes = static_cast<const uint8*>(data);
+	uint64 hash = seed;
+	for (SIZE_T i = 0; i < size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 0x100000001B3ull;
+	}
+	return hash;
+}
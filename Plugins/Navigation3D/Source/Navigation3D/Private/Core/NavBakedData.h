@@ -0,0 +1,105 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavOccupancy;
+
+// How the occupancy bits are stored in baked data
+enum class ENavBakedCompression : uint8
+{
+	// The packed bitfield as is, 32 cells per word. Loads with a single copy.
+	BitPacked = 0,
+
+	// Alternating runs of free and blocked cells, starting with free cells, each run length stored as a variable length
+	// integer. Much smaller when obstacles are large and few.
+	RunLength = 1
+};
+
+// Why reading baked data failed
+enum class ENavBakedDataResult : uint8
+{
+	Success,
+
+	// The data is shorter than its header says
+	Truncated,
+
+	// The data doesn't start with the baked data magic, or the payload doesn't decode to the grid size
+	InvalidFormat,
+
+	// The data was written by a different version of the format
+	UnsupportedVersion,
+
+	// The header or the payload doesn't match the checksum stored in the header
+	Corrupt
+};
+
+// The fixed size header at the start of baked data. Every field is stored little endian.
+struct NavBakedDataHeader
+{
+	uint32 Magic;
+	uint16 Version;
+	uint8 Compression;
+	uint8 Reserved;
+	int32 Divisions[3];
+	uint32 CellCount;
+	uint32 PayloadSize;
+	uint32 BlockedCellCount;
+	uint64 LevelChecksum;
+
+	// The hash of every field above and of the payload
+	uint64 Checksum;
+
+	// Gets the number of cells along each axis of the grid the data was baked for
+	FORCEINLINE FIntVector GetDivisions() const { return FIntVector(Divisions[0], Divisions[1], Divisions[2]); }
+};
+
+static_assert(sizeof(NavBakedDataHeader) == 48, "The baked data header must not have any padding");
+
+/**
+* Reads and writes the occupancy of a grid as a single contiguous block of bytes: a versioned header followed by the occupancy
+* bits, either packed or run length encoded. Reading decodes straight from the block (a memory mapped file or the bytes
+* of a loaded asset) into the two bitfields of the occupancy, without any other allocation. The header stores a checksum
+* of the level the data was baked from, so callers can detect stale data before using it, and a checksum of
+* the whole block to detect corruption.
+*/
+class NavBakedData
+{
+public:
+	// "N3DB" read as a little endian integer
+	static constexpr uint32 Magic = 0x4244334E;
+
+	// Bumped whenever the layout of the header or of a payload changes
+	static constexpr uint16 Version = 1;
+
+	// The initial value of Hash, the 64-bit FNV-1a offset basis
+	static constexpr uint64 HashSeed = 0xCBF29CE484222325ull;
+
+	/**
+	* Writes the occupancy of a grid.
+	* @param	divisions			The number of cells along each axis of the grid
+	* @param	occupancy			The occupancy to write, with one bit per cell of the grid
+	* @param	level_checksum		Identifies the level content the occupancy was built from
+	* @param	compression			The preferred payload encoding. Run length encoding falls back to packed bits when it isn't smaller.
+	* @param	out_data			Receives the header and the payload
+	*/
+	static void Write(const FIntVector& divisions, const NavOccupancy& occupancy, uint64 level_checksum, ENavBakedCompression compression, std::vector<uint8>& out_data);
+
+	// Reads and validates the header, without looking at the payload
+	static ENavBakedDataResult ReadHeader(const uint8* data, SIZE_T size, NavBakedDataHeader& out_header);
+
+	/**
+	* Reads the occupancy bits. The near blocked bits of the occupancy are left clear and must be rebuilt by the caller.
+	* @param	data				The start of the baked data
+	* @param	size				The number of bytes of baked data
+	* @param	out_occupancy		Initialized to the number of cells of the baked grid and filled with the baked bits
+	* @param	out_header			Receives the header (optional)
+	* @return	Success, or why the data couldn't be read, in which case the occupancy is left reset
+	*/
+	static ENavBakedDataResult Read(const uint8* data, SIZE_T size, NavOccupancy& out_occupancy, NavBakedDataHeader* out_header = nullptr);
+
+	// Combines bytes into a 64-bit FNV-1a hash. Pass the previous result as the seed to hash several blocks.
+	static uint64 Hash(const void* data, SIZE_T size, uint64 seed = HashSeed);
+};
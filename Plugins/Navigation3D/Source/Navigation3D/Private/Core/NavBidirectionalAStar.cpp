@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavBidirectionalAStar.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+
+bool NavBidirectionalAStar::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path)
+{
+	NAV_TRACE_SCOPE(NavBidirectionalAStar::FindPath);
+
+	out_path.clear();
+	NavSearchContext& reverseContext = context.GetReverseContext();
+	context.Reset(grid.Num());
+	reverseContext.Reset(grid.Num());
+
+	if (start_index == end_index)
+	{
+		out_path.push_back(start_index);
+		return true;
+	}
+
+	// Like A*, the start is never tested but the end has to be free
+	if (occupancy.IsBlocked(end_index))
+		return false;
+
+	const FVector startLocation(grid.GetCoordinates(start_index));
+	const FVector endLocation(grid.GetCoordinates(end_index));
+	context.Open(start_index, INDEX_NONE, 0.0f, FVector::Distance(startLocation, endLocation));
+	reverseContext.Open(end_index, INDEX_NONE, 0.0f, FVector::Distance(startLocation, endLocation));
+
+	// The cost of the shortest path found through a cell both searches reached, and that cell
+	float bestCost = FLT_MAX;
+	int32 meetingCell = INDEX_NONE;
+
+	while (context.IsOpenEmpty() == false && reverseContext.IsOpenEmpty() == false)
+	{
+		// Every path shorter than the best one goes through an open cell of each side, with a score below the best cost.
+		// The heuristics are consistent, so the scores are lower bounds and no such path is left once either side reaches it.
+		if (FMath::Max(context.GetMinOpenScore(), reverseContext.GetMinOpenScore()) >= bestCost)
+			break;
+
+		// Grow the smaller side, which keeps the two frontiers balanced and finishes first around walled in cells
+		const bool forward = context.GetOpenNum() <= reverseContext.GetOpenNum();
+		NavSearchContext& side = forward ? context : reverseContext;
+		const NavSearchContext& otherSide = forward ? reverseContext : context;
+		const FVector& target = forward ? endLocation : startLocation;
+
+		const int32 current = side.PopOpen();
+		const float currentGScore = side.GetGScore(current);
+		grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32 offsetIndex)
+		{
+			if (side.IsClosed(neighbor))
+				return;
+
+			// The backward search may step onto the start even if it's blocked, like the forward search leaves it
+			const float tentativeGScore = currentGScore + NavNeighborDistances[offsetIndex];
+			if (tentativeGScore >= side.GetGScore(neighbor) || (neighbor != start_index && occupancy.IsBlocked(neighbor)))
+				return;
+
+			side.Open(neighbor, current, tentativeGScore, tentativeGScore + FVector::Distance(target, FVector(grid.GetCoordinates(neighbor))));
+
+			const float otherGScore = otherSide.GetGScore(neighbor);
+			if (otherGScore != FLT_MAX && tentativeGScore + otherGScore < bestCost)
+			{
+				bestCost = tentativeGScore + otherGScore;
+				meetingCell = neighbor;
+			}
+		});
+	}
+
+	if (meetingCell == INDEX_NONE)
+		return false;
+
+	// Walk back to the start from the meeting cell, flip it, then walk on to the end
+	for (int32 node = meetingCell; node != INDEX_NONE; node = context.GetParent(node))
+	{
+		out_path.push_back(node);
+	}
+	std::reverse(out_path.begin(), out_path.end());
+	for (int32 node = reverseContext.GetParent(meetingCell); node != INDEX_NONE; node = reverseContext.GetParent(node))
+	{
+		out_path.push_back(node);
+	}
+	return true;
+}
@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+class NavSearchContext;
+
+/**
+* Bidirectional A* over the cells of the grid, with the same moves and costs as NavAStar. One search grows from the start
+* towards the end and another from the end towards the start, expanding whichever has fewer open cells. It stops once either
+* side can't find anything shorter than the best path through a cell both have reached, so the path found is as short as A*'s.
+* When one of the cells is walled in, its side runs out of cells after flooding only the small region around it.
+*/
+class NavBidirectionalAStar
+{
+public:
+	/**
+	* Finds the shortest path between two cells.
+	* @param	grid				The grid to search
+	* @param	occupancy			The occupancy of the grid
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	context				The search state to use for the forward search, its reverse context is used for the backward one
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	static bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path);
+};
@@ -0,0 +1,143 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavClearanceField.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+
+namespace
+{
+	// The number of lines transformed by each parallel task
+	constexpr int32 LineChunkSize = 64;
+
+	/**
+	* Computes the lower envelope of the parabolas (q - p)^2 + values[p] rooted at each position p of a line, which gives every
+	* position the squared distance to the closest zero once the passes of the previous axes have filled the values in.
+	* @param	values				The value at each position of the line, replaced by the result clamped to MaxClearanceSq
+	* @param	count				The number of positions along the line
+	* @param	roots				Scratch storage for the positions of the parabolas of the envelope, at least count long
+	* @param	bounds				Scratch storage for the ranges of the envelope covered by each parabola, at least count + 1 long
+	* @param	results				Scratch storage for the results, at least count long
+	*/
+	void TransformLine(uint16* values, int32 count, int32* roots, double* bounds, uint16* results)
+	{
+		// Build the envelope left to right, dropping the parabolas the new one hides
+		int32 k = 0;
+		roots[0] = 0;
+		bounds[0] = -DBL_MAX;
+		bounds[1] = DBL_MAX;
+		for (int32 q = 1; q < count; ++q)
+		{
+			double s;
+			while (true)
+			{
+				const int32 p = roots[k];
+				s = static_cast<double>((static_cast<int64>(values[q]) + (static_cast<int64>(q) * q)) - (static_cast<int64>(values[p]) + (static_cast<int64>(p) * p))) / (2.0 * (q - p));
+				if (s > bounds[k])
+					break;
+
+				--k;
+			}
+			++k;
+			roots[k] = q;
+			bounds[k] = s;
+			bounds[k + 1] = DBL_MAX;
+		}
+
+		// Read the envelope back at each position
+		k = 0;
+		for (int32 q = 0; q < count; ++q)
+		{
+			while (bounds[k + 1] < q)
+			{
+				++k;
+			}
+			const int64 distance = static_cast<int64>(q - roots[k]);
+			results[q] = static_cast<uint16>(FMath::Min<int64>((distance * distance) + values[roots[k]], NavClearanceField::MaxClearanceSq));
+		}
+		for (int32 q = 0; q < count; ++q)
+		{
+			values[q] = results[q];
+		}
+	}
+}
+
+void NavClearanceField::Build(const NavGrid& grid, const NavOccupancy& occupancy, const ParallelForFuncType& parallel_for)
+{
+	NAV_TRACE_SCOPE(NavClearanceField::Build);
+
+	// Distances past the clamp only ever add up to more than it, so clamping the free cells from the start keeps every result exact up to it
+	ClearancesSq.resize(grid.Num());
+	for (int32 i = 0; i < grid.Num(); ++i)
+	{
+		ClearancesSq[i] = occupancy.IsBlocked(i) ? 0 : MaxClearanceSq;
+	}
+
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		TransformLines(grid, axis, parallel_for);
+	}
+}
+
+uint16 NavClearanceField::GetRequiredClearanceSq(float agent_radius)
+{
+	// Half the diagonal of a cell
+	const float distance = FMath::Max(agent_radius, 0.0f) + 0.86602540f;
+	return static_cast<uint16>(FMath::CeilToInt(FMath::Min(distance * distance, static_cast<float>(MaxClearanceSq))));
+}
+
+SIZE_T NavClearanceField::GetAllocatedSize() const
+{
+	return ClearancesSq.capacity() * sizeof(uint16);
+}
+
+void NavClearanceField::TransformLines(const NavGrid& grid, int32 axis, const ParallelForFuncType& parallel_for)
+{
+	const FIntVector& divisions = grid.GetDivisions();
+	const int32 strides[3] = { 1, divisions.X, divisions.X * divisions.Y };
+	const int32 count = divisions[axis];
+	const int32 stride = strides[axis];
+
+	// The lines are numbered along the two other axes, the lower one first
+	const int32 firstAxis = axis == 0 ? 1 : 0;
+	const int32 secondAxis = axis == 2 ? 1 : 2;
+	const int32 lineCount = divisions[firstAxis] * divisions[secondAxis];
+	const int32 chunkCount = (lineCount + LineChunkSize - 1) / LineChunkSize;
+
+	auto transformChunk = [&](int32 chunk)
+	{
+		std::vector<uint16> line(count);
+		std::vector<int32> roots(count);
+		std::vector<double> bounds(count + 1);
+		std::vector<uint16> results(count);
+
+		const int32 lastLine = FMath::Min(lineCount, (chunk + 1) * LineChunkSize);
+		for (int32 lineIndex = chunk * LineChunkSize; lineIndex < lastLine; ++lineIndex)
+		{
+			const int32 first = ((lineIndex % divisions[firstAxis]) * strides[firstAxis]) + ((lineIndex / divisions[firstAxis]) * strides[secondAxis]);
+			for (int32 i = 0; i < count; ++i)
+			{
+				line[i] = ClearancesSq[first + (i * stride)];
+			}
+
+			TransformLine(line.data(), count, roots.data(), bounds.data(), results.data());
+
+			for (int32 i = 0; i < count; ++i)
+			{
+				ClearancesSq[first + (i * stride)] = line[i];
+			}
+		}
+	};
+
+	if (parallel_for != nullptr)
+	{
+		parallel_for(chunkCount, transformChunk);
+	}
+	else
+	{
+		for (int32 chunk = 0; chunk < chunkCount; ++chunk)
+		{
+			transformChunk(chunk);
+		}
+	}
+}
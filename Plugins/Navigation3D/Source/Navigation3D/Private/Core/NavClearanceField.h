@@ -0,0 +1,67 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <functional>
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+
+/**
+* The Euclidean distance from every cell to the closest blocked cell, in cells between their centers, so agents of any size
+* share the same grid: a cell is usable by an agent when its clearance leaves room for the agent's radius. Built with an exact
+* linear time distance transform (Felzenszwalb and Huttenlocher) run along X, then Y, then Z, each line of a pass independent
+* of the others so they run in parallel. Squared distances are stored in 16 bits, anything further than 255 cells reads as
+* MaxClearanceSq. The space outside the grid counts as free.
+*/
+class NavClearanceField
+{
+public:
+	// Runs body(index) for every index in [0, count), possibly in parallel, returning once every call has returned
+	using ParallelForFuncType = std::function<void(int32 count, const std::function<void(int32 index)>& body)>;
+
+	// The squared clearance of cells further than 255 cells from any blocked cell
+	static constexpr uint16 MaxClearanceSq = 0xFFFF;
+
+	/**
+	* Computes the clearance of every cell.
+	* @param	grid				The grid the occupancy covers
+	* @param	occupancy			The occupancy to measure the distances to
+	* @param	parallel_for		Runs the lines of each pass in parallel (optional, they run one after another otherwise)
+	*/
+	void Build(const NavGrid& grid, const NavOccupancy& occupancy, const ParallelForFuncType& parallel_for = nullptr);
+
+	// Checks if the field has been built
+	FORCEINLINE bool IsValid() const { return ClearancesSq.size() > 0; }
+
+	// Gets the squared distance between the centers of a cell and the closest blocked cell, 0 for blocked cells
+	FORCEINLINE uint16 GetClearanceSq(int32 index) const { return ClearancesSq[index]; }
+
+	// Gets the distance between the centers of a cell and the closest blocked cell, in cells
+	FORCEINLINE float GetClearance(int32 index) const { return FMath::Sqrt(static_cast<float>(ClearancesSq[index])); }
+
+	/**
+	* Gets the squared clearance a cell needs for an agent to stand at its center without overlapping the blocked cells around it.
+	* No point of a blocked cell is closer than half the diagonal of a cell to its center, which the agent's radius is added to.
+	* This is exact for blocked cells sharing only a corner with the cell and conservative for the others, so an agent of radius 0
+	* fits in every free cell but the narrowest gaps only let through agents much smaller than a cell.
+	* @param	agent_radius		The radius of the agent, in cells
+	* @return	The squared clearance to compare with GetClearanceSq
+	*/
+	static uint16 GetRequiredClearanceSq(float agent_radius);
+
+	// Checks if an agent needing the squared clearance fits in a cell
+	FORCEINLINE bool IsClear(int32 index, uint16 required_clearance_sq) const { return ClearancesSq[index] >= required_clearance_sq; }
+
+	// Gets the number of bytes used by the field
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Helper function running the distance transform along every line of cells parallel to an axis
+	void TransformLines(const NavGrid& grid, int32 axis, const ParallelForFuncType& parallel_for);
+
+	// The squared clearance of each cell, indexed by flat index
+	std::vector<uint16> ClearancesSq;
+};
@@ -0,0 +1,509 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavClusterGraph.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+
+namespace
+{
+	/**
+	* Runs A* towards a cell without leaving a box of cells, or Dijkstra from the start when there is no end. The cost of the path
+	* to each cell reached is left in the context.
+	* @param	on_closed			Called as on_closed(int32 index) with each cell expanded, returns true to stop the search
+	* @return	Whether on_closed stopped the search
+	*/
+	template<typename ClosedFuncType>
+	bool SearchInBox(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& box_min, const FIntVector& box_max, int32 start_index, int32 end_index, NavSearchContext& context, ClosedFuncType&& on_closed)
+	{
+		context.Reset(grid.Num());
+
+		const bool hasEnd = end_index != INDEX_NONE;
+		const FVector endLocation = hasEnd ? FVector(grid.GetCoordinates(end_index)) : FVector::ZeroVector;
+		auto h = [&](const FIntVector& coordinates)
+		{
+			return hasEnd ? FVector::Distance(endLocation, FVector(coordinates)) : 0.0f;
+		};
+
+		context.Open(start_index, INDEX_NONE, 0.0f, h(grid.GetCoordinates(start_index)));
+
+		while (context.IsOpenEmpty() == false)
+		{
+			const int32 current = context.PopOpen();
+			if (on_closed(current))
+				return true;
+
+			const FIntVector currentCoordinates = grid.GetCoordinates(current);
+			const float currentGScore = context.GetGScore(current);
+
+			grid.ForEachNeighbor(currentCoordinates, [&](int32 neighbor, int32 offsetIndex)
+			{
+				const NavNeighborOffset& offset = NavNeighborOffsets[offsetIndex];
+				const FIntVector neighborCoordinates(currentCoordinates.X + offset.X, currentCoordinates.Y + offset.Y, currentCoordinates.Z + offset.Z);
+				if (neighborCoordinates.X < box_min.X || neighborCoordinates.X > box_max.X ||
+					neighborCoordinates.Y < box_min.Y || neighborCoordinates.Y > box_max.Y ||
+					neighborCoordinates.Z < box_min.Z || neighborCoordinates.Z > box_max.Z)
+					return;
+
+				if (context.IsClosed(neighbor))
+					return;
+
+				const float tentative_gScore = currentGScore + NavNeighborDistances[offsetIndex];
+				if (tentative_gScore < context.GetGScore(neighbor) && occupancy.IsBlocked(neighbor) == false)
+				{
+					context.Open(neighbor, current, tentative_gScore, tentative_gScore + h(neighborCoordinates));
+				}
+			});
+		}
+
+		return false;
+	}
+
+	// Runs A* between two cells without leaving a box of cells
+	bool SearchInBox(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& box_min, const FIntVector& box_max, int32 start_index, int32 end_index, NavSearchContext& context)
+	{
+		return SearchInBox(grid, occupancy, box_min, box_max, start_index, end_index, context, [end_index](int32 index) { return index == end_index; });
+	}
+
+	// Runs Dijkstra from a cell without leaving a box of cells, until every target cell has been reached
+	void SearchInBox(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& box_min, const FIntVector& box_max, int32 start_index, const int32* targets, int32 target_count, NavSearchContext& context)
+	{
+		int32 remaining = target_count;
+		SearchInBox(grid, occupancy, box_min, box_max, start_index, INDEX_NONE, context, [&](int32 index)
+		{
+			for (int32 i = 0; i < target_count; ++i)
+			{
+				if (targets[i] == index && --remaining == 0)
+					return true;
+			}
+			return false;
+		});
+	}
+
+	// Appends the cells of the path found by the last search to the end, skipping its first cell
+	void AppendSearchPath(const NavSearchContext& context, int32 end_index, std::vector<int32>& out_path)
+	{
+		const size_t first = out_path.size();
+		for (int32 node = end_index; context.GetParent(node) != INDEX_NONE; node = context.GetParent(node))
+		{
+			out_path.push_back(node);
+		}
+		std::reverse(out_path.begin() + first, out_path.end());
+	}
+}
+
+void NavClusterGraph::Build(const NavGrid& grid, const NavOccupancy& occupancy, int32 cluster_size, const NavClusterGraph* previous, const std::vector<int32>& changed_cells)
+{
+	NAV_TRACE_SCOPE(NavClusterGraph::Build);
+
+	Divisions = grid.GetDivisions();
+	ClusterSize = FMath::Max(cluster_size, 1);
+	ClusterCounts = FIntVector((Divisions.X + ClusterSize - 1) / ClusterSize, (Divisions.Y + ClusterSize - 1) / ClusterSize, (Divisions.Z + ClusterSize - 1) / ClusterSize);
+	const int32 clusterCount = ClusterCounts.X * ClusterCounts.Y * ClusterCounts.Z;
+
+	// The clusters of a previous graph only line up with ours if it was built for the same grid and cluster size
+	const bool reuse = previous != nullptr && previous->IsValid() && previous->ClusterSize == ClusterSize && previous->Divisions == Divisions;
+
+	std::vector<uint8> dirty(clusterCount, reuse ? 0 : 1);
+	if (reuse)
+	{
+		Clusters = previous->Clusters;
+
+		// A changed cell changes its own cluster, and the entrances of the clusters on the other side of the faces it lies on
+		for (const int32 cell : changed_cells)
+		{
+			const FIntVector coordinates = grid.GetCoordinates(cell);
+			const FIntVector clusterCoordinates(coordinates.X / ClusterSize, coordinates.Y / ClusterSize, coordinates.Z / ClusterSize);
+			dirty[GetClusterIndex(coordinates)] = 1;
+
+			// A cell can lie on both faces along an axis when clusters are a single cell wide
+			auto markNeighbor = [&](int32 axis, int32 step)
+			{
+				FIntVector neighbor = clusterCoordinates;
+				neighbor[axis] += step;
+				dirty[(neighbor.Z * ClusterCounts.X * ClusterCounts.Y) + (neighbor.Y * ClusterCounts.X) + neighbor.X] = 1;
+			};
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				const int32 local = coordinates[axis] - (clusterCoordinates[axis] * ClusterSize);
+				if (local == 0 && clusterCoordinates[axis] > 0)
+				{
+					markNeighbor(axis, -1);
+				}
+				if (local == ClusterSize - 1 && clusterCoordinates[axis] + 1 < ClusterCounts[axis])
+				{
+					markNeighbor(axis, 1);
+				}
+			}
+		}
+	}
+	else
+	{
+		Clusters.assign(clusterCount, NavCluster());
+	}
+
+	NavSearchContext context;
+	for (int32 cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		if (dirty[cluster])
+		{
+			BuildCluster(grid, occupancy, cluster, context);
+		}
+	}
+
+	// Number the entrances of every cluster so the abstract search can use dense ids
+	EntranceOffsets.resize(clusterCount);
+	EntranceClusters.clear();
+	for (int32 cluster = 0; cluster < clusterCount; ++cluster)
+	{
+		EntranceOffsets[cluster] = static_cast<int32>(EntranceClusters.size());
+		EntranceClusters.insert(EntranceClusters.end(), Clusters[cluster].EntranceCells.size(), cluster);
+	}
+}
+
+void NavClusterGraph::BuildCluster(const NavGrid& grid, const NavOccupancy& occupancy, int32 cluster_index, NavSearchContext& context)
+{
+	NavCluster& cluster = Clusters[cluster_index];
+	cluster.EntranceCells.clear();
+
+	const FIntVector clusterCoordinates = GetClusterCoordinates(cluster_index);
+	std::vector<int32> faceCells;
+	for (int32 face = 0; face < 6; ++face)
+	{
+		const int32 axis = face / 2;
+		cluster.FaceBegin[face] = static_cast<int32>(cluster.EntranceCells.size());
+
+		if (face % 2 == 0)
+		{
+			// The entrances on the -axis face are the ones of the previous cluster's +axis face, moved across it.
+			// Both clusters find them the same way, so the entrances of a face line up one to one on each side.
+			if (clusterCoordinates[axis] == 0)
+				continue;
+
+			FIntVector previousCluster = clusterCoordinates;
+			--previousCluster[axis];
+			GetFaceEntrances(grid, occupancy, previousCluster, axis, faceCells);
+
+			const int32 step = grid.GetNeighborIndexOffset(axis * 2);
+			for (const int32 cell : faceCells)
+			{
+				cluster.EntranceCells.push_back(cell + step);
+			}
+		}
+		else
+		{
+			GetFaceEntrances(grid, occupancy, clusterCoordinates, axis, faceCells);
+			cluster.EntranceCells.insert(cluster.EntranceCells.end(), faceCells.begin(), faceCells.end());
+		}
+	}
+	cluster.FaceBegin[6] = static_cast<int32>(cluster.EntranceCells.size());
+
+	// Cache the cost between each pair of entrances. Paths are symmetric, so the last entrance doesn't need its own search.
+	const int32 entranceCount = static_cast<int32>(cluster.EntranceCells.size());
+	cluster.Costs.assign(entranceCount * entranceCount, FLT_MAX);
+
+	FIntVector boxMin, boxMax;
+	GetClusterBounds(clusterCoordinates, boxMin, boxMax);
+	for (int32 i = 0; i < entranceCount; ++i)
+	{
+		cluster.Costs[(i * entranceCount) + i] = 0.0f;
+		if (i == entranceCount - 1)
+			break;
+
+		SearchInBox(grid, occupancy, boxMin, boxMax, cluster.EntranceCells[i], &cluster.EntranceCells[i + 1], entranceCount - i - 1, context);
+		for (int32 j = i + 1; j < entranceCount; ++j)
+		{
+			const float cost = context.GetGScore(cluster.EntranceCells[j]);
+			cluster.Costs[(i * entranceCount) + j] = cost;
+			cluster.Costs[(j * entranceCount) + i] = cost;
+		}
+	}
+}
+
+void NavClusterGraph::GetFaceEntrances(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& cluster_coordinates, int32 axis, std::vector<int32>& out_cells) const
+{
+	out_cells.clear();
+
+	// The last cluster along the axis has no face to cross
+	if (cluster_coordinates[axis] + 1 >= ClusterCounts[axis])
+		return;
+
+	FIntVector boxMin, boxMax;
+	GetClusterBounds(cluster_coordinates, boxMin, boxMax);
+
+	// Mark the cells of the face whose neighbor across it is free too
+	const int32 u = (axis + 1) % 3;
+	const int32 v = (axis + 2) % 3;
+	const int32 width = boxMax[u] - boxMin[u] + 1;
+	const int32 height = boxMax[v] - boxMin[v] + 1;
+	const int32 step = grid.GetNeighborIndexOffset(axis * 2);
+
+	std::vector<uint8> open(width * height, 0);
+	FIntVector coordinates;
+	coordinates[axis] = boxMax[axis];
+	for (int32 j = 0; j < height; ++j)
+	{
+		for (int32 i = 0; i < width; ++i)
+		{
+			coordinates[u] = boxMin[u] + i;
+			coordinates[v] = boxMin[v] + j;
+			const int32 cell = grid.GetIndex(coordinates);
+			open[(j * width) + i] = occupancy.IsBlocked(cell) == false && occupancy.IsBlocked(cell + step) == false;
+		}
+	}
+
+	// Flood fill each group of open cells, and place its entrance at the open cell closest to the group's middle
+	std::vector<int32> group;
+	for (int32 seed = 0; seed < width * height; ++seed)
+	{
+		if (open[seed] != 1)
+			continue;
+
+		group.clear();
+		group.push_back(seed);
+		open[seed] = 2;
+		float sumI = 0.0f;
+		float sumJ = 0.0f;
+		for (size_t next = 0; next < group.size(); ++next)
+		{
+			const int32 i = group[next] % width;
+			const int32 j = group[next] / width;
+			sumI += i;
+			sumJ += j;
+
+			auto visit = [&](int32 ni, int32 nj)
+			{
+				if (ni >= 0 && ni < width && nj >= 0 && nj < height && open[(nj * width) + ni] == 1)
+				{
+					open[(nj * width) + ni] = 2;
+					group.push_back((nj * width) + ni);
+				}
+			};
+			visit(i - 1, j);
+			visit(i + 1, j);
+			visit(i, j - 1);
+			visit(i, j + 1);
+		}
+
+		const float middleI = sumI / group.size();
+		const float middleJ = sumJ / group.size();
+		int32 best = group[0];
+		float bestDistance = FLT_MAX;
+		for (const int32 candidate : group)
+		{
+			const float di = (candidate % width) - middleI;
+			const float dj = (candidate / width) - middleJ;
+			const float distance = (di * di) + (dj * dj);
+			if (distance < bestDistance || (distance == bestDistance && candidate < best))
+			{
+				best = candidate;
+				bestDistance = distance;
+			}
+		}
+
+		coordinates[u] = boxMin[u] + (best % width);
+		coordinates[v] = boxMin[v] + (best / width);
+		out_cells.push_back(grid.GetIndex(coordinates));
+	}
+}
+
+bool NavClusterGraph::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path) const
+{
+	NAV_TRACE_SCOPE(NavClusterGraph::FindPath);
+
+	out_path.clear();
+
+	if (IsValid() == false || occupancy.IsBlocked(end_index))
+		return false;
+
+	const FIntVector startCoordinates = grid.GetCoordinates(start_index);
+	const FIntVector endCoordinates = grid.GetCoordinates(end_index);
+	const int32 startCluster = GetClusterIndex(startCoordinates);
+	const int32 endCluster = GetClusterIndex(endCoordinates);
+
+	// Cells in the same cluster are usually connected inside it, so try that before going through the abstract graph
+	out_path.push_back(start_index);
+	if (startCluster == endCluster)
+	{
+		FIntVector boxMin, boxMax;
+		GetClusterBounds(GetClusterCoordinates(startCluster), boxMin, boxMax);
+		if (SearchInBox(grid, occupancy, boxMin, boxMax, start_index, end_index, context))
+		{
+			AppendSearchPath(context, end_index, out_path);
+			return true;
+		}
+	}
+
+	// Find the cost from the start and from the end to the entrances of their clusters
+	auto getEntranceCosts = [&](int32 cluster_index, int32 cell, std::vector<float>& out_costs)
+	{
+		FIntVector boxMin, boxMax;
+		GetClusterBounds(GetClusterCoordinates(cluster_index), boxMin, boxMax);
+		const NavCluster& cluster = Clusters[cluster_index];
+		SearchInBox(grid, occupancy, boxMin, boxMax, cell, cluster.EntranceCells.data(), static_cast<int32>(cluster.EntranceCells.size()), context);
+
+		out_costs.resize(cluster.EntranceCells.size());
+		for (size_t i = 0; i < cluster.EntranceCells.size(); ++i)
+		{
+			out_costs[i] = context.GetGScore(cluster.EntranceCells[i]);
+		}
+	};
+
+	std::vector<float> startCosts;
+	std::vector<float> endCosts;
+	getEntranceCosts(startCluster, start_index, startCosts);
+	getEntranceCosts(endCluster, end_index, endCosts);
+
+	// Search the abstract graph, made of every entrance plus the start and the end
+	const int32 startId = GetEntranceCount();
+	const int32 endId = startId + 1;
+	context.Reset(endId + 1);
+
+	const FVector endLocation(endCoordinates);
+	auto getCell = [&](int32 id)
+	{
+		if (id == startId)
+			return start_index;
+		if (id == endId)
+			return end_index;
+		const int32 cluster = EntranceClusters[id];
+		return Clusters[cluster].EntranceCells[id - EntranceOffsets[cluster]];
+	};
+	auto h = [&](int32 id)
+	{
+		return FVector::Distance(endLocation, FVector(grid.GetCoordinates(getCell(id))));
+	};
+
+	context.Open(startId, INDEX_NONE, 0.0f, h(startId));
+
+	bool found = false;
+	while (context.IsOpenEmpty() == false)
+	{
+		const int32 current = context.PopOpen();
+		if (current == endId)
+		{
+			found = true;
+			break;
+		}
+
+		const float currentGScore = context.GetGScore(current);
+		auto relax = [&](int32 neighbor, float cost)
+		{
+			if (cost == FLT_MAX || context.IsClosed(neighbor))
+				return;
+
+			const float tentative_gScore = currentGScore + cost;
+			if (tentative_gScore < context.GetGScore(neighbor))
+			{
+				context.Open(neighbor, current, tentative_gScore, tentative_gScore + (neighbor == endId ? 0.0f : h(neighbor)));
+			}
+		};
+
+		if (current == startId)
+		{
+			for (size_t i = 0; i < startCosts.size(); ++i)
+			{
+				relax(EntranceOffsets[startCluster] + static_cast<int32>(i), startCosts[i]);
+			}
+			continue;
+		}
+
+		const int32 clusterIndex = EntranceClusters[current];
+		const NavCluster& cluster = Clusters[clusterIndex];
+		const int32 entrance = current - EntranceOffsets[clusterIndex];
+		const int32 entranceCount = static_cast<int32>(cluster.EntranceCells.size());
+
+		// The other entrances of the cluster, through the cached paths
+		for (int32 other = 0; other < entranceCount; ++other)
+		{
+			if (other != entrance)
+			{
+				relax(EntranceOffsets[clusterIndex] + other, cluster.Costs[(entrance * entranceCount) + other]);
+			}
+		}
+
+		// The entrance facing this one in the next cluster, a single step away
+		int32 face = 0;
+		while (entrance >= cluster.FaceBegin[face + 1])
+		{
+			++face;
+		}
+		FIntVector neighborCluster = GetClusterCoordinates(clusterIndex);
+		neighborCluster[face / 2] += (face % 2 == 0) ? -1 : 1;
+		const int32 neighborIndex = (neighborCluster.Z * ClusterCounts.X * ClusterCounts.Y) + (neighborCluster.Y * ClusterCounts.X) + neighborCluster.X;
+		relax(EntranceOffsets[neighborIndex] + Clusters[neighborIndex].FaceBegin[face ^ 1] + (entrance - cluster.FaceBegin[face]), 1.0f);
+
+		// The end, when it's in this cluster
+		if (clusterIndex == endCluster)
+		{
+			relax(endId, endCosts[entrance]);
+		}
+	}
+
+	if (found == false)
+	{
+		out_path.clear();
+		return false;
+	}
+
+	std::vector<int32> abstractPath;
+	for (int32 node = endId; node != INDEX_NONE; node = context.GetParent(node))
+	{
+		abstractPath.push_back(node);
+	}
+	std::reverse(abstractPath.begin(), abstractPath.end());
+
+	// Refine each step of the abstract path into cells. Steps between clusters cross a face, the others stay inside a cluster.
+	for (size_t i = 1; i < abstractPath.size(); ++i)
+	{
+		const int32 previous = abstractPath[i - 1];
+		const int32 next = abstractPath[i];
+		const int32 fromCell = getCell(previous);
+		const int32 toCell = getCell(next);
+
+		if (previous != startId && next != endId && EntranceClusters[previous] != EntranceClusters[next])
+		{
+			out_path.push_back(toCell);
+			continue;
+		}
+
+		if (fromCell == toCell)
+			continue;
+
+		FIntVector boxMin, boxMax;
+		GetClusterBounds(GetClusterCoordinates(next == endId ? endCluster : EntranceClusters[next]), boxMin, boxMax);
+		SearchInBox(grid, occupancy, boxMin, boxMax, fromCell, toCell, context);
+		AppendSearchPath(context, toCell, out_path);
+	}
+
+	return true;
+}
+
+int32 NavClusterGraph::GetClusterIndex(const FIntVector& coordinates) const
+{
+	return ((coordinates.Z / ClusterSize) * ClusterCounts.X * ClusterCounts.Y) + ((coordinates.Y / ClusterSize) * ClusterCounts.X) + (coordinates.X / ClusterSize);
+}
+
+FIntVector NavClusterGraph::GetClusterCoordinates(int32 cluster_index) const
+{
+	const int32 clustersPerLevel = ClusterCounts.X * ClusterCounts.Y;
+	return FIntVector(cluster_index % ClusterCounts.X, (cluster_index % clustersPerLevel) / ClusterCounts.X, cluster_index / clustersPerLevel);
+}
+
+void NavClusterGraph::GetClusterBounds(const FIntVector& cluster_coordinates, FIntVector& out_min, FIntVector& out_max) const
+{
+	out_min = FIntVector(cluster_coordinates.X * ClusterSize, cluster_coordinates.Y * ClusterSize, cluster_coordinates.Z * ClusterSize);
+	out_max = FIntVector(FMath::Min(out_min.X + ClusterSize, Divisions.X) - 1, FMath::Min(out_min.Y + ClusterSize, Divisions.Y) - 1, FMath::Min(out_min.Z + ClusterSize, Divisions.Z) - 1);
+}
+
+SIZE_T NavClusterGraph::GetAllocatedSize() const
+{
+	SIZE_T size = (Clusters.capacity() * sizeof(NavCluster)) + ((EntranceOffsets.capacity() + EntranceClusters.capacity()) * sizeof(int32));
+	for (const NavCluster& cluster : Clusters)
+	{
+		size += (cluster.EntranceCells.capacity() * sizeof(int32)) + (cluster.Costs.capacity() * sizeof(float));
+	}
+	return size;
+}
@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+class NavSearchContext;
+
+// The entrances of a cluster and the cost of the paths between them
+struct NavCluster
+{
+	// The flat index of the cell of each entrance, grouped by face in the order -X, +X, -Y, +Y, -Z, +Z
+	std::vector<int32> EntranceCells;
+
+	// The entrances of face f are [FaceBegin[f], FaceBegin[f + 1])
+	int32 FaceBegin[7] = {};
+
+	// The cost of the shortest path inside the cluster between each pair of entrances, FLT_MAX if there is none
+	std::vector<float> Costs;
+};
+
+/**
+* Hierarchical pathfinding (HPA*) over the grid. The grid is split into cubic clusters. Where two face adjacent clusters have
+* free cells facing each other, each connected group of them becomes a pair of entrances, one on each side, placed at the cell
+* closest to the middle of the group. The costs of the paths between the entrances of a cluster are cached, so long queries
+* search this small abstract graph first and then refine each step of it with A* inside a single cluster. Paths found this way
+* are close to, but may be slightly longer than, the shortest path. When the occupancy changes, only the clusters touching the
+* changed cells are rebuilt. Built graphs are never modified, so searching one from several threads is safe as long as each
+* thread uses its own search context.
+*/
+class NavClusterGraph
+{
+public:
+	/**
+	* Builds the entrances and cached costs of every cluster.
+	* @param	grid				The grid to split into clusters
+	* @param	occupancy			The occupancy the graph is built for
+	* @param	cluster_size		The number of cells along each axis of a cluster
+	* @param	previous			A graph built with the same grid and cluster size to copy the unchanged clusters from (optional)
+	* @param	changed_cells		The flat index of every cell whose occupancy changed since previous was built
+	*/
+	void Build(const NavGrid& grid, const NavOccupancy& occupancy, int32 cluster_size, const NavClusterGraph* previous = nullptr, const std::vector<int32>& changed_cells = std::vector<int32>());
+
+	// Checks if the graph has been built
+	FORCEINLINE bool IsValid() const { return Clusters.size() > 0; }
+
+	// Gets the number of cells along each axis of a cluster
+	FORCEINLINE int32 GetClusterSize() const { return ClusterSize; }
+
+	// Gets the number of entrances of every cluster
+	FORCEINLINE int32 GetEntranceCount() const { return static_cast<int32>(EntranceClusters.size()); }
+
+	/**
+	* Finds a path between two cells, searching the abstract graph when they're in different clusters.
+	* @param	grid				The grid the graph was built for
+	* @param	occupancy			The occupancy the graph was built for
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	context				The search state to use, reset by each step of the search
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path) const;
+
+	// Gets the number of bytes used by the clusters and the abstract graph
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Helper function building the entrances and costs of a cluster
+	void BuildCluster(const NavGrid& grid, const NavOccupancy& occupancy, int32 cluster_index, NavSearchContext& context);
+
+	// Helper function finding the entrances on the face between a cluster and the next cluster along an axis, as cells of the first cluster
+	void GetFaceEntrances(const NavGrid& grid, const NavOccupancy& occupancy, const FIntVector& cluster_coordinates, int32 axis, std::vector<int32>& out_cells) const;
+
+	// Helper function getting the index of the cluster containing a cell
+	int32 GetClusterIndex(const FIntVector& coordinates) const;
+
+	// Helper function getting the coordinates of a cluster from its index
+	FIntVector GetClusterCoordinates(int32 cluster_index) const;
+
+	// Helper function getting the range of cells covered by a cluster, inclusive
+	void GetClusterBounds(const FIntVector& cluster_coordinates, FIntVector& out_min, FIntVector& out_max) const;
+
+	// The number of cells along each axis of the grid
+	FIntVector Divisions = FIntVector::ZeroValue;
+
+	// The number of cells along each axis of a cluster
+	int32 ClusterSize = 0;
+
+	// The number of clusters along each axis
+	FIntVector ClusterCounts = FIntVector::ZeroValue;
+
+	// The clusters, indexed like cells
+	std::vector<NavCluster> Clusters;
+
+	// The abstract graph id of the first entrance of each cluster
+	std::vector<int32> EntranceOffsets;
+
+	// The cluster of each entrance, indexed by abstract graph id
+	std::vector<int32> EntranceClusters;
+};
@@ -0,0 +1,139 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavComponents.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+
+namespace
+{
+	// The fraction of the cells that can change before the labels are rebuilt from scratch. Each change can leave a
+	// stale label behind, or a split component reported as connected.
+	constexpr int32 RebuildChangeDivisor = 32;
+}
+
+void NavComponents::Build(const NavGrid& grid, const NavOccupancy& occupancy, const NavComponents* previous, const std::vector<int32>& changed_cells)
+{
+	NAV_TRACE_SCOPE(NavComponents::Build);
+
+	const int32 changedNum = static_cast<int32>(changed_cells.size());
+	if (previous == nullptr || previous->IsValid() == false || static_cast<int32>(previous->Labels.size()) != grid.Num() ||
+		previous->StaleChangeNum + changedNum > FMath::Max(grid.Num() / RebuildChangeDivisor, 1))
+	{
+		BuildLabels(grid, occupancy);
+		return;
+	}
+
+	Labels = previous->Labels;
+	Roots = previous->Roots;
+	StaleChangeNum = previous->StaleChangeNum + changedNum;
+
+	for (const int32 cell : changed_cells)
+	{
+		// A blocked cell may split its component, which the labels keep ignoring until they're rebuilt
+		if (occupancy.IsBlocked(cell))
+		{
+			Labels[cell] = INDEX_NONE;
+			continue;
+		}
+
+		if (Labels[cell] != INDEX_NONE)
+			continue;
+
+		// A freed cell joins every component it touches into one
+		const int32 label = static_cast<int32>(Roots.size());
+		Roots.push_back(label);
+		Labels[cell] = label;
+		grid.ForEachNeighbor(grid.GetCoordinates(cell), [&](int32 neighbor, int32)
+		{
+			const int32 neighborLabel = Labels[neighbor];
+			if (neighborLabel != INDEX_NONE)
+			{
+				Roots[FindRoot(neighborLabel)] = FindRoot(label);
+			}
+		});
+	}
+
+	// Point every label straight at its representative, so queries never walk a chain
+	for (int32 label = 0; label < static_cast<int32>(Roots.size()); ++label)
+	{
+		Roots[label] = FindRoot(label);
+	}
+}
+
+bool NavComponents::IsReachable(const NavGrid& grid, int32 start_index, int32 end_index) const
+{
+	if (start_index == end_index)
+		return true;
+
+	const int32 endComponent = GetComponent(end_index);
+	if (endComponent == INDEX_NONE)
+		return false;
+
+	const int32 startComponent = GetComponent(start_index);
+	if (startComponent != INDEX_NONE)
+		return startComponent == endComponent;
+
+	// The searches never test the start, so a blocked one still reaches the components of its neighbors
+	bool reachable = false;
+	grid.ForEachNeighbor(grid.GetCoordinates(start_index), [&](int32 neighbor, int32)
+	{
+		reachable |= GetComponent(neighbor) == endComponent;
+	});
+	return reachable;
+}
+
+SIZE_T NavComponents::GetAllocatedSize() const
+{
+	return (Labels.capacity() + Roots.capacity()) * sizeof(int32);
+}
+
+void NavComponents::BuildLabels(const NavGrid& grid, const NavOccupancy& occupancy)
+{
+	Labels.assign(grid.Num(), INDEX_NONE);
+	Roots.clear();
+	StaleChangeNum = 0;
+
+	std::vector<int32> stack;
+	for (int32 seed = 0; seed < grid.Num(); ++seed)
+	{
+		if (Labels[seed] != INDEX_NONE || occupancy.IsBlocked(seed))
+			continue;
+
+		// Flood the component of the cell, every cell reached gets the same label
+		const int32 label = static_cast<int32>(Roots.size());
+		Roots.push_back(label);
+		Labels[seed] = label;
+		stack.push_back(seed);
+		while (stack.empty() == false)
+		{
+			const int32 current = stack.back();
+			stack.pop_back();
+			grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32)
+			{
+				if (Labels[neighbor] == INDEX_NONE && occupancy.IsBlocked(neighbor) == false)
+				{
+					Labels[neighbor] = label;
+					stack.push_back(neighbor);
+				}
+			});
+		}
+	}
+}
+
+int32 NavComponents::FindRoot(int32 label)
+{
+	int32 root = label;
+	while (Roots[root] != root)
+	{
+		root = Roots[root];
+	}
+
+	while (Roots[label] != root)
+	{
+		const int32 next = Roots[label];
+		Roots[label] = root;
+		label = next;
+	}
+	return root;
+}
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+
+/**
+* The connected components of the free cells of the grid, linked by the same moves as the searches, used to reject queries
+* between cells that can't reach each other without flooding every cell reachable from the start. Cells that become free are
+* merged into the components of their free neighbors. Cells that become blocked only lose their label: they may split a
+* component, so after changes the components can report cells as connected when they no longer are, but never the reverse.
+* Rejected queries are always unreachable. The labels are rebuilt from scratch once enough cells have changed. Built components
+* are never modified, so querying them from several threads is safe.
+*/
+class NavComponents
+{
+public:
+	/**
+	* Labels the connected components of the free cells.
+	* @param	grid				The grid the occupancy covers
+	* @param	occupancy			The occupancy the components are built for
+	* @param	previous			Components built with the same grid to update instead of labeling every cell again (optional)
+	* @param	changed_cells		The flat index of every cell whose occupancy changed since previous was built
+	*/
+	void Build(const NavGrid& grid, const NavOccupancy& occupancy, const NavComponents* previous = nullptr, const std::vector<int32>& changed_cells = std::vector<int32>());
+
+	// Checks if the components have been built
+	FORCEINLINE bool IsValid() const { return Labels.size() > 0; }
+
+	// Gets the component of a cell, INDEX_NONE if the cell is blocked
+	FORCEINLINE int32 GetComponent(int32 index) const
+	{
+		const int32 label = Labels[index];
+		return label != INDEX_NONE ? Roots[label] : INDEX_NONE;
+	}
+
+	/**
+	* Checks if a search could find a path between two cells. Like the searches, the start may be blocked as long as one of
+	* its neighbors is connected to the end.
+	* @param	grid				The grid the components were built for
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @return	False when there is certainly no path, true when there may be one
+	*/
+	bool IsReachable(const NavGrid& grid, int32 start_index, int32 end_index) const;
+
+	// Gets the number of cells changed since the labels were last rebuilt from scratch
+	FORCEINLINE int32 GetStaleChangeNum() const { return StaleChangeNum; }
+
+	// Gets the number of bytes used by the labels
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Helper function labeling every cell from scratch, flooding each component in turn
+	void BuildLabels(const NavGrid& grid, const NavOccupancy& occupancy);
+
+	// Helper function finding the representative label of a label while merging, compressing the chain on the way
+	int32 FindRoot(int32 label);
+
+	// The label of each free cell, INDEX_NONE for blocked cells. Several labels can belong to the same component.
+	std::vector<int32> Labels;
+
+	// The representative label of the component of each label, compared to check if two cells are connected
+	std::vector<int32> Roots;
+
+	// The number of cells changed since the labels were last rebuilt from scratch
+	int32 StaleChangeNum = 0;
+};
@@ -0,0 +1,472 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavCooperativePlanner.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include <algorithm>
+
+namespace
+{
+	// The cost of waiting a step anywhere but at the goal
+	constexpr float WaitCost = 1.0f;
+
+	/**
+	* Gets the length of the shortest path between two cells if nothing was blocked, moving to the neighbors the grid allows,
+	* which is a lower bound of the length of any path between them and much closer to it than the straight line.
+	*/
+	float GetOpenDistance(const NavGrid& grid, const FIntVector& a, const FIntVector& b)
+	{
+		int32 d0 = FMath::Abs(a.X - b.X);
+		int32 d1 = FMath::Abs(a.Y - b.Y);
+		int32 d2 = FMath::Abs(a.Z - b.Z);
+		if (d0 < d1) std::swap(d0, d1);
+		if (d1 < d2) std::swap(d1, d2);
+		if (d0 < d1) std::swap(d0, d1);
+
+		// Corners cover a unit of every axis, edges a unit of two axes, faces a unit of one
+		if (grid.GetNeighborCount() >= 26)
+			return (1.73205081f * d2) + (1.41421356f * (d1 - d2)) + (d0 - d1);
+
+		if (grid.GetNeighborCount() >= 18)
+		{
+			if (d0 >= d1 + d2)
+				return (1.41421356f * (d1 + d2)) + (d0 - d1 - d2);
+
+			const int32 total = d0 + d1 + d2;
+			return (1.41421356f * (total / 2)) + (total % 2);
+		}
+		return static_cast<float>(d0 + d1 + d2);
+	}
+
+	// An entry of an open list, ordered on its score then preferring the deepest, ties being common with an exact heuristic
+	struct OpenEntry
+	{
+		float FScore;
+		float GScore;
+		int32 Index;
+
+		// Whether the heuristic in the score is the true distance rather than a lower bound of it
+		bool bExact;
+
+		FORCEINLINE bool operator>(const OpenEntry& other) const
+		{
+			return FScore > other.FScore || (FScore == other.FScore && GScore < other.GScore);
+		}
+	};
+
+	using OpenQueue = std::priority_queue<OpenEntry, std::vector<OpenEntry>, std::greater<OpenEntry> >;
+}
+
+struct NavCooperativePlanner::GoalDistances
+{
+	struct Record
+	{
+		float G;
+		bool bClosed;
+	};
+
+	int32 Goal = INDEX_NONE;
+
+	// The cell the search heads towards, the agent's start when the goal was set
+	FIntVector Target = FIntVector::ZeroValue;
+
+	// The cells reached so far, by flat index
+	std::unordered_map<int32, Record> Records;
+
+	OpenQueue Open;
+
+	void Init(const NavGrid& grid, const NavOccupancy& occupancy, int32 goal, int32 target)
+	{
+		Goal = goal;
+		Target = grid.GetCoordinates(target);
+		Records.clear();
+		Open = OpenQueue();
+		if (occupancy.IsBlocked(goal) == false)
+		{
+			Records.emplace(goal, Record{ 0.0f, false });
+			Open.push(OpenEntry{ GetHeuristic(grid, goal), 0.0f, goal, true });
+		}
+	}
+
+	FORCEINLINE float GetHeuristic(const NavGrid& grid, int32 cell) const
+	{
+		return GetOpenDistance(grid, Target, grid.GetCoordinates(cell));
+	}
+
+	// Gets the distance of a cell to the goal if the search already expanded it, without searching further
+	FORCEINLINE bool TryGetDistance(int32 cell, float& out_distance) const
+	{
+		const auto found = Records.find(cell);
+		if (found == Records.end() || found->second.bClosed == false)
+			return false;
+
+		out_distance = found->second.G;
+		return true;
+	}
+
+	// Gets the length of the shortest path from a cell to the goal, resuming the search until the cell is expanded
+	float GetDistance(const NavGrid& grid, const NavOccupancy& occupancy, int32 cell)
+	{
+		const auto found = Records.find(cell);
+		if (found != Records.end() && found->second.bClosed)
+			return found->second.G;
+
+		while (Open.empty() == false)
+		{
+			const OpenEntry entry = Open.top();
+			Open.pop();
+			Record& record = Records[entry.Index];
+			if (record.bClosed || entry.GScore > record.G)
+				continue;
+
+			record.bClosed = true;
+			grid.ForEachNeighbor(grid.GetCoordinates(entry.Index), [&](int32 neighbor, int32 offsetIndex)
+			{
+				if (occupancy.IsBlocked(neighbor))
+					return;
+
+				const float gScore = entry.GScore + NavNeighborDistances[offsetIndex];
+				Record& neighborRecord = Records.emplace(neighbor, Record{ FLT_MAX, false }).first->second;
+				if (neighborRecord.bClosed == false && gScore < neighborRecord.G)
+				{
+					neighborRecord.G = gScore;
+					Open.push(OpenEntry{ gScore + GetHeuristic(grid, neighbor), gScore, neighbor, true });
+				}
+			});
+
+			if (entry.Index == cell)
+				return entry.GScore;
+		}
+		return FLT_MAX;
+	}
+
+	SIZE_T GetAllocatedSize() const
+	{
+		return (Records.size() * (sizeof(std::pair<const int32, Record>) + sizeof(void*))) + (Records.bucket_count() * sizeof(void*)) + (Open.size() * sizeof(OpenEntry));
+	}
+};
+
+struct NavCooperativePlanner::GroupState
+{
+	// A (cell, time) state reached by the search of an agent
+	struct Node
+	{
+		float G;
+		int32 Parent;
+		int32 Cell;
+		int32 Time;
+		bool bClosed;
+	};
+
+	NavReservationTable Reservations;
+
+	std::vector<Node> Nodes;
+
+	// The position in Nodes of each (cell, time) state reached
+	std::unordered_map<uint64, int32> NodeIndices;
+
+	OpenQueue Open;
+
+	int64 ExpandedNum = 0;
+	int32 FailedNum = 0;
+};
+
+NavCooperativePlanner::NavCooperativePlanner() = default;
+
+NavCooperativePlanner::~NavCooperativePlanner() = default;
+
+void NavCooperativePlanner::SetWindow(int32 window)
+{
+	Window = FMath::Max(window, 1);
+}
+
+int32 NavCooperativePlanner::PlanWindow(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<NavCooperativeAgent>& agents, std::vector<std::vector<int32> >& out_paths,
+	const ParallelForFuncType& parallel_for)
+{
+	NAV_TRACE_SCOPE(NavCooperativePlanner::PlanWindow);
+
+	const int32 agentCount = static_cast<int32>(agents.size());
+	out_paths.resize(agentCount);
+
+	// The distances to a goal are kept as long as the agent heads to it
+	Distances.resize(agentCount);
+	for (int32 agent = 0; agent < agentCount; ++agent)
+	{
+		if (Distances[agent] == nullptr)
+		{
+			Distances[agent].reset(new GoalDistances());
+		}
+		if (Distances[agent]->Goal != agents[agent].Goal)
+		{
+			Distances[agent]->Init(grid, occupancy, agents[agent].Goal, agents[agent].Start);
+		}
+	}
+
+	GroupAgents(grid, agents);
+	while (GroupStates.size() < Groups.size())
+	{
+		GroupStates.emplace_back(new GroupState());
+	}
+
+	auto planGroup = [&](int32 group)
+	{
+		GroupState& state = *GroupStates[group];
+		state.Reservations.Reset();
+		state.ExpandedNum = 0;
+		state.FailedNum = 0;
+
+		// Every agent holds its cell at the start, so the agents planned first don't step into it right away
+		for (const int32 agent : Groups[group])
+		{
+			state.Reservations.Reserve(agents[agent].Start, 0, agent);
+		}
+
+		for (const int32 agent : Groups[group])
+		{
+			if (PlanAgent(grid, occupancy, agent, agents[agent], *Distances[agent], state, out_paths[agent]) == false)
+			{
+				++state.FailedNum;
+			}
+		}
+	};
+
+	const int32 groupCount = static_cast<int32>(Groups.size());
+	if (parallel_for != nullptr && groupCount > 1)
+	{
+		parallel_for(groupCount, planGroup);
+	}
+	else
+	{
+		for (int32 group = 0; group < groupCount; ++group)
+		{
+			planGroup(group);
+		}
+	}
+
+	int32 failedNum = 0;
+	LastExpandedNum = 0;
+	for (int32 group = 0; group < groupCount; ++group)
+	{
+		failedNum += GroupStates[group]->FailedNum;
+		LastExpandedNum += GroupStates[group]->ExpandedNum;
+	}
+	LastGroupNum = groupCount;
+	++WindowCount;
+	return failedNum;
+}
+
+void NavCooperativePlanner::ResetHeuristics()
+{
+	Distances.clear();
+}
+
+SIZE_T NavCooperativePlanner::GetAllocatedSize() const
+{
+	SIZE_T size = 0;
+	for (const std::unique_ptr<GoalDistances>& distances : Distances)
+	{
+		size += sizeof(GoalDistances) + distances->GetAllocatedSize();
+	}
+	for (const std::unique_ptr<GroupState>& state : GroupStates)
+	{
+		size += sizeof(GroupState) + state->Reservations.GetAllocatedSize() + (state->Nodes.capacity() * sizeof(GroupState::Node)) +
+			(state->NodeIndices.size() * (sizeof(std::pair<const uint64, int32>) + sizeof(void*))) + (state->NodeIndices.bucket_count() * sizeof(void*));
+	}
+	for (const std::vector<int32>& group : Groups)
+	{
+		size += group.capacity() * sizeof(int32);
+	}
+	return size;
+}
+
+bool NavCooperativePlanner::PlanAgent(const NavGrid& grid, const NavOccupancy& occupancy, int32 agent, const NavCooperativeAgent& info, GoalDistances& distances, GroupState& state, std::vector<int32>& out_path) const
+{
+	state.Nodes.clear();
+	state.NodeIndices.clear();
+	state.Open = OpenQueue();
+	out_path.clear();
+
+	auto getKey = [](int32 cell, int32 time) { return (static_cast<uint64>(static_cast<uint32>(time)) << 32) | static_cast<uint32>(cell); };
+	auto addNode = [&](int32 cell, int32 time, int32 parent, float gScore, float hScore, bool exact)
+	{
+		const auto inserted = state.NodeIndices.emplace(getKey(cell, time), static_cast<int32>(state.Nodes.size()));
+		if (inserted.second)
+		{
+			state.Nodes.push_back(GroupState::Node{ gScore, parent, cell, time, false });
+		}
+		else
+		{
+			GroupState::Node& node = state.Nodes[inserted.first->second];
+			if (node.bClosed || gScore >= node.G)
+				return;
+
+			node.G = gScore;
+			node.Parent = parent;
+		}
+		state.Open.push(OpenEntry{ gScore + hScore, gScore, inserted.first->second, exact });
+	};
+
+	// An agent whose goal can't be reached from its cell stays there
+	const FIntVector goalCoordinates = grid.GetCoordinates(info.Goal);
+	const float startH = distances.GetDistance(grid, occupancy, info.Start);
+	if (startH != FLT_MAX)
+	{
+		addNode(info.Start, 0, INDEX_NONE, 0.0f, startH, true);
+	}
+
+	int32 last = INDEX_NONE;
+	while (state.Open.empty() == false)
+	{
+		const OpenEntry entry = state.Open.top();
+		state.Open.pop();
+		if (state.Nodes[entry.Index].bClosed || entry.GScore > state.Nodes[entry.Index].G)
+			continue;
+
+		// States enter the open list with the distance to the goal in an empty grid, the true distance is only looked up once
+		// they reach the top, so the reverse search doesn't have to expand the cells around every state reached
+		const GroupState::Node current = state.Nodes[entry.Index];
+		float hScore = entry.FScore - entry.GScore;
+		if (entry.bExact == false)
+		{
+			const float distance = distances.GetDistance(grid, occupancy, current.Cell);
+			if (distance == FLT_MAX)
+				continue;
+
+			if (distance > hScore)
+			{
+				state.Open.push(OpenEntry{ entry.GScore + distance, entry.GScore, entry.Index, true });
+				continue;
+			}
+			hScore = distance;
+		}
+
+		state.Nodes[entry.Index].bClosed = true;
+		++state.ExpandedNum;
+		if (current.Time == Window)
+		{
+			last = entry.Index;
+			break;
+		}
+
+		// Wait in place, free at the goal
+		if (state.Reservations.CanMove(current.Cell, current.Cell, current.Time, agent))
+		{
+			addNode(current.Cell, current.Time + 1, entry.Index, current.G + (current.Cell == info.Goal ? 0.0f : WaitCost), hScore, true);
+		}
+
+		grid.ForEachNeighbor(grid.GetCoordinates(current.Cell), [&](int32 neighbor, int32 offsetIndex)
+		{
+			if (occupancy.IsBlocked(neighbor) || state.Reservations.CanMove(current.Cell, neighbor, current.Time, agent) == false)
+				return;
+
+			// The agents that aren't planned yet are still in their cell at the first step
+			if (current.Time == 0)
+			{
+				const int32 holder = state.Reservations.GetAgent(neighbor, 0);
+				if (holder != INDEX_NONE && holder != agent)
+					return;
+			}
+
+			float distance = 0.0f;
+			const bool exact = distances.TryGetDistance(neighbor, distance);
+			if (exact == false)
+			{
+				distance = GetOpenDistance(grid, grid.GetCoordinates(neighbor), goalCoordinates);
+			}
+			addNode(neighbor, current.Time + 1, entry.Index, current.G + NavNeighborDistances[offsetIndex], distance, exact);
+		});
+	}
+
+	if (last != INDEX_NONE)
+	{
+		out_path.resize(Window + 1);
+		for (int32 node = last; node != INDEX_NONE; node = state.Nodes[node].Parent)
+		{
+			out_path[state.Nodes[node].Time] = state.Nodes[node].Cell;
+		}
+	}
+	else
+	{
+		out_path.assign(Window + 1, info.Start);
+	}
+
+	// Waiting in place keeps the cell even if it was reserved by another agent, which is then in conflict with it
+	bool reserved = true;
+	for (int32 time = 0; time <= Window; ++time)
+	{
+		reserved &= state.Reservations.Reserve(out_path[time], time, agent);
+	}
+	return last != INDEX_NONE || (startH == FLT_MAX && reserved);
+}
+
+void NavCooperativePlanner::GroupAgents(const NavGrid& grid, const std::vector<NavCooperativeAgent>& agents)
+{
+	const int32 agentCount = static_cast<int32>(agents.size());
+
+	// Two agents can only meet within a window if their starts are at most two windows apart on every axis. Agents are
+	// bucketed by that distance, so only the agents of neighboring buckets are compared.
+	const int32 reach = 2 * Window;
+	std::unordered_map<uint64, std::vector<int32> > buckets;
+	auto getBucketKey = [](const FIntVector& bucket)
+	{
+		return (static_cast<uint64>(static_cast<uint32>(bucket.X) & 0x1FFFFF) << 42) | (static_cast<uint64>(static_cast<uint32>(bucket.Y) & 0x1FFFFF) << 21) | (static_cast<uint32>(bucket.Z) & 0x1FFFFF);
+	};
+
+	std::vector<int32> roots(agentCount);
+	for (int32 agent = 0; agent < agentCount; ++agent)
+	{
+		roots[agent] = agent;
+	}
+	auto findRoot = [&roots](int32 agent)
+	{
+		while (roots[agent] != agent)
+		{
+			roots[agent] = roots[roots[agent]];
+			agent = roots[agent];
+		}
+		return agent;
+	};
+
+	for (int32 agent = 0; agent < agentCount; ++agent)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(agents[agent].Start);
+		const FIntVector bucket(coordinates.X / (reach + 1), coordinates.Y / (reach + 1), coordinates.Z / (reach + 1));
+		for (int32 z = -1; z <= 1; ++z)
+		{
+			for (int32 y = -1; y <= 1; ++y)
+			{
+				for (int32 x = -1; x <= 1; ++x)
+				{
+					const auto neighbors = buckets.find(getBucketKey(FIntVector(bucket.X + x, bucket.Y + y, bucket.Z + z)));
+					if (neighbors == buckets.end())
+						continue;
+
+					for (const int32 other : neighbors->second)
+					{
+						const FIntVector otherCoordinates = grid.GetCoordinates(agents[other].Start);
+						if (FMath::Abs(coordinates.X - otherCoordinates.X) <= reach && FMath::Abs(coordinates.Y - otherCoordinates.Y) <= reach && FMath::Abs(coordinates.Z - otherCoordinates.Z) <= reach)
+						{
+							roots[findRoot(agent)] = findRoot(other);
+						}
+					}
+				}
+			}
+		}
+		buckets[getBucketKey(bucket)].push_back(agent);
+	}
+
+	// Gather the groups, each in the order of the window, starting from a different agent each time
+	Groups.clear();
+	std::unordered_map<int32, int32> groupIndices;
+	for (int32 i = 0; i < agentCount; ++i)
+	{
+		const int32 agent = (i + WindowCount) % agentCount;
+		const auto group = groupIndices.emplace(findRoot(agent), static_cast<int32>(Groups.size()));
+		if (group.second)
+		{
+			Groups.emplace_back();
+		}
+		Groups[group.first->second].push_back(agent);
+	}
+}
@@ -0,0 +1,109 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include "NavReservationTable.h"
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+
+// An agent to plan for
+struct NavCooperativeAgent
+{
+	// The flat index of the cell the agent is in
+	int32 Start;
+
+	// The flat index of the cell the agent heads to
+	int32 Goal;
+};
+
+/**
+* Plans the paths of many agents together so they don't run into each other (windowed hierarchical cooperative A*). Agents
+* are planned one after another over (cell, time step), for a window of time steps, each avoiding the cells the agents planned
+* before it reserved. Moving to a neighbor or waiting takes one step. The heuristic is the true distance to the goal ignoring
+* the other agents, from a reverse search kept for each agent and only expanded as far as the searches ask for (reverse
+* resumable A*), so it's paid once per goal rather than once per window. States are queued with the distance over an empty grid
+* and only look the true distance up when they reach the top of the open list, which keeps the reverse searches narrow. Agents
+* are meant to follow the first half of their window, then be planned again, the order changing each time so no agent keeps
+* giving way.
+*
+* Agents can move at most one cell per step, so agents starting more than two windows apart can't reserve the same cells. They
+* are split into groups that don't reach each other, planned in parallel, each with its own reservation table.
+*
+* An agent the agents planned before it leave no way to move waits in place, possibly in conflict with them. Not thread safe.
+*/
+class NavCooperativePlanner
+{
+public:
+	// Runs body(index) for every index in [0, count), possibly in parallel, returning once every call has returned
+	using ParallelForFuncType = std::function<void(int32 count, const std::function<void(int32 index)>& body)>;
+
+	NavCooperativePlanner();
+	~NavCooperativePlanner();
+
+	// Sets the number of time steps planned for each agent
+	void SetWindow(int32 window);
+
+	// Gets the number of time steps planned for each agent
+	FORCEINLINE int32 GetWindow() const { return Window; }
+
+	/**
+	* Plans the next window of every agent.
+	* @param	grid				The grid to plan in
+	* @param	occupancy			The occupancy of the grid, must be the one the previous windows were planned with, see ResetHeuristics
+	* @param	agents				The agents, identified by their position in the array across windows
+	* @param	out_paths			The cell of each agent at each time step of the window, from the start at step 0. Agents wait at their goal once they reach it.
+	* @param	parallel_for		Plans the groups of agents that can't reach each other in parallel (optional, they're planned one after another otherwise)
+	* @return	The number of agents that found no way through the reservations and wait in place
+	*/
+	int32 PlanWindow(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<NavCooperativeAgent>& agents, std::vector<std::vector<int32> >& out_paths,
+		const ParallelForFuncType& parallel_for = nullptr);
+
+	// Forgets the distances to the goals, which must be done when the occupancy changes
+	void ResetHeuristics();
+
+	// Gets the number of (cell, time) states expanded by the last window, over every agent
+	FORCEINLINE int64 GetLastExpandedNum() const { return LastExpandedNum; }
+
+	// Gets the number of groups the agents of the last window were split into
+	FORCEINLINE int32 GetLastGroupNum() const { return LastGroupNum; }
+
+	// Gets the number of bytes used by the distances to the goals, the reservations and the search state
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// The reverse search from an agent's goal giving the true distance of the cells it reached
+	struct GoalDistances;
+
+	// The search state and reservations used by a group of agents, one per group planned at the same time
+	struct GroupState;
+
+	// Helper function searching the window of an agent over (cell, time), reserving its cells. Returns false if it waits in place.
+	bool PlanAgent(const NavGrid& grid, const NavOccupancy& occupancy, int32 agent, const NavCooperativeAgent& info, GoalDistances& distances, GroupState& state, std::vector<int32>& out_path) const;
+
+	// Helper function splitting the agents into groups that can't reach each other within a window
+	void GroupAgents(const NavGrid& grid, const std::vector<NavCooperativeAgent>& agents);
+
+	int32 Window = 16;
+
+	// The distances to the goal of each agent, by position in the agents array
+	std::vector<std::unique_ptr<GoalDistances> > Distances;
+
+	// The state of each group, reused between windows
+	std::vector<std::unique_ptr<GroupState> > GroupStates;
+
+	// The agents of each group, in the order they're planned
+	std::vector<std::vector<int32> > Groups;
+
+	// The number of windows planned, shifting the order agents are planned in
+	int32 WindowCount = 0;
+
+	int64 LastExpandedNum = 0;
+	int32 LastGroupNum = 0;
+};
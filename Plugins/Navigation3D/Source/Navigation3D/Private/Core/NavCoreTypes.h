@@ -0,0 +1,126 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+// The pathfinding core only relies on the integer types, FIntVector, FVector and a few FMath functions. Inside the engine
+// they come from CoreMinimal. The standalone build (see CMakeLists.txt at the root of the plugin) defines NAVIGATION3D_STANDALONE
+// and gets the minimal plain versions below instead, so the core can be built and tested without the engine.
+#if !defined(NAVIGATION3D_STANDALONE)
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+
+// Marks the scope as a named event in Unreal Insights when CPU tracing is enabled
+#define NAV_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE(Name)
+
+#else
+
+#define NAV_TRACE_SCOPE(Name)
+
+#include <cfloat>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+typedef std::int8_t int8;
+typedef std::uint8_t uint8;
+typedef std::int16_t int16;
+typedef std::uint16_t uint16;
+typedef std::int32_t int32;
+typedef std::uint32_t uint32;
+typedef std::int64_t int64;
+typedef std::uint64_t uint64;
+typedef std::size_t SIZE_T;
+
+#if defined(_MSC_VER)
+#define FORCEINLINE __forceinline
+#else
+#define FORCEINLINE inline __attribute__((always_inline))
+#endif
+
+#define INDEX_NONE (-1)
+#define KINDA_SMALL_NUMBER (1.e-4f)
+
+struct FMath
+{
+	template<typename T> static constexpr FORCEINLINE T Min(T a, T b) { return a < b ? a : b; }
+	template<typename T> static constexpr FORCEINLINE T Max(T a, T b) { return a > b ? a : b; }
+	template<typename T> static constexpr FORCEINLINE T Max3(T a, T b, T c) { return Max(Max(a, b), c); }
+	template<typename T> static constexpr FORCEINLINE T Abs(T a) { return a < 0 ? -a : a; }
+	template<typename T> static constexpr FORCEINLINE T Clamp(T value, T min, T max) { return value < min ? min : (value > max ? max : value); }
+	static FORCEINLINE float Sqrt(float value) { return std::sqrt(value); }
+	static FORCEINLINE int32 FloorToInt(float value) { return static_cast<int32>(std::floor(value)); }
+	static FORCEINLINE int32 CeilToInt(float value) { return static_cast<int32>(std::ceil(value)); }
+
+	static FORCEINLINE uint32 CountTrailingZeros(uint32 value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		return _BitScanForward(&index, value) ? index : 32;
+#else
+		return value == 0 ? 32 : static_cast<uint32>(__builtin_ctz(value));
+#endif
+	}
+
+	static FORCEINLINE uint64 CountTrailingZeros64(uint64 value)
+	{
+#if defined(_MSC_VER)
+		unsigned long index;
+		return _BitScanForward64(&index, value) ? index : 64;
+#else
+		return value == 0 ? 64 : static_cast<uint64>(__builtin_ctzll(value));
+#endif
+	}
+};
+
+struct FIntVector
+{
+	int32 X;
+	int32 Y;
+	int32 Z;
+
+	static const FIntVector ZeroValue;
+
+	FIntVector() {}
+	FIntVector(int32 x, int32 y, int32 z) : X(x), Y(y), Z(z) {}
+	explicit FIntVector(int32 value) : X(value), Y(value), Z(value) {}
+
+	FORCEINLINE int32& operator[](int32 index) { return (&X)[index]; }
+	FORCEINLINE const int32& operator[](int32 index) const { return (&X)[index]; }
+
+	FORCEINLINE bool operator==(const FIntVector& other) const { return X == other.X && Y == other.Y && Z == other.Z; }
+	FORCEINLINE bool operator!=(const FIntVector& other) const { return (*this == other) == false; }
+	FORCEINLINE FIntVector operator+(const FIntVector& other) const { return FIntVector(X + other.X, Y + other.Y, Z + other.Z); }
+	FORCEINLINE FIntVector operator-(const FIntVector& other) const { return FIntVector(X - other.X, Y - other.Y, Z - other.Z); }
+	FORCEINLINE FIntVector operator*(int32 scale) const { return FIntVector(X * scale, Y * scale, Z * scale); }
+};
+
+inline const FIntVector FIntVector::ZeroValue(0, 0, 0);
+
+struct FVector
+{
+	float X;
+	float Y;
+	float Z;
+
+	static const FVector ZeroVector;
+
+	FVector() {}
+	FVector(float x, float y, float z) : X(x), Y(y), Z(z) {}
+	explicit FVector(float value) : X(value), Y(value), Z(value) {}
+	explicit FVector(const FIntVector& vector) : X(static_cast<float>(vector.X)), Y(static_cast<float>(vector.Y)), Z(static_cast<float>(vector.Z)) {}
+
+	FORCEINLINE FVector operator+(const FVector& other) const { return FVector(X + other.X, Y + other.Y, Z + other.Z); }
+	FORCEINLINE FVector operator-(const FVector& other) const { return FVector(X - other.X, Y - other.Y, Z - other.Z); }
+	FORCEINLINE FVector operator*(float scale) const { return FVector(X * scale, Y * scale, Z * scale); }
+
+	static FORCEINLINE float Distance(const FVector& a, const FVector& b)
+	{
+		const FVector delta = a - b;
+		return std::sqrt((delta.X * delta.X) + (delta.Y * delta.Y) + (delta.Z * delta.Z));
+	}
+};
+
+inline const FVector FVector::ZeroVector(0.0f, 0.0f, 0.0f);
+
+#endif
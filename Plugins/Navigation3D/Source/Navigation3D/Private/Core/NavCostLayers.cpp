@@ -0,0 +1,74 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavCostLayers.h"
+#include <algorithm>
+
+void NavCostLayers::Init(int32 cell_count, int32 layer_count)
+{
+	CellNum = cell_count;
+	LayerNum = FMath::Clamp(layer_count, 0, MaxLayers);
+	Costs.assign(static_cast<size_t>(CellNum) * LayerNum, 0);
+	CostCounts.assign(static_cast<size_t>(LayerNum) * 256, 0);
+	for (int32 layer = 0; layer < LayerNum; ++layer)
+	{
+		CostCounts[layer * 256] = CellNum;
+	}
+}
+
+void NavCostLayers::SetCost(int32 index, int32 layer, uint8 cost)
+{
+	uint8& current = Costs[(index * LayerNum) + layer];
+	--CostCounts[(layer * 256) + current];
+	++CostCounts[(layer * 256) + cost];
+	current = cost;
+}
+
+void NavCostLayers::FillLayer(int32 layer, uint8 cost)
+{
+	for (int32 index = 0; index < CellNum; ++index)
+	{
+		Costs[(index * LayerNum) + layer] = cost;
+	}
+
+	std::fill(CostCounts.begin() + (layer * 256), CostCounts.begin() + ((layer + 1) * 256), 0);
+	CostCounts[(layer * 256) + cost] = CellNum;
+}
+
+uint8 NavCostLayers::GetMinCost(int32 layer) const
+{
+	for (int32 cost = 0; cost < 256; ++cost)
+	{
+		if (CostCounts[(layer * 256) + cost] > 0)
+			return static_cast<uint8>(cost);
+	}
+	return 0;
+}
+
+SIZE_T NavCostLayers::GetAllocatedSize() const
+{
+	return (Costs.capacity() * sizeof(uint8)) + (CostCounts.capacity() * sizeof(int32));
+}
+
+NavCostProfile::NavCostProfile(const NavCostLayers& layers, const float* weights, int32 weight_count)
+	: Layers(layers)
+{
+	// Only the layers up to the last one with a weight are read
+	for (int32 layer = 0; layer < FMath::Min(weight_count, layers.GetLayerNum()); ++layer)
+	{
+		if (weights[layer] > 0.0f)
+		{
+			LayerNum = layer + 1;
+		}
+	}
+
+	for (int32 layer = 0; layer < LayerNum; ++layer)
+	{
+		const float weight = FMath::Max(weights[layer], 0.0f);
+		for (int32 cost = 0; cost < 256; ++cost)
+		{
+			Tables[layer][cost] = weight * (cost / 255.0f);
+		}
+		MinCellCost += Tables[layer][layers.GetMinCost(layer)];
+	}
+}
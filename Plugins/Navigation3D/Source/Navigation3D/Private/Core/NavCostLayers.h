@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+/**
+* Per cell traversal costs in up to MaxLayers layers, such as danger, noise or congestion, each a uint8 from 0 (no extra cost)
+* to 255 (the full weight of the layer). The layers of a cell are stored next to each other, so a search reads every layer of a
+* cell from the same cache line. Queries combine the layers with a NavCostProfile. Each layer keeps a count of its values, so
+* the lowest cost of any cell, which bounds the heuristic, is known without scanning the grid.
+*/
+class NavCostLayers
+{
+public:
+	// The largest number of layers
+	static constexpr int32 MaxLayers = 4;
+
+	/**
+	* Allocates the layers, every cell at 0.
+	* @param	cell_count			The number of cells of the grid
+	* @param	layer_count			The number of layers, up to MaxLayers
+	*/
+	void Init(int32 cell_count, int32 layer_count);
+
+	// Checks if the layers have been allocated
+	FORCEINLINE bool IsValid() const { return LayerNum > 0; }
+
+	// Gets the number of cells
+	FORCEINLINE int32 Num() const { return CellNum; }
+
+	// Gets the number of layers
+	FORCEINLINE int32 GetLayerNum() const { return LayerNum; }
+
+	// Gets the cost of a cell in a layer
+	FORCEINLINE uint8 GetCost(int32 index, int32 layer) const { return Costs[(index * LayerNum) + layer]; }
+
+	// Gets the costs of every layer of a cell, one after another
+	FORCEINLINE const uint8* GetCosts(int32 index) const { return &Costs[index * LayerNum]; }
+
+	// Sets the cost of a cell in a layer
+	void SetCost(int32 index, int32 layer, uint8 cost);
+
+	// Sets the cost of every cell in a layer
+	void FillLayer(int32 layer, uint8 cost);
+
+	// Gets the lowest cost of any cell in a layer
+	uint8 GetMinCost(int32 layer) const;
+
+	// Gets the number of bytes used by the layers
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// The costs of each cell, the layers of a cell next to each other
+	std::vector<uint8> Costs;
+
+	// The number of cells with each cost, for each layer
+	std::vector<int32> CostCounts;
+
+	int32 CellNum = 0;
+	int32 LayerNum = 0;
+};
+
+/**
+* The weights a query gives to each cost layer. Moving into a cell costs the distance moved times the cell cost, which is
+* 1 plus the sum of each layer's weight times its cost over 255, averaged with the cost of the cell moved from. The weights are
+* turned into a table per layer when the profile is created, so reading the cost of a cell is a lookup per layer.
+*/
+class NavCostProfile
+{
+public:
+	/**
+	* Creates a profile for a set of layers.
+	* @param	layers				The layers to read the costs from, which must outlive the profile
+	* @param	weights				The weight of each layer, layers without one don't add to the cost. Negative weights count as 0.
+	* @param	weight_count		The number of weights
+	*/
+	NavCostProfile(const NavCostLayers& layers, const float* weights, int32 weight_count);
+
+	// Gets the cost of moving through a cell, relative to the distance, at least 1
+	FORCEINLINE float GetCellCost(int32 index) const
+	{
+		const uint8* costs = Layers.GetCosts(index);
+		float cost = 1.0f;
+		for (int32 layer = 0; layer < LayerNum; ++layer)
+		{
+			cost += Tables[layer][costs[layer]];
+		}
+		return cost;
+	}
+
+	// Gets the lowest cost of any cell, which scales the distance heuristic so it never overestimates
+	FORCEINLINE float GetMinCellCost() const { return MinCellCost; }
+
+private:
+	const NavCostLayers& Layers;
+
+	// The number of layers with a weight
+	int32 LayerNum = 0;
+
+	// The extra cost of each layer value, for each layer
+	float Tables[NavCostLayers::MaxLayers][256];
+
+	float MinCellCost = 1.0f;
+};
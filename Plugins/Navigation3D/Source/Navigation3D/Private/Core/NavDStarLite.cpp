@@ -0,0 +1,338 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavDStarLite.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+
+namespace
+{
+	// The relative difference below which the keys are considered equal
+	constexpr float KeyTolerance = 1.e-5f;
+}
+
+void NavDStarLite::Init(const NavGrid& grid, int32 start_index, int32 goal_index)
+{
+	// Keep the pages already allocated for this grid, but clear them, nothing is known about the new goal
+	const int32 pageCount = (grid.Num() + RecordPageMask) >> RecordPageShift;
+	RecordPages.resize(pageCount);
+	for (std::unique_ptr<Record[]>& page : RecordPages)
+	{
+		for (int32 i = 0; page != nullptr && i <= RecordPageMask; ++i)
+		{
+			page[i] = Record{ FLT_MAX, FLT_MAX, NotInHeap };
+		}
+	}
+	OpenHeap.clear();
+
+	Start = start_index;
+	StartCoordinates = grid.GetCoordinates(start_index);
+	Goal = goal_index;
+	KeyModifier = 0.0f;
+
+	// The search grows from the goal
+	Record& goal = Touch(Goal);
+	goal.Rhs = 0.0f;
+	UpdateVertex(grid, Goal);
+}
+
+void NavDStarLite::SetStart(const NavGrid& grid, int32 start_index)
+{
+	// Every key in the heap was computed with a heuristic to the old start, which can be off by up to the distance moved.
+	// Adding that distance to the new keys keeps the old ones lower bounds, so they are only recomputed when they reach the top.
+	const FIntVector coordinates = grid.GetCoordinates(start_index);
+	KeyModifier += FVector::Distance(FVector(StartCoordinates), FVector(coordinates));
+	Start = start_index;
+	StartCoordinates = coordinates;
+}
+
+void NavDStarLite::UpdateCells(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& changed_cells)
+{
+	if (IsValid() == false)
+		return;
+
+	NAV_TRACE_SCOPE(NavDStarLite::UpdateCells);
+
+	// A cell changing only changes the cost of the moves into and out of it, so only its lookahead and its neighbors' change
+	for (const int32 cell : changed_cells)
+	{
+		if (cell != Goal)
+		{
+			Touch(cell).Rhs = ComputeRhs(grid, occupancy, cell);
+			UpdateVertex(grid, cell);
+		}
+
+		grid.ForEachNeighbor(grid.GetCoordinates(cell), [&](int32 neighbor, int32)
+		{
+			if (neighbor != Goal)
+			{
+				Touch(neighbor).Rhs = ComputeRhs(grid, occupancy, neighbor);
+				UpdateVertex(grid, neighbor);
+			}
+		});
+	}
+}
+
+bool NavDStarLite::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, std::vector<int32>& out_path)
+{
+	NAV_TRACE_SCOPE(NavDStarLite::FindPath);
+
+	out_path.clear();
+	LastExpandedNum = 0;
+	if (IsValid() == false || occupancy.IsBlocked(Goal))
+		return false;
+
+	// Like A*, a blocked start can still be left. Its lookahead was skipped while it wasn't the start, so it is computed now.
+	if (Start != Goal && occupancy.IsBlocked(Start))
+	{
+		Touch(Start).Rhs = ComputeRhs(grid, occupancy, Start);
+		UpdateVertex(grid, Start);
+	}
+
+	// Expand the inconsistent cells until the start is consistent and no cell in the heap could lower its cost. Cells along
+	// another shortest path have the same key as the start, up to rounding, so those are expanded too rather than compared.
+	Record& start = Touch(Start);
+	while (OpenHeap.empty() == false)
+	{
+		const Key startKey = CalculateKey(grid, start, Start);
+		if (OpenHeap[0].EntryKey.Primary > startKey.Primary + (KeyTolerance * FMath::Max(startKey.Primary, 1.0f)) && start.Rhs <= start.G)
+			break;
+
+		const int32 current = OpenHeap[0].Index;
+		Record& record = Touch(current);
+
+		// The key is out of date since the agent moved, put it back with the current one
+		const Key key = CalculateKey(grid, record, current);
+		if (OpenHeap[0].EntryKey < key)
+		{
+			OpenHeap[0].EntryKey = key;
+			SiftDown(0);
+			continue;
+		}
+
+		++LastExpandedNum;
+		if (record.G > record.Rhs)
+		{
+			// The cost went down, the neighbors may now go through the cell, unless it is a blocked start
+			record.G = record.Rhs;
+			RemoveOpen(0);
+			if (occupancy.IsBlocked(current))
+				continue;
+
+			grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32 offsetIndex)
+			{
+				if (neighbor == Goal || (neighbor != Start && occupancy.IsBlocked(neighbor)))
+					return;
+
+				Record& neighborRecord = Touch(neighbor);
+				const float rhs = record.G + NavNeighborDistances[offsetIndex];
+				if (rhs < neighborRecord.Rhs)
+				{
+					neighborRecord.Rhs = rhs;
+					UpdateVertex(grid, neighbor);
+				}
+			});
+		}
+		else
+		{
+			// The cost went up, the neighbors that went through the cell have to look for another way
+			const float oldG = record.G;
+			record.G = FLT_MAX;
+			if (current != Goal)
+			{
+				record.Rhs = ComputeRhs(grid, occupancy, current);
+			}
+			UpdateVertex(grid, current);
+
+			// The lookahead of the neighbors of a blocked cell was recomputed without it when it changed
+			if (occupancy.IsBlocked(current))
+				continue;
+
+			grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32 offsetIndex)
+			{
+				if (neighbor == Goal || (neighbor != Start && occupancy.IsBlocked(neighbor)))
+					return;
+
+				Record& neighborRecord = Touch(neighbor);
+				if (neighborRecord.Rhs == oldG + NavNeighborDistances[offsetIndex])
+				{
+					neighborRecord.Rhs = ComputeRhs(grid, occupancy, neighbor);
+					UpdateVertex(grid, neighbor);
+				}
+			});
+		}
+	}
+	TotalExpandedNum += LastExpandedNum;
+
+	// The search can stop before the start's own cost is settled, its lookahead is the cost of the path
+	if (start.Rhs == FLT_MAX)
+		return false;
+
+	// Walk down the costs from the start, every step goes to the neighbor through which the cost is the lowest
+	out_path.push_back(Start);
+	for (int32 current = Start; current != Goal;)
+	{
+		float bestCost = FLT_MAX;
+		int32 next = INDEX_NONE;
+		grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32 offsetIndex)
+		{
+			const float g = GetG(neighbor);
+			if (g == FLT_MAX || occupancy.IsBlocked(neighbor))
+				return;
+
+			const float cost = g + NavNeighborDistances[offsetIndex];
+			if (cost < bestCost)
+			{
+				bestCost = cost;
+				next = neighbor;
+			}
+		});
+
+		if (next == INDEX_NONE || static_cast<int32>(out_path.size()) > grid.Num())
+		{
+			out_path.clear();
+			return false;
+		}
+
+		out_path.push_back(next);
+		current = next;
+	}
+	return true;
+}
+
+SIZE_T NavDStarLite::GetAllocatedSize() const
+{
+	SIZE_T size = (OpenHeap.capacity() * sizeof(OpenEntry)) + (RecordPages.capacity() * sizeof(std::unique_ptr<Record[]>));
+	for (const std::unique_ptr<Record[]>& page : RecordPages)
+	{
+		if (page != nullptr)
+		{
+			size += (RecordPageMask + 1) * sizeof(Record);
+		}
+	}
+	return size;
+}
+
+NavDStarLite::Record& NavDStarLite::Touch(int32 index)
+{
+	std::unique_ptr<Record[]>& page = RecordPages[index >> RecordPageShift];
+	if (page == nullptr)
+	{
+		page.reset(new Record[RecordPageMask + 1]);
+		for (int32 i = 0; i <= RecordPageMask; ++i)
+		{
+			page[i] = Record{ FLT_MAX, FLT_MAX, NotInHeap };
+		}
+	}
+	return page[index & RecordPageMask];
+}
+
+NavDStarLite::Key NavDStarLite::CalculateKey(const NavGrid& grid, const Record& record, int32 index) const
+{
+	const float cost = FMath::Min(record.G, record.Rhs);
+	if (cost == FLT_MAX)
+		return Key{ FLT_MAX, FLT_MAX };
+
+	return Key{ cost + FVector::Distance(FVector(StartCoordinates), FVector(grid.GetCoordinates(index))) + KeyModifier, cost };
+}
+
+float NavDStarLite::ComputeRhs(const NavGrid& grid, const NavOccupancy& occupancy, int32 index) const
+{
+	if (index != Start && occupancy.IsBlocked(index))
+		return FLT_MAX;
+
+	float rhs = FLT_MAX;
+	grid.ForEachNeighbor(grid.GetCoordinates(index), [&](int32 neighbor, int32 offsetIndex)
+	{
+		const float g = GetG(neighbor);
+		if (g != FLT_MAX && occupancy.IsBlocked(neighbor) == false)
+		{
+			rhs = FMath::Min(rhs, g + NavNeighborDistances[offsetIndex]);
+		}
+	});
+	return rhs;
+}
+
+void NavDStarLite::UpdateVertex(const NavGrid& grid, int32 index)
+{
+	Record& record = Touch(index);
+	const bool consistent = record.G == record.Rhs;
+	if (record.HeapIndex != NotInHeap)
+	{
+		if (consistent)
+		{
+			RemoveOpen(record.HeapIndex);
+			return;
+		}
+
+		// The key may go either way
+		const int32 position = record.HeapIndex;
+		OpenHeap[position].EntryKey = CalculateKey(grid, record, index);
+		SiftUp(position);
+		SiftDown(record.HeapIndex);
+	}
+	else if (consistent == false)
+	{
+		record.HeapIndex = static_cast<int32>(OpenHeap.size());
+		OpenHeap.push_back({ CalculateKey(grid, record, index), index });
+		SiftUp(record.HeapIndex);
+	}
+}
+
+void NavDStarLite::RemoveOpen(int32 position)
+{
+	Touch(OpenHeap[position].Index).HeapIndex = NotInHeap;
+
+	// Move the last entry into the hole and restore the heap
+	const OpenEntry last = OpenHeap.back();
+	OpenHeap.pop_back();
+	if (position < static_cast<int32>(OpenHeap.size()))
+	{
+		OpenHeap[position] = last;
+		Record& record = Touch(last.Index);
+		record.HeapIndex = position;
+		SiftUp(position);
+		SiftDown(record.HeapIndex);
+	}
+}
+
+void NavDStarLite::SiftUp(int32 position)
+{
+	const OpenEntry entry = OpenHeap[position];
+	while (position > 0)
+	{
+		const int32 parentPosition = (position - 1) / 2;
+		if ((entry.EntryKey < OpenHeap[parentPosition].EntryKey) == false)
+			break;
+
+		OpenHeap[position] = OpenHeap[parentPosition];
+		Touch(OpenHeap[position].Index).HeapIndex = position;
+		position = parentPosition;
+	}
+	OpenHeap[position] = entry;
+	Touch(entry.Index).HeapIndex = position;
+}
+
+void NavDStarLite::SiftDown(int32 position)
+{
+	const OpenEntry entry = OpenHeap[position];
+	const int32 count = static_cast<int32>(OpenHeap.size());
+	while (true)
+	{
+		int32 child = (position * 2) + 1;
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && OpenHeap[child + 1].EntryKey < OpenHeap[child].EntryKey)
+			++child;
+
+		if ((OpenHeap[child].EntryKey < entry.EntryKey) == false)
+			break;
+
+		OpenHeap[position] = OpenHeap[child];
+		Touch(OpenHeap[position].Index).HeapIndex = position;
+		position = child;
+	}
+	OpenHeap[position] = entry;
+	Touch(entry.Index).HeapIndex = position;
+}
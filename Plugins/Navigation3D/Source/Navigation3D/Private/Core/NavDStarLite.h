@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <memory>
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+
+/**
+* An incremental planner (D* Lite) keeping its search state between queries, for an agent replanning towards the same goal
+* as it moves and as cells change. It searches backwards from the goal, so the costs it stores don't depend on the start:
+* moving the agent only shifts the heuristic, and a changed cell only makes the cells whose cost went through it, or could now
+* go through it, inconsistent. The next query repairs those cells instead of searching again from scratch. Moves and costs
+* are the same as NavAStar's. A planner belongs to a single agent and isn't thread safe.
+*/
+class NavDStarLite
+{
+public:
+	/**
+	* Starts planning for a new goal, forgetting the previous search.
+	* @param	grid				The grid to search
+	* @param	start_index			The flat index of the cell the agent is in
+	* @param	goal_index			The flat index of the cell to reach
+	*/
+	void Init(const NavGrid& grid, int32 start_index, int32 goal_index);
+
+	// Moves the agent to another cell, usually along the last path found
+	void SetStart(const NavGrid& grid, int32 start_index);
+
+	/**
+	* Takes changes to the occupancy into account. Must be called with every cell that changed between the occupancy of the
+	* previous query and the occupancy of the next one.
+	* @param	grid				The grid the planner searches
+	* @param	occupancy			The occupancy of the next query, including the changes
+	* @param	changed_cells		The flat index of every cell whose occupancy changed
+	*/
+	void UpdateCells(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& changed_cells);
+
+	/**
+	* Finds the shortest path from the start to the goal, only expanding the cells made inconsistent since the last query.
+	* @param	grid				The grid the planner searches
+	* @param	occupancy			The occupancy to search
+	* @param	out_path			The flat index of every cell along the path, including the start and the goal
+	* @return	Whether a path was found
+	*/
+	bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, std::vector<int32>& out_path);
+
+	// Checks if the planner has a goal
+	FORCEINLINE bool IsValid() const { return Goal != INDEX_NONE; }
+
+	// Gets the flat index of the cell the agent is in
+	FORCEINLINE int32 GetStart() const { return Start; }
+
+	// Gets the flat index of the cell to reach
+	FORCEINLINE int32 GetGoal() const { return Goal; }
+
+	// Gets the number of cells expanded by the last query
+	FORCEINLINE int32 GetLastExpandedNum() const { return LastExpandedNum; }
+
+	// Gets the number of cells expanded since the planner was created
+	FORCEINLINE uint64 GetTotalExpandedNum() const { return TotalExpandedNum; }
+
+	// Gets the number of bytes used by the record pages and the open heap
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// The search state of a cell
+	struct Record
+	{
+		// The cost of the best path found from the cell to the goal
+		float G;
+
+		// The cost of the best path through the neighbors of the cell (the one-step lookahead). The cell is consistent when both match.
+		float Rhs;
+
+		// The position of the cell in the open heap, or NotInHeap
+		int32 HeapIndex;
+	};
+
+	static constexpr int32 NotInHeap = -1;
+
+	// The priority of a cell in the open heap, compared on the first value then the second
+	struct Key
+	{
+		float Primary;
+		float Secondary;
+
+		FORCEINLINE bool operator<(const Key& other) const
+		{
+			return Primary < other.Primary || (Primary == other.Primary && Secondary < other.Secondary);
+		}
+	};
+
+	struct OpenEntry
+	{
+		Key EntryKey;
+		int32 Index;
+	};
+
+	// The number of records per page, as a power of two
+	static constexpr int32 RecordPageShift = 12;
+	static constexpr int32 RecordPageMask = (1 << RecordPageShift) - 1;
+
+	// Gets the cost from a cell to the goal, FLT_MAX if the cell hasn't been reached
+	FORCEINLINE float GetG(int32 index) const
+	{
+		const Record* page = RecordPages[index >> RecordPageShift].get();
+		return page != nullptr ? page[index & RecordPageMask].G : FLT_MAX;
+	}
+
+	// Gets the record of a cell, allocating its page the first time
+	Record& Touch(int32 index);
+
+	// Helper function computing the priority of a cell
+	Key CalculateKey(const NavGrid& grid, const Record& record, int32 index) const;
+
+	// Helper function computing the lookahead cost of a cell from its neighbors
+	float ComputeRhs(const NavGrid& grid, const NavOccupancy& occupancy, int32 index) const;
+
+	// Helper function adding, moving or removing a cell in the open heap depending on whether it's consistent
+	void UpdateVertex(const NavGrid& grid, int32 index);
+
+	// Helper function removing the entry at a position of the open heap
+	void RemoveOpen(int32 position);
+
+	// Moves a heap entry up until its parent has a lower key
+	void SiftUp(int32 position);
+
+	// Moves a heap entry down until its children have higher keys
+	void SiftDown(int32 position);
+
+	// The pages of per cell records, indexed by flat index. Pages no search has reached yet are null.
+	std::vector<std::unique_ptr<Record[]> > RecordPages;
+
+	// The inconsistent cells, as a binary min heap on their keys
+	std::vector<OpenEntry> OpenHeap;
+
+	int32 Start = INDEX_NONE;
+	int32 Goal = INDEX_NONE;
+	FIntVector StartCoordinates = FIntVector::ZeroValue;
+
+	// The sum of the heuristic distances the agent moved by, added to the keys instead of reordering the heap
+	float KeyModifier = 0.0f;
+
+	int32 LastExpandedNum = 0;
+	uint64 TotalExpandedNum = 0;
+};
@@ -0,0 +1,270 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavFlowField.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include <algorithm>
+#include <iterator>
+
+namespace
+{
+	// The number of cells of a wave recomputed by each parallel task, enough to outweigh the cost of scheduling it
+	constexpr int32 WaveChunkSize = 512;
+
+	// Gets the index into NavNeighborOffsets of the opposite of an offset
+	FORCEINLINE int32 GetOppositeOffsetIndex(int32 offset_index)
+	{
+		const NavNeighborOffset& offset = NavNeighborOffsets[offset_index];
+		return GetNavNeighborOffsetIndex(-offset.X, -offset.Y, -offset.Z);
+	}
+}
+
+void NavFlowField::Build(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& goal_cells, const ParallelForFuncType& parallel_for)
+{
+	NAV_TRACE_SCOPE(NavFlowField::Build);
+
+	Distances.assign(grid.Num(), FLT_MAX);
+	Moves.assign(grid.Num(), NoMove);
+	CandidateWaves.assign(grid.Num(), 0);
+	Wave = 0;
+	LastUpdatedNum = 0;
+
+	Goals = goal_cells;
+	std::sort(Goals.begin(), Goals.end());
+	Goals.erase(std::unique(Goals.begin(), Goals.end()), Goals.end());
+
+	NextWave();
+	for (const int32 goal : Goals)
+	{
+		SeedGoal(grid, occupancy, goal);
+	}
+	Spread(grid, occupancy, parallel_for);
+}
+
+void NavFlowField::SetGoals(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& goal_cells, const ParallelForFuncType& parallel_for)
+{
+	if (IsValid() == false)
+	{
+		Build(grid, occupancy, goal_cells, parallel_for);
+		return;
+	}
+
+	NAV_TRACE_SCOPE(NavFlowField::SetGoals);
+
+	std::vector<int32> goals = goal_cells;
+	std::sort(goals.begin(), goals.end());
+	goals.erase(std::unique(goals.begin(), goals.end()), goals.end());
+
+	std::vector<int32> removedGoals;
+	std::vector<int32> addedGoals;
+	std::set_difference(Goals.begin(), Goals.end(), goals.begin(), goals.end(), std::back_inserter(removedGoals));
+	std::set_difference(goals.begin(), goals.end(), Goals.begin(), Goals.end(), std::back_inserter(addedGoals));
+	Goals = std::move(goals);
+
+	// Raise first, a goal added on the way to a removed one is reset along with the cells around it then seeded again
+	LastUpdatedNum = 0;
+	NextWave();
+	Raise(grid, occupancy, removedGoals);
+	for (const int32 goal : addedGoals)
+	{
+		SeedGoal(grid, occupancy, goal);
+	}
+	Spread(grid, occupancy, parallel_for);
+}
+
+void NavFlowField::UpdateOccupancy(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& changed_cells, const ParallelForFuncType& parallel_for)
+{
+	if (IsValid() == false)
+		return;
+
+	NAV_TRACE_SCOPE(NavFlowField::UpdateOccupancy);
+
+	std::vector<int32> blockedCells;
+	for (const int32 cell : changed_cells)
+	{
+		if (occupancy.IsBlocked(cell))
+		{
+			blockedCells.push_back(cell);
+		}
+	}
+
+	LastUpdatedNum = 0;
+	NextWave();
+	Raise(grid, occupancy, blockedCells);
+
+	// Freed cells pull their distance from their neighbors, and freed goals spread theirs
+	for (const int32 cell : changed_cells)
+	{
+		if (occupancy.IsBlocked(cell))
+			continue;
+
+		if (std::binary_search(Goals.begin(), Goals.end(), cell))
+		{
+			SeedGoal(grid, occupancy, cell);
+		}
+		else
+		{
+			AddCandidate(cell);
+		}
+	}
+	Spread(grid, occupancy, parallel_for);
+}
+
+int32 NavFlowField::GetNextCell(const NavGrid& grid, int32 index) const
+{
+	const uint8 move = Moves[index];
+	return move == NoMove ? INDEX_NONE : index + grid.GetNeighborIndexOffset(move);
+}
+
+SIZE_T NavFlowField::GetAllocatedSize() const
+{
+	return (Distances.capacity() * sizeof(float)) + (Moves.capacity() * sizeof(uint8)) + (Goals.capacity() * sizeof(int32)) +
+		(Candidates.capacity() * sizeof(int32)) + (CandidateWaves.capacity() * sizeof(uint32)) + (WaveCells.capacity() * sizeof(int32)) +
+		(WaveDistances.capacity() * sizeof(float)) + (WaveMoves.capacity() * sizeof(uint8)) + (RaiseStack.capacity() * sizeof(int32));
+}
+
+void NavFlowField::Raise(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& cells)
+{
+	// The moves form a forest rooted at the goals, so the cells reaching a goal through one of the cells are the trees below them
+	RaiseStack.clear();
+	for (const int32 cell : cells)
+	{
+		Distances[cell] = FLT_MAX;
+		Moves[cell] = NoMove;
+		RaiseStack.push_back(cell);
+	}
+
+	while (RaiseStack.empty() == false)
+	{
+		const int32 index = RaiseStack.back();
+		RaiseStack.pop_back();
+		++LastUpdatedNum;
+
+		if (occupancy.IsBlocked(index) == false)
+		{
+			AddCandidate(index);
+		}
+
+		grid.ForEachNeighbor(grid.GetCoordinates(index), [&](int32 neighbor, int32 offsetIndex)
+		{
+			if (Moves[neighbor] != NoMove && Moves[neighbor] == GetOppositeOffsetIndex(offsetIndex))
+			{
+				Distances[neighbor] = FLT_MAX;
+				Moves[neighbor] = NoMove;
+				RaiseStack.push_back(neighbor);
+			}
+		});
+	}
+}
+
+void NavFlowField::AddCandidate(int32 index)
+{
+	if (CandidateWaves[index] != Wave)
+	{
+		CandidateWaves[index] = Wave;
+		Candidates.push_back(index);
+	}
+}
+
+void NavFlowField::AddNeighborCandidates(const NavGrid& grid, const NavOccupancy& occupancy, int32 index)
+{
+	grid.ForEachNeighbor(grid.GetCoordinates(index), [&](int32 neighbor, int32)
+	{
+		if (occupancy.IsBlocked(neighbor) == false)
+		{
+			AddCandidate(neighbor);
+		}
+	});
+}
+
+void NavFlowField::Spread(const NavGrid& grid, const NavOccupancy& occupancy, const ParallelForFuncType& parallel_for)
+{
+	while (Candidates.empty() == false)
+	{
+		std::swap(WaveCells, Candidates);
+		Candidates.clear();
+		NextWave();
+
+		// Every cell of the wave only reads the distances of the previous waves, so the cells are recomputed independently
+		const int32 count = static_cast<int32>(WaveCells.size());
+		WaveDistances.resize(count);
+		WaveMoves.resize(count);
+		const std::function<void(int32)> pullChunk = [&](int32 chunk)
+		{
+			const int32 end = FMath::Min(count, (chunk + 1) * WaveChunkSize);
+			for (int32 i = chunk * WaveChunkSize; i < end; ++i)
+			{
+				const int32 index = WaveCells[i];
+				float bestDistance = Distances[index];
+				uint8 bestMove = Moves[index];
+				if (occupancy.IsBlocked(index) == false)
+				{
+					// Blocked cells are always unreachable, so they're skipped along with the other unreachable cells
+					grid.ForEachNeighbor(grid.GetCoordinates(index), [&](int32 neighbor, int32 offsetIndex)
+					{
+						const float neighborDistance = Distances[neighbor];
+						if (neighborDistance == FLT_MAX)
+							return;
+
+						const float distance = neighborDistance + NavNeighborDistances[offsetIndex];
+						if (distance < bestDistance)
+						{
+							bestDistance = distance;
+							bestMove = static_cast<uint8>(offsetIndex);
+						}
+					});
+				}
+				WaveDistances[i] = bestDistance;
+				WaveMoves[i] = bestMove;
+			}
+		};
+
+		const int32 chunkCount = (count + WaveChunkSize - 1) / WaveChunkSize;
+		if (parallel_for && chunkCount > 1)
+		{
+			parallel_for(chunkCount, pullChunk);
+		}
+		else
+		{
+			for (int32 chunk = 0; chunk < chunkCount; ++chunk)
+			{
+				pullChunk(chunk);
+			}
+		}
+
+		// Apply the improvements in order, so the result doesn't depend on how the wave was split
+		for (int32 i = 0; i < count; ++i)
+		{
+			const int32 index = WaveCells[i];
+			if (WaveDistances[i] < Distances[index])
+			{
+				Distances[index] = WaveDistances[i];
+				Moves[index] = WaveMoves[i];
+				++LastUpdatedNum;
+				AddNeighborCandidates(grid, occupancy, index);
+			}
+		}
+	}
+}
+
+void NavFlowField::NextWave()
+{
+	// Clear the stamps when they wrap around, instead of mistaking an old wave for the current one
+	if (++Wave == 0)
+	{
+		std::fill(CandidateWaves.begin(), CandidateWaves.end(), 0);
+		Wave = 1;
+	}
+}
+
+void NavFlowField::SeedGoal(const NavGrid& grid, const NavOccupancy& occupancy, int32 index)
+{
+	if (occupancy.IsBlocked(index))
+		return;
+
+	Distances[index] = 0.0f;
+	Moves[index] = NoMove;
+	++LastUpdatedNum;
+	AddNeighborCandidates(grid, occupancy, index);
+}
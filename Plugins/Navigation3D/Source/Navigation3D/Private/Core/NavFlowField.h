@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <functional>
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+
+/**
+* The distance from every cell of the grid to the closest of a set of goal cells (a Dijkstra map), along with the move to
+* make from each cell to get closer, so any number of agents heading to the same goals read their next step in O(1) instead
+* of each searching for a path. Distances spread from the goals in waves: each wave recomputes the cells next to the ones the
+* previous wave improved from their neighbors, in parallel, then applies the improvements, until nothing improves. When goals
+* are removed or cells become blocked, only the cells whose moves led through them are reset and spread into again, and added
+* goals and freed cells only spread the distances they shorten.
+*/
+class NavFlowField
+{
+public:
+	// Runs body(index) for every index in [0, count), possibly in parallel, returning once every call has returned
+	using ParallelForFuncType = std::function<void(int32 count, const std::function<void(int32 index)>& body)>;
+
+	// The move of a cell that is a goal or can't reach one
+	static constexpr uint8 NoMove = 0xFF;
+
+	/**
+	* Computes the field from scratch.
+	* @param	grid				The grid to compute the field over
+	* @param	occupancy			The occupancy of the grid
+	* @param	goal_cells			The flat index of every goal cell. Blocked goals are kept, but only used once they're freed.
+	* @param	parallel_for		Runs the cells of each wave in parallel (optional, they run one after another otherwise)
+	*/
+	void Build(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& goal_cells, const ParallelForFuncType& parallel_for = nullptr);
+
+	// Replaces the goals, only updating the cells whose distance changes. Same parameters as Build.
+	void SetGoals(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& goal_cells, const ParallelForFuncType& parallel_for = nullptr);
+
+	/**
+	* Updates the field after the occupancy of some cells changed, only updating the cells whose distance changes.
+	* @param	grid				The grid the field was computed over
+	* @param	occupancy			The occupancy of the grid, including the changes
+	* @param	changed_cells		The flat index of every cell whose occupancy changed since the field was last updated
+	* @param	parallel_for		Runs the cells of each wave in parallel (optional)
+	*/
+	void UpdateOccupancy(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& changed_cells, const ParallelForFuncType& parallel_for = nullptr);
+
+	// Checks if the field has been computed
+	FORCEINLINE bool IsValid() const { return Distances.size() > 0; }
+
+	// Gets the goal cells, sorted
+	FORCEINLINE const std::vector<int32>& GetGoals() const { return Goals; }
+
+	// Gets the length of the shortest path from a cell to the closest goal, in cells, or FLT_MAX if no goal can be reached
+	FORCEINLINE float GetDistance(int32 index) const { return Distances[index]; }
+
+	// Gets the index into NavNeighborOffsets of the move to make from a cell, or NoMove if the cell is a goal or can't reach one
+	FORCEINLINE uint8 GetMove(int32 index) const { return Moves[index]; }
+
+	// Gets the flat index of the cell to move to from a cell, or INDEX_NONE if the cell is a goal or can't reach one
+	int32 GetNextCell(const NavGrid& grid, int32 index) const;
+
+	// Gets the number of cells updated by the last build or update, a measure of its cost
+	FORCEINLINE int32 GetLastUpdatedNum() const { return LastUpdatedNum; }
+
+	// Gets the number of bytes used by the field and its scratch buffers
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Helper function resetting the cells whose moves lead into one of the cells, and queueing them to be spread into again
+	void Raise(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& cells);
+
+	// Helper function queueing a cell to be recomputed in the next wave, once per wave
+	void AddCandidate(int32 index);
+
+	// Helper function queueing the free neighbors of a cell to be recomputed in the next wave
+	void AddNeighborCandidates(const NavGrid& grid, const NavOccupancy& occupancy, int32 index);
+
+	// Helper function running waves from the queued cells until no distance improves
+	void Spread(const NavGrid& grid, const NavOccupancy& occupancy, const ParallelForFuncType& parallel_for);
+
+	// Helper function starting a new wave, so every cell can be queued again
+	void NextWave();
+
+	// Helper function setting a free goal to zero and queueing its neighbors
+	void SeedGoal(const NavGrid& grid, const NavOccupancy& occupancy, int32 index);
+
+	// The distance from each cell to the closest goal, FLT_MAX if none can be reached
+	std::vector<float> Distances;
+
+	// The move to make from each cell, as an index into NavNeighborOffsets, or NoMove
+	std::vector<uint8> Moves;
+
+	// The goal cells, sorted
+	std::vector<int32> Goals;
+
+	// The cells to recompute in the next wave, and the wave each cell was last queued in
+	std::vector<int32> Candidates;
+	std::vector<uint32> CandidateWaves;
+	uint32 Wave = 0;
+
+	// The cells recomputed in the current wave, and the distance and move computed for each
+	std::vector<int32> WaveCells;
+	std::vector<float> WaveDistances;
+	std::vector<uint8> WaveMoves;
+
+	// The cells left to reset when raising
+	std::vector<int32> RaiseStack;
+
+	// The number of cells updated by the last build or update
+	int32 LastUpdatedNum = 0;
+};
@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavGrid.h"
+
+void NavGrid::Init(const FIntVector& divisions, int32 min_shared_neighbor_axes)
+{
+	Divisions = divisions;
+	NeighborCount = NavNeighborCounts[FMath::Clamp(min_shared_neighbor_axes, 0, 2)];
+
+	for (int32 i = 0; i < 26; ++i)
+	{
+		const NavNeighborOffset& offset = NavNeighborOffsets[i];
+		NeighborIndexOffsets[i] = (offset.Z * Divisions.X * Divisions.Y) + (offset.Y * Divisions.X) + offset.X;
+	}
+}
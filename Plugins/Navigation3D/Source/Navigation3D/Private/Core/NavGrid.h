@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+
+// The offset from a cell to one of its neighbors
+struct NavNeighborOffset
+{
+	int8 X;
+	int8 Y;
+	int8 Z;
+};
+
+// The offsets to all 26 neighbors of a cell, ordered by the number of axes they share with the cell (2, then 1, then 0)
+static constexpr NavNeighborOffset NavNeighborOffsets[26] =
+{
+	// Faces
+	{ 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 },
+
+	// Edges
+	{ 1, 1, 0 }, { 1, -1, 0 }, { -1, 1, 0 }, { -1, -1, 0 },
+	{ 1, 0, 1 }, { 1, 0, -1 }, { -1, 0, 1 }, { -1, 0, -1 },
+	{ 0, 1, 1 }, { 0, 1, -1 }, { 0, -1, 1 }, { 0, -1, -1 },
+
+	// Corners
+	{ 1, 1, 1 }, { 1, 1, -1 }, { 1, -1, 1 }, { 1, -1, -1 },
+	{ -1, 1, 1 }, { -1, 1, -1 }, { -1, -1, 1 }, { -1, -1, -1 },
+};
+
+// The length of the move to each neighbor, in the same order as NavNeighborOffsets
+static constexpr float NavNeighborDistances[26] =
+{
+	// Faces
+	1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f,
+
+	// Edges
+	1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f,
+	1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f,
+	1.41421356f, 1.41421356f, 1.41421356f, 1.41421356f,
+
+	// Corners
+	1.73205081f, 1.73205081f, 1.73205081f, 1.73205081f,
+	1.73205081f, 1.73205081f, 1.73205081f, 1.73205081f,
+};
+
+// The number of leading entries of NavNeighborOffsets that are neighbors for each MinSharedNeighborAxes value
+static constexpr int32 NavNeighborCounts[3] = { 26, 18, 6 };
+
+// Gets the index into NavNeighborOffsets of an offset with components in [-1, 1], or INDEX_NONE for the zero offset
+FORCEINLINE int32 GetNavNeighborOffsetIndex(int32 x, int32 y, int32 z)
+{
+	static constexpr int8 OffsetIndices[27] =
+	{
+		25, 9, 24, 13, 1, 12, 23, 8, 22,
+		17, 3, 16, 5, -1, 4, 15, 2, 14,
+		21, 7, 20, 11, 0, 10, 19, 6, 18,
+	};
+	return OffsetIndices[((x + 1) * 9) + ((y + 1) * 3) + (z + 1)];
+}
+
+// Describes the dimensions of the grid and computes the neighbors of a cell from its flat index, without storing them
+class NavGrid
+{
+public:
+	// Sets the dimensions of the grid and which offsets count as neighbors
+	void Init(const FIntVector& divisions, int32 min_shared_neighbor_axes);
+
+	// Gets the number of cells in the grid
+	FORCEINLINE int32 Num() const { return Divisions.X * Divisions.Y * Divisions.Z; }
+
+	// Gets the number of divisions along each axis
+	FORCEINLINE const FIntVector& GetDivisions() const { return Divisions; }
+
+	// Gets the number of neighbors of a cell in the interior of the grid
+	FORCEINLINE int32 GetNeighborCount() const { return NeighborCount; }
+
+	// Converts valid coordinates into a flat index
+	FORCEINLINE int32 GetIndex(const FIntVector& coordinates) const
+	{
+		return (coordinates.Z * Divisions.X * Divisions.Y) + (coordinates.Y * Divisions.X) + coordinates.X;
+	}
+
+	// Converts a flat index into coordinates
+	FORCEINLINE FIntVector GetCoordinates(int32 index) const
+	{
+		const int32 divisionPerLevel = Divisions.X * Divisions.Y;
+		return FIntVector(index % Divisions.X, (index % divisionPerLevel) / Divisions.X, index / divisionPerLevel);
+	}
+
+	// Checks if the coordinates are inside the grid
+	FORCEINLINE bool AreCoordinatesValid(const FIntVector& coordinates) const
+	{
+		return coordinates.X >= 0 && coordinates.X < Divisions.X &&
+			coordinates.Y >= 0 && coordinates.Y < Divisions.Y &&
+			coordinates.Z >= 0 && coordinates.Z < Divisions.Z;
+	}
+
+	// Checks if a cell is one of the neighbors of another, as allowed by MinSharedNeighborAxes
+	FORCEINLINE bool AreNeighbors(const FIntVector& a, const FIntVector& b) const
+	{
+		const FIntVector offset = b - a;
+		if (FMath::Abs(offset.X) > 1 || FMath::Abs(offset.Y) > 1 || FMath::Abs(offset.Z) > 1)
+			return false;
+
+		// The offsets are ordered by the number of axes they share, so the allowed ones come first
+		const int32 offsetIndex = GetNavNeighborOffsetIndex(offset.X, offset.Y, offset.Z);
+		return offsetIndex != INDEX_NONE && offsetIndex < NeighborCount;
+	}
+
+	// Gets the flat index delta of an entry of NavNeighborOffsets
+	FORCEINLINE int32 GetNeighborIndexOffset(int32 offset_index) const { return NeighborIndexOffsets[offset_index]; }
+
+	/**
+	* Calls a function with the flat index of each neighbor of a cell that is inside the grid.
+	* @param	coordinates			The coordinates of the cell
+	* @param	func				Called as func(int32 neighbor_index, int32 offset_index)
+	*/
+	template<typename FuncType>
+	FORCEINLINE void ForEachNeighbor(const FIntVector& coordinates, FuncType&& func) const
+	{
+		const int32 index = GetIndex(coordinates);
+
+		// Cells that don't touch the border have every neighbor, so skip the bounds checks
+		if (coordinates.X > 0 && coordinates.X < Divisions.X - 1 &&
+			coordinates.Y > 0 && coordinates.Y < Divisions.Y - 1 &&
+			coordinates.Z > 0 && coordinates.Z < Divisions.Z - 1)
+		{
+			for (int32 i = 0; i < NeighborCount; ++i)
+			{
+				func(index + NeighborIndexOffsets[i], i);
+			}
+			return;
+		}
+
+		for (int32 i = 0; i < NeighborCount; ++i)
+		{
+			const NavNeighborOffset& offset = NavNeighborOffsets[i];
+			if (AreCoordinatesValid(FIntVector(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z)))
+			{
+				func(index + NeighborIndexOffsets[i], i);
+			}
+		}
+	}
+
+private:
+	// The number of divisions along each axis
+	FIntVector Divisions = FIntVector::ZeroValue;
+
+	// The number of leading entries of NavNeighborOffsets used as neighbors
+	int32 NeighborCount = 0;
+
+	// The flat index delta for each entry of NavNeighborOffsets
+	int32 NeighborIndexOffsets[26] = {};
+};
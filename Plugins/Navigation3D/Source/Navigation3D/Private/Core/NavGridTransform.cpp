@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavGridTransform.h"
+#include "NavSimd.h"
+#include <cmath>
+
+void NavGridTransform::Init(const FIntVector& divisions, const FVector& origin, const FVector axes[3], float division_size)
+{
+	Divisions = divisions;
+	Origin = origin;
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		const FVector& a = axes[axis];
+		CellAxes[axis] = a * division_size;
+
+		// The axes are orthogonal, so each row of the inverse is an axis over its squared length, here also divided by the division size
+		const float lengthSq = (a.X * a.X) + (a.Y * a.Y) + (a.Z * a.Z);
+		const float scale = lengthSq > 0.0f && division_size > 0.0f ? 1.0f / (lengthSq * division_size) : 0.0f;
+		Rows[axis][0] = a.X * scale;
+		Rows[axis][1] = a.Y * scale;
+		Rows[axis][2] = a.Z * scale;
+		Rows[axis][3] = -((Rows[axis][0] * origin.X) + (Rows[axis][1] * origin.Y) + (Rows[axis][2] * origin.Z));
+	}
+}
+
+FVector NavGridTransform::GetCellSpaceLocation(const FVector& location) const
+{
+	return FVector((Rows[0][0] * location.X) + (Rows[0][1] * location.Y) + (Rows[0][2] * location.Z) + Rows[0][3],
+		(Rows[1][0] * location.X) + (Rows[1][1] * location.Y) + (Rows[1][2] * location.Z) + Rows[1][3],
+		(Rows[2][0] * location.X) + (Rows[2][1] * location.Y) + (Rows[2][2] * location.Z) + Rows[2][3]);
+}
+
+FIntVector NavGridTransform::GetClampedCoordinates(const FVector& location) const
+{
+	const FVector cellSpaceLocation = GetCellSpaceLocation(location);
+	return FIntVector(FMath::Clamp(FMath::FloorToInt(cellSpaceLocation.X), 0, Divisions.X - 1),
+		FMath::Clamp(FMath::FloorToInt(cellSpaceLocation.Y), 0, Divisions.Y - 1),
+		FMath::Clamp(FMath::FloorToInt(cellSpaceLocation.Z), 0, Divisions.Z - 1));
+}
+
+int32 NavGridTransform::GetCellIndex(const FVector& location) const
+{
+	const FVector cellSpaceLocation = GetCellSpaceLocation(location);
+	const FIntVector coordinates(FMath::FloorToInt(cellSpaceLocation.X), FMath::FloorToInt(cellSpaceLocation.Y), FMath::FloorToInt(cellSpaceLocation.Z));
+	if (coordinates.X < 0 || coordinates.X >= Divisions.X || coordinates.Y < 0 || coordinates.Y >= Divisions.Y || coordinates.Z < 0 || coordinates.Z >= Divisions.Z)
+		return INDEX_NONE;
+
+	return (((coordinates.Z * Divisions.Y) + coordinates.Y) * Divisions.X) + coordinates.X;
+}
+
+FVector NavGridTransform::GetWorldLocation(const FVector& cell_space_location) const
+{
+	return Origin + (CellAxes[0] * cell_space_location.X) + (CellAxes[1] * cell_space_location.Y) + (CellAxes[2] * cell_space_location.Z);
+}
+
+FVector NavGridTransform::GetCellCenter(const FIntVector& coordinates) const
+{
+	return GetWorldLocation(FVector(coordinates.X + 0.5f, coordinates.Y + 0.5f, coordinates.Z + 0.5f));
+}
+
+void NavGridTransform::GetCellIndices(const FVector* locations, int32 count, bool clamp, int32* out_cells) const
+{
+	NAV_TRACE_SCOPE(NavGridTransform::GetCellIndices);
+
+	const NavFloat4 zero = NavSet4(0.0f);
+	const NavFloat4 sizes[3] = { NavSet4(static_cast<float>(Divisions.X)), NavSet4(static_cast<float>(Divisions.Y)), NavSet4(static_cast<float>(Divisions.Z)) };
+
+	// The largest value below each size, so clamped values truncate to the last cell
+	const NavFloat4 lastValues[3] = { NavSet4(std::nextafter(static_cast<float>(Divisions.X), 0.0f)), NavSet4(std::nextafter(static_cast<float>(Divisions.Y), 0.0f)),
+		NavSet4(std::nextafter(static_cast<float>(Divisions.Z), 0.0f)) };
+
+	int32 first = 0;
+	for (; first + 4 <= count; first += 4)
+	{
+		const FVector* batch = locations + first;
+		const NavFloat4 x = NavSet4(batch[0].X, batch[1].X, batch[2].X, batch[3].X);
+		const NavFloat4 y = NavSet4(batch[0].Y, batch[1].Y, batch[2].Y, batch[3].Y);
+		const NavFloat4 z = NavSet4(batch[0].Z, batch[1].Z, batch[2].Z, batch[3].Z);
+
+		// Values clamped into [0, size) truncate to the cell they floor to, so the lanes only need a min and a max rather than a floor
+		float clamped[3][4];
+		NavMask4 inside = NavLessEqual4(zero, zero);
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			const NavFloat4 value = (NavSet4(Rows[axis][0]) * x) + (NavSet4(Rows[axis][1]) * y) + (NavSet4(Rows[axis][2]) * z) + NavSet4(Rows[axis][3]);
+			inside = inside & NavLessEqual4(zero, value) & NavLess4(value, sizes[axis]);
+			NavStore4(clamped[axis], NavMin4(NavMax4(value, zero), lastValues[axis]));
+		}
+
+		const uint32 insideBits = NavMaskBits4(inside);
+		for (int32 lane = 0; lane < 4; ++lane)
+		{
+			const int32 index = (((static_cast<int32>(clamped[2][lane]) * Divisions.Y) + static_cast<int32>(clamped[1][lane])) * Divisions.X) + static_cast<int32>(clamped[0][lane]);
+			out_cells[first + lane] = clamp || (insideBits & (1u << lane)) != 0 ? index : INDEX_NONE;
+		}
+	}
+
+	for (; first < count; ++first)
+	{
+		if (clamp)
+		{
+			const FIntVector coordinates = GetClampedCoordinates(locations[first]);
+			out_cells[first] = (((coordinates.Z * Divisions.Y) + coordinates.Y) * Divisions.X) + coordinates.X;
+		}
+		else
+		{
+			out_cells[first] = GetCellIndex(locations[first]);
+		}
+	}
+}
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+
+/**
+* The transform between world space and the cells of a grid, with the inverse of the volume's rotation and scale and the
+* division size folded into a single 3x4 matrix, so converting a location is a matrix product and a floor instead of going
+* through the actor's transform. Batches of locations are converted four at a time. Never modified once built, so any number
+* of threads can share it.
+*/
+class NavGridTransform
+{
+public:
+	/**
+	* Caches the transform of a grid.
+	* @param	divisions			The number of cells along each axis
+	* @param	origin				The world space location of the corner of cell (0, 0, 0)
+	* @param	axes				The world space vectors spanned by one grid space unit along X, Y and Z, orthogonal to each other
+	* @param	division_size		The size of a cell in grid space units
+	*/
+	void Init(const FIntVector& divisions, const FVector& origin, const FVector axes[3], float division_size);
+
+	// Checks if the transform has been built
+	FORCEINLINE bool IsValid() const { return Divisions.X > 0 && Divisions.Y > 0 && Divisions.Z > 0; }
+
+	// Gets the number of cells along each axis
+	FORCEINLINE const FIntVector& GetDivisions() const { return Divisions; }
+
+	// Gets a world space location in grid space measured in cells, so cell (x, y, z) spans [x, x + 1] along X, and so on
+	FVector GetCellSpaceLocation(const FVector& location) const;
+
+	// Gets the coordinates of the cell containing a world space location, clamped to the closest cell outside of the grid
+	FIntVector GetClampedCoordinates(const FVector& location) const;
+
+	// Gets the flat index of the cell containing a world space location, or INDEX_NONE outside of the grid
+	int32 GetCellIndex(const FVector& location) const;
+
+	// Gets the world space location of a location in grid space measured in cells
+	FVector GetWorldLocation(const FVector& cell_space_location) const;
+
+	// Gets the world space location of the center of a cell
+	FVector GetCellCenter(const FIntVector& coordinates) const;
+
+	/**
+	* Converts world space locations into the flat index of their cells, four at a time.
+	* @param	locations			The world space locations to convert
+	* @param	count				The number of locations
+	* @param	clamp				Whether the locations outside of the grid get the closest cell rather than INDEX_NONE
+	* @param	out_cells			Receives the flat index of the cell of each location
+	*/
+	void GetCellIndices(const FVector* locations, int32 count, bool clamp, int32* out_cells) const;
+
+private:
+	// The rows of the world space to cell space matrix, the last column being the translation
+	float Rows[3][4] = {};
+
+	// The origin and the world space vectors spanned by one cell along each axis, to go back to world space
+	FVector Origin = FVector::ZeroVector;
+	FVector CellAxes[3] = { FVector::ZeroVector, FVector::ZeroVector, FVector::ZeroVector };
+
+	FIntVector Divisions = FIntVector::ZeroValue;
+};
@@ -0,0 +1,353 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavJumpPointSearch.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+
+namespace
+{
+	// Gets the position of a move in the canonical ordering: corners, then edges by axis pair, then faces by axis
+	int32 GetCanonicalRank(const NavNeighborOffset& offset)
+	{
+		const int32 movedAxes = (offset.X != 0) + (offset.Y != 0) + (offset.Z != 0);
+		if (movedAxes == 3)
+			return 0;
+		if (movedAxes == 2)
+			return offset.Z == 0 ? 1 : (offset.Y == 0 ? 2 : 3);
+		return offset.X != 0 ? 4 : (offset.Y != 0 ? 5 : 6);
+	}
+
+	// Gets the bit of a cell of the 3x3x3 block centered on a cell, from its offset to the center
+	FORCEINLINE uint32 GetBlockBit(int32 x, int32 y, int32 z)
+	{
+		return 1u << (((x + 1) * 9) + ((y + 1) * 3) + (z + 1));
+	}
+
+	/**
+	* The pruning rules for each MinSharedNeighborAxes value and incoming move. A cell x reached from p = x - d doesn't need to
+	* consider the move to n = x + e if some other path from p to n inside the 3x3x3 block around x is shorter, or just as long
+	* and canonically earlier, because the search reaches n through that path instead. Moves with such a path in an empty block
+	* are pruned for good, the others are the natural successors of d. Pruned moves whose paths can all be blocked become
+	* forced successors when they are.
+	*/
+	struct JumpRuleTable
+	{
+		// The natural successors of each move, as a bitmask of NavNeighborOffsets entries
+		uint32 Natural[3][26];
+
+		// The moves that are forced if every one of their alternative paths is blocked
+		uint32 Forceable[3][26];
+
+		// The range of AlternativeMasks holding the alternative paths of each forceable move
+		int32 AlternativeBegin[3][26][26];
+		int32 AlternativeEnd[3][26][26];
+
+		// The cells of each alternative path as GetBlockBit bits. Only masks that aren't a superset of another one are kept.
+		std::vector<uint32> AlternativeMasks;
+
+		JumpRuleTable()
+		{
+			for (int32 minSharedAxes = 0; minSharedAxes < 3; ++minSharedAxes)
+			{
+				const int32 moveCount = NavNeighborCounts[minSharedAxes];
+				for (int32 move = 0; move < 26; ++move)
+				{
+					Natural[minSharedAxes][move] = 0;
+					Forceable[minSharedAxes][move] = 0;
+					for (int32 next = 0; next < 26; ++next)
+					{
+						AlternativeBegin[minSharedAxes][move][next] = AlternativeEnd[minSharedAxes][move][next] = 0;
+					}
+
+					if (move >= moveCount)
+						continue;
+
+					for (int32 next = 0; next < moveCount; ++next)
+					{
+						AddRule(minSharedAxes, move, next);
+					}
+				}
+			}
+		}
+
+		void AddRule(int32 min_shared_axes, int32 move, int32 next)
+		{
+			const NavNeighborOffset& d = NavNeighborOffsets[move];
+			const NavNeighborOffset& e = NavNeighborOffsets[next];
+			const FIntVector p(-d.X, -d.Y, -d.Z);
+			const FIntVector n(e.X, e.Y, e.Z);
+
+			// Going back to where we came from is never needed
+			if (p == n)
+				return;
+
+			const float cost = NavNeighborDistances[move] + NavNeighborDistances[next];
+			const int32 firstRank = GetCanonicalRank(d);
+			const int32 secondRank = GetCanonicalRank(e);
+			const int32 moveCount = NavNeighborCounts[min_shared_axes];
+
+			// Collect the paths of up to 3 moves from p to n that avoid the center and beat the path through it.
+			// Longer paths can't be as short as two moves.
+			std::vector<uint32> masks;
+			bool alwaysPruned = false;
+			struct PathState { FIntVector Cell; float Cost; int32 FirstRank; int32 Moves; uint32 Mask; };
+			std::vector<PathState> stack = { { p, 0.0f, INDEX_NONE, 0, 0u } };
+			while (stack.empty() == false && alwaysPruned == false)
+			{
+				const PathState state = stack.back();
+				stack.pop_back();
+
+				for (int32 i = 0; i < moveCount && alwaysPruned == false; ++i)
+				{
+					const NavNeighborOffset& offset = NavNeighborOffsets[i];
+					const FIntVector cell(state.Cell.X + offset.X, state.Cell.Y + offset.Y, state.Cell.Z + offset.Z);
+					if (FMath::Abs(cell.X) > 1 || FMath::Abs(cell.Y) > 1 || FMath::Abs(cell.Z) > 1 || cell == FIntVector::ZeroValue)
+						continue;
+
+					const float pathCost = state.Cost + NavNeighborDistances[i];
+					const int32 pathFirstRank = state.Moves == 0 ? GetCanonicalRank(offset) : state.FirstRank;
+					if (cell == n)
+					{
+						// Equal costs imply the same kinds of moves, and so two moves, which are compared by their ranks
+						const bool shorter = pathCost < cost - KINDA_SMALL_NUMBER;
+						const bool canonicallyEarlier = FMath::Abs(pathCost - cost) <= KINDA_SMALL_NUMBER && state.Moves == 1 &&
+							(pathFirstRank < firstRank || (pathFirstRank == firstRank && GetCanonicalRank(offset) < secondRank));
+						if (shorter || canonicallyEarlier)
+						{
+							if (state.Mask == 0)
+								alwaysPruned = true;
+							else
+								masks.push_back(state.Mask);
+						}
+					}
+					else if (state.Moves < 2)
+					{
+						stack.push_back({ cell, pathCost, pathFirstRank, state.Moves + 1, state.Mask | GetBlockBit(cell.X, cell.Y, cell.Z) });
+					}
+				}
+			}
+
+			if (alwaysPruned)
+				return;
+
+			if (masks.empty())
+			{
+				Natural[min_shared_axes][move] |= 1u << next;
+				return;
+			}
+
+			// Keep the minimal masks, a path using a superset of another path's cells is free only if that one is
+			Forceable[min_shared_axes][move] |= 1u << next;
+			AlternativeBegin[min_shared_axes][move][next] = static_cast<int32>(AlternativeMasks.size());
+			for (const uint32 mask : masks)
+			{
+				bool redundant = false;
+				for (const uint32 other : masks)
+				{
+					if (other != mask && (other & mask) == other)
+						redundant = true;
+				}
+				if (redundant == false && std::find(AlternativeMasks.begin() + AlternativeBegin[min_shared_axes][move][next], AlternativeMasks.end(), mask) == AlternativeMasks.end())
+					AlternativeMasks.push_back(mask);
+			}
+			AlternativeEnd[min_shared_axes][move][next] = static_cast<int32>(AlternativeMasks.size());
+		}
+	};
+
+	const JumpRuleTable& GetJumpRuleTable()
+	{
+		static const JumpRuleTable table;
+		return table;
+	}
+
+	// Walks straight lines through the grid looking for jump points
+	struct Jumper
+	{
+		const NavGrid& Grid;
+		const NavOccupancy& Occupancy;
+		const JumpRuleTable& Rules;
+		NavSearchContext& Context;
+		int32 MinSharedAxes;
+		int32 EndIndex;
+
+		// Gets the moves that are forced at a cell reached by a move, because every shorter path to them is blocked
+		uint32 GetForcedMoves(const FIntVector& coordinates, int32 index, int32 direction) const
+		{
+			// Cells away from blocked cells never have forced moves
+			if (Occupancy.IsNearBlocked(index) == false)
+				return 0;
+
+			// Gather which cells of the surrounding block can't be walked through. Cells outside the grid count as blocked.
+			uint32 blocked = 0;
+			for (int32 i = 0; i < 26; ++i)
+			{
+				const NavNeighborOffset& offset = NavNeighborOffsets[i];
+				if (Grid.AreCoordinatesValid(FIntVector(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z)) == false ||
+					Occupancy.IsBlocked(index + Grid.GetNeighborIndexOffset(i)))
+				{
+					blocked |= GetBlockBit(offset.X, offset.Y, offset.Z);
+				}
+			}
+
+			uint32 forced = 0;
+			for (uint32 remaining = Rules.Forceable[MinSharedAxes][direction]; remaining != 0; remaining &= remaining - 1)
+			{
+				const int32 next = FMath::CountTrailingZeros(remaining);
+				const NavNeighborOffset& offset = NavNeighborOffsets[next];
+				if (blocked & GetBlockBit(offset.X, offset.Y, offset.Z))
+					continue;
+
+				bool allBlocked = true;
+				for (int32 i = Rules.AlternativeBegin[MinSharedAxes][direction][next]; i < Rules.AlternativeEnd[MinSharedAxes][direction][next] && allBlocked; ++i)
+				{
+					allBlocked = (Rules.AlternativeMasks[i] & blocked) != 0;
+				}
+
+				if (allBlocked)
+					forced |= 1u << next;
+			}
+			return forced;
+		}
+
+		/**
+		* Moves from a cell in a direction until a jump point is found or the way is blocked.
+		* @param	coordinates			The coordinates of the cell to start from
+		* @param	index				The flat index of the cell to start from
+		* @param	direction			The entry of NavNeighborOffsets to move along
+		* @param	out_steps			The number of moves made to reach the jump point
+		* @return	The flat index of the jump point, or INDEX_NONE
+		*/
+		int32 Jump(FIntVector coordinates, int32 index, int32 direction, int32& out_steps) const
+		{
+			const NavNeighborOffset& offset = NavNeighborOffsets[direction];
+			const int32 indexOffset = Grid.GetNeighborIndexOffset(direction);
+			const uint32 turns = Rules.Natural[MinSharedAxes][direction] & ~(1u << direction);
+			const int32 startIndex = index;
+
+			for (int32 steps = 1; ; ++steps)
+			{
+				// Lines already walked by this search without finding anything don't need walking again
+				if (Context.GetDeadEndMoves(index) & (1u << direction))
+					break;
+
+				coordinates = FIntVector(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z);
+				index += indexOffset;
+
+				if (Grid.AreCoordinatesValid(coordinates) == false || Occupancy.IsBlocked(index))
+					break;
+
+				if (index == EndIndex || GetForcedMoves(coordinates, index, direction) != 0)
+				{
+					out_steps = steps;
+					return index;
+				}
+
+				// Stop here if turning onto any natural successor would lead to a jump point
+				for (uint32 remaining = turns; remaining != 0; remaining &= remaining - 1)
+				{
+					int32 turnSteps = 0;
+					if (Jump(coordinates, index, FMath::CountTrailingZeros(remaining), turnSteps) != INDEX_NONE)
+					{
+						out_steps = steps;
+						return index;
+					}
+				}
+			}
+
+			// Every cell walked leads to no jump point in this direction either
+			for (int32 cell = startIndex; cell != index; cell += indexOffset)
+			{
+				Context.AddDeadEndMove(cell, direction);
+			}
+			return INDEX_NONE;
+		}
+	};
+
+	// Gets the sign of a value as -1, 0 or 1
+	FORCEINLINE int32 Sign(int32 value)
+	{
+		return (value > 0) - (value < 0);
+	}
+}
+
+bool NavJumpPointSearch::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path)
+{
+	NAV_TRACE_SCOPE(NavJumpPointSearch::FindPath);
+
+	out_path.clear();
+	context.Reset(grid.Num());
+
+	const int32 neighborCount = grid.GetNeighborCount();
+	const int32 minSharedAxes = neighborCount == 26 ? 0 : (neighborCount == 18 ? 1 : 2);
+	const uint32 allMoves = (1u << neighborCount) - 1;
+	const Jumper jumper = { grid, occupancy, GetJumpRuleTable(), context, minSharedAxes, end_index };
+
+	const FIntVector endCoordinates = grid.GetCoordinates(end_index);
+	auto h = [&endCoordinates](const FIntVector& coordinates)
+	{
+		return FVector::Distance(FVector(endCoordinates), FVector(coordinates));
+	};
+
+	context.Open(start_index, INDEX_NONE, 0.0f, h(grid.GetCoordinates(start_index)));
+
+	while (context.IsOpenEmpty() == false)
+	{
+		const int32 current = context.PopOpen();
+		const FIntVector currentCoordinates = grid.GetCoordinates(current);
+		const int32 parent = context.GetParent(current);
+
+		if (current == end_index)
+		{
+			// Rebuild the path from the end, filling in the cells skipped between jump points, then flip it
+			out_path.push_back(current);
+			for (int32 node = current; context.GetParent(node) != INDEX_NONE; node = context.GetParent(node))
+			{
+				const int32 nodeParent = context.GetParent(node);
+				const FIntVector nodeCoordinates = grid.GetCoordinates(node);
+				const FIntVector parentCoordinates = grid.GetCoordinates(nodeParent);
+				const int32 back = GetNavNeighborOffsetIndex(Sign(parentCoordinates.X - nodeCoordinates.X), Sign(parentCoordinates.Y - nodeCoordinates.Y), Sign(parentCoordinates.Z - nodeCoordinates.Z));
+				const int32 step = grid.GetNeighborIndexOffset(back);
+				for (int32 cell = node + step; ; cell += step)
+				{
+					out_path.push_back(cell);
+					if (cell == nodeParent)
+						break;
+				}
+			}
+			std::reverse(out_path.begin(), out_path.end());
+			return true;
+		}
+
+		// The start tries every move, other jump points their natural and forced successors
+		uint32 moves = allMoves;
+		if (parent != INDEX_NONE)
+		{
+			const FIntVector parentCoordinates = grid.GetCoordinates(parent);
+			const int32 direction = GetNavNeighborOffsetIndex(Sign(currentCoordinates.X - parentCoordinates.X), Sign(currentCoordinates.Y - parentCoordinates.Y), Sign(currentCoordinates.Z - parentCoordinates.Z));
+			moves = jumper.Rules.Natural[minSharedAxes][direction] | jumper.GetForcedMoves(currentCoordinates, current, direction);
+		}
+
+		const float currentGScore = context.GetGScore(current);
+		for (; moves != 0; moves &= moves - 1)
+		{
+			const int32 direction = FMath::CountTrailingZeros(moves);
+
+			int32 steps = 0;
+			const int32 jumpPoint = jumper.Jump(currentCoordinates, current, direction, steps);
+			if (jumpPoint == INDEX_NONE || context.IsClosed(jumpPoint))
+				continue;
+
+			const float tentative_gScore = currentGScore + (steps * NavNeighborDistances[direction]);
+			if (tentative_gScore < context.GetGScore(jumpPoint))
+			{
+				context.Open(jumpPoint, current, tentative_gScore, tentative_gScore + h(grid.GetCoordinates(jumpPoint)));
+			}
+		}
+	}
+
+	// Failed to find path
+	return false;
+}
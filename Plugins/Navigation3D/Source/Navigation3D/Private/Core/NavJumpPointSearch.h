@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+class NavSearchContext;
+
+/**
+* Jump Point Search over the uniform cost grid. Moves are ordered canonically (corners, then edges, then faces), so a cell
+* reached by a move only has to consider the moves that may follow it on a canonical shortest path (its natural successors),
+* plus any move made necessary because the shorter ways around the cell are blocked (its forced successors). Both are derived
+* once for every MinSharedNeighborAxes setting from the paths inside the 3x3x3 block around a cell. Straight runs of cells are
+* skipped by jumping until the goal, a cell with forced successors, or a cell from which a natural successor jump finds one of
+* those is reached. Only these jump points enter the open heap, and the paths found are as short as the ones found by A*.
+*/
+class NavJumpPointSearch
+{
+public:
+	/**
+	* Finds the shortest path between two cells.
+	* @param	grid				The grid to search
+	* @param	occupancy			The occupancy of the grid, including its near blocked bits
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	static bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, NavSearchContext& context, std::vector<int32>& out_path);
+};
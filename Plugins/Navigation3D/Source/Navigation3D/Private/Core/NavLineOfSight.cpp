@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavLineOfSight.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+
+bool NavLineOfSight::HasLineOfSight(const NavGrid& grid, const NavOccupancy& occupancy, int32 from_index, int32 to_index)
+{
+	return ForEachSegmentCell(grid, from_index, to_index, [&occupancy](int32 index) { return occupancy.IsBlocked(index) == false; });
+}
+
+void NavLineOfSight::SmoothPath(const NavGrid& grid, const NavOccupancy& occupancy, std::vector<int32>& path)
+{
+	NAV_TRACE_SCOPE(NavLineOfSight::SmoothPath);
+
+	const int32 count = static_cast<int32>(path.size());
+	if (count < 3)
+		return;
+
+	// The waypoints kept so far are written over the front of the path, the last one kept is the anchor
+	int32 keptCount = 1;
+	int32 anchor = path[0];
+
+	// The last turn seen from the anchor. The cells between two turns are a straight run of the same move.
+	int32 visible = anchor;
+
+	// Cells are read ahead of the waypoints written, but the previous one may already be overwritten. Moves are compared by
+	// coordinates, on narrow grids different moves can have the same flat index delta.
+	const int32 last = path[count - 1];
+	FIntVector previous = grid.GetCoordinates(anchor);
+	FIntVector current = grid.GetCoordinates(path[1]);
+
+	for (int32 i = 1; i < count; ++i)
+	{
+		const int32 cell = path[i];
+		const FIntVector next = i < count - 1 ? grid.GetCoordinates(path[i + 1]) : current;
+		const bool turns = i == count - 1 || current - previous != next - current;
+		previous = current;
+		current = next;
+		if (turns == false)
+			continue;
+
+		if (NavLineOfSight::HasLineOfSight(grid, occupancy, anchor, cell))
+		{
+			visible = cell;
+			continue;
+		}
+
+		// Keep the last turn that could be reached directly, then try again from it
+		if (visible != anchor)
+		{
+			anchor = visible;
+			path[keptCount++] = anchor;
+			if (NavLineOfSight::HasLineOfSight(grid, occupancy, anchor, cell))
+			{
+				visible = cell;
+				continue;
+			}
+		}
+
+		// Keep the straight run of the original path up to this turn
+		anchor = cell;
+		visible = cell;
+		path[keptCount++] = anchor;
+	}
+
+	if (anchor != last)
+	{
+		path[keptCount++] = last;
+	}
+	path.resize(keptCount);
+}
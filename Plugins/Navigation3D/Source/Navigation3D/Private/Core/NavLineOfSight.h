@@ -0,0 +1,128 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include "NavGrid.h"
+#include <vector>
+
+class NavOccupancy;
+
+/**
+* Line of sight tests between cell centers against the occupancy, walking the cells crossed by the segment with a 3D DDA
+* (Amanatides and Woo). Boundary crossings are compared with exact integer arithmetic, so the walk is the same in both
+* directions. Where the segment passes exactly through an edge or a corner, every cell touching it must be free, so an agent
+* following the segment never squeezes between two blocked cells.
+*/
+class NavLineOfSight
+{
+public:
+	/**
+	* Checks if the segment between the centers of two cells only crosses free cells. The first cell isn't tested.
+	* @param	grid				The grid the cells belong to
+	* @param	occupancy			The occupancy of the grid
+	* @param	from_index			The flat index of the cell the segment starts at
+	* @param	to_index			The flat index of the cell the segment ends at
+	* @return	Whether every cell crossed after the first is free
+	*/
+	static bool HasLineOfSight(const NavGrid& grid, const NavOccupancy& occupancy, int32 from_index, int32 to_index);
+
+	/**
+	* Removes the waypoints of a path that can be skipped by walking straight from an earlier waypoint (string pulling).
+	* Only the cells where the path turns are tested, so the cost grows with the number of turns rather than the number of cells.
+	* Every segment of the result either has line of sight or is a straight run of moves of the original path.
+	* @param	grid				The grid the path was found on
+	* @param	occupancy			The occupancy of the grid
+	* @param	path				The flat index of every waypoint along the path, including the start and the end, shortened in place
+	*/
+	static void SmoothPath(const NavGrid& grid, const NavOccupancy& occupancy, std::vector<int32>& path);
+
+	/**
+	* Calls a function with the flat index of every cell crossed by the segment between the centers of two cells, from the start
+	* towards the end, including every cell touching an edge or a corner it passes through. The first cell is skipped.
+	* @param	grid				The grid the cells belong to
+	* @param	from_index			The flat index of the cell the segment starts at
+	* @param	to_index			The flat index of the cell the segment ends at
+	* @param	func				Called as func(int32 cell_index), returning false to stop the walk
+	* @return	Whether the walk reached the end without being stopped
+	*/
+	template<typename FuncType>
+	static bool ForEachSegmentCell(const NavGrid& grid, int32 from_index, int32 to_index, FuncType&& func)
+	{
+		const FIntVector from = grid.GetCoordinates(from_index);
+		const FIntVector to = grid.GetCoordinates(to_index);
+		const FIntVector& divisions = grid.GetDivisions();
+
+		// The segment crosses the k-th cell boundary along an axis at t = (2k - 1) / (2 * length), so crossings along two axes are
+		// ordered by comparing (2 * crossed + 1) * other_length between them, without any rounding
+		const int32 deltas[3] = { to.X - from.X, to.Y - from.Y, to.Z - from.Z };
+		const int32 strides[3] = { 1, divisions.X, divisions.X * divisions.Y };
+		int64 lengths[3];
+		int32 indexSteps[3];
+		int64 crossed[3] = { 0, 0, 0 };
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			lengths[axis] = FMath::Abs(deltas[axis]);
+			indexSteps[axis] = deltas[axis] < 0 ? -strides[axis] : strides[axis];
+		}
+
+		int32 index = from_index;
+		while (true)
+		{
+			// Find the axes whose next boundary is crossed first
+			int32 nextAxis = INDEX_NONE;
+			uint32 tiedAxes = 0;
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				if (crossed[axis] == lengths[axis])
+					continue;
+
+				if (nextAxis == INDEX_NONE)
+				{
+					nextAxis = axis;
+					tiedAxes = 1u << axis;
+					continue;
+				}
+
+				const int64 time = ((2 * crossed[axis]) + 1) * lengths[nextAxis];
+				const int64 nextTime = ((2 * crossed[nextAxis]) + 1) * lengths[axis];
+				if (time < nextTime)
+				{
+					nextAxis = axis;
+					tiedAxes = 1u << axis;
+				}
+				else if (time == nextTime)
+				{
+					tiedAxes |= 1u << axis;
+				}
+			}
+
+			if (nextAxis == INDEX_NONE)
+				return true;
+
+			// Through an edge or a corner, visit every cell around it: each combination of the steps along the tied axes
+			for (uint32 steps = tiedAxes; steps != 0; steps = (steps - 1) & tiedAxes)
+			{
+				int32 cell = index;
+				for (int32 axis = 0; axis < 3; ++axis)
+				{
+					if (steps & (1u << axis))
+					{
+						cell += indexSteps[axis];
+					}
+				}
+				if (func(cell) == false)
+					return false;
+			}
+
+			for (int32 axis = 0; axis < 3; ++axis)
+			{
+				if (tiedAxes & (1u << axis))
+				{
+					index += indexSteps[axis];
+					++crossed[axis];
+				}
+			}
+		}
+	}
+};
@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavOccupancy.h"
+#include "NavGrid.h"
+
+void NavOccupancy::Init(int32 cell_count)
+{
+	CellCount = FMath::Max(cell_count, 0);
+	Words.assign((CellCount + 31) / 32, 0u);
+	NearBlockedWords.assign(Words.size(), 0u);
+}
+
+void NavOccupancy::Reset()
+{
+	Words.clear();
+	Words.shrink_to_fit();
+	NearBlockedWords.clear();
+	NearBlockedWords.shrink_to_fit();
+	CellCount = 0;
+}
+
+void NavOccupancy::SetBlocked(int32 index, bool blocked)
+{
+	const uint32 mask = 1u << (index & 31);
+	if (blocked)
+		Words[index >> 5] |= mask;
+	else
+		Words[index >> 5] &= ~mask;
+}
+
+void NavOccupancy::SetBlockedRange(int32 first_index, int32 count)
+{
+	int32 index = first_index;
+	const int32 end = first_index + count;
+	while (index < end)
+	{
+		// Fill up to the end of the current word, or the end of the range if it comes first
+		const int32 bit = index & 31;
+		const int32 bitCount = FMath::Min(32 - bit, end - index);
+		const uint32 mask = bitCount == 32 ? ~0u : ((1u << bitCount) - 1u) << bit;
+		Words[index >> 5] |= mask;
+		index += bitCount;
+	}
+}
+
+void NavOccupancy::BuildNearBlocked(const NavGrid& grid)
+{
+	NAV_TRACE_SCOPE(NavOccupancy::BuildNearBlocked);
+
+	std::fill(NearBlockedWords.begin(), NearBlockedWords.end(), 0u);
+
+	// Spread each blocked cell to its neighbors
+	for (int32 index = 0; index < CellCount; ++index)
+	{
+		if (IsBlocked(index) == false)
+			continue;
+
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		for (int32 i = 0; i < 26; ++i)
+		{
+			const NavNeighborOffset& offset = NavNeighborOffsets[i];
+			if (grid.AreCoordinatesValid(FIntVector(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z)))
+			{
+				const int32 neighbor = index + grid.GetNeighborIndexOffset(i);
+				NearBlockedWords[neighbor >> 5] |= 1u << (neighbor & 31);
+			}
+		}
+	}
+}
+
+void NavOccupancy::UpdateNearBlocked(const NavGrid& grid, int32 index)
+{
+	const FIntVector coordinates = grid.GetCoordinates(index);
+
+	// The cell's own bit can't change, only the bits of the cells it's a neighbor of
+	for (int32 i = 0; i < 26; ++i)
+	{
+		const NavNeighborOffset& offset = NavNeighborOffsets[i];
+		const FIntVector cellCoordinates(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z);
+		if (grid.AreCoordinatesValid(cellCoordinates) == false)
+			continue;
+
+		const int32 cell = index + grid.GetNeighborIndexOffset(i);
+		bool nearBlocked = false;
+		for (int32 j = 0; j < 26 && nearBlocked == false; ++j)
+		{
+			const NavNeighborOffset& neighborOffset = NavNeighborOffsets[j];
+			if (grid.AreCoordinatesValid(FIntVector(cellCoordinates.X + neighborOffset.X, cellCoordinates.Y + neighborOffset.Y, cellCoordinates.Z + neighborOffset.Z)))
+			{
+				nearBlocked = IsBlocked(cell + grid.GetNeighborIndexOffset(j));
+			}
+		}
+
+		if (nearBlocked)
+			NearBlockedWords[cell >> 5] |= 1u << (cell & 31);
+		else
+			NearBlockedWords[cell >> 5] &= ~(1u << (cell & 31));
+	}
+}
+
+void NavOccupancy::GetChangedCells(const NavOccupancy& other, std::vector<int32>& out_cells) const
+{
+	out_cells.clear();
+	if (other.CellCount != CellCount)
+		return;
+
+	// Compare a word at a time, only looking at the bits of the words that differ
+	for (int32 word = 0; word < static_cast<int32>(Words.size()); ++word)
+	{
+		for (uint32 changed = Words[word] ^ other.Words[word]; changed != 0; changed &= changed - 1)
+		{
+			out_cells.push_back((word << 5) + static_cast<int32>(FMath::CountTrailingZeros(changed)));
+		}
+	}
+}
+
+int32 NavOccupancy::FindNearestFreeCell(const NavGrid& grid, int32 index, int32 max_distance) const
+{
+	if (IsBlocked(index) == false)
+		return index;
+
+	// The cells of the shell at Chebyshev distance r are at least r away, so once a free cell closer than that is found the search is over
+	const FIntVector center = grid.GetCoordinates(index);
+	const int32 maxDistanceSq = max_distance * max_distance;
+	int32 bestIndex = INDEX_NONE;
+	int32 bestDistanceSq = maxDistanceSq + 1;
+	for (int32 radius = 1; radius <= max_distance && radius * radius < bestDistanceSq; ++radius)
+	{
+		for (int32 z = -radius; z <= radius; ++z)
+		{
+			for (int32 y = -radius; y <= radius; ++y)
+			{
+				// Inside the shell only the two cells at either end of the row are on it
+				const bool fullRow = FMath::Abs(z) == radius || FMath::Abs(y) == radius;
+				for (int32 x = -radius; x <= radius; x += fullRow ? 1 : 2 * radius)
+				{
+					const FIntVector coordinates(center.X + x, center.Y + y, center.Z + z);
+					const int32 distanceSq = (x * x) + (y * y) + (z * z);
+					if (distanceSq >= bestDistanceSq || grid.AreCoordinatesValid(coordinates) == false)
+						continue;
+
+					const int32 cell = grid.GetIndex(coordinates);
+					if (IsBlocked(cell) == false)
+					{
+						bestIndex = cell;
+						bestDistanceSq = distanceSq;
+					}
+				}
+			}
+		}
+	}
+	return bestIndex;
+}
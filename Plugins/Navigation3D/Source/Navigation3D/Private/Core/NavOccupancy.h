@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+
+// A packed bitfield storing one bit per grid cell. A set bit means the cell is blocked.
+// A second bitfield marks the cells that have a blocked cell among their 26 neighbors.
+class NavOccupancy
+{
+public:
+	// Resizes the bitfield to hold the specified number of cells and marks every cell as free
+	void Init(int32 cell_count);
+
+	// Releases the bitfield memory
+	void Reset();
+
+	// Marks the cell at the specified flat index as blocked or free
+	void SetBlocked(int32 index, bool blocked);
+
+	// Checks if the cell at the specified flat index is blocked
+	FORCEINLINE bool IsBlocked(int32 index) const
+	{
+		return (Words[index >> 5] >> (index & 31)) & 1u;
+	}
+
+	// Checks if any of the 26 neighbors of the cell at the specified flat index is blocked
+	FORCEINLINE bool IsNearBlocked(int32 index) const
+	{
+		return (NearBlockedWords[index >> 5] >> (index & 31)) & 1u;
+	}
+
+	// Marks a run of consecutive cells as blocked, a word at a time
+	void SetBlockedRange(int32 first_index, int32 count);
+
+	// Gets the packed occupancy bits, 32 cells per word with the unused bits of the last word cleared
+	FORCEINLINE const uint32* GetWords() const { return Words.data(); }
+
+	// Gets the packed occupancy bits to fill them in bulk. The near blocked bits must be rebuilt afterwards.
+	FORCEINLINE uint32* GetMutableWords() { return Words.data(); }
+
+	// Gets the number of words of the packed occupancy bits
+	FORCEINLINE int32 GetWordCount() const { return static_cast<int32>(Words.size()); }
+
+	// Recomputes the near blocked bits of every cell
+	void BuildNearBlocked(const NavGrid& grid);
+
+	// Recomputes the near blocked bits of a cell whose occupancy changed and of its neighbors
+	void UpdateNearBlocked(const NavGrid& grid, int32 index);
+
+	// Gets the flat index of every cell whose occupancy differs from another bitfield of the same size, in increasing order
+	void GetChangedCells(const NavOccupancy& other, std::vector<int32>& out_cells) const;
+
+	/**
+	* Finds the free cell whose center is closest to the center of a cell, searching shells of cells around it.
+	* @param	grid				The grid the bitfield covers
+	* @param	index				The flat index of the cell to search around, returned if it's free
+	* @param	max_distance		The largest distance searched, in cells
+	* @return	The flat index of the closest free cell, or INDEX_NONE if every cell within max_distance is blocked
+	*/
+	int32 FindNearestFreeCell(const NavGrid& grid, int32 index, int32 max_distance) const;
+
+	// Gets the number of cells stored in the bitfield
+	FORCEINLINE int32 Num() const { return CellCount; }
+
+	// Checks if the bitfield has been initialized
+	FORCEINLINE bool IsValid() const { return CellCount > 0; }
+
+	// Gets the number of bytes used by the bitfields
+	FORCEINLINE SIZE_T GetAllocatedSize() const { return (Words.capacity() + NearBlockedWords.capacity()) * sizeof(uint32); }
+
+private:
+	// The packed occupancy bits, 32 cells per word
+	std::vector<uint32> Words;
+
+	// The packed near blocked bits, 32 cells per word
+	std::vector<uint32> NearBlockedWords;
+
+	// The number of cells stored in the bitfield
+	int32 CellCount = 0;
+};
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavPathCache.h"
+#include "NavGrid.h"
+#include "NavLineOfSight.h"
+#include <algorithm>
+#include <cstdint>
+
+void NavPathCache::SetCapacity(int32 capacity)
+{
+	Capacity = FMath::Max(capacity, 0);
+	Trim();
+}
+
+ENavPathCacheResult NavPathCache::Find(const NavGrid& grid, int32 start_index, int32 end_index, uint32 profile, bool reuse_tails, std::vector<int32>& out_path)
+{
+	const std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator found = EntryMap.find(Key{ start_index, end_index, profile });
+	if (found != EntryMap.end())
+	{
+		Entries.splice(Entries.begin(), Entries, found->second);
+		out_path = found->second->Path;
+		++HitNum;
+		return ENavPathCacheResult::Hit;
+	}
+
+	if (reuse_tails)
+	{
+		// Find the path to the same end with the fewest waypoints left after a waypoint the start is on or next to
+		const FIntVector startCoordinates = grid.GetCoordinates(start_index);
+		std::list<Entry>::iterator bestEntry = Entries.end();
+		size_t bestWaypoint = 0;
+		size_t bestRemaining = SIZE_MAX;
+		for (std::list<Entry>::iterator entry = Entries.begin(); entry != Entries.end(); ++entry)
+		{
+			if (entry->EntryKey.End != end_index || entry->EntryKey.Profile != profile)
+				continue;
+
+			// Search from the end, the first waypoint found leaves the least of the path
+			const std::vector<int32>& path = entry->Path;
+			for (size_t waypoint = path.size(); waypoint-- > 0 && path.size() - waypoint < bestRemaining;)
+			{
+				const FIntVector coordinates = grid.GetCoordinates(path[waypoint]);
+				if (coordinates == startCoordinates || grid.AreNeighbors(startCoordinates, coordinates))
+				{
+					bestEntry = entry;
+					bestWaypoint = waypoint;
+					bestRemaining = path.size() - waypoint;
+					break;
+				}
+			}
+		}
+
+		if (bestEntry != Entries.end())
+		{
+			Entries.splice(Entries.begin(), Entries, bestEntry);
+			const std::vector<int32>& path = bestEntry->Path;
+			out_path.clear();
+			if (path[bestWaypoint] != start_index)
+			{
+				out_path.push_back(start_index);
+			}
+			out_path.insert(out_path.end(), path.begin() + bestWaypoint, path.end());
+			++TailHitNum;
+			return ENavPathCacheResult::TailHit;
+		}
+	}
+
+	++MissNum;
+	return ENavPathCacheResult::Miss;
+}
+
+void NavPathCache::Add(const NavGrid& grid, int32 start_index, int32 end_index, uint32 profile, const std::vector<int32>& path, uint32 version)
+{
+	// A search that read the occupancy before the last invalidation may have gone through a cell that changed since
+	if (Capacity == 0 || version != Version || path.empty())
+		return;
+
+	const Key key{ start_index, end_index, profile };
+	const std::unordered_map<Key, std::list<Entry>::iterator, KeyHash>::iterator found = EntryMap.find(key);
+	if (found != EntryMap.end())
+	{
+		Entries.splice(Entries.begin(), Entries, found->second);
+	}
+	else
+	{
+		Entries.push_front(Entry());
+		Entries.front().EntryKey = key;
+		EntryMap.emplace(key, Entries.begin());
+	}
+
+	Entry& entry = Entries.front();
+	entry.Path = path;
+
+	// Moves between neighbors only depend on the cell moved to, longer segments on every cell they cross
+	entry.Cells.clear();
+	entry.Cells.push_back(path[0]);
+	for (size_t i = 1; i < path.size(); ++i)
+	{
+		if (grid.AreNeighbors(grid.GetCoordinates(path[i - 1]), grid.GetCoordinates(path[i])))
+		{
+			entry.Cells.push_back(path[i]);
+			continue;
+		}
+
+		NavLineOfSight::ForEachSegmentCell(grid, path[i - 1], path[i], [&entry](int32 cell)
+		{
+			entry.Cells.push_back(cell);
+			return true;
+		});
+	}
+	std::sort(entry.Cells.begin(), entry.Cells.end());
+	entry.Cells.erase(std::unique(entry.Cells.begin(), entry.Cells.end()), entry.Cells.end());
+
+	Trim();
+}
+
+void NavPathCache::Invalidate(const std::vector<int32>& changed_cells)
+{
+	++Version;
+	if (changed_cells.empty())
+		return;
+
+	std::vector<int32> changed = changed_cells;
+	std::sort(changed.begin(), changed.end());
+
+	for (std::list<Entry>::iterator entry = Entries.begin(); entry != Entries.end();)
+	{
+		// Look the smaller of the two sorted lists up in the other
+		const std::vector<int32>& small = entry->Cells.size() < changed.size() ? entry->Cells : changed;
+		const std::vector<int32>& large = entry->Cells.size() < changed.size() ? changed : entry->Cells;
+		const bool affected = std::any_of(small.begin(), small.end(), [&large](int32 cell) { return std::binary_search(large.begin(), large.end(), cell); });
+		if (affected)
+		{
+			EntryMap.erase(entry->EntryKey);
+			entry = Entries.erase(entry);
+			++InvalidatedNum;
+		}
+		else
+		{
+			++entry;
+		}
+	}
+}
+
+void NavPathCache::Clear()
+{
+	++Version;
+	Entries.clear();
+	EntryMap.clear();
+}
+
+void NavPathCache::ResetStats()
+{
+	HitNum = 0;
+	TailHitNum = 0;
+	MissNum = 0;
+	InvalidatedNum = 0;
+	EvictedNum = 0;
+}
+
+SIZE_T NavPathCache::GetAllocatedSize() const
+{
+	SIZE_T size = EntryMap.bucket_count() * sizeof(void*);
+	for (const Entry& entry : Entries)
+	{
+		size += sizeof(Entry) + ((entry.Path.capacity() + entry.Cells.capacity()) * sizeof(int32)) + sizeof(std::pair<Key, std::list<Entry>::iterator>);
+	}
+	return size;
+}
+
+void NavPathCache::Trim()
+{
+	while (static_cast<int32>(Entries.size()) > Capacity)
+	{
+		EntryMap.erase(Entries.back().EntryKey);
+		Entries.pop_back();
+		++EvictedNum;
+	}
+}
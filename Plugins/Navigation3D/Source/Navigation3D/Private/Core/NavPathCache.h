@@ -0,0 +1,146 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+class NavGrid;
+
+// How a path was answered by the path cache
+enum class ENavPathCacheResult : uint8
+{
+	// No usable path was cached
+	Miss,
+
+	// A path was cached for the same start, end and profile
+	Hit,
+
+	// A path to the same end with the same profile passes next to the start, and was reused from there
+	TailHit
+};
+
+/**
+* A bounded cache of the paths found between pairs of cells, so agents asking for the same path again, such as a swarm
+* heading to the same cell, skip the search. Paths are keyed by their start cell, end cell and a profile identifying the
+* settings of the search that found them, and the least recently used paths are evicted first. Each path remembers every
+* cell it depends on, including the cells crossed between distant waypoints, and is dropped as soon as one of them changes.
+* Paths that got shorter because cells were freed elsewhere are kept. The cache isn't thread safe.
+*/
+class NavPathCache
+{
+public:
+	// Sets the maximum number of paths kept, evicting the least recently used ones above it. Zero disables the cache.
+	void SetCapacity(int32 capacity);
+
+	// Gets the maximum number of paths kept
+	FORCEINLINE int32 GetCapacity() const { return Capacity; }
+
+	// Gets the number of paths cached
+	FORCEINLINE int32 Num() const { return static_cast<int32>(Entries.size()); }
+
+	/**
+	* Looks up the path between two cells, counting the hit or miss.
+	* @param	grid				The grid the paths were found on
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	profile				Identifies the settings of the search
+	* @param	reuse_tails			Whether a path to the same end passing next to the start (a neighbor as allowed by the grid)
+	*								may be reused from there, which is faster but not always as short as searching
+	* @param	out_path			The flat index of every waypoint along the cached path, including the start and the end
+	* @return	How the path was answered, out_path is only written on hits
+	*/
+	ENavPathCacheResult Find(const NavGrid& grid, int32 start_index, int32 end_index, uint32 profile, bool reuse_tails, std::vector<int32>& out_path);
+
+	/**
+	* Caches a path found by a search, unless the cache was invalidated since the search read the occupancy.
+	* @param	grid				The grid the path was found on
+	* @param	start_index			The flat index of the cell the path starts at
+	* @param	end_index			The flat index of the cell the path ends at
+	* @param	profile				Identifies the settings of the search
+	* @param	path				The flat index of every waypoint along the path, including the start and the end
+	* @param	version				The version of the cache when the search read the occupancy
+	*/
+	void Add(const NavGrid& grid, int32 start_index, int32 end_index, uint32 profile, const std::vector<int32>& path, uint32 version);
+
+	// Drops every path depending on one of the changed cells, and starts a new version
+	void Invalidate(const std::vector<int32>& changed_cells);
+
+	// Drops every path, and starts a new version
+	void Clear();
+
+	// Gets the version of the cache, which changes every time paths are invalidated. Read it along with the occupancy searched.
+	FORCEINLINE uint32 GetVersion() const { return Version; }
+
+	// Gets the number of lookups answered with a cached path for the same cells
+	FORCEINLINE uint64 GetHitNum() const { return HitNum; }
+
+	// Gets the number of lookups answered with the tail of a cached path
+	FORCEINLINE uint64 GetTailHitNum() const { return TailHitNum; }
+
+	// Gets the number of lookups that found no usable path
+	FORCEINLINE uint64 GetMissNum() const { return MissNum; }
+
+	// Gets the number of paths dropped because a cell they depend on changed
+	FORCEINLINE uint64 GetInvalidatedNum() const { return InvalidatedNum; }
+
+	// Gets the number of paths evicted to stay within the capacity
+	FORCEINLINE uint64 GetEvictedNum() const { return EvictedNum; }
+
+	// Forgets the hit, miss, invalidation and eviction counts
+	void ResetStats();
+
+	// Gets the number of bytes used by the cached paths
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// The cells and search settings a path was found for
+	struct Key
+	{
+		int32 Start;
+		int32 End;
+		uint32 Profile;
+
+		FORCEINLINE bool operator==(const Key& other) const { return Start == other.Start && End == other.End && Profile == other.Profile; }
+	};
+
+	struct KeyHash
+	{
+		FORCEINLINE size_t operator()(const Key& key) const
+		{
+			return std::hash<uint64>()((static_cast<uint64>(static_cast<uint32>(key.Start)) << 32) | static_cast<uint32>(key.End)) ^ (static_cast<size_t>(key.Profile) * 0x9E3779B97F4A7C15ull);
+		}
+	};
+
+	struct Entry
+	{
+		Key EntryKey;
+
+		// The waypoints of the path
+		std::vector<int32> Path;
+
+		// Every cell the path goes through, sorted
+		std::vector<int32> Cells;
+	};
+
+	// Helper function evicting the least recently used paths above the capacity
+	void Trim();
+
+	// The cached paths, the most recently used first
+	std::list<Entry> Entries;
+
+	// The position of each cached path in Entries
+	std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> EntryMap;
+
+	// The maximum number of paths kept
+	int32 Capacity = 0;
+
+	uint32 Version = 0;
+	uint64 HitNum = 0;
+	uint64 TailHitNum = 0;
+	uint64 MissNum = 0;
+	uint64 InvalidatedNum = 0;
+	uint64 EvictedNum = 0;
+};
@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavPortalGraph.h"
+#include <algorithm>
+#include <queue>
+
+void NavPortalGraph::AddPortal(int32 volume_a, int32 cell_a, const FVector& location_a, int32 volume_b, int32 cell_b, const FVector& location_b)
+{
+	VolumeEnds[volume_a].push_back(static_cast<int32>(Ends.size()));
+	Ends.push_back(End{ volume_a, cell_a, location_a });
+	VolumeEnds[volume_b].push_back(static_cast<int32>(Ends.size()));
+	Ends.push_back(End{ volume_b, cell_b, location_b });
+}
+
+void NavPortalGraph::RemoveVolume(int32 volume)
+{
+	if (VolumeEnds.count(volume) == 0)
+		return;
+
+	// Keep the pairs that don't touch the volume, then index the ends again
+	std::vector<End> ends;
+	ends.reserve(Ends.size());
+	for (size_t i = 0; i < Ends.size(); i += 2)
+	{
+		if (Ends[i].Volume != volume && Ends[i + 1].Volume != volume)
+		{
+			ends.push_back(Ends[i]);
+			ends.push_back(Ends[i + 1]);
+		}
+	}
+	Ends.swap(ends);
+
+	VolumeEnds.clear();
+	for (int32 i = 0; i < static_cast<int32>(Ends.size()); ++i)
+	{
+		VolumeEnds[Ends[i].Volume].push_back(i);
+	}
+}
+
+int32 NavPortalGraph::GetPortalNum(int32 volume) const
+{
+	const auto volumeEnds = VolumeEnds.find(volume);
+	return volumeEnds != VolumeEnds.end() ? static_cast<int32>(volumeEnds->second.size()) : 0;
+}
+
+bool NavPortalGraph::FindRoute(int32 start_volume, int32 start_cell, const FVector& start_location, int32 goal_volume, int32 goal_cell, const FVector& goal_location,
+	const SegmentFuncType& find_segment, std::vector<NavRouteSegment>& out_route) const
+{
+	NAV_TRACE_SCOPE(NavPortalGraph::FindRoute);
+
+	out_route.clear();
+	LastSegmentSearchNum = 0;
+
+	// The portal ends, then the start and the goal
+	const int32 endCount = static_cast<int32>(Ends.size());
+	const int32 startNode = endCount;
+	const int32 goalNode = endCount + 1;
+	auto getVolume = [&](int32 node) { return node < endCount ? Ends[node].Volume : (node == startNode ? start_volume : goal_volume); };
+	auto getCell = [&](int32 node) { return node < endCount ? Ends[node].Cell : (node == startNode ? start_cell : goal_cell); };
+	auto getLocation = [&](int32 node) -> const FVector& { return node < endCount ? Ends[node].Location : (node == startNode ? start_location : goal_location); };
+
+	// An entry reaching a node from its parent. Moves inside a volume enter the heap with the straight line distance and are
+	// searched once they reach the top, then enter again with their real length.
+	struct Entry
+	{
+		float FScore;
+		float GScore;
+		int32 Node;
+		int32 Parent;
+		bool bExact;
+
+		bool operator>(const Entry& other) const { return FScore > other.FScore; }
+	};
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+	std::vector<int32> parents(endCount + 2, INDEX_NONE);
+	std::vector<float> gScores(endCount + 2, FLT_MAX);
+	std::vector<bool> closed(endCount + 2, false);
+
+	auto h = [&](int32 node) { return FVector::Distance(getLocation(node), goal_location); };
+	open.push(Entry{ h(startNode), 0.0f, startNode, INDEX_NONE, true });
+
+	while (open.empty() == false)
+	{
+		const Entry entry = open.top();
+		open.pop();
+		if (closed[entry.Node])
+			continue;
+
+		if (entry.bExact == false)
+		{
+			// Search the path inside the volume now that it may be part of the best route
+			++LastSegmentSearchNum;
+			const float cost = find_segment(getVolume(entry.Node), getCell(entry.Parent), getCell(entry.Node));
+			if (cost >= 0.0f)
+			{
+				const float gScore = gScores[entry.Parent] + cost;
+				open.push(Entry{ gScore + h(entry.Node), gScore, entry.Node, entry.Parent, true });
+			}
+			continue;
+		}
+
+		closed[entry.Node] = true;
+		parents[entry.Node] = entry.Parent;
+		gScores[entry.Node] = entry.GScore;
+		if (entry.Node == goalNode)
+			break;
+
+		// Cross the portal into the other volume
+		if (entry.Node < endCount)
+		{
+			const int32 other = entry.Node ^ 1;
+			if (closed[other] == false)
+			{
+				const float gScore = entry.GScore + FVector::Distance(Ends[entry.Node].Location, Ends[other].Location);
+				open.push(Entry{ gScore + h(other), gScore, other, entry.Node, true });
+			}
+		}
+
+		// Move to the other portals of the same volume, or to the goal
+		const int32 volume = getVolume(entry.Node);
+		auto addMove = [&](int32 node)
+		{
+			if (node != entry.Node && closed[node] == false)
+			{
+				const float gScore = entry.GScore + FVector::Distance(getLocation(entry.Node), getLocation(node));
+				open.push(Entry{ gScore + h(node), gScore, node, entry.Node, false });
+			}
+		};
+
+		const auto volumeEnds = VolumeEnds.find(volume);
+		if (volumeEnds != VolumeEnds.end())
+		{
+			for (const int32 end : volumeEnds->second)
+			{
+				addMove(end);
+			}
+		}
+		if (volume == goal_volume)
+		{
+			addMove(goalNode);
+		}
+	}
+
+	if (closed[goalNode] == false)
+		return false;
+
+	// Walk back from the goal, keeping the moves inside a volume and skipping the portal crossings
+	for (int32 node = goalNode; parents[node] != INDEX_NONE; node = parents[node])
+	{
+		const int32 parent = parents[node];
+		const bool crossing = node < endCount && parent == (node ^ 1);
+		if (crossing)
+			continue;
+
+		// Moves through a portal without crossing it are joined, the path searched between their ends is no longer
+		NavRouteSegment segment{ getVolume(node), getCell(parent), getCell(node) };
+		if (out_route.empty() == false && out_route.back().Volume == segment.Volume && out_route.back().FromCell == segment.ToCell)
+		{
+			out_route.back().FromCell = segment.FromCell;
+			continue;
+		}
+		out_route.push_back(segment);
+	}
+	std::reverse(out_route.begin(), out_route.end());
+	return true;
+}
+
+SIZE_T NavPortalGraph::GetAllocatedSize() const
+{
+	SIZE_T size = Ends.capacity() * sizeof(End);
+	for (const auto& volumeEnds : VolumeEnds)
+	{
+		size += sizeof(volumeEnds) + (volumeEnds.second.capacity() * sizeof(int32));
+	}
+	return size;
+}
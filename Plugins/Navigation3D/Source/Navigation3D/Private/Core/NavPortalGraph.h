@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// A step of a route through several volumes, a path to search inside a single volume
+struct NavRouteSegment
+{
+	// The id of the volume to search in
+	int32 Volume;
+
+	// The flat index of the cell to start from, in the volume's grid
+	int32 FromCell;
+
+	// The flat index of the cell to reach, in the volume's grid
+	int32 ToCell;
+};
+
+/**
+* The portals linking the grids of separate volumes, where a cell on the border of one volume faces a cell of another, and
+* the routing of queries across them. Routes are found with A* over the portals, using the straight line distance between two
+* portals of the same volume as a lower bound of the path between them. The actual path is only searched, with find_segment,
+* when a route reaches the portal through it, and the portal is put back with the real cost (lazy A*), so only the segments
+* the best route may take are searched. Locations are in world space and costs in world units, volumes are identified by the
+* ids they're added with. Not thread safe.
+*/
+class NavPortalGraph
+{
+public:
+	// Finds a path inside a volume between two of its cells, returning its length in world units, or a negative value if there is none
+	using SegmentFuncType = std::function<float(int32 volume, int32 from_cell, int32 to_cell)>;
+
+	/**
+	* Links a cell of a volume with a cell of another, both ways.
+	* @param	volume_a			The id of the first volume
+	* @param	cell_a				The flat index of the cell in the first volume's grid
+	* @param	location_a			The world space center of the cell in the first volume
+	* @param	volume_b			The id of the second volume
+	* @param	cell_b				The flat index of the cell in the second volume's grid
+	* @param	location_b			The world space center of the cell in the second volume
+	*/
+	void AddPortal(int32 volume_a, int32 cell_a, const FVector& location_a, int32 volume_b, int32 cell_b, const FVector& location_b);
+
+	// Removes every portal of a volume, when it's unloaded or rebuilt
+	void RemoveVolume(int32 volume);
+
+	// Gets the number of portals
+	FORCEINLINE int32 GetPortalNum() const { return static_cast<int32>(Ends.size() / 2); }
+
+	// Gets the number of portals of a volume
+	int32 GetPortalNum(int32 volume) const;
+
+	/**
+	* Finds the shortest route between cells of two volumes through the portals.
+	* @param	start_volume		The id of the volume to start from
+	* @param	start_cell			The flat index of the cell to start from
+	* @param	start_location		The world space center of the cell to start from
+	* @param	goal_volume			The id of the volume to reach
+	* @param	goal_cell			The flat index of the cell to reach
+	* @param	goal_location		The world space center of the cell to reach
+	* @param	find_segment		Searches a path inside a volume, called at most once for each pair of cells
+	* @param	out_route			The paths to search in each volume along the route, in order. A portal is crossed between each segment and the next.
+	* @return	Whether a route was found
+	*/
+	bool FindRoute(int32 start_volume, int32 start_cell, const FVector& start_location, int32 goal_volume, int32 goal_cell, const FVector& goal_location,
+		const SegmentFuncType& find_segment, std::vector<NavRouteSegment>& out_route) const;
+
+	// Gets the number of segments searched by the last query
+	FORCEINLINE int32 GetLastSegmentSearchNum() const { return LastSegmentSearchNum; }
+
+	// Gets the number of bytes used by the portals
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// One side of a portal, stored next to the other side so the other side of end i is end i ^ 1
+	struct End
+	{
+		int32 Volume;
+		int32 Cell;
+		FVector Location;
+	};
+
+	// The ends of every portal, in pairs
+	std::vector<End> Ends;
+
+	// The ends in each volume, by volume id
+	std::unordered_map<int32, std::vector<int32> > VolumeEnds;
+
+	mutable int32 LastSegmentSearchNum = 0;
+};
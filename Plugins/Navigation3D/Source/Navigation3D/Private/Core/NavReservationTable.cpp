@@ -0,0 +1,15 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavReservationTable.h"
+
+bool NavReservationTable::Reserve(int32 cell, int32 time, int32 agent)
+{
+	const auto result = Reservations.emplace(GetKey(cell, time), agent);
+	return result.second || result.first->second == agent;
+}
+
+SIZE_T NavReservationTable::GetAllocatedSize() const
+{
+	return (Reservations.size() * (sizeof(std::pair<const uint64, int32>) + sizeof(void*))) + (Reservations.bucket_count() * sizeof(void*));
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <unordered_map>
+
+/**
+* The cells agents planned to be in at each time step, so agents planned afterwards avoid them. Only the reserved (cell, time)
+* pairs are stored, in a hash table, so its size follows the number of agents and the length of their plans rather than the
+* size of the grid. Two agents can't hold the same cell at the same time, nor swap cells between two time steps. Not thread safe.
+*/
+class NavReservationTable
+{
+public:
+	// Drops every reservation
+	FORCEINLINE void Reset() { Reservations.clear(); }
+
+	/**
+	* Reserves a cell at a time step for an agent.
+	* @param	cell				The flat index of the cell
+	* @param	time				The time step
+	* @param	agent				The id of the agent
+	* @return	Whether the cell was free at that time, or already held by the agent
+	*/
+	bool Reserve(int32 cell, int32 time, int32 agent);
+
+	// Gets the agent holding a cell at a time step, or INDEX_NONE
+	FORCEINLINE int32 GetAgent(int32 cell, int32 time) const
+	{
+		const auto reservation = Reservations.find(GetKey(cell, time));
+		return reservation != Reservations.end() ? reservation->second : INDEX_NONE;
+	}
+
+	/**
+	* Checks if an agent can move from a cell at a time step to a cell at the next one, or stay when both are the same. The cell
+	* to reach has to be free at the next step, and the move can't swap cells with another agent.
+	* @param	from				The flat index of the cell the agent is in
+	* @param	to					The flat index of the cell to reach
+	* @param	time				The time step the agent is in from
+	* @param	agent				The id of the agent
+	* @return	Whether the move is free of conflicts
+	*/
+	FORCEINLINE bool CanMove(int32 from, int32 to, int32 time, int32 agent) const
+	{
+		const int32 holder = GetAgent(to, time + 1);
+		if (holder != INDEX_NONE && holder != agent)
+			return false;
+
+		// Another agent coming the other way over the same move
+		if (from != to)
+		{
+			const int32 oncoming = GetAgent(to, time);
+			if (oncoming != INDEX_NONE && oncoming != agent && GetAgent(from, time + 1) == oncoming)
+				return false;
+		}
+		return true;
+	}
+
+	// Gets the number of reservations
+	FORCEINLINE int32 Num() const { return static_cast<int32>(Reservations.size()); }
+
+	// Gets the number of bytes used by the reservations, an estimate of the hash table's nodes and buckets
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	FORCEINLINE static uint64 GetKey(int32 cell, int32 time) { return (static_cast<uint64>(static_cast<uint32>(time)) << 32) | static_cast<uint32>(cell); }
+
+	// The agent holding each (cell, time) pair
+	std::unordered_map<uint64, int32> Reservations;
+};
@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavSearchContext.h"
+
+NavNodeRecord NavSearchContext::EmptyRecordPage[NavSearchContext::RecordPageMask + 1] = {};
+
+void NavSearchContext::Reset(int32 cell_count)
+{
+	OpenHeap.clear();
+
+	// Keep the pages already allocated, the new generation invalidates their records
+	const int32 pageCount = (FMath::Max(cell_count, 0) + RecordPageMask) >> RecordPageShift;
+	RecordPages.resize(pageCount, EmptyRecordPage);
+	AllocatedRecordPages.resize(pageCount);
+
+	// Clear the stamps on the rare occasion the generation wraps around so old records can't be mistaken for current ones
+	if (++Generation == 0)
+	{
+		for (std::unique_ptr<NavNodeRecord[]>& page : AllocatedRecordPages)
+		{
+			for (int32 i = 0; page != nullptr && i <= RecordPageMask; ++i)
+			{
+				page[i].Generation = 0;
+			}
+		}
+		Generation = 1;
+	}
+}
+
+void NavSearchContext::AllocateRecordPage(int32 page)
+{
+	// Value initialized, so every record starts with generation 0 which no search uses
+	AllocatedRecordPages[page].reset(new NavNodeRecord[RecordPageMask + 1]());
+	RecordPages[page] = AllocatedRecordPages[page].get();
+}
+
+void NavSearchContext::Open(int32 index, int32 parent, float g_score, float f_score)
+{
+	NavNodeRecord& record = Touch(index);
+	record.GScore = g_score;
+	record.Parent = parent;
+
+	if (record.HeapIndex >= 0)
+	{
+		// Decrease key
+		OpenHeap[record.HeapIndex].FScore = f_score;
+		SiftUp(record.HeapIndex);
+	}
+	else
+	{
+		record.HeapIndex = static_cast<int32>(OpenHeap.size());
+		OpenHeap.push_back({ f_score, index });
+		PeakOpenNum = FMath::Max(PeakOpenNum, record.HeapIndex + 1);
+		SiftUp(record.HeapIndex);
+	}
+}
+
+int32 NavSearchContext::PopOpen()
+{
+	const int32 index = OpenHeap[0].Index;
+	GetRecord(index).HeapIndex = NavNodeRecord::Closed;
+	++TotalExpandedNum;
+
+	// Move the last entry to the top and restore the heap
+	const NavOpenEntry last = OpenHeap.back();
+	OpenHeap.pop_back();
+	if (OpenHeap.empty() == false)
+	{
+		OpenHeap[0] = last;
+		GetRecord(last.Index).HeapIndex = 0;
+		SiftDown(0);
+	}
+
+	return index;
+}
+
+void NavSearchContext::SiftUp(int32 position)
+{
+	const NavOpenEntry entry = OpenHeap[position];
+	while (position > 0)
+	{
+		const int32 parentPosition = (position - 1) / 2;
+		if (OpenHeap[parentPosition].FScore <= entry.FScore)
+			break;
+
+		OpenHeap[position] = OpenHeap[parentPosition];
+		GetRecord(OpenHeap[position].Index).HeapIndex = position;
+		position = parentPosition;
+	}
+	OpenHeap[position] = entry;
+	GetRecord(entry.Index).HeapIndex = position;
+}
+
+void NavSearchContext::SiftDown(int32 position)
+{
+	const NavOpenEntry entry = OpenHeap[position];
+	const int32 count = static_cast<int32>(OpenHeap.size());
+	while (true)
+	{
+		int32 child = (position * 2) + 1;
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && OpenHeap[child + 1].FScore < OpenHeap[child].FScore)
+			++child;
+
+		if (entry.FScore <= OpenHeap[child].FScore)
+			break;
+
+		OpenHeap[position] = OpenHeap[child];
+		GetRecord(OpenHeap[position].Index).HeapIndex = position;
+		position = child;
+	}
+	OpenHeap[position] = entry;
+	GetRecord(entry.Index).HeapIndex = position;
+}
+
+NavSearchContext& NavSearchContext::GetReverseContext()
+{
+	if (ReverseContext == nullptr)
+	{
+		ReverseContext.reset(new NavSearchContext());
+	}
+	return *ReverseContext;
+}
+
+uint64 NavSearchContext::GetTotalExpandedNum() const
+{
+	return TotalExpandedNum + (ReverseContext != nullptr ? ReverseContext->GetTotalExpandedNum() : 0);
+}
+
+SIZE_T NavSearchContext::GetAllocatedSize() const
+{
+	SIZE_T size = (OpenHeap.capacity() * sizeof(NavOpenEntry)) + (RecordPages.capacity() * sizeof(NavNodeRecord*)) + (AllocatedRecordPages.capacity() * sizeof(std::unique_ptr<NavNodeRecord[]>));
+	for (const std::unique_ptr<NavNodeRecord[]>& page : AllocatedRecordPages)
+	{
+		if (page != nullptr)
+		{
+			size += (RecordPageMask + 1) * sizeof(NavNodeRecord);
+		}
+	}
+	if (ReverseContext != nullptr)
+	{
+		size += ReverseContext->GetAllocatedSize();
+	}
+	return size + (PathCells.capacity() * sizeof(int32));
+}
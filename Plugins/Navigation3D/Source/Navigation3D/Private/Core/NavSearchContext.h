@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <memory>
+#include <vector>
+
+// The search state of a single node, indexed by the node's flat index. Records stamped with an older generation are treated as unreached.
+struct NavNodeRecord
+{
+	// The cost of the best known path from the start to the node
+	float GScore;
+
+	// The node this node was reached from, or INDEX_NONE for the start node
+	int32 Parent;
+
+	// The search the record was last written by
+	uint32 Generation = 0;
+
+	// The position of the node in the open heap, or one of the NavNodeRecord::NotInHeap/Closed states
+	int32 HeapIndex;
+
+	// The moves (as a bitmask of NavNeighborOffsets entries) known to lead to no jump point from the node, used by Jump Point Search
+	uint32 DeadEndMoves;
+
+	static constexpr int32 NotInHeap = -1;
+	static constexpr int32 Closed = -2;
+};
+
+// An entry of the open heap. The score is stored with the entry so the heap can be reordered without touching the records.
+struct NavOpenEntry
+{
+	float FScore;
+	int32 Index;
+};
+
+// The state of a single path search. The grid is never written to while searching, so each thread searching
+// the same volume needs its own context. A context keeps its buffers between searches and invalidates the node records
+// of the previous search in O(1) by bumping its generation. Records are allocated in pages the first time a search reaches
+// one of their nodes, so searches over large sparse graphs only pay for the part they explore.
+class NavSearchContext
+{
+public:
+	// Prepares the context for a new search over a grid with the specified number of cells
+	void Reset(int32 cell_count);
+
+	// Gets the cost of the best known path from the start to the node, or FLT_MAX if the node hasn't been reached
+	FORCEINLINE float GetGScore(int32 index) const
+	{
+		const NavNodeRecord* record = FindRecord(index);
+		return record != nullptr ? record->GScore : FLT_MAX;
+	}
+
+	// Gets the node the node was reached from, or INDEX_NONE
+	FORCEINLINE int32 GetParent(int32 index) const
+	{
+		const NavNodeRecord* record = FindRecord(index);
+		return record != nullptr ? record->Parent : INDEX_NONE;
+	}
+
+	// Checks if the node has already been expanded
+	FORCEINLINE bool IsClosed(int32 index) const
+	{
+		const NavNodeRecord* record = FindRecord(index);
+		return record != nullptr && record->HeapIndex == NavNodeRecord::Closed;
+	}
+
+	// Gets the moves known to lead to no jump point from the node
+	FORCEINLINE uint32 GetDeadEndMoves(int32 index) const
+	{
+		const NavNodeRecord* record = FindRecord(index);
+		return record != nullptr ? record->DeadEndMoves : 0u;
+	}
+
+	// Remembers that a move leads to no jump point from the node
+	FORCEINLINE void AddDeadEndMove(int32 index, int32 move)
+	{
+		Touch(index).DeadEndMoves |= 1u << move;
+	}
+
+	// Checks if there are no nodes left to expand
+	FORCEINLINE bool IsOpenEmpty() const { return OpenHeap.empty(); }
+
+	// Gets the number of nodes waiting to be expanded
+	FORCEINLINE int32 GetOpenNum() const { return static_cast<int32>(OpenHeap.size()); }
+
+	// Gets the lowest score in the open heap, which must not be empty
+	FORCEINLINE float GetMinOpenScore() const { return OpenHeap[0].FScore; }
+
+	/**
+	* Records a better path to a node, adding it to the open heap or moving it up if it's already there.
+	* @param	index				The node reached
+	* @param	parent				The node it was reached from
+	* @param	g_score				The cost of the path from the start to the node
+	* @param	f_score				The cost plus the heuristic estimate to the goal
+	*/
+	void Open(int32 index, int32 parent, float g_score, float f_score);
+
+	// Removes the node with the lowest score from the open heap and marks it closed
+	int32 PopOpen();
+
+	// Changes the parent and the cost of a node without touching the open heap, for searches that correct the parent of a node once it's expanded
+	FORCEINLINE void SetParent(int32 index, int32 parent, float g_score)
+	{
+		NavNodeRecord& record = Touch(index);
+		record.Parent = parent;
+		record.GScore = g_score;
+	}
+
+	// Gets the number of nodes expanded by every search run with the context so far, including the searches of each step of hierarchical
+	// queries and the backward half of bidirectional ones
+	uint64 GetTotalExpandedNum() const;
+
+	// Gets the search state of the backward half of bidirectional searches, created the first time it's needed
+	NavSearchContext& GetReverseContext();
+
+	// Gets the largest number of nodes waiting to be expanded at once since the peak was last reset
+	FORCEINLINE int32 GetPeakOpenNum() const { return PeakOpenNum; }
+
+	// Starts measuring the open heap peak again, usually before a query
+	FORCEINLINE void ResetPeakOpenNum() { PeakOpenNum = 0; }
+
+	// Gets the number of bytes used by the record pages and the open heap
+	SIZE_T GetAllocatedSize() const;
+
+	// Scratch storage for the flat indices of the cells (or the octree nodes) along the path found, reused between searches
+	std::vector<int32> PathCells;
+
+private:
+	// The number of records per page, as a power of two
+	static constexpr int32 RecordPageShift = 12;
+	static constexpr int32 RecordPageMask = (1 << RecordPageShift) - 1;
+
+	// Gets the record of a node if the current search has written it
+	FORCEINLINE const NavNodeRecord* FindRecord(int32 index) const
+	{
+		const NavNodeRecord* record = RecordPages[index >> RecordPageShift] + (index & RecordPageMask);
+		return record->Generation == Generation ? record : nullptr;
+	}
+
+	// Gets the record of a node that has already been touched by the current search
+	FORCEINLINE NavNodeRecord& GetRecord(int32 index)
+	{
+		return RecordPages[index >> RecordPageShift][index & RecordPageMask];
+	}
+
+	// Allocates a page of records
+	void AllocateRecordPage(int32 page);
+
+	// Gets the record of a node, clearing it first if it was written by a previous search
+	FORCEINLINE NavNodeRecord& Touch(int32 index)
+	{
+		if (RecordPages[index >> RecordPageShift] == EmptyRecordPage)
+		{
+			AllocateRecordPage(index >> RecordPageShift);
+		}
+
+		NavNodeRecord& record = GetRecord(index);
+		if (record.Generation != Generation)
+		{
+			record.GScore = FLT_MAX;
+			record.Parent = INDEX_NONE;
+			record.Generation = Generation;
+			record.HeapIndex = NavNodeRecord::NotInHeap;
+			record.DeadEndMoves = 0;
+		}
+		return record;
+	}
+
+	// Moves a heap entry up until its parent has a lower score
+	void SiftUp(int32 position);
+
+	// Moves a heap entry down until its children have higher scores
+	void SiftDown(int32 position);
+
+	// The pages of per node records, indexed by flat index. Pages no search has reached yet point to EmptyRecordPage.
+	std::vector<NavNodeRecord*> RecordPages;
+
+	// The pages allocated by this context, at the same positions as in RecordPages
+	std::vector<std::unique_ptr<NavNodeRecord[]> > AllocatedRecordPages;
+
+	// A page of records that are never written, stamped with the generation no search uses
+	static NavNodeRecord EmptyRecordPage[RecordPageMask + 1];
+
+	// The nodes waiting to be expanded, as a binary min heap on FScore
+	std::vector<NavOpenEntry> OpenHeap;
+
+	// The generation of the current search
+	uint32 Generation = 0;
+
+	// The number of nodes popped from the open heap since the context was created
+	uint64 TotalExpandedNum = 0;
+
+	// The largest size of the open heap since ResetPeakOpenNum was called
+	int32 PeakOpenNum = 0;
+
+	// The search state of the backward half of bidirectional searches
+	std::unique_ptr<NavSearchContext> ReverseContext;
+};
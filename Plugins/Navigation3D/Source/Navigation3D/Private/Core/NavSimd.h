@@ -0,0 +1,81 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+
+// Four float lanes and four lane masks, mapped to SSE2 on x86, NEON on ARM and plain arrays elsewhere. Only the few operations
+// the voxelizer and the grid transform need are provided, so the core doesn't depend on the engine's vector math.
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define NAV_SIMD_SSE 1
+#include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#define NAV_SIMD_NEON 1
+#include <arm_neon.h>
+#endif
+
+#if defined(NAV_SIMD_SSE)
+
+struct NavFloat4 { __m128 V; };
+struct NavMask4 { __m128 V; };
+
+FORCEINLINE NavFloat4 NavSet4(float value) { return { _mm_set1_ps(value) }; }
+FORCEINLINE NavFloat4 NavSet4(float a, float b, float c, float d) { return { _mm_setr_ps(a, b, c, d) }; }
+FORCEINLINE NavFloat4 operator+(const NavFloat4& a, const NavFloat4& b) { return { _mm_add_ps(a.V, b.V) }; }
+FORCEINLINE NavFloat4 operator-(const NavFloat4& a, const NavFloat4& b) { return { _mm_sub_ps(a.V, b.V) }; }
+FORCEINLINE NavFloat4 operator*(const NavFloat4& a, const NavFloat4& b) { return { _mm_mul_ps(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavMin4(const NavFloat4& a, const NavFloat4& b) { return { _mm_min_ps(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavMax4(const NavFloat4& a, const NavFloat4& b) { return { _mm_max_ps(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavAbs4(const NavFloat4& a) { return { _mm_andnot_ps(_mm_set1_ps(-0.0f), a.V) }; }
+FORCEINLINE NavMask4 NavLessEqual4(const NavFloat4& a, const NavFloat4& b) { return { _mm_cmple_ps(a.V, b.V) }; }
+FORCEINLINE NavMask4 NavLess4(const NavFloat4& a, const NavFloat4& b) { return { _mm_cmplt_ps(a.V, b.V) }; }
+FORCEINLINE void NavStore4(float* out_values, const NavFloat4& a) { _mm_storeu_ps(out_values, a.V); }
+FORCEINLINE NavMask4 operator&(const NavMask4& a, const NavMask4& b) { return { _mm_and_ps(a.V, b.V) }; }
+FORCEINLINE NavMask4 operator|(const NavMask4& a, const NavMask4& b) { return { _mm_or_ps(a.V, b.V) }; }
+FORCEINLINE uint32 NavMaskBits4(const NavMask4& a) { return static_cast<uint32>(_mm_movemask_ps(a.V)); }
+
+#elif defined(NAV_SIMD_NEON)
+
+struct NavFloat4 { float32x4_t V; };
+struct NavMask4 { uint32x4_t V; };
+
+FORCEINLINE NavFloat4 NavSet4(float value) { return { vdupq_n_f32(value) }; }
+FORCEINLINE NavFloat4 NavSet4(float a, float b, float c, float d) { const float values[4] = { a, b, c, d }; return { vld1q_f32(values) }; }
+FORCEINLINE NavFloat4 operator+(const NavFloat4& a, const NavFloat4& b) { return { vaddq_f32(a.V, b.V) }; }
+FORCEINLINE NavFloat4 operator-(const NavFloat4& a, const NavFloat4& b) { return { vsubq_f32(a.V, b.V) }; }
+FORCEINLINE NavFloat4 operator*(const NavFloat4& a, const NavFloat4& b) { return { vmulq_f32(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavMin4(const NavFloat4& a, const NavFloat4& b) { return { vminq_f32(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavMax4(const NavFloat4& a, const NavFloat4& b) { return { vmaxq_f32(a.V, b.V) }; }
+FORCEINLINE NavFloat4 NavAbs4(const NavFloat4& a) { return { vabsq_f32(a.V) }; }
+FORCEINLINE NavMask4 NavLessEqual4(const NavFloat4& a, const NavFloat4& b) { return { vcleq_f32(a.V, b.V) }; }
+FORCEINLINE NavMask4 NavLess4(const NavFloat4& a, const NavFloat4& b) { return { vcltq_f32(a.V, b.V) }; }
+FORCEINLINE void NavStore4(float* out_values, const NavFloat4& a) { vst1q_f32(out_values, a.V); }
+FORCEINLINE NavMask4 operator&(const NavMask4& a, const NavMask4& b) { return { vandq_u32(a.V, b.V) }; }
+FORCEINLINE NavMask4 operator|(const NavMask4& a, const NavMask4& b) { return { vorrq_u32(a.V, b.V) }; }
+FORCEINLINE uint32 NavMaskBits4(const NavMask4& a)
+{
+	const uint32x4_t bits = vshrq_n_u32(a.V, 31);
+	return vgetq_lane_u32(bits, 0) | (vgetq_lane_u32(bits, 1) << 1) | (vgetq_lane_u32(bits, 2) << 2) | (vgetq_lane_u32(bits, 3) << 3);
+}
+
+#else
+
+struct NavFloat4 { float V[4]; };
+struct NavMask4 { bool V[4]; };
+
+FORCEINLINE NavFloat4 NavSet4(float value) { return { { value, value, value, value } }; }
+FORCEINLINE NavFloat4 NavSet4(float a, float b, float c, float d) { return { { a, b, c, d } }; }
+FORCEINLINE NavFloat4 operator+(const NavFloat4& a, const NavFloat4& b) { return { { a.V[0] + b.V[0], a.V[1] + b.V[1], a.V[2] + b.V[2], a.V[3] + b.V[3] } }; }
+FORCEINLINE NavFloat4 operator-(const NavFloat4& a, const NavFloat4& b) { return { { a.V[0] - b.V[0], a.V[1] - b.V[1], a.V[2] - b.V[2], a.V[3] - b.V[3] } }; }
+FORCEINLINE NavFloat4 operator*(const NavFloat4& a, const NavFloat4& b) { return { { a.V[0] * b.V[0], a.V[1] * b.V[1], a.V[2] * b.V[2], a.V[3] * b.V[3] } }; }
+FORCEINLINE NavFloat4 NavMin4(const NavFloat4& a, const NavFloat4& b) { return { { FMath::Min(a.V[0], b.V[0]), FMath::Min(a.V[1], b.V[1]), FMath::Min(a.V[2], b.V[2]), FMath::Min(a.V[3], b.V[3]) } }; }
+FORCEINLINE NavFloat4 NavMax4(const NavFloat4& a, const NavFloat4& b) { return { { FMath::Max(a.V[0], b.V[0]), FMath::Max(a.V[1], b.V[1]), FMath::Max(a.V[2], b.V[2]), FMath::Max(a.V[3], b.V[3]) } }; }
+FORCEINLINE NavFloat4 NavAbs4(const NavFloat4& a) { return { { FMath::Abs(a.V[0]), FMath::Abs(a.V[1]), FMath::Abs(a.V[2]), FMath::Abs(a.V[3]) } }; }
+FORCEINLINE NavMask4 NavLessEqual4(const NavFloat4& a, const NavFloat4& b) { return { { a.V[0] <= b.V[0], a.V[1] <= b.V[1], a.V[2] <= b.V[2], a.V[3] <= b.V[3] } }; }
+FORCEINLINE NavMask4 NavLess4(const NavFloat4& a, const NavFloat4& b) { return { { a.V[0] < b.V[0], a.V[1] < b.V[1], a.V[2] < b.V[2], a.V[3] < b.V[3] } }; }
+FORCEINLINE void NavStore4(float* out_values, const NavFloat4& a) { for (int32 i = 0; i < 4; ++i) { out_values[i] = a.V[i]; } }
+FORCEINLINE NavMask4 operator&(const NavMask4& a, const NavMask4& b) { return { { a.V[0] && b.V[0], a.V[1] && b.V[1], a.V[2] && b.V[2], a.V[3] && b.V[3] } }; }
+FORCEINLINE NavMask4 operator|(const NavMask4& a, const NavMask4& b) { return { { a.V[0] || b.V[0], a.V[1] || b.V[1], a.V[2] || b.V[2], a.V[3] || b.V[3] } }; }
+FORCEINLINE uint32 NavMaskBits4(const NavMask4& a) { return (a.V[0] ? 1u : 0u) | (a.V[1] ? 2u : 0u) | (a.V[2] ? 4u : 0u) | (a.V[3] ? 8u : 0u); }
+
+#endif
@@ -0,0 +1,435 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavSparseOctree.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+
+// The inputs of a build, passed down while building the nodes
+struct NavOctreeBuildContext
+{
+	const NavSparseOctree::RegionBlockedFuncType& IsRegionBlocked;
+	const NavSparseOctree* Previous;
+	const std::vector<NavCellBox>& ChangedRegions;
+};
+
+namespace
+{
+	// The level of the nodes storing per cell occupancy, 4x4x4 cells
+	constexpr int32 LeafLevel = 2;
+
+	// Spreads the lower 21 bits of a value so there are two zero bits between each of them
+	FORCEINLINE uint64 SpreadBits(uint32 value)
+	{
+		uint64 bits = value & 0x1fffff;
+		bits = (bits | (bits << 32)) & 0x1f00000000ffffull;
+		bits = (bits | (bits << 16)) & 0x1f0000ff0000ffull;
+		bits = (bits | (bits << 8)) & 0x100f00f00f00f00full;
+		bits = (bits | (bits << 4)) & 0x10c30c30c30c30c3ull;
+		bits = (bits | (bits << 2)) & 0x1249249249249249ull;
+		return bits;
+	}
+
+	// Gathers every third bit of a value, the inverse of SpreadBits
+	FORCEINLINE uint32 CompactBits(uint64 bits)
+	{
+		bits &= 0x1249249249249249ull;
+		bits = (bits ^ (bits >> 2)) & 0x10c30c30c30c30c3ull;
+		bits = (bits ^ (bits >> 4)) & 0x100f00f00f00f00full;
+		bits = (bits ^ (bits >> 8)) & 0x1f0000ff0000ffull;
+		bits = (bits ^ (bits >> 16)) & 0x1f00000000ffffull;
+		bits = (bits ^ (bits >> 32)) & 0x1fffffull;
+		return static_cast<uint32>(bits);
+	}
+
+	FORCEINLINE uint64 EncodeMorton(const FIntVector& coordinates)
+	{
+		return SpreadBits(coordinates.X) | (SpreadBits(coordinates.Y) << 1) | (SpreadBits(coordinates.Z) << 2);
+	}
+
+	FORCEINLINE FIntVector DecodeMorton(uint64 code)
+	{
+		return FIntVector(CompactBits(code), CompactBits(code >> 1), CompactBits(code >> 2));
+	}
+
+	// Gets the offset of a child from its parent's minimum cell, in units of the child's size
+	FORCEINLINE FIntVector GetOctantOffset(int32 octant)
+	{
+		return FIntVector(octant & 1, (octant >> 1) & 1, (octant >> 2) & 1);
+	}
+
+	// Checks if two boxes of cells overlap, with inclusive max coordinates
+	FORCEINLINE bool DoBoxesOverlap(const FIntVector& min_a, const FIntVector& max_a, const FIntVector& min_b, const FIntVector& max_b)
+	{
+		return min_a.X <= max_b.X && min_b.X <= max_a.X &&
+			min_a.Y <= max_b.Y && min_b.Y <= max_a.Y &&
+			min_a.Z <= max_b.Z && min_b.Z <= max_a.Z;
+	}
+}
+
+void NavSparseOctree::Build(const FIntVector& divisions, const RegionBlockedFuncType& is_region_blocked, const NavSparseOctree* previous, const std::vector<NavCellBox>& changed_regions)
+{
+	NAV_TRACE_SCOPE(NavSparseOctree::Build);
+
+	Divisions = divisions;
+	Nodes.clear();
+	Leaves.clear();
+
+	// The root is the smallest power of two cube holding the grid, and at least a leaf
+	const int32 maxDivisions = FMath::Max3(Divisions.X, Divisions.Y, Divisions.Z);
+	RootLevel = LeafLevel;
+	while ((1 << RootLevel) < maxDivisions)
+	{
+		++RootLevel;
+	}
+
+	// The nodes of a previous octree only line up with ours if it was built for the same grid
+	if (previous != nullptr && (previous->IsValid() == false || previous->Divisions != Divisions))
+	{
+		previous = nullptr;
+	}
+
+	const NavOctreeBuildContext build{ is_region_blocked, previous, changed_regions };
+	Nodes.emplace_back();
+	BuildNode(build, 0, FIntVector::ZeroValue, RootLevel, previous != nullptr ? 0 : INDEX_NONE);
+
+	Nodes.shrink_to_fit();
+	Leaves.shrink_to_fit();
+}
+
+void NavSparseOctree::BuildNode(const NavOctreeBuildContext& build, int32 node_index, const FIntVector& min_coordinates, int32 level, int32 previous_index)
+{
+	const int32 size = 1 << level;
+	const FIntVector maxCoordinates = min_coordinates + FIntVector(size - 1);
+
+	Nodes[node_index].Code = EncodeMorton(min_coordinates);
+	Nodes[node_index].Child = INDEX_NONE;
+	Nodes[node_index].Level = static_cast<uint8>(level);
+
+	// Nodes outside of the grid can never be entered
+	if (min_coordinates.X >= Divisions.X || min_coordinates.Y >= Divisions.Y || min_coordinates.Z >= Divisions.Z)
+	{
+		Nodes[node_index].Type = ENavOctreeNodeType::Blocked;
+		return;
+	}
+
+	// Copy the nodes no changed region touches instead of testing them again
+	if (previous_index != INDEX_NONE)
+	{
+		bool changed = false;
+		for (const NavCellBox& region : build.ChangedRegions)
+		{
+			if (DoBoxesOverlap(min_coordinates, maxCoordinates, region.Min, region.Max))
+			{
+				changed = true;
+				break;
+			}
+		}
+
+		if (changed == false)
+		{
+			CopyNode(*build.Previous, node_index, previous_index);
+			return;
+		}
+	}
+
+	// Nodes sticking out of the grid are always split so their outside cells stay blocked
+	const bool inside = maxCoordinates.X < Divisions.X && maxCoordinates.Y < Divisions.Y && maxCoordinates.Z < Divisions.Z;
+	if (inside && build.IsRegionBlocked(min_coordinates, size) == false)
+	{
+		Nodes[node_index].Type = ENavOctreeNodeType::Free;
+		return;
+	}
+
+	if (level == LeafLevel)
+	{
+		BuildLeaf(build, node_index, min_coordinates);
+		return;
+	}
+
+	// Split the node. Its children are appended after every node built so far, so they're always the last ones when it's done.
+	const int32 firstChild = static_cast<int32>(Nodes.size());
+	Nodes.resize(Nodes.size() + 8);
+	Nodes[node_index].Type = ENavOctreeNodeType::Branch;
+	Nodes[node_index].Child = firstChild;
+
+	const int32 halfSize = size / 2;
+	const bool previousIsBranch = previous_index != INDEX_NONE && build.Previous->Nodes[previous_index].Type == ENavOctreeNodeType::Branch;
+	for (int32 octant = 0; octant < 8; ++octant)
+	{
+		const int32 previousChild = previousIsBranch ? build.Previous->Nodes[previous_index].Child + octant : INDEX_NONE;
+		BuildNode(build, firstChild + octant, min_coordinates + (GetOctantOffset(octant) * halfSize), level - 1, previousChild);
+	}
+
+	// Merge children that all ended up free or all ended up blocked
+	const ENavOctreeNodeType firstType = Nodes[firstChild].Type;
+	if (firstType == ENavOctreeNodeType::Free || firstType == ENavOctreeNodeType::Blocked)
+	{
+		bool uniform = true;
+		for (int32 octant = 1; octant < 8 && uniform; ++octant)
+		{
+			uniform = Nodes[firstChild + octant].Type == firstType;
+		}
+
+		if (uniform)
+		{
+			Nodes.resize(firstChild);
+			Nodes[node_index].Type = firstType;
+			Nodes[node_index].Child = INDEX_NONE;
+		}
+	}
+}
+
+void NavSparseOctree::BuildLeaf(const NavOctreeBuildContext& build, int32 node_index, const FIntVector& min_coordinates)
+{
+	auto isInside = [this](const FIntVector& coordinates)
+	{
+		return coordinates.X < Divisions.X && coordinates.Y < Divisions.Y && coordinates.Z < Divisions.Z;
+	};
+
+	// Test each 2x2x2 octant as a whole first, and only test its cells one by one when it's blocked.
+	// The bit of a cell is its local Morton code, so the 8 cells of an octant are the 8 bits starting at octant * 8.
+	uint64 blockedMask = 0;
+	for (int32 octant = 0; octant < 8; ++octant)
+	{
+		const FIntVector octantMin = min_coordinates + (GetOctantOffset(octant) * 2);
+		if (isInside(octantMin + FIntVector(1)) && build.IsRegionBlocked(octantMin, 2) == false)
+			continue;
+
+		for (int32 cell = 0; cell < 8; ++cell)
+		{
+			const FIntVector coordinates = octantMin + GetOctantOffset(cell);
+			if (isInside(coordinates) == false || build.IsRegionBlocked(coordinates, 1))
+			{
+				blockedMask |= 1ull << ((octant * 8) + cell);
+			}
+		}
+	}
+
+	NavOctreeNode& node = Nodes[node_index];
+	if (blockedMask == ~0ull)
+	{
+		node.Type = ENavOctreeNodeType::Blocked;
+	}
+	else if (blockedMask == 0)
+	{
+		node.Type = ENavOctreeNodeType::Free;
+	}
+	else
+	{
+		node.Type = ENavOctreeNodeType::Leaf;
+		node.Child = static_cast<int32>(Leaves.size());
+		Leaves.push_back({ blockedMask, node_index });
+	}
+}
+
+void NavSparseOctree::CopyNode(const NavSparseOctree& previous, int32 node_index, int32 previous_index)
+{
+	const NavOctreeNode& previousNode = previous.Nodes[previous_index];
+	Nodes[node_index] = previousNode;
+
+	if (previousNode.Type == ENavOctreeNodeType::Leaf)
+	{
+		Nodes[node_index].Child = static_cast<int32>(Leaves.size());
+		Leaves.push_back({ previous.Leaves[previousNode.Child].BlockedMask, node_index });
+	}
+	else if (previousNode.Type == ENavOctreeNodeType::Branch)
+	{
+		const int32 firstChild = static_cast<int32>(Nodes.size());
+		Nodes.resize(Nodes.size() + 8);
+		Nodes[node_index].Child = firstChild;
+		for (int32 octant = 0; octant < 8; ++octant)
+		{
+			CopyNode(previous, firstChild + octant, previousNode.Child + octant);
+		}
+	}
+}
+
+int32 NavSparseOctree::FindGraphNode(const FIntVector& coordinates) const
+{
+	if (IsValid() == false ||
+		coordinates.X < 0 || coordinates.X >= Divisions.X ||
+		coordinates.Y < 0 || coordinates.Y >= Divisions.Y ||
+		coordinates.Z < 0 || coordinates.Z >= Divisions.Z)
+		return INDEX_NONE;
+
+	// Walk down from the root, the bits of the coordinates at each level pick the child
+	int32 index = 0;
+	for (;;)
+	{
+		const NavOctreeNode& node = Nodes[index];
+		switch (node.Type)
+		{
+		case ENavOctreeNodeType::Free:
+			return index;
+
+		case ENavOctreeNodeType::Blocked:
+			return INDEX_NONE;
+
+		case ENavOctreeNodeType::Leaf:
+		{
+			const int32 cell = static_cast<int32>(EncodeMorton(FIntVector(coordinates.X & 3, coordinates.Y & 3, coordinates.Z & 3)));
+			if ((Leaves[node.Child].BlockedMask >> cell) & 1ull)
+				return INDEX_NONE;
+			return static_cast<int32>(Nodes.size()) + (node.Child * 64) + cell;
+		}
+
+		default:
+		{
+			const int32 shift = node.Level - 1;
+			const int32 octant = ((coordinates.X >> shift) & 1) | (((coordinates.Y >> shift) & 1) << 1) | (((coordinates.Z >> shift) & 1) << 2);
+			index = node.Child + octant;
+		}
+		}
+	}
+}
+
+void NavSparseOctree::GetGraphNodeBounds(int32 id, FIntVector& out_min_coordinates, int32& out_size) const
+{
+	const int32 nodeCount = static_cast<int32>(Nodes.size());
+	if (id < nodeCount)
+	{
+		out_min_coordinates = DecodeMorton(Nodes[id].Code);
+		out_size = 1 << Nodes[id].Level;
+		return;
+	}
+
+	// Ids past the nodes are the cells of the leaves
+	const int32 leaf = (id - nodeCount) / 64;
+	const int32 cell = (id - nodeCount) % 64;
+	out_min_coordinates = DecodeMorton(Nodes[Leaves[leaf].Node].Code) + DecodeMorton(cell);
+	out_size = 1;
+}
+
+FVector NavSparseOctree::GetGraphNodeCenter(int32 id) const
+{
+	FIntVector minCoordinates;
+	int32 size;
+	GetGraphNodeBounds(id, minCoordinates, size);
+	return FVector(minCoordinates) + FVector(size * 0.5f);
+}
+
+template<typename FuncType>
+void NavSparseOctree::ForEachGraphNodeInBox(const FIntVector& min_coordinates, const FIntVector& max_coordinates, FuncType&& func) const
+{
+	// Each level pushes at most 8 children, and only one of them gets split further before the others are popped
+	int32 stack[8 * 24];
+	int32 stackSize = 0;
+	stack[stackSize++] = 0;
+
+	while (stackSize > 0)
+	{
+		const int32 index = stack[--stackSize];
+		const NavOctreeNode& node = Nodes[index];
+		const int32 size = 1 << node.Level;
+		const FIntVector nodeMin = DecodeMorton(node.Code);
+		if (DoBoxesOverlap(nodeMin, nodeMin + FIntVector(size - 1), min_coordinates, max_coordinates) == false)
+			continue;
+
+		switch (node.Type)
+		{
+		case ENavOctreeNodeType::Free:
+			func(index, nodeMin, size);
+			break;
+
+		case ENavOctreeNodeType::Leaf:
+		{
+			const int32 firstCellId = static_cast<int32>(Nodes.size()) + (node.Child * 64);
+			uint64 freeMask = ~Leaves[node.Child].BlockedMask;
+			while (freeMask != 0)
+			{
+				const int32 cell = static_cast<int32>(FMath::CountTrailingZeros64(freeMask));
+				freeMask &= freeMask - 1;
+
+				const FIntVector coordinates = nodeMin + DecodeMorton(cell);
+				if (DoBoxesOverlap(coordinates, coordinates, min_coordinates, max_coordinates))
+				{
+					func(firstCellId + cell, coordinates, 1);
+				}
+			}
+			break;
+		}
+
+		case ENavOctreeNodeType::Branch:
+			for (int32 octant = 0; octant < 8; ++octant)
+			{
+				stack[stackSize++] = node.Child + octant;
+			}
+			break;
+
+		default:
+			break;
+		}
+	}
+}
+
+bool NavSparseOctree::FindPath(const FIntVector& start, const FIntVector& end, int32 min_shared_axes, NavSearchContext& context, std::vector<int32>& out_path) const
+{
+	NAV_TRACE_SCOPE(NavSparseOctree::FindPath);
+
+	out_path.clear();
+
+	const int32 startId = FindGraphNode(start);
+	const int32 endId = FindGraphNode(end);
+	if (startId == INDEX_NONE || endId == INDEX_NONE)
+		return false;
+
+	context.Reset(GetGraphNodeCount());
+
+	// Moving between node centers, the straight line distance to the goal's center never overestimates
+	const FVector endCenter = GetGraphNodeCenter(endId);
+	context.Open(startId, INDEX_NONE, 0.0f, FVector::Distance(GetGraphNodeCenter(startId), endCenter));
+
+	while (context.IsOpenEmpty() == false)
+	{
+		const int32 current = context.PopOpen();
+
+		if (current == endId)
+		{
+			// Rebuild the path from the end, then flip it
+			for (int32 node = current; node != INDEX_NONE; node = context.GetParent(node))
+			{
+				out_path.push_back(node);
+			}
+			std::reverse(out_path.begin(), out_path.end());
+			return true;
+		}
+
+		FIntVector currentMin;
+		int32 currentSize;
+		GetGraphNodeBounds(current, currentMin, currentSize);
+		const FIntVector currentMax = currentMin + FIntVector(currentSize - 1);
+		const FVector currentCenter = FVector(currentMin) + FVector(currentSize * 0.5f);
+		const float currentGScore = context.GetGScore(current);
+
+		// Every node touching the current one is in the box grown by a cell. Free nodes never overlap, so they only touch.
+		ForEachGraphNodeInBox(currentMin - FIntVector(1), currentMax + FIntVector(1), [&](int32 neighbor, const FIntVector& neighborMin, int32 neighborSize)
+		{
+			if (neighbor == current || context.IsClosed(neighbor))
+				return;
+
+			// The axes along which the two nodes overlap by more than a point are the axes their shared face, edge or corner spans
+			const FIntVector neighborMax = neighborMin + FIntVector(neighborSize - 1);
+			const int32 sharedAxes = (neighborMin.X <= currentMax.X && currentMin.X <= neighborMax.X) +
+				(neighborMin.Y <= currentMax.Y && currentMin.Y <= neighborMax.Y) +
+				(neighborMin.Z <= currentMax.Z && currentMin.Z <= neighborMax.Z);
+			if (sharedAxes < min_shared_axes)
+				return;
+
+			const FVector neighborCenter = FVector(neighborMin) + FVector(neighborSize * 0.5f);
+			const float tentative_gScore = currentGScore + FVector::Distance(currentCenter, neighborCenter);
+			if (tentative_gScore < context.GetGScore(neighbor))
+			{
+				context.Open(neighbor, current, tentative_gScore, tentative_gScore + FVector::Distance(neighborCenter, endCenter));
+			}
+		});
+	}
+
+	// Failed to find path
+	return false;
+}
+
+SIZE_T NavSparseOctree::GetAllocatedSize() const
+{
+	return (Nodes.capacity() * sizeof(NavOctreeNode)) + (Leaves.capacity() * sizeof(NavOctreeLeaf));
+}
@@ -0,0 +1,145 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <functional>
+#include <vector>
+
+class NavSearchContext;
+struct NavOctreeBuildContext;
+
+// What a node of the sparse octree holds
+enum class ENavOctreeNodeType : uint8
+{
+	// Every cell of the node is free, the node is a single node of the search graph
+	Free,
+
+	// Every cell of the node is blocked or outside of the grid
+	Blocked,
+
+	// The node is split into 8 children
+	Branch,
+
+	// The node is 4x4x4 cells whose occupancy is stored as a 64 bit mask, each free cell is a node of the search graph
+	Leaf
+};
+
+// A node of the sparse octree
+struct NavOctreeNode
+{
+	// The Morton code of the node's minimum cell
+	uint64 Code;
+
+	// The index of the first of the 8 children of a branch (in Morton order), or the index of the mask of a leaf
+	int32 Child;
+
+	// The node covers 2^Level cells along each axis
+	uint8 Level;
+
+	ENavOctreeNodeType Type;
+};
+
+// An axis aligned box of cells with inclusive min and max coordinates
+struct NavCellBox
+{
+	FIntVector Min;
+	FIntVector Max;
+};
+
+// The cells of a 4x4x4 leaf node
+struct NavOctreeLeaf
+{
+	// One bit per cell in local Morton order. A set bit means the cell is blocked.
+	uint64 BlockedMask;
+
+	// The node the leaf belongs to
+	int32 Node;
+};
+
+/**
+* A sparse voxel octree over the grid. Regions that are entirely free or entirely blocked collapse into a single node, so
+* memory grows with the surface of the obstacles instead of the volume of the grid. Only the 4x4x4 nodes that contain both
+* free and blocked cells store per cell occupancy. The search graph is made of the free nodes of every size and the free
+* cells of the leaves, two of which are neighbors when they touch and their overlap shares at least MinSharedNeighborAxes axes.
+* Paths cross open space in a few large steps and follow obstacles at the resolution of the grid. Published octrees are
+* never modified, so searching one from several threads is safe as long as each thread uses its own search context.
+*/
+class NavSparseOctree
+{
+public:
+	// Tests if any part of the cube of cells starting at min_coordinates with the specified size along each axis is blocked
+	using RegionBlockedFuncType = std::function<bool(const FIntVector& min_coordinates, int32 size)>;
+
+	/**
+	* Builds the octree top down, only splitting the nodes whose region is blocked.
+	* @param	divisions			The number of cells along each axis
+	* @param	is_region_blocked	Tests a cube of cells, only called for cubes inside the grid
+	* @param	previous			An octree built for the same grid to copy the unchanged nodes from (optional)
+	* @param	changed_regions		The regions that changed since previous was built
+	*/
+	void Build(const FIntVector& divisions, const RegionBlockedFuncType& is_region_blocked, const NavSparseOctree* previous = nullptr, const std::vector<NavCellBox>& changed_regions = std::vector<NavCellBox>());
+
+	// Checks if the octree has been built
+	FORCEINLINE bool IsValid() const { return Nodes.size() > 0; }
+
+	// Gets the number of cells along each axis of the grid the octree was built for
+	FORCEINLINE const FIntVector& GetDivisions() const { return Divisions; }
+
+	// Gets the number of ids used by the search graph. Not every id below it is a node of the graph.
+	FORCEINLINE int32 GetGraphNodeCount() const { return static_cast<int32>(Nodes.size() + (Leaves.size() * 64)); }
+
+	// Gets the id of the search graph node containing a cell, or INDEX_NONE if the cell is blocked or outside of the grid
+	int32 FindGraphNode(const FIntVector& coordinates) const;
+
+	// Gets the minimum cell and the size along each axis of a search graph node
+	void GetGraphNodeBounds(int32 id, FIntVector& out_min_coordinates, int32& out_size) const;
+
+	// Gets the center of a search graph node, in cells
+	FVector GetGraphNodeCenter(int32 id) const;
+
+	/**
+	* Finds the shortest path through the search graph between the nodes containing two cells.
+	* @param	start				The cell to start from
+	* @param	end					The cell to reach
+	* @param	min_shared_axes		The minimum number of axes two touching nodes must share to be neighbors
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The id of every search graph node along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	bool FindPath(const FIntVector& start, const FIntVector& end, int32 min_shared_axes, NavSearchContext& context, std::vector<int32>& out_path) const;
+
+	// Gets the number of bytes used by the nodes and leaves
+	SIZE_T GetAllocatedSize() const;
+
+private:
+	// Helper function building a node and its children
+	void BuildNode(const NavOctreeBuildContext& build, int32 node_index, const FIntVector& min_coordinates, int32 level, int32 previous_index);
+
+	// Helper function storing the occupancy of the cells of a 4x4x4 node
+	void BuildLeaf(const NavOctreeBuildContext& build, int32 node_index, const FIntVector& min_coordinates);
+
+	// Helper function copying a node and its children from the previous octree
+	void CopyNode(const NavSparseOctree& previous, int32 node_index, int32 previous_index);
+
+	/**
+	* Calls a function for each search graph node overlapping a box of cells.
+	* @param	min_coordinates		The minimum cell of the box
+	* @param	max_coordinates		The maximum cell of the box, inclusive
+	* @param	func				Called as func(int32 id, const FIntVector& min_coordinates, int32 size)
+	*/
+	template<typename FuncType>
+	void ForEachGraphNodeInBox(const FIntVector& min_coordinates, const FIntVector& max_coordinates, FuncType&& func) const;
+
+	// The number of cells along each axis of the grid
+	FIntVector Divisions = FIntVector::ZeroValue;
+
+	// The level of the root node
+	int32 RootLevel = 0;
+
+	// The nodes, starting with the root
+	std::vector<NavOctreeNode> Nodes;
+
+	// The cells of the leaf nodes
+	std::vector<NavOctreeLeaf> Leaves;
+};
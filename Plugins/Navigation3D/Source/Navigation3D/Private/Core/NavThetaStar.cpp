@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavThetaStar.h"
+#include "NavGrid.h"
+#include "NavLineOfSight.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+
+namespace
+{
+	// Gets the distance between two cells
+	FORCEINLINE float GetDistance(const FIntVector& a, const FIntVector& b)
+	{
+		return FVector::Distance(FVector(a), FVector(b));
+	}
+}
+
+bool NavThetaStar::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, bool lazy, NavSearchContext& context, std::vector<int32>& out_path)
+{
+	NAV_TRACE_SCOPE(NavThetaStar::FindPath);
+
+	out_path.clear();
+	context.Reset(grid.Num());
+
+	const FIntVector endCoordinates = grid.GetCoordinates(end_index);
+	context.Open(start_index, INDEX_NONE, 0.0f, GetDistance(grid.GetCoordinates(start_index), endCoordinates));
+
+	while (context.IsOpenEmpty() == false)
+	{
+		const int32 current = context.PopOpen();
+		const FIntVector currentCoordinates = grid.GetCoordinates(current);
+
+		// Lazy Theta* assumed the parent could see the cell, fall back to the best expanded neighbor when it can't. The neighbor
+		// the cell was reached from is expanded, so there is always one, and moving from it is a grid move even without line of sight.
+		if (lazy)
+		{
+			const int32 parent = context.GetParent(current);
+			if (parent != INDEX_NONE && NavLineOfSight::HasLineOfSight(grid, occupancy, parent, current) == false)
+			{
+				int32 bestNeighbor = INDEX_NONE;
+				float bestGScore = FLT_MAX;
+				grid.ForEachNeighbor(currentCoordinates, [&](int32 neighbor, int32)
+				{
+					if (context.IsClosed(neighbor) == false || neighbor == current)
+						return;
+
+					const float gScore = context.GetGScore(neighbor) + GetDistance(grid.GetCoordinates(neighbor), currentCoordinates);
+					if (gScore < bestGScore)
+					{
+						bestNeighbor = neighbor;
+						bestGScore = gScore;
+					}
+				});
+				context.SetParent(current, bestNeighbor, bestGScore);
+			}
+		}
+
+		if (current == end_index)
+		{
+			// Rebuild the path from the end, then flip it
+			for (int32 node = current; node != INDEX_NONE; node = context.GetParent(node))
+			{
+				out_path.push_back(node);
+			}
+			std::reverse(out_path.begin(), out_path.end());
+			return true;
+		}
+
+		const int32 currentParent = context.GetParent(current);
+		const FIntVector parentCoordinates = currentParent != INDEX_NONE ? grid.GetCoordinates(currentParent) : currentCoordinates;
+		const float currentGScore = context.GetGScore(current);
+		const float parentGScore = currentParent != INDEX_NONE ? context.GetGScore(currentParent) : currentGScore;
+
+		grid.ForEachNeighbor(currentCoordinates, [&](int32 neighbor, int32)
+		{
+			if (context.IsClosed(neighbor) || occupancy.IsBlocked(neighbor))
+				return;
+
+			const FIntVector neighborCoordinates = grid.GetCoordinates(neighbor);
+
+			// Go straight from the parent when it can see the neighbor (always assumed by Lazy Theta*), otherwise through the cell
+			int32 parent = current;
+			float tentative_gScore = currentGScore + GetDistance(currentCoordinates, neighborCoordinates);
+			if (currentParent != INDEX_NONE && (lazy || NavLineOfSight::HasLineOfSight(grid, occupancy, currentParent, neighbor)))
+			{
+				parent = currentParent;
+				tentative_gScore = parentGScore + GetDistance(parentCoordinates, neighborCoordinates);
+			}
+
+			if (tentative_gScore < context.GetGScore(neighbor))
+			{
+				context.Open(neighbor, parent, tentative_gScore, tentative_gScore + GetDistance(neighborCoordinates, endCoordinates));
+			}
+		});
+	}
+
+	// Failed to find path
+	return false;
+}
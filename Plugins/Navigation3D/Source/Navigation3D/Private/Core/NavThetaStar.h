@@ -0,0 +1,33 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+class NavSearchContext;
+
+/**
+* Theta*, an any-angle variant of A* over the grid. A reached cell takes the parent of the cell it was reached from when
+* the two have line of sight, so paths go straight between the cells where they bend instead of following the grid moves.
+* Lazy Theta* assumes line of sight when a cell is reached and only checks it once the cell is expanded, falling back to the
+* best expanded neighbor when it's missing, which trades a few slightly longer paths for one line of sight test per expansion.
+*/
+class NavThetaStar
+{
+public:
+	/**
+	* Finds a short any-angle path between two cells.
+	* @param	grid				The grid to search
+	* @param	occupancy			The occupancy of the grid
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	lazy				Whether line of sight is only checked when a cell is expanded (Lazy Theta*)
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The flat index of every waypoint along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	static bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, bool lazy, NavSearchContext& context, std::vector<int32>& out_path);
+};
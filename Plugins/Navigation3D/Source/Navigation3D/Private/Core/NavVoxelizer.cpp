@@ -0,0 +1,456 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavVoxelizer.h"
+#include "NavOccupancy.h"
+#include "NavSimd.h"
+#include <cmath>
+
+namespace
+{
+	// The number of slabs the grid is split into when it has enough layers, enough to keep every worker busy
+	constexpr int32 TargetSlabCount = 64;
+
+	// A position or direction in float, whatever the precision of FVector
+	struct NavVoxelVector
+	{
+		float X;
+		float Y;
+		float Z;
+
+		NavVoxelVector() {}
+		NavVoxelVector(float x, float y, float z) : X(x), Y(y), Z(z) {}
+		explicit NavVoxelVector(const FVector& vector) : X(static_cast<float>(vector.X)), Y(static_cast<float>(vector.Y)), Z(static_cast<float>(vector.Z)) {}
+
+		NavVoxelVector operator+(const NavVoxelVector& other) const { return NavVoxelVector(X + other.X, Y + other.Y, Z + other.Z); }
+		NavVoxelVector operator-(const NavVoxelVector& other) const { return NavVoxelVector(X - other.X, Y - other.Y, Z - other.Z); }
+		NavVoxelVector operator*(float scale) const { return NavVoxelVector(X * scale, Y * scale, Z * scale); }
+		FVector ToVector() const { return FVector(X, Y, Z); }
+	};
+
+	FORCEINLINE float Dot(const NavVoxelVector& a, const NavVoxelVector& b)
+	{
+		return (a.X * b.X) + (a.Y * b.Y) + (a.Z * b.Z);
+	}
+
+	FORCEINLINE NavVoxelVector Cross(const NavVoxelVector& a, const NavVoxelVector& b)
+	{
+		return NavVoxelVector((a.Y * b.Z) - (a.Z * b.Y), (a.Z * b.X) - (a.X * b.Z), (a.X * b.Y) - (a.Y * b.X));
+	}
+
+	FORCEINLINE NavVoxelVector Abs(const NavVoxelVector& a)
+	{
+		return NavVoxelVector(std::fabs(a.X), std::fabs(a.Y), std::fabs(a.Z));
+	}
+
+	// Gets a plane through a point, or false if the normal is degenerate
+	bool MakePlane(const NavVoxelVector& normal, const NavVoxelVector& point, NavPlane& out_plane)
+	{
+		const float length = std::sqrt(Dot(normal, normal));
+		if (length < 1.e-8f)
+			return false;
+
+		const NavVoxelVector unitNormal = normal * (1.0f / length);
+		out_plane.Normal = unitNormal.ToVector();
+		out_plane.Distance = Dot(unitNormal, point);
+		return true;
+	}
+
+	// The four lanes of cell centers along a row of the grid and the half extent of the box tested around them
+	struct NavCellLanes
+	{
+		NavFloat4 X;
+		float Y;
+		float Z;
+		NavVoxelVector HalfExtent;
+	};
+
+	// Checks which boxes overlap a shape along a separating axis candidate, from the projections of the shape onto the axis
+	// relative to each box center
+	FORCEINLINE NavMask4 OverlapsOnAxis(const NavFloat4& min_projection, const NavFloat4& max_projection, const NavVoxelVector& axis, const NavVoxelVector& half_extent)
+	{
+		const NavFloat4 radius = NavSet4(Dot(Abs(axis), half_extent));
+		return NavLessEqual4(min_projection, radius) & NavLessEqual4(NavSet4(0.0f) - radius, max_projection);
+	}
+
+	uint32 TestSphere(const NavVoxelShapes::Sphere& sphere, const NavCellLanes& cells)
+	{
+		const NavVoxelVector center(sphere.Center);
+		const NavFloat4 zero = NavSet4(0.0f);
+
+		// The distance from the center to the closest point of each box, per axis
+		const NavFloat4 dx = NavMax4(NavAbs4(NavSet4(center.X) - cells.X) - NavSet4(cells.HalfExtent.X), zero);
+		const float dy = FMath::Max(std::fabs(center.Y - cells.Y) - cells.HalfExtent.Y, 0.0f);
+		const float dz = FMath::Max(std::fabs(center.Z - cells.Z) - cells.HalfExtent.Z, 0.0f);
+		return NavMaskBits4(NavLessEqual4((dx * dx) + NavSet4((dy * dy) + (dz * dz)), NavSet4(sphere.Radius * sphere.Radius)));
+	}
+
+	// Tests the segment against each box grown by the radius, which contains every point within the radius of the box
+	uint32 TestCapsule(const NavVoxelShapes::Capsule& capsule, const NavCellLanes& cells)
+	{
+		const NavVoxelVector a(capsule.A);
+		const NavVoxelVector direction = NavVoxelVector(capsule.B) - a;
+		const NavVoxelVector extent = cells.HalfExtent + NavVoxelVector(capsule.Radius, capsule.Radius, capsule.Radius);
+
+		const NavFloat4 centers[3] = { cells.X, NavSet4(cells.Y), NavSet4(cells.Z) };
+		const float starts[3] = { a.X, a.Y, a.Z };
+		const float directions[3] = { direction.X, direction.Y, direction.Z };
+		const float extents[3] = { extent.X, extent.Y, extent.Z };
+
+		NavFloat4 tMin = NavSet4(0.0f);
+		NavFloat4 tMax = NavSet4(1.0f);
+		NavMask4 overlaps = NavLessEqual4(tMin, tMax);
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			const NavFloat4 low = centers[axis] - NavSet4(extents[axis]);
+			const NavFloat4 high = centers[axis] + NavSet4(extents[axis]);
+			const NavFloat4 start = NavSet4(starts[axis]);
+			if (std::fabs(directions[axis]) < 1.e-6f)
+			{
+				// Parallel to the slab, the segment has to start inside it
+				overlaps = overlaps & NavLessEqual4(low, start) & NavLessEqual4(start, high);
+				continue;
+			}
+
+			const NavFloat4 inverse = NavSet4(1.0f / directions[axis]);
+			const NavFloat4 t1 = (low - start) * inverse;
+			const NavFloat4 t2 = (high - start) * inverse;
+			tMin = NavMax4(tMin, NavMin4(t1, t2));
+			tMax = NavMin4(tMax, NavMax4(t1, t2));
+		}
+		return NavMaskBits4(overlaps & NavLessEqual4(tMin, tMax));
+	}
+
+	// Only tests the planes of the hull (its bounds are tested by the caller), which may keep a few boxes that are near
+	// an edge of the hull without touching it
+	uint32 TestConvex(const NavVoxelShapes::Convex& convex, const NavCellLanes& cells)
+	{
+		NavMask4 overlaps = NavLessEqual4(NavSet4(0.0f), NavSet4(0.0f));
+		for (const NavPlane& plane : convex.Planes)
+		{
+			const NavVoxelVector normal(plane.Normal);
+
+			// The box is outside when its center is in front of the plane by more than its projected half extent
+			const NavFloat4 distance = (NavSet4(normal.X) * cells.X) + NavSet4((normal.Y * cells.Y) + (normal.Z * cells.Z) - plane.Distance);
+			overlaps = overlaps & NavLessEqual4(distance, NavSet4(Dot(Abs(normal), cells.HalfExtent)));
+			if (NavMaskBits4(overlaps) == 0)
+				return 0;
+		}
+		return NavMaskBits4(overlaps);
+	}
+
+	// The separating axis test of Akenine-Moller: the cross products of the box axes and the triangle edges, then the triangle
+	// plane. The box axes are covered by the triangle bounds tested by the caller.
+	uint32 TestTriangle(const NavVoxelShapes::Triangle& triangle, const NavCellLanes& cells)
+	{
+		const NavVoxelVector vertices[3] = { NavVoxelVector(triangle.Vertices[0]), NavVoxelVector(triangle.Vertices[1]), NavVoxelVector(triangle.Vertices[2]) };
+
+		// The vertices relative to each cell center
+		NavFloat4 x[3];
+		float y[3];
+		float z[3];
+		for (int32 i = 0; i < 3; ++i)
+		{
+			x[i] = NavSet4(vertices[i].X) - cells.X;
+			y[i] = vertices[i].Y - cells.Y;
+			z[i] = vertices[i].Z - cells.Z;
+		}
+
+		auto testAxis = [&](const NavVoxelVector& axis)
+		{
+			const NavFloat4 p0 = (NavSet4(axis.X) * x[0]) + NavSet4((axis.Y * y[0]) + (axis.Z * z[0]));
+			const NavFloat4 p1 = (NavSet4(axis.X) * x[1]) + NavSet4((axis.Y * y[1]) + (axis.Z * z[1]));
+			const NavFloat4 p2 = (NavSet4(axis.X) * x[2]) + NavSet4((axis.Y * y[2]) + (axis.Z * z[2]));
+			return OverlapsOnAxis(NavMin4(NavMin4(p0, p1), p2), NavMax4(NavMax4(p0, p1), p2), axis, cells.HalfExtent);
+		};
+
+		const NavVoxelVector edges[3] = { vertices[1] - vertices[0], vertices[2] - vertices[1], vertices[0] - vertices[2] };
+		NavMask4 overlaps = testAxis(Cross(edges[0], edges[1]));
+		for (int32 i = 0; i < 3 && NavMaskBits4(overlaps) != 0; ++i)
+		{
+			const NavVoxelVector& edge = edges[i];
+			overlaps = overlaps & testAxis(NavVoxelVector(0.0f, -edge.Z, edge.Y));
+			overlaps = overlaps & testAxis(NavVoxelVector(edge.Z, 0.0f, -edge.X));
+			overlaps = overlaps & testAxis(NavVoxelVector(-edge.Y, edge.X, 0.0f));
+		}
+		return NavMaskBits4(overlaps);
+	}
+
+	// Gets the bounds of each kind of shape
+	void GetBounds(const NavVoxelShapes::Sphere& sphere, NavVoxelVector& out_min, NavVoxelVector& out_max)
+	{
+		const NavVoxelVector radius(sphere.Radius, sphere.Radius, sphere.Radius);
+		out_min = NavVoxelVector(sphere.Center) - radius;
+		out_max = NavVoxelVector(sphere.Center) + radius;
+	}
+
+	void GetBounds(const NavVoxelShapes::Capsule& capsule, NavVoxelVector& out_min, NavVoxelVector& out_max)
+	{
+		const NavVoxelVector a(capsule.A);
+		const NavVoxelVector b(capsule.B);
+		const NavVoxelVector radius(capsule.Radius, capsule.Radius, capsule.Radius);
+		out_min = NavVoxelVector(FMath::Min(a.X, b.X), FMath::Min(a.Y, b.Y), FMath::Min(a.Z, b.Z)) - radius;
+		out_max = NavVoxelVector(FMath::Max(a.X, b.X), FMath::Max(a.Y, b.Y), FMath::Max(a.Z, b.Z)) + radius;
+	}
+
+	void GetBounds(const NavVoxelShapes::Convex& convex, NavVoxelVector& out_min, NavVoxelVector& out_max)
+	{
+		out_min = NavVoxelVector(convex.Min);
+		out_max = NavVoxelVector(convex.Max);
+	}
+
+	void GetBounds(const NavVoxelShapes::Triangle& triangle, NavVoxelVector& out_min, NavVoxelVector& out_max)
+	{
+		out_min = out_max = NavVoxelVector(triangle.Vertices[0]);
+		for (int32 i = 1; i < 3; ++i)
+		{
+			const NavVoxelVector vertex(triangle.Vertices[i]);
+			out_min = NavVoxelVector(FMath::Min(out_min.X, vertex.X), FMath::Min(out_min.Y, vertex.Y), FMath::Min(out_min.Z, vertex.Z));
+			out_max = NavVoxelVector(FMath::Max(out_max.X, vertex.X), FMath::Max(out_max.Y, vertex.Y), FMath::Max(out_max.Z, vertex.Z));
+		}
+	}
+
+	// The range of cells whose boxes overlap the bounds of a shape, or false if there are none
+	bool GetCellRange(const NavVoxelVector& min, const NavVoxelVector& max, const NavVoxelVector& half_extent, const FIntVector& divisions, FIntVector& out_min, FIntVector& out_max)
+	{
+		const float mins[3] = { min.X, min.Y, min.Z };
+		const float maxs[3] = { max.X, max.Y, max.Z };
+		const float extents[3] = { half_extent.X, half_extent.Y, half_extent.Z };
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			// Cell c overlaps when c + 0.5 - extent <= max and c + 0.5 + extent >= min
+			out_min[axis] = FMath::Max(static_cast<int32>(std::ceil(mins[axis] - 0.5f - extents[axis])), 0);
+			out_max[axis] = FMath::Min(static_cast<int32>(std::floor(maxs[axis] - 0.5f + extents[axis])), divisions[axis] - 1);
+			if (out_min[axis] > out_max[axis])
+				return false;
+		}
+		return true;
+	}
+
+	// Sets the bits of the cells of a Z range overlapped by a shape, testing the cells of each row four at a time
+	template<typename ShapeType, typename TestFuncType>
+	void RasterizeShape(const ShapeType& shape, TestFuncType test, const FIntVector& divisions, int32 min_z, int32 max_z, const NavVoxelVector& half_extent, uint32* words)
+	{
+		NavVoxelVector boundsMin;
+		NavVoxelVector boundsMax;
+		GetBounds(shape, boundsMin, boundsMax);
+
+		FIntVector cellMin;
+		FIntVector cellMax;
+		if (GetCellRange(boundsMin, boundsMax, half_extent, divisions, cellMin, cellMax) == false)
+			return;
+
+		NavCellLanes cells;
+		cells.HalfExtent = half_extent;
+		for (int32 z = FMath::Max(cellMin.Z, min_z); z <= FMath::Min(cellMax.Z, max_z); ++z)
+		{
+			cells.Z = z + 0.5f;
+			for (int32 y = cellMin.Y; y <= cellMax.Y; ++y)
+			{
+				cells.Y = y + 0.5f;
+				const int32 rowIndex = (z * divisions.X * divisions.Y) + (y * divisions.X);
+				for (int32 x = cellMin.X; x <= cellMax.X; x += 4)
+				{
+					cells.X = NavSet4(x + 0.5f, x + 1.5f, x + 2.5f, x + 3.5f);
+
+					// Drop the lanes past the end of the range
+					const uint32 laneMask = (1u << FMath::Min(cellMax.X - x + 1, 4)) - 1u;
+					uint32 overlaps = test(shape, cells) & laneMask;
+					while (overlaps != 0)
+					{
+						const int32 index = rowIndex + x + static_cast<int32>(FMath::CountTrailingZeros(overlaps));
+						words[index >> 5] |= 1u << (index & 31);
+						overlaps &= overlaps - 1u;
+					}
+				}
+			}
+		}
+	}
+
+	// Gets the range of slabs a shape overlaps, or false if it's outside the grid
+	template<typename ShapeType>
+	bool GetSlabRange(const ShapeType& shape, const FIntVector& divisions, const NavVoxelVector& half_extent, int32 slab_layers, int32& out_first, int32& out_last)
+	{
+		NavVoxelVector boundsMin;
+		NavVoxelVector boundsMax;
+		GetBounds(shape, boundsMin, boundsMax);
+
+		FIntVector cellMin;
+		FIntVector cellMax;
+		if (GetCellRange(boundsMin, boundsMax, half_extent, divisions, cellMin, cellMax) == false)
+			return false;
+
+		out_first = cellMin.Z / slab_layers;
+		out_last = cellMax.Z / slab_layers;
+		return true;
+	}
+
+	// The shapes overlapping a slab, by index into the shape arrays
+	struct NavSlabShapes
+	{
+		std::vector<int32> Spheres;
+		std::vector<int32> Capsules;
+		std::vector<int32> Convexes;
+		std::vector<int32> Triangles;
+	};
+
+	template<typename ShapeType>
+	void AddToSlabs(const std::vector<ShapeType>& shapes, std::vector<int32> NavSlabShapes::* list, const FIntVector& divisions, const NavVoxelVector& half_extent, int32 slab_layers, std::vector<NavSlabShapes>& slabs)
+	{
+		for (int32 i = 0; i < static_cast<int32>(shapes.size()); ++i)
+		{
+			int32 first;
+			int32 last;
+			if (GetSlabRange(shapes[i], divisions, half_extent, slab_layers, first, last))
+			{
+				for (int32 slab = first; slab <= last; ++slab)
+				{
+					(slabs[slab].*list).push_back(i);
+				}
+			}
+		}
+	}
+}
+
+void NavVoxelShapes::AddBox(const FVector& center, const FVector& half_axis_x, const FVector& half_axis_y, const FVector& half_axis_z)
+{
+	const NavVoxelVector c(center);
+	const NavVoxelVector axes[3] = { NavVoxelVector(half_axis_x), NavVoxelVector(half_axis_y), NavVoxelVector(half_axis_z) };
+
+	Convex convex;
+	for (int32 i = 0; i < 3; ++i)
+	{
+		// The normal of the faces at the ends of an axis is perpendicular to the two other axes
+		NavVoxelVector normal = Cross(axes[(i + 1) % 3], axes[(i + 2) % 3]);
+		if (Dot(normal, axes[i]) < 0.0f)
+		{
+			normal = normal * -1.0f;
+		}
+
+		NavPlane plane;
+		if (MakePlane(normal, c + axes[i], plane))
+		{
+			convex.Planes.push_back(plane);
+		}
+		if (MakePlane(normal * -1.0f, c - axes[i], plane))
+		{
+			convex.Planes.push_back(plane);
+		}
+	}
+
+	const NavVoxelVector extent = Abs(axes[0]) + Abs(axes[1]) + Abs(axes[2]);
+	convex.Min = (c - extent).ToVector();
+	convex.Max = (c + extent).ToVector();
+	Convexes.push_back(convex);
+}
+
+void NavVoxelShapes::AddConvex(const std::vector<FVector>& vertices, const std::vector<int32>& triangle_indices)
+{
+	if (vertices.empty())
+		return;
+
+	Convex convex;
+	NavVoxelVector min(vertices[0]);
+	NavVoxelVector max(vertices[0]);
+	NavVoxelVector centroid(0.0f, 0.0f, 0.0f);
+	for (const FVector& vertex : vertices)
+	{
+		const NavVoxelVector v(vertex);
+		min = NavVoxelVector(FMath::Min(min.X, v.X), FMath::Min(min.Y, v.Y), FMath::Min(min.Z, v.Z));
+		max = NavVoxelVector(FMath::Max(max.X, v.X), FMath::Max(max.Y, v.Y), FMath::Max(max.Z, v.Z));
+		centroid = centroid + v;
+	}
+	centroid = centroid * (1.0f / vertices.size());
+
+	// Face the plane of each triangle away from the inside of the hull, whatever the winding of the triangles
+	for (size_t i = 0; i + 2 < triangle_indices.size(); i += 3)
+	{
+		const NavVoxelVector a(vertices[triangle_indices[i]]);
+		const NavVoxelVector b(vertices[triangle_indices[i + 1]]);
+		const NavVoxelVector c(vertices[triangle_indices[i + 2]]);
+		NavVoxelVector normal = Cross(b - a, c - a);
+		if (Dot(normal, centroid - a) > 0.0f)
+		{
+			normal = normal * -1.0f;
+		}
+
+		NavPlane plane;
+		if (MakePlane(normal, a, plane))
+		{
+			convex.Planes.push_back(plane);
+		}
+	}
+
+	convex.Min = min.ToVector();
+	convex.Max = max.ToVector();
+	Convexes.push_back(convex);
+}
+
+void NavVoxelShapes::AddTriangleMesh(const std::vector<FVector>& vertices, const std::vector<int32>& triangle_indices)
+{
+	Triangles.reserve(Triangles.size() + (triangle_indices.size() / 3));
+	for (size_t i = 0; i + 2 < triangle_indices.size(); i += 3)
+	{
+		Triangles.push_back(Triangle{ { vertices[triangle_indices[i]], vertices[triangle_indices[i + 1]], vertices[triangle_indices[i + 2]] } });
+	}
+}
+
+void NavVoxelizer::Voxelize(const FIntVector& divisions, const NavVoxelShapes& shapes, const FVector& cell_half_extent, NavOccupancy& occupancy, const ParallelForFuncType& parallel_for)
+{
+	NAV_TRACE_SCOPE(NavVoxelizer::Voxelize);
+
+	if (shapes.IsEmpty() || occupancy.Num() != divisions.X * divisions.Y * divisions.Z)
+		return;
+
+	const NavVoxelVector halfExtent(cell_half_extent);
+
+	// Every slab holds at least 32 cells, so an occupancy word never spans more than two neighboring slabs
+	const int32 layerCells = divisions.X * divisions.Y;
+	const int32 minSlabLayers = (32 + layerCells - 1) / layerCells;
+	const int32 slabLayers = FMath::Max(minSlabLayers, (divisions.Z + TargetSlabCount - 1) / TargetSlabCount);
+	const int32 slabCount = (divisions.Z + slabLayers - 1) / slabLayers;
+
+	std::vector<NavSlabShapes> slabs(slabCount);
+	AddToSlabs(shapes.Spheres, &NavSlabShapes::Spheres, divisions, halfExtent, slabLayers, slabs);
+	AddToSlabs(shapes.Capsules, &NavSlabShapes::Capsules, divisions, halfExtent, slabLayers, slabs);
+	AddToSlabs(shapes.Convexes, &NavSlabShapes::Convexes, divisions, halfExtent, slabLayers, slabs);
+	AddToSlabs(shapes.Triangles, &NavSlabShapes::Triangles, divisions, halfExtent, slabLayers, slabs);
+
+	uint32* words = occupancy.GetMutableWords();
+	auto rasterizeSlab = [&](int32 slab)
+	{
+		const NavSlabShapes& slabShapes = slabs[slab];
+		const int32 minZ = slab * slabLayers;
+		const int32 maxZ = FMath::Min(minZ + slabLayers, divisions.Z) - 1;
+		for (const int32 i : slabShapes.Spheres)
+			RasterizeShape(shapes.Spheres[i], TestSphere, divisions, minZ, maxZ, halfExtent, words);
+		for (const int32 i : slabShapes.Capsules)
+			RasterizeShape(shapes.Capsules[i], TestCapsule, divisions, minZ, maxZ, halfExtent, words);
+		for (const int32 i : slabShapes.Convexes)
+			RasterizeShape(shapes.Convexes[i], TestConvex, divisions, minZ, maxZ, halfExtent, words);
+		for (const int32 i : slabShapes.Triangles)
+			RasterizeShape(shapes.Triangles[i], TestTriangle, divisions, minZ, maxZ, halfExtent, words);
+	};
+
+	// Even slabs, then odd slabs, so no two slabs writing the same word run at once
+	for (int32 parity = 0; parity < 2; ++parity)
+	{
+		const int32 count = (slabCount - parity + 1) / 2;
+		auto body = [&](int32 index)
+		{
+			rasterizeSlab((index * 2) + parity);
+		};
+
+		if (parallel_for)
+		{
+			parallel_for(count, body);
+		}
+		else
+		{
+			for (int32 index = 0; index < count; ++index)
+			{
+				body(index);
+			}
+		}
+	}
+}
@@ -0,0 +1,92 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <functional>
+#include <vector>
+
+class NavOccupancy;
+
+// A plane as its normal and its distance from the origin along the normal. Points with Dot(Normal, p) > Distance are in front.
+struct NavPlane
+{
+	FVector Normal;
+	float Distance;
+};
+
+/**
+* Collision geometry in the grid space of a volume, measured in cells: cell (x, y, z) spans [x, x + 1] along X, and so on.
+* Boxes and convex hulls are solids, triangles only block the cells they pass through, as with physics overlap queries
+* against triangle meshes.
+*/
+struct NavVoxelShapes
+{
+	struct Sphere
+	{
+		FVector Center;
+		float Radius;
+	};
+
+	// The points within Radius of the segment from A to B
+	struct Capsule
+	{
+		FVector A;
+		FVector B;
+		float Radius;
+	};
+
+	// The intersection of the back sides of its planes, with the bounds of its vertices
+	struct Convex
+	{
+		std::vector<NavPlane> Planes;
+		FVector Min;
+		FVector Max;
+	};
+
+	struct Triangle
+	{
+		FVector Vertices[3];
+	};
+
+	std::vector<Sphere> Spheres;
+	std::vector<Capsule> Capsules;
+	std::vector<Convex> Convexes;
+	std::vector<Triangle> Triangles;
+
+	// Adds a box, or a parallelepiped under non uniform scale, from its center and the half extent vectors along its three edges
+	void AddBox(const FVector& center, const FVector& half_axis_x, const FVector& half_axis_y, const FVector& half_axis_z);
+
+	// Adds a convex hull from its vertices and the triangles of its surface, as three vertex indices each
+	void AddConvex(const std::vector<FVector>& vertices, const std::vector<int32>& triangle_indices);
+
+	// Adds every triangle of a mesh, as three vertex indices each
+	void AddTriangleMesh(const std::vector<FVector>& vertices, const std::vector<int32>& triangle_indices);
+
+	// Checks if there are no shapes
+	FORCEINLINE bool IsEmpty() const { return Spheres.empty() && Capsules.empty() && Convexes.empty() && Triangles.empty(); }
+};
+
+/**
+* Rasterizes collision geometry into an occupancy bitfield. A cell is blocked when a shape overlaps the box of the specified
+* half extent around its center, tested four cells at a time with SIMD separating axis tests. Capsules and convex hulls are
+* tested conservatively, so they may block a few extra cells around their edges, but never miss one. The grid is split into
+* slabs of Z layers searched in parallel: the even slabs first, then the odd ones, so slabs sharing an occupancy word never
+* run at the same time.
+*/
+class NavVoxelizer
+{
+public:
+	// Runs body(index) for every index in [0, count), possibly in parallel, returning once every call has returned
+	using ParallelForFuncType = std::function<void(int32 count, const std::function<void(int32 index)>& body)>;
+
+	/**
+	* Sets the bit of every cell overlapped by a shape. Bits already set are kept.
+	* @param	divisions			The number of cells along each axis of the grid
+	* @param	shapes				The shapes to rasterize, in grid space
+	* @param	cell_half_extent	The half extent of the box tested around each cell center, in cells (0.5 tests the cell itself)
+	* @param	occupancy			The occupancy of the grid to set the bits of
+	* @param	parallel_for		Runs the slabs in parallel (optional, they run one after another otherwise)
+	*/
+	static void Voxelize(const FIntVector& divisions, const NavVoxelShapes& shapes, const FVector& cell_half_extent, NavOccupancy& occupancy, const ParallelForFuncType& parallel_for = nullptr);
+};
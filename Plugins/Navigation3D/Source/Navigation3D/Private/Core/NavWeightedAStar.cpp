@@ -0,0 +1,127 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavWeightedAStar.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include "NavSearchContext.h"
+#include <algorithm>
+#include <chrono>
+
+namespace
+{
+	// Gets a steady time in seconds, for the time budget of the anytime search
+	double GetSeconds()
+	{
+		return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// The number of expansions between two checks of the time budget
+	constexpr int32 TimeCheckInterval = 64;
+
+	// Weights closer to 1 than this are rounded down to 1, the last searches would only shave rounding errors off the path
+	constexpr float MinWeightStep = 0.05f;
+}
+
+bool NavWeightedAStar::FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float weight, NavSearchContext& context, std::vector<int32>& out_path)
+{
+	NAV_TRACE_SCOPE(NavWeightedAStar::FindPath);
+
+	float cost = 0.0f;
+	int32 expanded = 0;
+	return Search(grid, occupancy, start_index, end_index, FMath::Max(weight, 1.0f), FLT_MAX, 0, 0.0, context, out_path, cost, expanded) == ESearchResult::Found;
+}
+
+bool NavWeightedAStar::FindPathAnytime(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float initial_weight, int32 max_expansions, double max_seconds,
+	NavSearchContext& context, std::vector<int32>& out_path, float& out_weight)
+{
+	NAV_TRACE_SCOPE(NavWeightedAStar::FindPathAnytime);
+
+	out_path.clear();
+	out_weight = FLT_MAX;
+	const double deadline = max_seconds > 0.0 ? GetSeconds() + max_seconds : 0.0;
+
+	float bestCost = FLT_MAX;
+	int32 expandedNum = 0;
+	std::vector<int32> path;
+	for (float weight = FMath::Max(initial_weight, 1.0f);; weight = (weight - 1.0f) * 0.5f < MinWeightStep ? 1.0f : 1.0f + ((weight - 1.0f) * 0.5f))
+	{
+		// Each search only has what's left of the budget
+		int32 remainingExpansions = 0;
+		if (max_expansions > 0)
+		{
+			remainingExpansions = max_expansions - expandedNum;
+			if (remainingExpansions <= 0)
+				break;
+		}
+
+		float cost = 0.0f;
+		int32 expanded = 0;
+		const ESearchResult result = Search(grid, occupancy, start_index, end_index, weight, bestCost, remainingExpansions, deadline, context, path, cost, expanded);
+		expandedNum += expanded;
+		if (result == ESearchResult::OutOfBudget)
+			break;
+
+		// Not finding anything shorter than the best path with this weight bounds it all the same
+		if (result == ESearchResult::Found)
+		{
+			bestCost = cost;
+			out_path.swap(path);
+		}
+		out_weight = weight;
+
+		// Without a first path there's nothing to improve, the cells can't reach each other
+		if (weight <= 1.0f || bestCost == FLT_MAX)
+			break;
+	}
+	return out_path.empty() == false;
+}
+
+NavWeightedAStar::ESearchResult NavWeightedAStar::Search(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float weight, float cost_bound, int32 max_expansions, double deadline,
+	NavSearchContext& context, std::vector<int32>& out_path, float& out_cost, int32& out_expanded)
+{
+	out_path.clear();
+	out_expanded = 0;
+	context.Reset(grid.Num());
+
+	const FVector endLocation(grid.GetCoordinates(end_index));
+	context.Open(start_index, INDEX_NONE, 0.0f, weight * FVector::Distance(endLocation, FVector(grid.GetCoordinates(start_index))));
+
+	while (context.IsOpenEmpty() == false)
+	{
+		if ((max_expansions > 0 && out_expanded >= max_expansions) || (deadline > 0.0 && (out_expanded % TimeCheckInterval) == 0 && GetSeconds() >= deadline))
+			return ESearchResult::OutOfBudget;
+
+		const int32 current = context.PopOpen();
+		++out_expanded;
+		if (current == end_index)
+		{
+			out_cost = context.GetGScore(current);
+			for (int32 node = current; node != INDEX_NONE; node = context.GetParent(node))
+			{
+				out_path.push_back(node);
+			}
+			std::reverse(out_path.begin(), out_path.end());
+			return ESearchResult::Found;
+		}
+
+		const float currentGScore = context.GetGScore(current);
+		grid.ForEachNeighbor(grid.GetCoordinates(current), [&](int32 neighbor, int32 offsetIndex)
+		{
+			if (context.IsClosed(neighbor))
+				return;
+
+			const float tentativeGScore = currentGScore + NavNeighborDistances[offsetIndex];
+			if (tentativeGScore >= context.GetGScore(neighbor) || occupancy.IsBlocked(neighbor))
+				return;
+
+			// The unweighted heuristic never overestimates, cells that can't beat the best path so far are left out
+			const float h = FVector::Distance(endLocation, FVector(grid.GetCoordinates(neighbor)));
+			if (tentativeGScore + h >= cost_bound)
+				return;
+
+			context.Open(neighbor, current, tentativeGScore, tentativeGScore + (weight * h));
+		});
+	}
+	return ESearchResult::NotFound;
+}
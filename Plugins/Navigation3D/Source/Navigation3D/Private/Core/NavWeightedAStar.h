@@ -0,0 +1,65 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include <vector>
+
+class NavGrid;
+class NavOccupancy;
+class NavSearchContext;
+
+/**
+* Bounded suboptimal variants of A* over the cells of the grid, with the same moves and costs as NavAStar. Weighted A* scales
+* the heuristic by a weight of at least one, which heads straight for the end and expands far fewer cells, in exchange for
+* paths up to weight times longer than the shortest. The anytime variant (restarting weighted A*) finds a first path with a
+* high weight, then searches again with lower and lower weights, skipping the cells that can't lead to a shorter path than the
+* best one so far, until the weight reaches one and the path is the shortest or a budget of expanded cells or time runs out.
+*/
+class NavWeightedAStar
+{
+public:
+	/**
+	* Finds a path between two cells at most weight times longer than the shortest.
+	* @param	grid				The grid to search
+	* @param	occupancy			The occupancy of the grid
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	weight				The factor applied to the heuristic, 1 searches like A*
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The flat index of every cell along the path, including the start and the end
+	* @return	Whether a path was found
+	*/
+	static bool FindPath(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float weight, NavSearchContext& context, std::vector<int32>& out_path);
+
+	/**
+	* Finds the shortest path it can between two cells within a budget, improving the path found with a high weight until the
+	* budget runs out. Limits of 0 leave the search unbounded, which always ends with the shortest path.
+	* @param	grid				The grid to search
+	* @param	occupancy			The occupancy of the grid
+	* @param	start_index			The flat index of the cell to start from
+	* @param	end_index			The flat index of the cell to reach
+	* @param	initial_weight		The weight of the first search, halved towards 1 by each of the next ones
+	* @param	max_expansions		The number of cells all the searches may expand together, 0 for no limit
+	* @param	max_seconds			The time all the searches may take together, 0 for no limit
+	* @param	context				The search state to use, reset at the start of each search
+	* @param	out_path			The flat index of every cell along the best path found, including the start and the end
+	* @param	out_weight			The weight of the last search that completed, the path is at most that many times longer than the shortest
+	* @return	Whether a path was found within the budget
+	*/
+	static bool FindPathAnytime(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float initial_weight, int32 max_expansions, double max_seconds,
+		NavSearchContext& context, std::vector<int32>& out_path, float& out_weight);
+
+private:
+	// How a single weighted search ended
+	enum class ESearchResult : uint8
+	{
+		Found,
+		NotFound,
+		OutOfBudget
+	};
+
+	// Helper function running a weighted search that ignores the cells that can't lead to a path shorter than cost_bound
+	static ESearchResult Search(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index, float weight, float cost_bound, int32 max_expansions, double deadline,
+		NavSearchContext& context, std::vector<int32>& out_path, float& out_cost, int32& out_expanded);
+};
@@ -0,0 +1,158 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavPathQueue.h"
+#include "Misc/ScopeLock.h"
+#include "NavStats.h"
+#include "Core/NavSearchContext.h"
+
+NavPathQueue::NavPathQueue(const ANavigationVolume3D* volume)
+	: Volume(volume)
+{
+}
+
+NavPathQueue::~NavPathQueue()
+{
+	Shutdown();
+
+	for (NavSearchContext* context : FreeContexts)
+	{
+		delete context;
+	}
+	FreeContexts.Empty();
+}
+
+int32 NavPathQueue::Submit(const FVector& start, const FVector& destination, int32 priority, const FNavPathQueryDelegate& on_complete)
+{
+	RequestPtr request = MakeShared<Request, ESPMode::ThreadSafe>();
+	request->Id = NextRequestId++;
+	request->Priority = priority;
+	request->Start = start;
+	request->Destination = destination;
+	request->OnComplete = on_complete;
+
+	// Wrap around before running out of positive ids
+	if (NextRequestId == MAX_int32)
+	{
+		NextRequestId = 1;
+	}
+
+	Requests.Add(request->Id, request);
+	PendingHeap.HeapPush(request, RequestCompare());
+	return request->Id;
+}
+
+bool NavPathQueue::Cancel(int32 request_id)
+{
+	RequestPtr request;
+	if (Requests.RemoveAndCopyValue(request_id, request) == false)
+		return false;
+
+	// Pending requests are dropped when they reach the top of the heap and tasks skip them if they haven't been searched yet
+	request->bCancelled = true;
+	return true;
+}
+
+bool NavPathQueue::IsPending(int32 request_id) const
+{
+	return Requests.Contains(request_id);
+}
+
+void NavPathQueue::Tick(int32 max_batch_size, int32 max_concurrent_batches, int32 max_completions)
+{
+	// Hand finished results back to their callers within the per frame budget
+	int32 completions = 0;
+	Result result;
+	while (completions < max_completions && Results.Dequeue(result))
+	{
+		RequestPtr request;
+		if (Requests.RemoveAndCopyValue(result.Id, request))
+		{
+			request->OnComplete.ExecuteIfBound(result.Id, result.bFoundPath, result.Path);
+			++completions;
+		}
+	}
+
+	// Forget the tasks that have finished
+	InFlightBatches.RemoveAll([](const FGraphEventRef& task)
+	{
+		return task->IsComplete();
+	});
+
+	// Dispatch the highest priority requests in batches so each task amortizes its search context over several searches
+	while (InFlightBatches.Num() < max_concurrent_batches && PendingHeap.Num() > 0)
+	{
+		TArray<RequestPtr> batch;
+		while (batch.Num() < max_batch_size && PendingHeap.Num() > 0)
+		{
+			RequestPtr request;
+			PendingHeap.HeapPop(request, RequestCompare(), false);
+			if (request->bCancelled == false)
+			{
+				batch.Add(request);
+			}
+		}
+
+		if (batch.Num() == 0)
+			break;
+
+		InFlightBatches.Add(FFunctionGraphTask::CreateAndDispatchWhenReady([this, batch = MoveTemp(batch)]()
+		{
+			RunBatch(batch);
+		}, TStatId(), nullptr, ENamedThreads::AnyBackgroundThreadNormalTask));
+	}
+}
+
+void NavPathQueue::Shutdown()
+{
+	for (auto& pair : Requests)
+	{
+		pair.Value->bCancelled = true;
+	}
+	Requests.Empty();
+	PendingHeap.Empty();
+
+	// The tasks reference the volume, so they have to finish before it goes away
+	if (InFlightBatches.Num() > 0)
+	{
+		FTaskGraphInterface::Get().WaitUntilTasksComplete(InFlightBatches);
+		InFlightBatches.Empty();
+	}
+	Results.Empty();
+}
+
+void NavPathQueue::RunBatch(const TArray<RequestPtr>& batch)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_AsyncBatch);
+
+	NavSearchContext* context = AcquireContext();
+
+	for (const RequestPtr& request : batch)
+	{
+		if (request->bCancelled)
+			continue;
+
+		Result result;
+		result.Id = request->Id;
+		result.bFoundPath = Volume->FindPathWithContext(request->Start, request->Destination, *context, result.Path);
+		Results.Enqueue(MoveTemp(result));
+	}
+
+	ReleaseContext(context);
+}
+
+NavSearchContext* NavPathQueue::AcquireContext()
+{
+	FScopeLock lock(&ContextLock);
+	if (FreeContexts.Num() > 0)
+	{
+		return FreeContexts.Pop(false);
+	}
+	return new NavSearchContext();
+}
+
+void NavPathQueue::ReleaseContext(NavSearchContext* context)
+{
+	FScopeLock lock(&ContextLock);
+	FreeContexts.Add(context);
+}
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Containers/Queue.h"
+#include "NavigationVolume3D.h"
+#include <atomic>
+
+class NavSearchContext;
+
+// Runs asynchronous path requests in prioritized batches on the task graph and hands the results back on the game thread
+class NavPathQueue
+{
+public:
+	NavPathQueue(const ANavigationVolume3D* volume);
+	~NavPathQueue();
+
+	/**
+	* Queues a path request. The request is searched on a worker thread and its delegate is called from Tick.
+	* @param	start				The world space location to start from
+	* @param	destination			The world space location to reach
+	* @param	priority			Requests with a higher priority are searched first
+	* @param	on_complete			Called on the game thread with the result
+	* @return	The id of the request
+	*/
+	int32 Submit(const FVector& start, const FVector& destination, int32 priority, const FNavPathQueryDelegate& on_complete);
+
+	// Cancels a request. Its delegate won't be called. Returns false if the request already completed or doesn't exist.
+	bool Cancel(int32 request_id);
+
+	// Checks if a request is waiting to be searched or for its delegate to be called
+	bool IsPending(int32 request_id) const;
+
+	/**
+	* Calls the delegates of finished requests and dispatches new batches to the task graph. Must be called on the game thread.
+	* @param	max_batch_size			The maximum number of requests searched by a single task
+	* @param	max_concurrent_batches	The maximum number of tasks in flight at the same time
+	* @param	max_completions			The maximum number of delegates called
+	*/
+	void Tick(int32 max_batch_size, int32 max_concurrent_batches, int32 max_completions);
+
+	// Cancels every request and waits for the tasks in flight to finish
+	void Shutdown();
+
+private:
+	struct Request
+	{
+		int32 Id = INDEX_NONE;
+		int32 Priority = 0;
+		FVector Start = FVector::ZeroVector;
+		FVector Destination = FVector::ZeroVector;
+		FNavPathQueryDelegate OnComplete;
+		std::atomic<bool> bCancelled { false };
+	};
+
+	struct Result
+	{
+		int32 Id = INDEX_NONE;
+		bool bFoundPath = false;
+		TArray<FVector> Path;
+	};
+
+	typedef TSharedPtr<Request, ESPMode::ThreadSafe> RequestPtr;
+
+	// Orders the pending heap by priority, then by submission order
+	struct RequestCompare
+	{
+		bool operator() (const RequestPtr& lhs, const RequestPtr& rhs) const
+		{
+			return lhs->Priority > rhs->Priority || (lhs->Priority == rhs->Priority && lhs->Id < rhs->Id);
+		}
+	};
+
+	// Searches a batch of requests on a worker thread
+	void RunBatch(const TArray<RequestPtr>& batch);
+
+	// Gets a search context from the pool, allocating one if the pool is empty
+	NavSearchContext* AcquireContext();
+
+	// Returns a search context to the pool
+	void ReleaseContext(NavSearchContext* context);
+
+	// The volume the paths are searched in
+	const ANavigationVolume3D* Volume = nullptr;
+
+	// The requests that haven't completed yet, by id. Only accessed on the game thread.
+	TMap<int32, RequestPtr> Requests;
+
+	// The requests waiting to be dispatched, as a heap ordered by RequestCompare
+	TArray<RequestPtr> PendingHeap;
+
+	// The results produced by the worker threads, waiting for their delegates to be called
+	TQueue<Result, EQueueMode::Mpsc> Results;
+
+	// The tasks that may still be running
+	FGraphEventArray InFlightBatches;
+
+	// The search contexts not used by any task
+	TArray<NavSearchContext*> FreeContexts;
+
+	// Guards FreeContexts
+	FCriticalSection ContextLock;
+
+	// The id given to the next request
+	int32 NextRequestId = 1;
+};
@@ -0,0 +1,35 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavStats.h"
+
+DEFINE_STAT(STAT_Navigation3D_FindPath);
+DEFINE_STAT(STAT_Navigation3D_Search);
+DEFINE_STAT(STAT_Navigation3D_Replan);
+DEFINE_STAT(STAT_Navigation3D_PathSmoothing);
+DEFINE_STAT(STAT_Navigation3D_PathConversion);
+DEFINE_STAT(STAT_Navigation3D_PhysicsOverlap);
+DEFINE_STAT(STAT_Navigation3D_BuildOccupancy);
+DEFINE_STAT(STAT_Navigation3D_Voxelize);
+DEFINE_STAT(STAT_Navigation3D_Revoxelize);
+DEFINE_STAT(STAT_Navigation3D_BuildClusterGraph);
+DEFINE_STAT(STAT_Navigation3D_BuildComponents);
+DEFINE_STAT(STAT_Navigation3D_BuildClearance);
+DEFINE_STAT(STAT_Navigation3D_BuildOctree);
+DEFINE_STAT(STAT_Navigation3D_UpdateFlowFields);
+DEFINE_STAT(STAT_Navigation3D_LoadBakedData);
+DEFINE_STAT(STAT_Navigation3D_AsyncBatch);
+DEFINE_STAT(STAT_Navigation3D_LinkPortals);
+DEFINE_STAT(STAT_Navigation3D_FindRoute);
+DEFINE_STAT(STAT_Navigation3D_PlanCooperative);
+DEFINE_STAT(STAT_Navigation3D_SpatialQueries);
+
+DEFINE_STAT(STAT_Navigation3D_PathQueries);
+DEFINE_STAT(STAT_Navigation3D_NodesExpanded);
+DEFINE_STAT(STAT_Navigation3D_OverlapQueries);
+DEFINE_STAT(STAT_Navigation3D_CacheHits);
+DEFINE_STAT(STAT_Navigation3D_PathCacheHits);
+DEFINE_STAT(STAT_Navigation3D_PathCacheMisses);
+DEFINE_STAT(STAT_Navigation3D_RejectedQueries);
+DEFINE_STAT(STAT_Navigation3D_RouteSegments);
+DEFINE_STAT(STAT_Navigation3D_PendingDirtyCells);
@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Stats/Stats.h"
+
+// Shown with "stat Navigation3D". Cycle counters also show up as named events in Unreal Insights when stat events are traced.
+DECLARE_STATS_GROUP(TEXT("Navigation3D"), STATGROUP_Navigation3D, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Path"), STAT_Navigation3D_FindPath, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Search"), STAT_Navigation3D_Search, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Replan"), STAT_Navigation3D_Replan, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Path Smoothing"), STAT_Navigation3D_PathSmoothing, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Path Conversion"), STAT_Navigation3D_PathConversion, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Physics Overlap"), STAT_Navigation3D_PhysicsOverlap, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Occupancy"), STAT_Navigation3D_BuildOccupancy, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Voxelize Collision Geometry"), STAT_Navigation3D_Voxelize, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Revoxelize Dirty Cells"), STAT_Navigation3D_Revoxelize, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Cluster Graph"), STAT_Navigation3D_BuildClusterGraph, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Connected Components"), STAT_Navigation3D_BuildComponents, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Clearance Field"), STAT_Navigation3D_BuildClearance, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Build Sparse Octree"), STAT_Navigation3D_BuildOctree, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Update Flow Fields"), STAT_Navigation3D_UpdateFlowFields, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Load Baked Data"), STAT_Navigation3D_LoadBakedData, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Async Path Batch"), STAT_Navigation3D_AsyncBatch, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Link Portals"), STAT_Navigation3D_LinkPortals, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Find Route"), STAT_Navigation3D_FindRoute, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Plan Cooperative Paths"), STAT_Navigation3D_PlanCooperative, STATGROUP_Navigation3D, );
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Batched Spatial Queries"), STAT_Navigation3D_SpatialQueries, STATGROUP_Navigation3D, );
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Queries"), STAT_Navigation3D_PathQueries, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Nodes Expanded"), STAT_Navigation3D_NodesExpanded, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Overlap Queries"), STAT_Navigation3D_OverlapQueries, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Occupancy Cache Hits"), STAT_Navigation3D_CacheHits, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Hits"), STAT_Navigation3D_PathCacheHits, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Path Cache Misses"), STAT_Navigation3D_PathCacheMisses, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Rejected Unreachable Queries"), STAT_Navigation3D_RejectedQueries, STATGROUP_Navigation3D, );
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Route Segment Searches"), STAT_Navigation3D_RouteSegments, STATGROUP_Navigation3D, );
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Pending Dirty Cells"), STAT_Navigation3D_PendingDirtyCells, STATGROUP_Navigation3D, );
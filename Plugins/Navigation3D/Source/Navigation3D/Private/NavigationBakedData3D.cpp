@@ -0,0 +1,21 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationBakedData3D.h"
+
+void UNavigationBakedData3D::Serialize(FArchive& Ar)
+{
+	Super::Serialize(Ar);
+
+	// Stored as one block rather than element by element
+	Data.BulkSerialize(Ar);
+}
+
+void UNavigationBakedData3D::SetData(TArray<uint8>&& data, const FIntVector& divisions, int32 blocked_cell_count, ENavBakedDataCompression compression)
+{
+	Data = MoveTemp(data);
+	Divisions = divisions;
+	BlockedCellCount = blocked_cell_count;
+	Compression = compression;
+	DataSize = Data.Num();
+}
@@ -0,0 +1,91 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationPlanner3D.h"
+#include "NavigationVolume3D.h"
+#include "NavStats.h"
+#include "Core/NavOccupancy.h"
+#include "Core/NavGrid.h"
+#include "Core/NavDStarLite.h"
+
+void UNavigationPlanner3D::BeginDestroy()
+{
+	delete Planner;
+	Planner = nullptr;
+	PlannedOccupancy.Reset();
+
+	Super::BeginDestroy();
+}
+
+void UNavigationPlanner3D::Init(ANavigationVolume3D* volume)
+{
+	Volume = volume;
+	Reset();
+}
+
+bool UNavigationPlanner3D::FindPath(const FVector& start, const FVector& destination, TArray<FVector>& out_path)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Replan);
+
+	out_path.Reset();
+	const ANavigationVolume3D* volume = Volume.Get();
+	const NavGrid* grid = volume != nullptr ? volume->GetGrid() : nullptr;
+	if (grid == nullptr)
+		return false;
+
+	const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = volume->GetOccupancySnapshot();
+	if (occupancy.IsValid() == false || occupancy->Num() != grid->Num())
+		return false;
+
+	if (Planner == nullptr)
+	{
+		Planner = new NavDStarLite();
+	}
+
+	const int32 startIndex = grid->GetIndex(volume->ConvertLocationToCoordinates(start));
+	const int32 goalIndex = grid->GetIndex(volume->ConvertLocationToCoordinates(destination));
+
+	// A new destination or a new grid invalidates the whole search, otherwise only what changed since the last query is repaired
+	if (Planner->IsValid() == false || Planner->GetGoal() != goalIndex || PlannedOccupancy.IsValid() == false || PlannedOccupancy->Num() != occupancy->Num())
+	{
+		Planner->Init(*grid, startIndex, goalIndex);
+	}
+	else
+	{
+		if (Planner->GetStart() != startIndex)
+		{
+			Planner->SetStart(*grid, startIndex);
+		}
+
+		if (PlannedOccupancy != occupancy)
+		{
+			occupancy->GetChangedCells(*PlannedOccupancy, ChangedCells);
+			Planner->UpdateCells(*grid, *occupancy, ChangedCells);
+		}
+	}
+	PlannedOccupancy = occupancy;
+
+	const bool found = Planner->FindPath(*grid, *occupancy, PathCells);
+	INC_DWORD_STAT_BY(STAT_Navigation3D_NodesExpanded, Planner->GetLastExpandedNum());
+	if (found == false)
+		return false;
+
+	out_path.Reserve(PathCells.size());
+	for (const int32 cell : PathCells)
+	{
+		out_path.Add(volume->ConvertCoordinatesToLocation(grid->GetCoordinates(cell)));
+	}
+	return true;
+}
+
+void UNavigationPlanner3D::Reset()
+{
+	delete Planner;
+	Planner = nullptr;
+	PlannedOccupancy.Reset();
+}
+
+int32 UNavigationPlanner3D::GetLastExpandedNodes() const
+{
+	return Planner != nullptr ? Planner->GetLastExpandedNum() : 0;
+}
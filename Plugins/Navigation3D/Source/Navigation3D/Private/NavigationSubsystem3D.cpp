@@ -0,0 +1,295 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "NavigationSubsystem3D.h"
+#include "NavigationVolume3D.h"
+#include "NavStats.h"
+#include "Core/NavGrid.h"
+#include "Core/NavOccupancy.h"
+#include "Core/NavPortalGraph.h"
+
+namespace
+{
+	// The size of the tiles the facing cells of a border are grouped in, so a long border gets several portals to route through
+	constexpr int32 PortalSpan = 8;
+}
+
+void UNavigationSubsystem3D::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	Portals = new NavPortalGraph();
+}
+
+void UNavigationSubsystem3D::Deinitialize()
+{
+	Volumes.Empty();
+	delete Portals;
+	Portals = nullptr;
+
+	Super::Deinitialize();
+}
+
+void UNavigationSubsystem3D::RegisterVolume(ANavigationVolume3D* volume)
+{
+	if (volume == nullptr || Portals == nullptr || GetVolumeId(volume) != INDEX_NONE)
+		return;
+
+	const int32 volumeId = NextVolumeId++;
+	Volumes.Add(volumeId, volume);
+	LinkVolume(volumeId);
+}
+
+void UNavigationSubsystem3D::UnregisterVolume(ANavigationVolume3D* volume)
+{
+	const int32 volumeId = GetVolumeId(volume);
+	if (volumeId == INDEX_NONE)
+		return;
+
+	Portals->RemoveVolume(volumeId);
+	Volumes.Remove(volumeId);
+}
+
+void UNavigationSubsystem3D::RefreshVolume(ANavigationVolume3D* volume)
+{
+	const int32 volumeId = GetVolumeId(volume);
+	if (volumeId == INDEX_NONE)
+		return;
+
+	Portals->RemoveVolume(volumeId);
+	LinkVolume(volumeId);
+}
+
+bool UNavigationSubsystem3D::FindPath(const FVector& start, const FVector& destination, TArray<FVector>& out_path)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_FindRoute);
+
+	out_path.Reset();
+	ANavigationVolume3D* startVolume = FindVolumeAt(start);
+	ANavigationVolume3D* goalVolume = FindVolumeAt(destination);
+	if (startVolume == nullptr || goalVolume == nullptr)
+		return false;
+
+	const int32 startCell = startVolume->GetCellIndex(start);
+	const int32 goalCell = goalVolume->GetCellIndex(destination);
+	if (startVolume == goalVolume)
+		return startVolume->FindPathBetweenCells(startCell, goalCell, out_path);
+
+	// The paths searched while looking for the route, by volume id and cells, joined afterwards
+	const int32 startId = GetVolumeId(startVolume);
+	TMap<FIntVector, TArray<FVector> > segmentPaths;
+	auto findSegment = [this, &segmentPaths, startId, startCell](int32 volume_id, int32 from_cell, int32 to_cell)
+	{
+		INC_DWORD_STAT(STAT_Navigation3D_RouteSegments);
+
+		ANavigationVolume3D* volume = Volumes.FindRef(volume_id).Get();
+		if (volume == nullptr)
+			return -1.0f;
+
+		// The portal cells may have been blocked since they were linked. Only the start of the query is left untested, like any search.
+		if ((volume_id != startId || from_cell != startCell) && volume->IsCellBlocked(from_cell))
+			return -1.0f;
+
+		TArray<FVector>& path = segmentPaths.Add(FIntVector(volume_id, from_cell, to_cell));
+		if (volume->FindPathBetweenCells(from_cell, to_cell, path) == false)
+			return -1.0f;
+
+		float length = 0.0f;
+		for (int32 i = 1; i < path.Num(); ++i)
+		{
+			length += FVector::Distance(path[i - 1], path[i]);
+		}
+		return length;
+	};
+
+	const FVector startLocation = startVolume->ConvertCoordinatesToLocation(startVolume->GetGrid()->GetCoordinates(startCell));
+	const FVector goalLocation = goalVolume->ConvertCoordinatesToLocation(goalVolume->GetGrid()->GetCoordinates(goalCell));
+	std::vector<NavRouteSegment> route;
+	if (Portals->FindRoute(startId, startCell, startLocation, GetVolumeId(goalVolume), goalCell, goalLocation, findSegment, route) == false)
+		return false;
+
+	// Join the paths of the segments, searching the ones made of several moves through the same volume as a whole
+	for (const NavRouteSegment& segment : route)
+	{
+		const TArray<FVector>* path = segmentPaths.Find(FIntVector(segment.Volume, segment.FromCell, segment.ToCell));
+		TArray<FVector> joinedPath;
+		if (path == nullptr)
+		{
+			ANavigationVolume3D* volume = Volumes.FindRef(segment.Volume).Get();
+			if (volume == nullptr || volume->FindPathBetweenCells(segment.FromCell, segment.ToCell, joinedPath) == false)
+			{
+				out_path.Reset();
+				return false;
+			}
+			path = &joinedPath;
+		}
+		out_path.Append(*path);
+	}
+	return true;
+}
+
+ANavigationVolume3D* UNavigationSubsystem3D::FindVolumeAt(const FVector& location) const
+{
+	for (const TPair<int32, TWeakObjectPtr<ANavigationVolume3D> >& volume : Volumes)
+	{
+		if (volume.Value.IsValid() && volume.Value->IsLocationInside(location))
+			return volume.Value.Get();
+	}
+	return nullptr;
+}
+
+int32 UNavigationSubsystem3D::GetPortalNum() const
+{
+	return Portals != nullptr ? Portals->GetPortalNum() : 0;
+}
+
+int32 UNavigationSubsystem3D::GetVolumePortalNum(const ANavigationVolume3D* volume) const
+{
+	const int32 volumeId = GetVolumeId(volume);
+	return volumeId != INDEX_NONE ? Portals->GetPortalNum(volumeId) : 0;
+}
+
+int32 UNavigationSubsystem3D::GetVolumeId(const ANavigationVolume3D* volume) const
+{
+	for (const TPair<int32, TWeakObjectPtr<ANavigationVolume3D> >& registered : Volumes)
+	{
+		if (registered.Value.Get() == volume)
+			return registered.Key;
+	}
+	return INDEX_NONE;
+}
+
+void UNavigationSubsystem3D::LinkVolume(int32 volume_id)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_LinkPortals);
+
+	for (const TPair<int32, TWeakObjectPtr<ANavigationVolume3D> >& other : Volumes)
+	{
+		// Facing borders would otherwise be linked twice, once from each side, so the other volume's border is only used when
+		// this one's doesn't face any of its free cells, as when this volume contains it
+		if (other.Key != volume_id && LinkVolumes(volume_id, other.Key) == 0)
+		{
+			LinkVolumes(other.Key, volume_id);
+		}
+	}
+}
+
+int32 UNavigationSubsystem3D::LinkVolumes(int32 volume_id, int32 other_id)
+{
+	const ANavigationVolume3D* volume = Volumes.FindRef(volume_id).Get();
+	const ANavigationVolume3D* other = Volumes.FindRef(other_id).Get();
+	if (volume == nullptr || other == nullptr || volume->GetGrid() == nullptr || other->GetGrid() == nullptr)
+		return 0;
+
+	// Volumes that don't come within a cell of each other can't face each other
+	const float divisionSize = volume->GetDivisionSize();
+	if (volume->GetGridBounds().ExpandBy(divisionSize).Intersect(other->GetGridBounds()) == false)
+		return 0;
+
+	const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = volume->GetOccupancySnapshot();
+	const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> otherOccupancy = other->GetOccupancySnapshot();
+	if (occupancy.IsValid() == false || otherOccupancy.IsValid() == false)
+		return 0;
+
+	int32 portalNum = 0;
+
+	const NavGrid& grid = *volume->GetGrid();
+	const FIntVector& divisions = grid.GetDivisions();
+	const FTransform& transform = volume->GetActorTransform();
+	TArray<int32> faceLinks;
+	TArray<bool> grouped;
+	TArray<int32> group;
+	TArray<int32> stack;
+	for (int32 face = 0; face < 6; ++face)
+	{
+		const int32 axis = face / 2;
+		const bool maxSide = (face & 1) != 0;
+		const int32 uAxis = (axis + 1) % 3;
+		const int32 vAxis = (axis + 2) % 3;
+		const int32 uCount = divisions[uAxis];
+		const int32 vCount = divisions[vAxis];
+
+		// Find the cell of the other volume each free cell of the face looks into, one cell outside of the face
+		faceLinks.Init(INDEX_NONE, uCount * vCount);
+		for (int32 v = 0; v < vCount; ++v)
+		{
+			for (int32 u = 0; u < uCount; ++u)
+			{
+				FIntVector coordinates;
+				coordinates[axis] = maxSide ? divisions[axis] - 1 : 0;
+				coordinates[uAxis] = u;
+				coordinates[vAxis] = v;
+				if (occupancy->IsBlocked(grid.GetIndex(coordinates)))
+					continue;
+
+				FVector gridSpaceLocation = (FVector(coordinates) + FVector(0.5f)) * divisionSize;
+				gridSpaceLocation[axis] += maxSide ? divisionSize : -divisionSize;
+				const int32 otherCell = other->GetCellIndex(transform.TransformPosition(gridSpaceLocation));
+				if (otherCell != INDEX_NONE && otherOccupancy->IsBlocked(otherCell) == false)
+				{
+					faceLinks[u + (v * uCount)] = otherCell;
+				}
+			}
+		}
+
+		// Group the linked cells that touch within the same tile, and put a portal on the cell closest to the middle of each group
+		grouped.Init(false, faceLinks.Num());
+		for (int32 first = 0; first < faceLinks.Num(); ++first)
+		{
+			if (faceLinks[first] == INDEX_NONE || grouped[first])
+				continue;
+
+			group.Reset();
+			stack.Reset();
+			stack.Add(first);
+			grouped[first] = true;
+			FVector2D center = FVector2D::ZeroVector;
+			while (stack.Num() > 0)
+			{
+				const int32 current = stack.Pop(false);
+				group.Add(current);
+				const int32 u = current % uCount;
+				const int32 v = current / uCount;
+				center += FVector2D(u, v);
+
+				const FIntPoint neighbors[4] = { FIntPoint(u - 1, v), FIntPoint(u + 1, v), FIntPoint(u, v - 1), FIntPoint(u, v + 1) };
+				for (const FIntPoint& neighbor : neighbors)
+				{
+					if (neighbor.X < 0 || neighbor.X >= uCount || neighbor.Y < 0 || neighbor.Y >= vCount ||
+						neighbor.X / PortalSpan != u / PortalSpan || neighbor.Y / PortalSpan != v / PortalSpan)
+						continue;
+
+					const int32 index = neighbor.X + (neighbor.Y * uCount);
+					if (faceLinks[index] != INDEX_NONE && grouped[index] == false)
+					{
+						grouped[index] = true;
+						stack.Add(index);
+					}
+				}
+			}
+			center /= group.Num();
+
+			int32 best = group[0];
+			float bestDistanceSq = FLT_MAX;
+			for (const int32 member : group)
+			{
+				const float distanceSq = FVector2D::DistSquared(FVector2D(member % uCount, member / uCount), center);
+				if (distanceSq < bestDistanceSq)
+				{
+					bestDistanceSq = distanceSq;
+					best = member;
+				}
+			}
+
+			FIntVector coordinates;
+			coordinates[axis] = maxSide ? divisions[axis] - 1 : 0;
+			coordinates[uAxis] = best % uCount;
+			coordinates[vAxis] = best / uCount;
+			const int32 otherCell = faceLinks[best];
+			Portals->AddPortal(volume_id, grid.GetIndex(coordinates), volume->ConvertCoordinatesToLocation(coordinates),
+				other_id, otherCell, other->ConvertCoordinatesToLocation(other->GetGrid()->GetCoordinates(otherCell)));
+			++portalNum;
+		}
+	}
+	return portalNum;
+}
@@ -7,324 +7,2110 @@
 #include "UObject/ConstructorHelpers.h"
 #include "Kismet/KismetMathLibrary.h"
 #include "Kismet/KismetSystemLibrary.h"
-#include "NavNode.h"
-#include <set>
-#include <unordered_map>
+#include "Misc/ScopeLock.h"
+#include "HAL/IConsoleManager.h"
+#include "EngineUtils.h"
+#include "Engine/World.h"
+#include "Components/PrimitiveComponent.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "PhysicsEngine/BodySetup.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "Async/ParallelFor.h"
+#include "NavPathQueue.h"
+#include "NavigationPlanner3D.h"
+#include "NavigationSubsystem3D.h"
+#include "NavStats.h"
+#include "Core/NavOccupancy.h"
+#include "Core/NavGrid.h"
+#include "Core/NavSearchContext.h"
+#include "Core/NavAStar.h"
+#include "Core/NavJumpPointSearch.h"
+#include "Core/NavLineOfSight.h"
+#include "Core/NavThetaStar.h"
+#include "Core/NavSparseOctree.h"
+#include "Core/NavClusterGraph.h"
+#include "Core/NavBakedData.h"
+#include "Core/NavVoxelizer.h"
+#include "Core/NavPathCache.h"
+#include "Core/NavFlowField.h"
+#include "Core/NavComponents.h"
+#include "Core/NavBidirectionalAStar.h"
+#include "Core/NavWeightedAStar.h"
+#include "Core/NavClearanceField.h"
+#include "Core/NavCostLayers.h"
+#include "Core/NavCooperativePlanner.h"
+#include "Core/NavGridTransform.h"
+
+DEFINE_LOG_CATEGORY_STATIC(LogNavigation3D, Log, All);
 
 static UMaterial* GridMaterial = nullptr;
 
-// Sets default values
-ANavigationVolume3D::ANavigationVolume3D()
+// The margin, in cells, added to the box tested around each cell when voxelizing collision geometry
+static constexpr float VoxelizationMargin = 0.01f;
+
+// Runs the parallel loops of the core on the task graph
+static void RunParallelFor(int32 count, const std::function<void(int32)>& body)
+{
+	ParallelFor(count, [&body](int32 index)
+	{
+		body(index);
+	});
+}
+
+// Gets a description of why baked data couldn't be read, for the log
+static const TCHAR* GetBakedDataResultText(ENavBakedDataResult result)
+{
+	switch (result)
+	{
+	case ENavBakedDataResult::Success:				return TEXT("success");
+	case ENavBakedDataResult::Truncated:			return TEXT("the data is truncated");
+	case ENavBakedDataResult::InvalidFormat:		return TEXT("the data isn't baked navigation data");
+	case ENavBakedDataResult::UnsupportedVersion:	return TEXT("the data was baked with a different version of the plugin");
+	case ENavBakedDataResult::Corrupt:				return TEXT("the data is corrupt");
+	}
+	return TEXT("unknown error");
+}
+
+// Combines the location, rotation and scale of a transform into a baked data checksum
+static uint64 HashTransform(const FTransform& transform, uint64 seed)
+{
+	const FVector location = transform.GetLocation();
+	const FQuat rotation = transform.GetRotation();
+	const FVector scale = transform.GetScale3D();
+	uint64 hash = NavBakedData::Hash(&location, sizeof(location), seed);
+	hash = NavBakedData::Hash(&rotation, sizeof(rotation), hash);
+	return NavBakedData::Hash(&scale, sizeof(scale), hash);
+}
+
+// Gets a bit per object type, so profiles listing the same object types in any order or more than once compare equal
+static uint64 GetObjectTypeMask(const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types)
+{
+	uint64 mask = 0;
+	for (const TEnumAsByte<EObjectTypeQuery>& objectType : object_types)
+	{
+		mask |= 1ull << (objectType.GetValue() & 63);
+	}
+	return mask;
+}
+
+static FAutoConsoleCommandWithWorld DumpStatsCommand(
+	TEXT("Navigation3D.DumpStats"),
+	TEXT("Logs the rolling path query stats of every navigation volume in the world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* world)
+	{
+		for (TActorIterator<ANavigationVolume3D> iter(world); iter; ++iter)
+		{
+			iter->DumpPathQueryStats();
+		}
+	}));
+
+static FAutoConsoleCommandWithWorld ResetStatsCommand(
+	TEXT("Navigation3D.ResetStats"),
+	TEXT("Forgets the recorded path query stats of every navigation volume in the world"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* world)
+	{
+		for (TActorIterator<ANavigationVolume3D> iter(world); iter; ++iter)
+		{
+			iter->ResetPathQueryStats();
+		}
+	}));
+
+// Sets default values
+ANavigationVolume3D::ANavigationVolume3D()
+{
+	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
+	PrimaryActorTick.bCanEverTick = true;
+
+	// Create the default scene component
+	DefaultSceneComponent = CreateDefaultSubobject<USceneComponent>("DefaultSceneComponent");
+	SetRootComponent(DefaultSceneComponent);
+
+	// Create the procedural mesh component
+	ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>("ProceduralMesh");
+	ProceduralMesh->SetupAttachment(GetRootComponent());
+	ProceduralMesh->CastShadow = false;
+	ProceduralMesh->SetEnableGravity(false);
+	ProceduralMesh->bApplyImpulseOnDamage = false;
+	ProceduralMesh->SetGenerateOverlapEvents(false);
+	ProceduralMesh->CanCharacterStepUpOn = ECanBeCharacterBase::ECB_No;
+	ProceduralMesh->SetCollisionProfileName("NoCollision");
+	ProceduralMesh->bHiddenInGame = false;
+
+	// By default, hide the volume while the game is running
+	SetActorHiddenInGame(true);
+
+	// Find and save the grid material
+	static ConstructorHelpers::FObjectFinder<UMaterial> materialFinder(TEXT("Material'/Navigation3D/M_Grid.M_Grid'"));
+	GridMaterial = materialFinder.Object;
+}
+
+void ANavigationVolume3D::OnConstruction(const FTransform& Transform)
+{
+	Super::OnConstruction(Transform);
+
+	UpdateDebugMesh(false);
+
+	// Set the material on the procedural mesh so it's color/opacity can be configurable. The instance is only created once.
+	if (DebugMaterial == nullptr)
+	{
+		DebugMaterial = UMaterialInstanceDynamic::Create(GridMaterial, this);
+	}
+	DebugMaterial->SetVectorParameterValue("Color", Color);
+	DebugMaterial->SetScalarParameterValue("Opacity", Color.A);
+	ProceduralMesh->SetMaterial(0, DebugMaterial);
+}
+
+void ANavigationVolume3D::UpdateDebugMesh(bool force)
+{
+	FDebugMeshSettings settings;
+	settings.Divisions = FIntVector(DivisionsX, DivisionsY, DivisionsZ);
+	settings.DivisionSize = DivisionSize;
+	settings.LineThickness = LineThickness;
+	settings.Mode = DebugDrawMode;
+	settings.SliceAxis = DebugSliceAxis;
+	settings.SliceIndex = DebugDrawMode == ENavDebugDrawMode::Slice ? FMath::Clamp(DebugSliceIndex, 0, settings.Divisions[static_cast<int32>(DebugSliceAxis)]) : INDEX_NONE;
+	settings.MaxCells = MaxDebugCells;
+
+	// Nothing the mesh depends on changed, and the section is still there (rerunning construction scripts recreates the component)
+	const FProcMeshSection* section = ProceduralMesh->GetProcMeshSection(0);
+	const int32 vertexCount = section != nullptr ? section->ProcVertexBuffer.Num() : 0;
+	if (force == false && settings == DebugMeshSettings && vertexCount == DebugMeshVertexCount)
+		return;
+
+	DebugMeshSettings = settings;
+
+	// Each line is two quads, reserve the buffers for every line up front rather than growing them
+	TArray<FVector> vertices;
+	TArray<int32> triangles;
+	auto reserveLines = [&vertices, &triangles](int64 line_count)
+	{
+		vertices.Reserve(static_cast<int32>(line_count * 8));
+		triangles.Reserve(static_cast<int32>(line_count * 12));
+	};
+
+	// The grid only exists while playing, so cells are located from the divisions
+	const FVector cellSize(DivisionSize);
+	auto getCellMin = [this](int32 cell)
+	{
+		return FVector(cell % DivisionsX, (cell / DivisionsX) % DivisionsY, cell / (DivisionsX * DivisionsY)) * DivisionSize;
+	};
+
+	switch (DebugDrawMode)
+	{
+	case ENavDebugDrawMode::FullGrid:
+	{
+		reserveLines((static_cast<int64>(DivisionsZ + 1) * (DivisionsX + 1)) + (static_cast<int64>(DivisionsZ + 1) * (DivisionsY + 1)) + (static_cast<int64>(DivisionsX + 1) * (DivisionsY + 1)));
+
+		// The X and Y lines of each Z plane, then the Z lines
+		for (int32 z = 0; z <= DivisionsZ; ++z)
+		{
+			for (int32 x = 0; x <= DivisionsX; ++x)
+			{
+				CreateLine(FVector(x * DivisionSize, 0.0f, z * DivisionSize), FVector(x * DivisionSize, GetGridSizeY(), z * DivisionSize), FVector::UpVector, vertices, triangles);
+			}
+			for (int32 y = 0; y <= DivisionsY; ++y)
+			{
+				CreateLine(FVector(0.0f, y * DivisionSize, z * DivisionSize), FVector(GetGridSizeX(), y * DivisionSize, z * DivisionSize), FVector::UpVector, vertices, triangles);
+			}
+		}
+		for (int32 x = 0; x <= DivisionsX; ++x)
+		{
+			for (int32 y = 0; y <= DivisionsY; ++y)
+			{
+				CreateLine(FVector(x * DivisionSize, y * DivisionSize, 0.0f), FVector(x * DivisionSize, y * DivisionSize, GetGridSizeZ()), FVector::ForwardVector, vertices, triangles);
+			}
+		}
+		break;
+	}
+	case ENavDebugDrawMode::BoundingBox:
+		reserveLines(12);
+		CreateBox(FVector::ZeroVector, FVector(GetGridSizeX(), GetGridSizeY(), GetGridSizeZ()), vertices, triangles);
+		break;
+	case ENavDebugDrawMode::Slice:
+	{
+		const int32 axis = static_cast<int32>(DebugSliceAxis);
+		reserveLines(static_cast<int64>(settings.Divisions[(axis + 1) % 3] + 1) + (settings.Divisions[(axis + 2) % 3] + 1));
+		CreateSlice(axis, settings.SliceIndex, vertices, triangles);
+		break;
+	}
+	case ENavDebugDrawMode::OccupiedCells:
+	{
+		const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = GetOccupancySnapshot();
+		if (occupancy.IsValid() == false || occupancy->Num() != GetTotalDivisions())
+			break;
+
+		// Walk the set bits a word at a time, most of a large volume is usually empty
+		TArray<int32> cells;
+		const uint32* words = occupancy->GetWords();
+		const int32 wordCount = (occupancy->Num() + 31) >> 5;
+		for (int32 word = 0; word < wordCount && cells.Num() < MaxDebugCells; ++word)
+		{
+			for (uint32 bits = words[word]; bits != 0 && cells.Num() < MaxDebugCells; bits &= bits - 1)
+			{
+				cells.Add((word << 5) + static_cast<int32>(FMath::CountTrailingZeros(bits)));
+			}
+		}
+
+		reserveLines(static_cast<int64>(cells.Num()) * 12);
+		for (const int32 cell : cells)
+		{
+			const FVector min = getCellMin(cell);
+			CreateBox(min, min + cellSize, vertices, triangles);
+		}
+		break;
+	}
+	case ENavDebugDrawMode::PathCells:
+	{
+		const int32 cellCount = FMath::Min(DebugPathCells.Num(), MaxDebugCells);
+		reserveLines(static_cast<int64>(cellCount) * 12);
+		for (int32 i = 0; i < cellCount; ++i)
+		{
+			const FVector min = getCellMin(DebugPathCells[i]);
+			CreateBox(min, min + cellSize, vertices, triangles);
+		}
+		break;
+	}
+	}
+
+	// Unused variables that are required to be passed to CreateMeshSection
+	TArray<FVector> Normals;
+	TArray<FVector2D> UVs;
+	TArray<FColor> Colors;
+	TArray<FProcMeshTangent> Tangents;
+
+	// Add the geometry to the procedural mesh so it will render
+	ProceduralMesh->CreateMeshSection(0, vertices, triangles, Normals, UVs, Colors, Tangents, false);
+	DebugMeshVertexCount = vertices.Num();
+}
+
+void ANavigationVolume3D::SetDebugPath(const std::vector<int32>& cells)
+{
+	if (DebugDrawMode != ENavDebugDrawMode::PathCells)
+		return;
+
+	DebugPathCells.Reset(static_cast<int32>(cells.size()));
+	for (const int32 cell : cells)
+	{
+		DebugPathCells.Add(cell);
+	}
+	UpdateDebugMesh(true);
+}
+
+// Called when the game starts or when spawned
+void ANavigationVolume3D::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Neighbors are computed from the flat index when needed, so only the grid dimensions have to be set up
+	Grid = new NavGrid();
+	Grid->Init(FIntVector(DivisionsX, DivisionsY, DivisionsZ), MinSharedNeighborAxes);
+
+	// Cache the transform of the grid for the spatial queries, again whenever the volume moves
+	UpdateGridTransform();
+	DefaultSceneComponent->TransformUpdated.AddUObject(this, &ANavigationVolume3D::OnRootTransformUpdated);
+
+	// Allocate the search state used by path queries made on the game thread
+	GameThreadContext = new NavSearchContext();
+
+	// Allocate the cost layers, every cell starts without extra cost
+	if (CostLayerCount > 0)
+	{
+		CostLayers = new NavCostLayers();
+		CostLayers->Init(GetTotalDivisions(), CostLayerCount);
+	}
+
+	// Create the queue for asynchronous path requests
+	PathQueue = new NavPathQueue(this);
+
+	// Create the path cache, filled by the queries made while it's enabled
+	PathCache = new NavPathCache();
+	PathCache->SetCapacity(PathCacheCapacity);
+
+	// Load the baked occupancy, or build it up front so the first path query doesn't pay for it. Without object types
+	// configured, it is built by the first path query instead, for the profile that query asks for.
+	if (bUseOccupancyCache && LoadBakedData() == false && bBuildOccupancyOnBeginPlay && OccupancyObjectTypes.Num() > 0)
+	{
+		BuildOccupancy(OccupancyObjectTypes, OccupancyActorClassFilter);
+	}
+
+	// Join the other volumes of the world, linking portals with the ones around this one
+	if (UNavigationSubsystem3D* navigation = GetWorld()->GetSubsystem<UNavigationSubsystem3D>())
+	{
+		navigation->RegisterVolume(this);
+	}
+}
+
+void ANavigationVolume3D::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	// Leave the other volumes before the grid goes away, this is also where a streamed level unloads the volume
+	if (UNavigationSubsystem3D* navigation = GetWorld()->GetSubsystem<UNavigationSubsystem3D>())
+	{
+		navigation->UnregisterVolume(this);
+	}
+
+	DefaultSceneComponent->TransformUpdated.RemoveAll(this);
+
+	// Delete the path queue first, it waits for the searches still using the grid
+	delete PathQueue;
+	PathQueue = nullptr;
+
+	// Delete the game thread search state
+	delete GameThreadContext;
+	GameThreadContext = nullptr;
+
+	// Delete the cached paths
+	delete PathCache;
+	PathCache = nullptr;
+
+	// Release the flow fields, they were built for the grid
+	FlowFields.Empty();
+
+	// Delete the cooperative planner, the cost layers and the grid
+	delete CooperativePlanner;
+	CooperativePlanner = nullptr;
+	CooperativeOccupancy.Reset();
+	delete CostLayers;
+	CostLayers = nullptr;
+	delete Grid;
+	Grid = nullptr;
+
+	// Release the occupancy and any pending updates
+	{
+		FScopeLock lock(&OccupancyLock);
+		Occupancy.Reset();
+		ClusterGraph.Reset();
+		Components.Reset();
+		ClearanceField.Reset();
+		Octree.Reset();
+		GridTransform.Reset();
+	}
+	StagingOccupancy.Reset();
+	DirtyCellMask.Empty();
+	PendingDirtyCells.Empty();
+	ActiveDirtyCells.Empty();
+	ChangedDirtyCells.Empty();
+	ActiveDirtyCursor = 0;
+	PendingDirtyRegions.Empty();
+	ActiveDirtyRegions.Empty();
+	ActiveDirtyRegionCursor = 0;
+	PendingOctreeRegions.Empty();
+	DynamicObstacles.Empty();
+	ResetPathQueryStats();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+// Called every frame
+void ANavigationVolume3D::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// Revoxelize the cells touched by moving obstacles within the per tick budget
+	UpdateDynamicObstacles();
+	ProcessDirtyOccupancy();
+
+	// Deliver finished asynchronous path requests and start new ones
+	if (PathQueue != nullptr)
+	{
+		PathQueue->Tick(MaxPathRequestsPerBatch, MaxConcurrentPathBatches, MaxPathCompletionsPerTick);
+	}
+}
+
+void ANavigationVolume3D::ConvertCellsToLocations(const NavGridTransform& grid_transform, const std::vector<int32>& cells, TArray<FVector>& out_locations) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PathConversion);
+
+	out_locations.Reserve(out_locations.Num() + cells.size());
+	for (const int32 cell : cells)
+	{
+		out_locations.Add(grid_transform.GetCellCenter(Grid->GetCoordinates(cell)));
+	}
+}
+
+bool ANavigationVolume3D::FindPath(const FVector& start, const FVector& destination, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter, TArray<FVector>& out_path)
+{
+	FNavPathQueryStats stats;
+	return FindPathWithStats(start, destination, object_types, actor_class_filter, out_path, stats);
+}
+
+bool ANavigationVolume3D::FindPathWithStats(const FVector& start, const FVector& destination, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter, TArray<FVector>& out_path, FNavPathQueryStats& out_stats)
+{
+	// Clear the out path
+	out_path.Empty();
+	out_stats = FNavPathQueryStats();
+
+	if (Grid == nullptr)
+		return false;
+
+	// Use the occupancy bitfield when enabled, building it for the requested profile the first time. Rebuilding it for every
+	// other profile would stall the game thread on each query alternating between them, so those query physics instead.
+	const bool useNavigationData = bUseOccupancyCache || Representation == ENavVolumeRepresentation::SparseOctree;
+	if (useNavigationData && IsNavigationDataBuilt() == false)
+	{
+		BuildOccupancy(object_types, actor_class_filter);
+	}
+	if (useNavigationData && HasOccupancyFor(object_types, actor_class_filter))
+	{
+		const bool found = FindPathWithContext(start, destination, *GameThreadContext, out_path, &out_stats);
+		SetDebugPath(found ? GameThreadContext->PathCells : std::vector<int32>());
+		return found;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_FindPath);
+	const double startTime = FPlatformTime::Seconds();
+	const uint64 startExpanded = GameThreadContext->GetTotalExpandedNum();
+	GameThreadContext->ResetPeakOpenNum();
+
+	// Otherwise, or for another profile, query physics for each cell as it's reached
+	const int32 startIndex = GetNodeIndex(ConvertLocationToCoordinates(start));
+	const int32 endIndex = GetNodeIndex(ConvertLocationToCoordinates(destination));
+	auto isBlocked = [&](int32 index)
+	{
+		++out_stats.OverlapQueries;
+		return IsCellBlockedByPhysics(Grid->GetCoordinates(index), object_types, actor_class_filter);
+	};
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+		out_stats.bFoundPath = NavAStar::FindPath(*Grid, startIndex, endIndex, isBlocked, *GameThreadContext, GameThreadContext->PathCells);
+	}
+	if (out_stats.bFoundPath)
+	{
+		ConvertCellsToLocations(*GridTransform, GameThreadContext->PathCells, out_path);
+	}
+
+	out_stats.PathLength = out_path.Num();
+	FinishPathQueryStats(*GameThreadContext, startTime, startExpanded, out_stats);
+	SetDebugPath(out_stats.bFoundPath ? GameThreadContext->PathCells : std::vector<int32>());
+	return out_stats.bFoundPath;
+}
+
+bool ANavigationVolume3D::FindPathWithContext(const FVector& start, const FVector& destination, NavSearchContext& context, TArray<FVector>& out_path, FNavPathQueryStats* out_stats) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_FindPath);
+	const double startTime = FPlatformTime::Seconds();
+	const uint64 startExpanded = context.GetTotalExpandedNum();
+	context.ResetPeakOpenNum();
+
+	// Clear the out path
+	out_path.Empty();
+
+	FNavPathQueryStats stats;
+	stats.bFoundPath = SearchNavigationData(start, destination, context, out_path, stats);
+	stats.PathLength = out_path.Num();
+	FinishPathQueryStats(context, startTime, startExpanded, stats);
+
+	if (out_stats != nullptr)
+	{
+		*out_stats = stats;
+	}
+	return stats.bFoundPath;
+}
+
+bool ANavigationVolume3D::SearchNavigationData(const FVector& start, const FVector& destination, NavSearchContext& context, TArray<FVector>& out_path, FNavPathQueryStats& out_stats) const
+{
+	// Queries may run on worker threads while the game thread moves the volume, so locations are converted with the grid
+	// transform published along with the navigation data rather than the actor transform
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
+	{
+		TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> octree;
+		TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform;
+		{
+			FScopeLock lock(&OccupancyLock);
+			octree = Octree;
+			gridTransform = GridTransform;
+		}
+		if (octree.IsValid() == false || gridTransform.IsValid() == false)
+			return false;
+
+		const FIntVector startCoordinates = gridTransform->GetClampedCoordinates(start);
+		const FIntVector endCoordinates = gridTransform->GetClampedCoordinates(destination);
+		{
+			SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+			if (octree->FindPath(startCoordinates, endCoordinates, MinSharedNeighborAxes, context, context.PathCells) == false)
+				return false;
+		}
+
+		// Go through the center of each node, starting and ending at the cells of the start and the destination
+		auto addLocation = [&out_path](const FVector& location)
+		{
+			if (out_path.Num() == 0 || out_path.Last().Equals(location) == false)
+			{
+				out_path.Add(location);
+			}
+		};
+
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PathConversion);
+		out_path.Reserve(context.PathCells.size() + 2);
+		addLocation(gridTransform->GetCellCenter(startCoordinates));
+		for (const int32 node : context.PathCells)
+		{
+			addLocation(gridTransform->GetWorldLocation(octree->GetGraphNodeCenter(node)));
+		}
+		addLocation(gridTransform->GetCellCenter(endCoordinates));
+		return true;
+	}
+
+	// Hold on to the published snapshots so updates finishing mid-query can't change them under us. The path cache version is
+	// read with them, so a path searched over an occupancy that gets replaced before the search completes isn't cached.
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy;
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> clusterGraph;
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> components;
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform;
+	uint32 pathCacheVersion = 0;
+	{
+		FScopeLock lock(&OccupancyLock);
+		occupancy = Occupancy;
+		clusterGraph = ClusterGraph;
+		components = Components;
+		gridTransform = GridTransform;
+		if (PathCache != nullptr)
+		{
+			FScopeLock cacheLock(&PathCacheLock);
+			pathCacheVersion = PathCache->GetVersion();
+		}
+	}
+	if (Grid == nullptr || occupancy.IsValid() == false || gridTransform.IsValid() == false)
+		return false;
+
+	const int32 startIndex = GetNodeIndex(gridTransform->GetClampedCoordinates(start));
+	const int32 endIndex = GetNodeIndex(gridTransform->GetClampedCoordinates(destination));
+
+	// Cells in different components can't reach each other, no need to flood the start's component to find out
+	if (components.IsValid() && components->IsReachable(*Grid, startIndex, endIndex) == false)
+	{
+		INC_DWORD_STAT(STAT_Navigation3D_RejectedQueries);
+		return false;
+	}
+
+	// Agents asking for a path found before, or starting next to one heading to the same cell, skip the search
+	const bool usePathCache = bCachePaths && PathCache != nullptr;
+	const uint32 pathCacheProfile = GetPathCacheProfile();
+	if (usePathCache)
+	{
+		ENavPathCacheResult result;
+		{
+			FScopeLock lock(&PathCacheLock);
+			result = PathCache->Find(*Grid, startIndex, endIndex, pathCacheProfile, bReusePathTails, context.PathCells);
+		}
+
+		if (result != ENavPathCacheResult::Miss)
+		{
+			INC_DWORD_STAT(STAT_Navigation3D_PathCacheHits);
+			out_stats.bPathCacheHit = true;
+			ConvertCellsToLocations(*gridTransform, context.PathCells, out_path);
+			return true;
+		}
+		INC_DWORD_STAT(STAT_Navigation3D_PathCacheMisses);
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+		if (SearchOccupancy(*occupancy, clusterGraph.Get(), startIndex, endIndex, context, out_stats.CacheHits) == false)
+			return false;
+	}
+
+	if (bSmoothPaths)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PathSmoothing);
+		NavLineOfSight::SmoothPath(*Grid, *occupancy, context.PathCells);
+	}
+
+	if (usePathCache)
+	{
+		FScopeLock lock(&PathCacheLock);
+		PathCache->Add(*Grid, startIndex, endIndex, pathCacheProfile, context.PathCells, pathCacheVersion);
+	}
+
+	ConvertCellsToLocations(*gridTransform, context.PathCells, out_path);
+	return true;
+}
+
+bool ANavigationVolume3D::SearchOccupancy(const NavOccupancy& occupancy, const NavClusterGraph* cluster_graph, int32 start_index, int32 end_index, NavSearchContext& context, int32& out_cache_hits) const
+{
+	// Search the cluster graph first. Only face adjacent cells across cluster borders become entrances, so when diagonal
+	// moves are allowed a path the graph misses may still exist, and the grid is searched rather than reporting there is none.
+	if (SearchAlgorithm == ENavSearchAlgorithm::Hierarchical && cluster_graph != nullptr)
+	{
+		if (cluster_graph->FindPath(*Grid, occupancy, start_index, end_index, context, context.PathCells))
+			return true;
+
+		if (MinSharedNeighborAxes >= 2)
+			return false;
+	}
+
+	// Jump Point Search needs the near blocked bits of the occupancy, and Theta* tests line of sight against it, so they're only available here
+	if (SearchAlgorithm == ENavSearchAlgorithm::JumpPointSearch)
+		return NavJumpPointSearch::FindPath(*Grid, occupancy, start_index, end_index, context, context.PathCells);
+
+	if (SearchAlgorithm == ENavSearchAlgorithm::ThetaStar || SearchAlgorithm == ENavSearchAlgorithm::LazyThetaStar)
+		return NavThetaStar::FindPath(*Grid, occupancy, start_index, end_index, SearchAlgorithm == ENavSearchAlgorithm::LazyThetaStar, context, context.PathCells);
+
+	if (SearchAlgorithm == ENavSearchAlgorithm::BidirectionalAStar)
+		return NavBidirectionalAStar::FindPath(*Grid, occupancy, start_index, end_index, context, context.PathCells);
+
+	if (SearchAlgorithm == ENavSearchAlgorithm::WeightedAStar)
+		return NavWeightedAStar::FindPath(*Grid, occupancy, start_index, end_index, HeuristicWeight, context, context.PathCells);
+
+	if (SearchAlgorithm == ENavSearchAlgorithm::AnytimeAStar)
+	{
+		float weight = 0.0f;
+		return NavWeightedAStar::FindPathAnytime(*Grid, occupancy, start_index, end_index, HeuristicWeight, AnytimeMaxExpansions, AnytimeBudgetMs / 1000.0, context, context.PathCells, weight);
+	}
+
+	auto isBlocked = [&occupancy, &out_cache_hits](int32 index)
+	{
+		++out_cache_hits;
+		return occupancy.IsBlocked(index);
+	};
+	return NavAStar::FindPath(*Grid, start_index, end_index, isBlocked, context, context.PathCells);
+}
+
+bool ANavigationVolume3D::FindPathForAgent(const FVector& start, const FVector& destination, float agent_radius, TArray<FVector>& out_path)
+{
+	out_path.Empty();
+	if (Grid == nullptr || GameThreadContext == nullptr)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_FindPath);
+	const double startTime = FPlatformTime::Seconds();
+	const uint64 startExpanded = GameThreadContext->GetTotalExpandedNum();
+	GameThreadContext->ResetPeakOpenNum();
+
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField;
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> components;
+	{
+		FScopeLock lock(&OccupancyLock);
+		clearanceField = ClearanceField;
+		components = Components;
+	}
+	if (clearanceField.IsValid() == false)
+		return false;
+
+	const int32 startIndex = GetNodeIndex(ConvertLocationToCoordinates(start));
+	const int32 endIndex = GetNodeIndex(ConvertLocationToCoordinates(destination));
+
+	// The cells an agent fits in are a subset of the free cells, so cells the components can't connect are still unreachable
+	FNavPathQueryStats stats;
+	if (components.IsValid() == false || components->IsReachable(*Grid, startIndex, endIndex))
+	{
+		const uint16 requiredClearanceSq = NavClearanceField::GetRequiredClearanceSq(agent_radius / DivisionSize);
+		auto isBlocked = [&clearanceField, &stats, requiredClearanceSq](int32 index)
+		{
+			++stats.CacheHits;
+			return clearanceField->IsClear(index, requiredClearanceSq) == false;
+		};
+
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+		stats.bFoundPath = NavAStar::FindPath(*Grid, startIndex, endIndex, isBlocked, *GameThreadContext, GameThreadContext->PathCells);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_Navigation3D_RejectedQueries);
+	}
+
+	if (stats.bFoundPath)
+	{
+		ConvertCellsToLocations(*GridTransform, GameThreadContext->PathCells, out_path);
+	}
+	stats.PathLength = out_path.Num();
+	FinishPathQueryStats(*GameThreadContext, startTime, startExpanded, stats);
+	SetDebugPath(stats.bFoundPath ? GameThreadContext->PathCells : std::vector<int32>());
+	return stats.bFoundPath;
+}
+
+bool ANavigationVolume3D::FindPathWithCosts(const FVector& start, const FVector& destination, const TArray<float>& layer_weights, TArray<FVector>& out_path)
+{
+	out_path.Empty();
+	if (Grid == nullptr || GameThreadContext == nullptr || CostLayers == nullptr)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_FindPath);
+	const double startTime = FPlatformTime::Seconds();
+	const uint64 startExpanded = GameThreadContext->GetTotalExpandedNum();
+	GameThreadContext->ResetPeakOpenNum();
+
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy;
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> components;
+	{
+		FScopeLock lock(&OccupancyLock);
+		occupancy = Occupancy;
+		components = Components;
+	}
+	if (occupancy.IsValid() == false)
+		return false;
+
+	const int32 startIndex = GetNodeIndex(ConvertLocationToCoordinates(start));
+	const int32 endIndex = GetNodeIndex(ConvertLocationToCoordinates(destination));
+
+	// Costs only change which way the path goes, cells the components can't connect are still unreachable
+	FNavPathQueryStats stats;
+	if (components.IsValid() == false || components->IsReachable(*Grid, startIndex, endIndex))
+	{
+		const NavCostProfile profile(*CostLayers, layer_weights.GetData(), layer_weights.Num());
+		auto isBlocked = [&occupancy, &stats](int32 index)
+		{
+			++stats.CacheHits;
+			return occupancy->IsBlocked(index);
+		};
+
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+		stats.bFoundPath = NavAStar::FindPathWithCosts(*Grid, startIndex, endIndex, isBlocked, [&profile](int32 index) { return profile.GetCellCost(index); },
+			profile.GetMinCellCost(), *GameThreadContext, GameThreadContext->PathCells);
+	}
+	else
+	{
+		INC_DWORD_STAT(STAT_Navigation3D_RejectedQueries);
+	}
+
+	if (stats.bFoundPath)
+	{
+		ConvertCellsToLocations(*GridTransform, GameThreadContext->PathCells, out_path);
+	}
+	stats.PathLength = out_path.Num();
+	FinishPathQueryStats(*GameThreadContext, startTime, startExpanded, stats);
+	SetDebugPath(stats.bFoundPath ? GameThreadContext->PathCells : std::vector<int32>());
+	return stats.bFoundPath;
+}
+
+void ANavigationVolume3D::SetCostInBox(int32 layer, const FBox& world_bounds, uint8 cost)
+{
+	if (CostLayers == nullptr || layer < 0 || layer >= CostLayers->GetLayerNum() || world_bounds.IsValid == 0)
+		return;
+
+	FIntVector minCoordinates;
+	FIntVector maxCoordinates;
+	if (GetCellRange(world_bounds, minCoordinates, maxCoordinates) == false)
+		return;
+
+	// The range covers every cell the box touches, only the cells whose center is inside are set
+	for (int32 z = minCoordinates.Z; z <= maxCoordinates.Z; ++z)
+	{
+		for (int32 y = minCoordinates.Y; y <= maxCoordinates.Y; ++y)
+		{
+			for (int32 x = minCoordinates.X; x <= maxCoordinates.X; ++x)
+			{
+				const FIntVector coordinates(x, y, z);
+				if (world_bounds.IsInside(ConvertCoordinatesToLocation(coordinates)))
+				{
+					CostLayers->SetCost(GetNodeIndex(coordinates), layer, cost);
+				}
+			}
+		}
+	}
+}
+
+void ANavigationVolume3D::ClearCostLayer(int32 layer)
+{
+	if (CostLayers != nullptr && layer >= 0 && layer < CostLayers->GetLayerNum())
+	{
+		CostLayers->FillLayer(layer, 0);
+	}
+}
+
+uint8 ANavigationVolume3D::GetCellCost(const FVector& location, int32 layer) const
+{
+	if (CostLayers == nullptr || layer < 0 || layer >= CostLayers->GetLayerNum())
+		return 0;
+
+	return CostLayers->GetCost(GetNodeIndex(ConvertLocationToCoordinates(location)), layer);
+}
+
+int32 ANavigationVolume3D::PlanCooperativePaths(const TArray<FVector>& starts, const TArray<FVector>& destinations, TArray<FNavCooperativePath>& out_paths)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PlanCooperative);
+
+	out_paths.Reset();
+	if (Grid == nullptr || starts.Num() != destinations.Num())
+		return INDEX_NONE;
+
+	const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = GetOccupancySnapshot();
+	if (occupancy.IsValid() == false || occupancy->Num() != Grid->Num())
+		return INDEX_NONE;
+
+	if (CooperativePlanner == nullptr)
+	{
+		CooperativePlanner = new NavCooperativePlanner();
+	}
+
+	// The distances to the goals were searched over the previous occupancy
+	if (CooperativeOccupancy != occupancy)
+	{
+		CooperativePlanner->ResetHeuristics();
+		CooperativeOccupancy = occupancy;
+	}
+	CooperativePlanner->SetWindow(CooperativeWindow);
+
+	std::vector<NavCooperativeAgent> agents;
+	agents.reserve(starts.Num());
+	for (int32 i = 0; i < starts.Num(); ++i)
+	{
+		agents.push_back(NavCooperativeAgent{ GetNodeIndex(ConvertLocationToCoordinates(starts[i])), GetNodeIndex(ConvertLocationToCoordinates(destinations[i])) });
+	}
+
+	std::vector<std::vector<int32> > paths;
+	const int32 waitingNum = CooperativePlanner->PlanWindow(*Grid, *occupancy, agents, paths, RunParallelFor);
+	INC_DWORD_STAT_BY(STAT_Navigation3D_NodesExpanded, CooperativePlanner->GetLastExpandedNum());
+
+	out_paths.SetNum(starts.Num());
+	for (int32 i = 0; i < starts.Num(); ++i)
+	{
+		ConvertCellsToLocations(*GridTransform, paths[i], out_paths[i].Locations);
+	}
+	return waitingNum;
+}
+
+bool ANavigationVolume3D::FindPathBetweenCells(int32 start_index, int32 end_index, TArray<FVector>& out_path)
+{
+	out_path.Reset();
+	if (Grid == nullptr || GameThreadContext == nullptr || start_index < 0 || start_index >= Grid->Num() || end_index < 0 || end_index >= Grid->Num())
+		return false;
+
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy;
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> clusterGraph;
+	{
+		FScopeLock lock(&OccupancyLock);
+		occupancy = Occupancy;
+		clusterGraph = ClusterGraph;
+	}
+	if (occupancy.IsValid() == false)
+		return false;
+
+	bool found = false;
+	int32 cacheHits = 0;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Search);
+		found = SearchOccupancy(*occupancy, clusterGraph.Get(), start_index, end_index, *GameThreadContext, cacheHits);
+	}
+	INC_DWORD_STAT_BY(STAT_Navigation3D_CacheHits, cacheHits);
+
+	if (found)
+	{
+		ConvertCellsToLocations(*GridTransform, GameThreadContext->PathCells, out_path);
+	}
+	return found;
+}
+
+bool ANavigationVolume3D::IsLocationInside(const FVector& location) const
+{
+	return GetCellIndex(location) != INDEX_NONE;
+}
+
+int32 ANavigationVolume3D::GetCellIndex(const FVector& location) const
+{
+	// Unlike ConvertLocationToCoordinates, locations outside of the grid aren't clamped to its border
+	const FVector gridSpaceLocation = GetActorTransform().InverseTransformPosition(location);
+	const FIntVector coordinates(FMath::FloorToInt(gridSpaceLocation.X / DivisionSize), FMath::FloorToInt(gridSpaceLocation.Y / DivisionSize), FMath::FloorToInt(gridSpaceLocation.Z / DivisionSize));
+	return AreCoordinatesValid(coordinates) ? GetNodeIndex(coordinates) : INDEX_NONE;
+}
+
+bool ANavigationVolume3D::IsCellBlocked(int32 index) const
+{
+	FScopeLock lock(&OccupancyLock);
+	return Occupancy.IsValid() == false || index < 0 || index >= Occupancy->Num() || Occupancy->IsBlocked(index);
+}
+
+FBox ANavigationVolume3D::GetGridBounds() const
+{
+	return FBox(FVector::ZeroVector, FVector(GetGridSizeX(), GetGridSizeY(), GetGridSizeZ())).TransformBy(GetActorTransform());
+}
+
+float ANavigationVolume3D::GetClearance(const FVector& location) const
+{
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField;
+	{
+		FScopeLock lock(&OccupancyLock);
+		clearanceField = ClearanceField;
+	}
+	if (clearanceField.IsValid() == false)
+		return -1.0f;
+
+	return clearanceField->GetClearance(GetNodeIndex(ConvertLocationToCoordinates(location))) * DivisionSize;
+}
+
+void ANavigationVolume3D::GetCellIndices(const TArray<FVector>& locations, TArray<int32>& out_cells) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_SpatialQueries);
+
+	const TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform = GetGridTransformSnapshot();
+	out_cells.SetNumUninitialized(locations.Num());
+	if (gridTransform.IsValid())
+	{
+		gridTransform->GetCellIndices(locations.GetData(), locations.Num(), false, out_cells.GetData());
+	}
+	else
+	{
+		for (int32& cell : out_cells)
+		{
+			cell = INDEX_NONE;
+		}
+	}
+}
+
+void ANavigationVolume3D::AreLocationsBlocked(const TArray<FVector>& locations, TArray<bool>& out_blocked) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_SpatialQueries);
+
+	// Take every snapshot at once, the queries themselves don't lock
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform;
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy;
+	TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> octree;
+	{
+		FScopeLock lock(&OccupancyLock);
+		gridTransform = GridTransform;
+		occupancy = Occupancy;
+		octree = Octree;
+	}
+
+	out_blocked.Init(true, locations.Num());
+	if (Grid == nullptr || gridTransform.IsValid() == false || (occupancy.IsValid() == false && octree.IsValid() == false))
+		return;
+
+	TArray<int32> cells;
+	cells.SetNumUninitialized(locations.Num());
+	gridTransform->GetCellIndices(locations.GetData(), locations.Num(), false, cells.GetData());
+	for (int32 i = 0; i < cells.Num(); ++i)
+	{
+		const int32 cell = cells[i];
+		if (cell == INDEX_NONE)
+			continue;
+
+		// The octree has no free node at blocked cells
+		out_blocked[i] = occupancy.IsValid() ? occupancy->IsBlocked(cell) : octree->FindGraphNode(Grid->GetCoordinates(cell)) == INDEX_NONE;
+	}
+}
+
+void ANavigationVolume3D::GetClearances(const TArray<FVector>& locations, TArray<float>& out_clearances) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_SpatialQueries);
+
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform;
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField;
+	{
+		FScopeLock lock(&OccupancyLock);
+		gridTransform = GridTransform;
+		clearanceField = ClearanceField;
+	}
+
+	out_clearances.Init(-1.0f, locations.Num());
+	if (gridTransform.IsValid() == false || clearanceField.IsValid() == false)
+		return;
+
+	TArray<int32> cells;
+	cells.SetNumUninitialized(locations.Num());
+	gridTransform->GetCellIndices(locations.GetData(), locations.Num(), true, cells.GetData());
+	for (int32 i = 0; i < cells.Num(); ++i)
+	{
+		out_clearances[i] = clearanceField->GetClearance(cells[i]) * DivisionSize;
+	}
+}
+
+void ANavigationVolume3D::FindNearestFreeLocations(const TArray<FVector>& locations, float max_distance, TArray<FVector>& out_locations, TArray<bool>& out_found) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_SpatialQueries);
+
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform;
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy;
+	{
+		FScopeLock lock(&OccupancyLock);
+		gridTransform = GridTransform;
+		occupancy = Occupancy;
+	}
+
+	out_locations = locations;
+	out_found.Init(false, locations.Num());
+	if (Grid == nullptr || gridTransform.IsValid() == false || occupancy.IsValid() == false || occupancy->Num() != Grid->Num())
+		return;
+
+	TArray<int32> cells;
+	cells.SetNumUninitialized(locations.Num());
+	gridTransform->GetCellIndices(locations.GetData(), locations.Num(), true, cells.GetData());
+	const int32 maxDistance = FMath::Max(FMath::FloorToInt(max_distance / DivisionSize), 0);
+	for (int32 i = 0; i < cells.Num(); ++i)
+	{
+		const int32 cell = occupancy->FindNearestFreeCell(*Grid, cells[i], maxDistance);
+		if (cell != INDEX_NONE)
+		{
+			out_locations[i] = gridTransform->GetCellCenter(Grid->GetCoordinates(cell));
+			out_found[i] = true;
+		}
+	}
+}
+
+uint32 ANavigationVolume3D::GetPathCacheProfile() const
+{
+	return static_cast<uint32>(SearchAlgorithm) | (bSmoothPaths ? 0x100u : 0u);
+}
+
+FNavPathCacheStats ANavigationVolume3D::GetPathCacheStats() const
+{
+	FNavPathCacheStats stats;
+	if (PathCache == nullptr)
+		return stats;
+
+	FScopeLock lock(&PathCacheLock);
+	stats.Hits = static_cast<int32>(PathCache->GetHitNum());
+	stats.TailHits = static_cast<int32>(PathCache->GetTailHitNum());
+	stats.Misses = static_cast<int32>(PathCache->GetMissNum());
+	stats.Invalidated = static_cast<int32>(PathCache->GetInvalidatedNum());
+	stats.Evicted = static_cast<int32>(PathCache->GetEvictedNum());
+	stats.CachedPaths = PathCache->Num();
+	const int64 lookups = PathCache->GetHitNum() + PathCache->GetTailHitNum() + PathCache->GetMissNum();
+	stats.HitRatio = lookups > 0 ? static_cast<float>(PathCache->GetHitNum() + PathCache->GetTailHitNum()) / lookups : 0.0f;
+	return stats;
+}
+
+void ANavigationVolume3D::ClearPathCache()
+{
+	if (PathCache == nullptr)
+		return;
+
+	FScopeLock lock(&PathCacheLock);
+	PathCache->Clear();
+	PathCache->ResetStats();
+}
+
+UNavigationPlanner3D* ANavigationVolume3D::CreatePlanner(UObject* owner)
+{
+	UNavigationPlanner3D* planner = NewObject<UNavigationPlanner3D>(owner != nullptr ? owner : this);
+	planner->Init(this);
+	return planner;
+}
+
+int32 ANavigationVolume3D::CreateFlowField(const TArray<FVector>& goals)
+{
+	if (Grid == nullptr || Representation == ENavVolumeRepresentation::SparseOctree)
+		return INDEX_NONE;
+
+	if (IsNavigationDataBuilt() == false)
+	{
+		BuildOccupancy(OccupancyObjectTypes, OccupancyActorClassFilter);
+		if (IsNavigationDataBuilt() == false)
+			return INDEX_NONE;
+	}
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_UpdateFlowFields);
+	TSharedPtr<NavFlowField> flowField = MakeShared<NavFlowField>();
+	flowField->Build(*Grid, *Occupancy, ConvertLocationsToCells(goals), RunParallelFor);
+
+	const int32 id = NextFlowFieldId++;
+	FlowFields.Add(id, flowField);
+	return id;
+}
+
+bool ANavigationVolume3D::SetFlowFieldGoals(int32 flow_field, const TArray<FVector>& goals)
+{
+	const TSharedPtr<NavFlowField>* flowField = FlowFields.Find(flow_field);
+	if (flowField == nullptr)
+		return false;
+
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_UpdateFlowFields);
+	(*flowField)->SetGoals(*Grid, *Occupancy, ConvertLocationsToCells(goals), RunParallelFor);
+	return true;
+}
+
+void ANavigationVolume3D::DestroyFlowField(int32 flow_field)
+{
+	FlowFields.Remove(flow_field);
+}
+
+bool ANavigationVolume3D::GetFlowFieldStep(int32 flow_field, const FVector& location, FVector& out_next_location, float& out_distance) const
+{
+	const TSharedPtr<NavFlowField>* flowField = FlowFields.Find(flow_field);
+	if (flowField == nullptr)
+		return false;
+
+	const int32 index = GetNodeIndex(ConvertLocationToCoordinates(location));
+	const float distance = (*flowField)->GetDistance(index);
+	if (distance == FLT_MAX)
+		return false;
+
+	// Goals have no next cell, agents there stay in their cell
+	const int32 next = (*flowField)->GetNextCell(*Grid, index);
+	out_next_location = ConvertCoordinatesToLocation(Grid->GetCoordinates(next != INDEX_NONE ? next : index));
+	out_distance = distance * DivisionSize;
+	return true;
+}
+
+std::vector<int32> ANavigationVolume3D::ConvertLocationsToCells(const TArray<FVector>& locations) const
+{
+	std::vector<int32> cells;
+	cells.reserve(locations.Num());
+	for (const FVector& location : locations)
+	{
+		cells.push_back(GetNodeIndex(ConvertLocationToCoordinates(location)));
+	}
+	return cells;
+}
+
+void ANavigationVolume3D::FinishPathQueryStats(const NavSearchContext& context, double start_time, uint64 start_expanded, FNavPathQueryStats& stats) const
+{
+	stats.NodesExpanded = static_cast<int32>(context.GetTotalExpandedNum() - start_expanded);
+	stats.OpenListPeak = context.GetPeakOpenNum();
+	stats.WallTimeMs = static_cast<float>((FPlatformTime::Seconds() - start_time) * 1000.0);
+
+	INC_DWORD_STAT(STAT_Navigation3D_PathQueries);
+	INC_DWORD_STAT_BY(STAT_Navigation3D_NodesExpanded, stats.NodesExpanded);
+	INC_DWORD_STAT_BY(STAT_Navigation3D_CacheHits, stats.CacheHits);
+
+	FScopeLock lock(&QueryStatsLock);
+
+	// Start over if the history was shrunk since the last query. The aggregates don't depend on the order of the entries.
+	if (RecentQueryStats.Num() > QueryStatsHistorySize || NextQueryStatsIndex >= QueryStatsHistorySize)
+	{
+		RecentQueryStats.Reset();
+		NextQueryStatsIndex = 0;
+	}
+	if (RecentQueryStats.Num() < QueryStatsHistorySize)
+	{
+		RecentQueryStats.Add(stats);
+	}
+	else
+	{
+		RecentQueryStats[NextQueryStatsIndex] = stats;
+	}
+	NextQueryStatsIndex = (NextQueryStatsIndex + 1) % QueryStatsHistorySize;
+	++TotalQueryCount;
+}
+
+FNavPathQueryStatsSummary ANavigationVolume3D::GetPathQueryStatsSummary() const
+{
+	FNavPathQueryStatsSummary summary;
+	TArray<float> wallTimes;
+	{
+		FScopeLock lock(&QueryStatsLock);
+		summary.TotalQueries = TotalQueryCount;
+		summary.SampleCount = RecentQueryStats.Num();
+		if (summary.SampleCount == 0)
+			return summary;
+
+		wallTimes.Reserve(summary.SampleCount);
+		int32 found = 0;
+		double wallTime = 0.0;
+		double nodesExpanded = 0.0;
+		double overlapQueries = 0.0;
+		double cacheHits = 0.0;
+		int32 pathCacheHits = 0;
+		for (const FNavPathQueryStats& stats : RecentQueryStats)
+		{
+			found += stats.bFoundPath ? 1 : 0;
+			wallTime += stats.WallTimeMs;
+			nodesExpanded += stats.NodesExpanded;
+			overlapQueries += stats.OverlapQueries;
+			cacheHits += stats.CacheHits;
+			pathCacheHits += stats.bPathCacheHit ? 1 : 0;
+			summary.MaxNodesExpanded = FMath::Max(summary.MaxNodesExpanded, stats.NodesExpanded);
+			summary.MaxOpenListPeak = FMath::Max(summary.MaxOpenListPeak, stats.OpenListPeak);
+			wallTimes.Add(stats.WallTimeMs);
+		}
+
+		summary.FoundRatio = static_cast<float>(found) / summary.SampleCount;
+		summary.AverageWallTimeMs = static_cast<float>(wallTime / summary.SampleCount);
+		summary.AverageNodesExpanded = static_cast<float>(nodesExpanded / summary.SampleCount);
+		summary.AverageOverlapQueries = static_cast<float>(overlapQueries / summary.SampleCount);
+		summary.AverageCacheHits = static_cast<float>(cacheHits / summary.SampleCount);
+		summary.PathCacheHitRatio = static_cast<float>(pathCacheHits) / summary.SampleCount;
+	}
+
+	// Sort outside of the lock so queries recording their stats aren't held up
+	wallTimes.Sort();
+	summary.P50WallTimeMs = wallTimes[FMath::Min(wallTimes.Num() / 2, wallTimes.Num() - 1)];
+	summary.P99WallTimeMs = wallTimes[FMath::Min((wallTimes.Num() * 99) / 100, wallTimes.Num() - 1)];
+	summary.MaxWallTimeMs = wallTimes.Last();
+	return summary;
+}
+
+void ANavigationVolume3D::ResetPathQueryStats()
+{
+	FScopeLock lock(&QueryStatsLock);
+	RecentQueryStats.Empty();
+	NextQueryStatsIndex = 0;
+	TotalQueryCount = 0;
+}
+
+void ANavigationVolume3D::DumpPathQueryStats() const
+{
+	const FNavPathQueryStatsSummary summary = GetPathQueryStatsSummary();
+	UE_LOG(LogNavigation3D, Log, TEXT("%s: %d queries, last %d: %.0f%% found, wall time avg %.3f ms p50 %.3f ms p99 %.3f ms max %.3f ms, nodes expanded avg %.1f max %d, open list peak %d, overlap queries avg %.1f, cache hits avg %.1f, %.0f%% from the path cache"),
+		*GetName(), summary.TotalQueries, summary.SampleCount, summary.FoundRatio * 100.0f,
+		summary.AverageWallTimeMs, summary.P50WallTimeMs, summary.P99WallTimeMs, summary.MaxWallTimeMs,
+		summary.AverageNodesExpanded, summary.MaxNodesExpanded, summary.MaxOpenListPeak, summary.AverageOverlapQueries, summary.AverageCacheHits, summary.PathCacheHitRatio * 100.0f);
+}
+
+int32 ANavigationVolume3D::RequestPathAsync(const FVector& start, const FVector& destination, int32 priority, const FNavPathQueryDelegate& on_complete)
+{
+	if (PathQueue == nullptr || (bUseOccupancyCache == false && Representation == ENavVolumeRepresentation::DenseGrid))
+		return INDEX_NONE;
+
+	// Worker threads can only read the occupancy, so make sure there is one to read
+	if (IsNavigationDataBuilt() == false)
+	{
+		BuildOccupancy(OccupancyObjectTypes, OccupancyActorClassFilter);
+	}
+
+	return PathQueue->Submit(start, destination, priority, on_complete);
+}
+
+bool ANavigationVolume3D::CancelPathRequest(int32 request_id)
+{
+	return PathQueue != nullptr && PathQueue->Cancel(request_id);
+}
+
+bool ANavigationVolume3D::IsPathRequestPending(int32 request_id) const
+{
+	return PathQueue != nullptr && PathQueue->IsPending(request_id);
+}
+
+TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> ANavigationVolume3D::GetOccupancySnapshot() const
+{
+	FScopeLock lock(&OccupancyLock);
+	return Occupancy;
+}
+
+TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> ANavigationVolume3D::GetOctreeSnapshot() const
+{
+	FScopeLock lock(&OccupancyLock);
+	return Octree;
+}
+
+TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> ANavigationVolume3D::GetGridTransformSnapshot() const
+{
+	FScopeLock lock(&OccupancyLock);
+	return GridTransform;
+}
+
+void ANavigationVolume3D::UpdateGridTransform()
+{
+	// The volume's rotation and scale keep the grid axes orthogonal, which is all the cached inverse relies on
+	const FTransform& transform = GetActorTransform();
+	const FVector axes[3] = { transform.TransformVector(FVector::ForwardVector), transform.TransformVector(FVector::RightVector), transform.TransformVector(FVector::UpVector) };
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> gridTransform = MakeShared<NavGridTransform, ESPMode::ThreadSafe>();
+	gridTransform->Init(FIntVector(DivisionsX, DivisionsY, DivisionsZ), transform.GetLocation(), axes, DivisionSize);
+
+	FScopeLock lock(&OccupancyLock);
+	GridTransform = gridTransform;
+}
+
+void ANavigationVolume3D::OnRootTransformUpdated(USceneComponent* updated_component, EUpdateTransformFlags update_transform_flags, ETeleportType teleport)
+{
+	UpdateGridTransform();
+}
+
+void ANavigationVolume3D::BuildOccupancy(const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildOccupancy);
+
+	// The grid is only set up once play begins
+	if (Grid == nullptr)
+		return;
+
+	// Remember the profile the occupancy is built for
+	if (&object_types != &OccupancyObjectTypes)
+	{
+		OccupancyObjectTypes = object_types;
+	}
+	OccupancyActorClassFilter = actor_class_filter;
+
+	// The octree replaces the bitfield, and is built without allocating anything per cell
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
+	{
+		PendingOctreeRegions.Reset();
+		BuildSparseOctree(nullptr);
+		return;
+	}
+
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = MakeShared<NavOccupancy, ESPMode::ThreadSafe>();
+	occupancy->Init(GetTotalDivisions());
+	VoxelizeOccupancy(*occupancy);
+	PublishOccupancy(occupancy);
+}
+
+void ANavigationVolume3D::VoxelizeOccupancy(NavOccupancy& occupancy)
+{
+	if (bVoxelizeCollisionGeometry)
+	{
+		VoxelizeCollisionGeometry(occupancy, FIntVector::ZeroValue, FIntVector(DivisionsX - 1, DivisionsY - 1, DivisionsZ - 1));
+		return;
+	}
+
+	// Test every cell once and store the result in the bitfield
+	for (int32 z = 0; z < DivisionsZ; ++z)
+	{
+		for (int32 y = 0; y < DivisionsY; ++y)
+		{
+			for (int32 x = 0; x < DivisionsX; ++x)
+			{
+				const FIntVector coordinates(x, y, z);
+				if (IsCellBlockedByPhysics(coordinates, OccupancyObjectTypes, OccupancyActorClassFilter))
+				{
+					occupancy.SetBlocked(GetNodeIndex(coordinates), true);
+				}
+			}
+		}
+	}
+}
+
+FVector ANavigationVolume3D::GetCellOverlapHalfExtent() const
+{
+	// The overlap test of a cell is a world aligned box of half the division size around its center. In grid space that box
+	// is rotated and scaled with the volume, so take the grid aligned box containing it, plus a margin for rounding.
+	const FTransform& transform = GetActorTransform();
+	FVector halfExtent(VoxelizationMargin);
+	for (int32 axis = 0; axis < 3; ++axis)
+	{
+		FVector worldHalfAxis = FVector::ZeroVector;
+		worldHalfAxis[axis] = DivisionSize / 2.0f;
+		halfExtent += transform.InverseTransformVector(worldHalfAxis).GetAbs() / DivisionSize;
+	}
+	return halfExtent;
+}
+
+void ANavigationVolume3D::VoxelizeCollisionGeometry(NavOccupancy& occupancy, const FIntVector& min_coordinates, const FIntVector& max_coordinates)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Voxelize);
+
+	const FVector halfExtent = GetCellOverlapHalfExtent();
+	TArray<UPrimitiveComponent*> components;
+	GatherOccupancyComponents(min_coordinates, max_coordinates, halfExtent, components);
+
+	// The shapes are moved so the region starts at the origin of the grid they're voxelized into
+	NavVoxelShapes shapes;
+	TArray<UPrimitiveComponent*> unreadableComponents;
+	for (UPrimitiveComponent* component : components)
+	{
+		if (AddCollisionShapes(component, min_coordinates, shapes) == false)
+		{
+			unreadableComponents.Add(component);
+		}
+	}
+
+	const FIntVector size = max_coordinates - min_coordinates + FIntVector(1, 1, 1);
+	NavVoxelizer::Voxelize(size, shapes, halfExtent, occupancy, RunParallelFor);
+
+	// Collision that can't be read is still queried from physics, only over the cells of its bounds within the region
+	const FCollisionShape cellShape = FCollisionShape::MakeBox(FVector(DivisionSize / 2.0f));
+	for (UPrimitiveComponent* component : unreadableComponents)
+	{
+		FIntVector minCoordinates;
+		FIntVector maxCoordinates;
+		if (GetCellRange(component->Bounds.GetBox(), minCoordinates, maxCoordinates) == false)
+			continue;
+
+		for (int32 z = FMath::Max(minCoordinates.Z, min_coordinates.Z); z <= FMath::Min(maxCoordinates.Z, max_coordinates.Z); ++z)
+		{
+			for (int32 y = FMath::Max(minCoordinates.Y, min_coordinates.Y); y <= FMath::Min(maxCoordinates.Y, max_coordinates.Y); ++y)
+			{
+				for (int32 x = FMath::Max(minCoordinates.X, min_coordinates.X); x <= FMath::Min(maxCoordinates.X, max_coordinates.X); ++x)
+				{
+					const FIntVector coordinates(x, y, z);
+					const int32 index = ((((z - min_coordinates.Z) * size.Y) + (y - min_coordinates.Y)) * size.X) + (x - min_coordinates.X);
+					if (occupancy.IsBlocked(index))
+						continue;
+
+					SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PhysicsOverlap);
+					INC_DWORD_STAT(STAT_Navigation3D_OverlapQueries);
+					if (component->OverlapComponent(ConvertCoordinatesToLocation(coordinates), FQuat::Identity, cellShape))
+					{
+						occupancy.SetBlocked(index, true);
+					}
+				}
+			}
+		}
+	}
+}
+
+bool ANavigationVolume3D::AddCollisionShapes(UPrimitiveComponent* component, const FIntVector& grid_origin, NavVoxelShapes& shapes) const
+{
+	UBodySetup* bodySetup = component->GetBodySetup();
+	if (bodySetup == nullptr)
+		return false;
+
+	// Shapes are converted into grid space, in cells from the grid origin
+	const FTransform& volumeTransform = GetActorTransform();
+	const FTransform& componentTransform = component->GetComponentTransform();
+	const FVector origin(grid_origin);
+	auto toGrid = [&](const FVector& local_position)
+	{
+		return (volumeTransform.InverseTransformPosition(componentTransform.TransformPosition(local_position)) / DivisionSize) - origin;
+	};
+	auto toGridVector = [&](const FVector& local_vector)
+	{
+		return volumeTransform.InverseTransformVector(componentTransform.TransformVector(local_vector)) / DivisionSize;
+	};
+
+	// Radii are scaled by the largest scale of the component and the smallest of the volume, so spheres and capsules
+	// under non uniform scale are covered by the ones voxelized
+	const float radiusScale = componentTransform.GetScale3D().GetAbsMax() / (volumeTransform.GetScale3D().GetAbsMin() * DivisionSize);
+
+	// Complex collision used as simple is only readable from static meshes with CPU accessible collision data
+	if (bodySetup->GetCollisionTraceFlag() == CTF_UseComplexAsSimple)
+	{
+		const UStaticMeshComponent* staticMeshComponent = Cast<UStaticMeshComponent>(component);
+		UStaticMesh* staticMesh = staticMeshComponent != nullptr ? staticMeshComponent->GetStaticMesh() : nullptr;
+		FTriMeshCollisionData triangleMesh;
+		if (staticMesh == nullptr || staticMesh->ContainsPhysicsTriMeshData(true) == false || staticMesh->GetPhysicsTriMeshData(&triangleMesh, true) == false)
+			return false;
+
+		std::vector<FVector> vertices;
+		vertices.reserve(triangleMesh.Vertices.Num());
+		for (const auto& vertex : triangleMesh.Vertices)
+		{
+			vertices.push_back(toGrid(FVector(vertex)));
+		}
+
+		std::vector<int32> indices;
+		indices.reserve(triangleMesh.Indices.Num() * 3);
+		for (const FTriIndices& triangle : triangleMesh.Indices)
+		{
+			indices.push_back(triangle.v0);
+			indices.push_back(triangle.v1);
+			indices.push_back(triangle.v2);
+		}
+
+		shapes.AddTriangleMesh(vertices, indices);
+		return true;
+	}
+
+	const FKAggregateGeom& geometry = bodySetup->AggGeom;
+	if (geometry.GetElementCount() == 0)
+		return false;
+
+	// Convex hulls without their triangles can't be turned into planes
+	for (const FKConvexElem& convex : geometry.ConvexElems)
+	{
+		if (convex.IndexData.Num() < 3)
+			return false;
+	}
+
+	for (const FKSphereElem& sphere : geometry.SphereElems)
+	{
+		shapes.Spheres.push_back(NavVoxelShapes::Sphere{ toGrid(sphere.Center), sphere.Radius * radiusScale });
+	}
+
+	for (const FKBoxElem& box : geometry.BoxElems)
+	{
+		const FQuat rotation = box.Rotation.Quaternion();
+		shapes.AddBox(toGrid(box.Center),
+			toGridVector(rotation.RotateVector(FVector(box.X / 2.0f, 0.0f, 0.0f))),
+			toGridVector(rotation.RotateVector(FVector(0.0f, box.Y / 2.0f, 0.0f))),
+			toGridVector(rotation.RotateVector(FVector(0.0f, 0.0f, box.Z / 2.0f))));
+	}
+
+	// Capsules run along their local Z axis
+	for (const FKSphylElem& capsule : geometry.SphylElems)
+	{
+		const FVector halfSegment = capsule.Rotation.Quaternion().RotateVector(FVector(0.0f, 0.0f, capsule.Length / 2.0f));
+		shapes.Capsules.push_back(NavVoxelShapes::Capsule{ toGrid(capsule.Center - halfSegment), toGrid(capsule.Center + halfSegment), capsule.Radius * radiusScale });
+	}
+
+	// Tapered capsules are covered by a capsule of their larger radius
+	for (const FKTaperedCapsuleElem& capsule : geometry.TaperedCapsuleElems)
+	{
+		const FVector halfSegment = capsule.Rotation.Quaternion().RotateVector(FVector(0.0f, 0.0f, capsule.Length / 2.0f));
+		shapes.Capsules.push_back(NavVoxelShapes::Capsule{ toGrid(capsule.Center - halfSegment), toGrid(capsule.Center + halfSegment), FMath::Max(capsule.Radius0, capsule.Radius1) * radiusScale });
+	}
+
+	for (const FKConvexElem& convex : geometry.ConvexElems)
+	{
+		const FTransform& elementTransform = convex.GetTransform();
+		std::vector<FVector> vertices;
+		vertices.reserve(convex.VertexData.Num());
+		for (const FVector& vertex : convex.VertexData)
+		{
+			vertices.push_back(toGrid(elementTransform.TransformPosition(vertex)));
+		}
+		shapes.AddConvex(vertices, std::vector<int32>(convex.IndexData.GetData(), convex.IndexData.GetData() + convex.IndexData.Num()));
+	}
+	return true;
+}
+
+void ANavigationVolume3D::PublishOccupancy(const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe>& occupancy)
+{
+	// A full rebuild supersedes any pending incremental update
+	StagingOccupancy.Reset();
+	DirtyCellMask.Init(false, GetTotalDivisions());
+	PendingDirtyCells.Reset();
+	ActiveDirtyCells.Reset();
+	ChangedDirtyCells.Reset();
+	ActiveDirtyCursor = 0;
+	PendingDirtyRegions.Reset();
+	ActiveDirtyRegions.Reset();
+	ActiveDirtyRegionCursor = 0;
+
+	occupancy->BuildNearBlocked(*Grid);
+
+	// The cluster graph is only needed, and only kept up to date, for hierarchical search
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> clusterGraph;
+	if (SearchAlgorithm == ENavSearchAlgorithm::Hierarchical)
+	{
+		clusterGraph = BuildClusterGraph(*occupancy, nullptr, TArray<int32>());
+	}
+
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> components;
+	if (bRejectUnreachableQueries)
+	{
+		components = BuildComponents(*occupancy, nullptr, TArray<int32>());
+	}
+
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField;
+	if (bBuildClearanceField)
+	{
+		clearanceField = BuildClearanceField(*occupancy);
+	}
+
+	// The flow fields are rebuilt rather than updated, any cell may have changed
+	if (FlowFields.Num() > 0)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_UpdateFlowFields);
+		for (const TPair<int32, TSharedPtr<NavFlowField> >& flowField : FlowFields)
+		{
+			const std::vector<int32> goals = flowField.Value->GetGoals();
+			flowField.Value->Build(*Grid, *occupancy, goals, RunParallelFor);
+		}
+	}
+
+	{
+		FScopeLock lock(&OccupancyLock);
+		Occupancy = occupancy;
+		ClusterGraph = clusterGraph;
+		Components = components;
+		ClearanceField = clearanceField;
+
+		// Paths found over the previous occupancy may go through any cell that changed
+		if (PathCache != nullptr)
+		{
+			FScopeLock cacheLock(&PathCacheLock);
+			PathCache->Clear();
+		}
+	}
+
+	if (DebugDrawMode == ENavDebugDrawMode::OccupiedCells)
+	{
+		UpdateDebugMesh(true);
+	}
+
+	// Any cell of the border may have changed
+	RefreshPortals(TArray<int32>());
+}
+
+void ANavigationVolume3D::BakeNavigationData()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	if (BakedData == nullptr)
+	{
+		UE_LOG(LogNavigation3D, Warning, TEXT("%s: assign a baked data asset before baking"), *GetName());
+		return;
+	}
 
-	// Create the default scene component
-	DefaultSceneComponent = CreateDefaultSubobject<USceneComponent>("DefaultSceneComponent");
-	SetRootComponent(DefaultSceneComponent);
+	NavOccupancy occupancy;
+	occupancy.Init(GetTotalDivisions());
+	VoxelizeOccupancy(occupancy);
 
-	// Create the procedural mesh component
-	ProceduralMesh = CreateDefaultSubobject<UProceduralMeshComponent>("ProceduralMesh");
-	ProceduralMesh->SetupAttachment(GetRootComponent());
-	ProceduralMesh->CastShadow = false;
-	ProceduralMesh->SetEnableGravity(false);
-	ProceduralMesh->bApplyImpulseOnDamage = false;
-	ProceduralMesh->SetGenerateOverlapEvents(false);
-	ProceduralMesh->CanCharacterStepUpOn = ECanBeCharacterBase::ECB_No;
-	ProceduralMesh->SetCollisionProfileName("NoCollision");
-	ProceduralMesh->bHiddenInGame = false;
+	const FIntVector divisions(DivisionsX, DivisionsY, DivisionsZ);
+	const ENavBakedCompression compression = BakedDataCompression == ENavBakedDataCompression::RunLength ? ENavBakedCompression::RunLength : ENavBakedCompression::BitPacked;
+	std::vector<uint8> data;
+	NavBakedData::Write(divisions, occupancy, ComputeLevelChecksum(), compression, data);
 
-	// By default, hide the volume while the game is running
-	SetActorHiddenInGame(true);
+	// Run length encoding may have fallen back to packed bits
+	NavBakedDataHeader header;
+	NavBakedData::ReadHeader(data.data(), data.size(), header);
+	const ENavBakedDataCompression storedCompression = header.Compression == static_cast<uint8>(ENavBakedCompression::RunLength) ? ENavBakedDataCompression::RunLength : ENavBakedDataCompression::BitPacked;
 
-	// Find and save the grid material
-	static ConstructorHelpers::FObjectFinder<UMaterial> materialFinder(TEXT("Material'/Navigation3D/M_Grid.M_Grid'"));
-	GridMaterial = materialFinder.Object;
+	BakedData->Modify();
+	BakedData->SetData(TArray<uint8>(data.data(), static_cast<int32>(data.size())), divisions, header.BlockedCellCount, storedCompression);
+	BakedData->MarkPackageDirty();
+
+	UE_LOG(LogNavigation3D, Log, TEXT("%s: baked %d cells (%u blocked) into %d bytes"), *GetName(), GetTotalDivisions(), header.BlockedCellCount, BakedData->DataSize);
 }
 
-void ANavigationVolume3D::OnConstruction(const FTransform& Transform)
+bool ANavigationVolume3D::LoadBakedData()
 {
-	Super::OnConstruction(Transform);
+	if (BakedData == nullptr || Grid == nullptr)
+		return false;
 
-	// Create arrays to store the vertices and the triangles
-	TArray<FVector> vertices;
-	TArray<int32> triangles;
-	
-	// Define variables for the start and end of the line
-	FVector start = FVector::ZeroVector;
-	FVector end = FVector::ZeroVector;
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_LoadBakedData);
+
+	const TArray<uint8>& data = BakedData->GetData();
+	const FIntVector divisions(DivisionsX, DivisionsY, DivisionsZ);
 
-	// Create the X lines geometry
-	for (int32 z = 0; z <= DivisionsZ; ++z)
+	// Check the header before decoding anything
+	NavBakedDataHeader header;
+	ENavBakedDataResult result = NavBakedData::ReadHeader(data.GetData(), data.Num(), header);
+	if (result == ENavBakedDataResult::Success && header.GetDivisions() != divisions)
 	{
-		start.Z = end.Z = z * DivisionSize;
-		for (int32 x = 0; x <= DivisionsX; ++x)
+		UE_LOG(LogNavigation3D, Warning, TEXT("%s: %s was baked for a different grid, rebake it"), *GetName(), *BakedData->GetName());
+		return false;
+	}
+	if (result == ENavBakedDataResult::Success && bRejectStaleBakedData && header.LevelChecksum != ComputeLevelChecksum())
+	{
+		UE_LOG(LogNavigation3D, Warning, TEXT("%s: %s is stale, the level has changed since it was baked"), *GetName(), *BakedData->GetName());
+		return false;
+	}
+
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> occupancy = MakeShared<NavOccupancy, ESPMode::ThreadSafe>();
+	if (result == ENavBakedDataResult::Success)
+	{
+		result = NavBakedData::Read(data.GetData(), data.Num(), *occupancy);
+	}
+	if (result != ENavBakedDataResult::Success)
+	{
+		UE_LOG(LogNavigation3D, Warning, TEXT("%s: can't load %s, %s"), *GetName(), *BakedData->GetName(), GetBakedDataResultText(result));
+		return false;
+	}
+
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildOctree);
+
+		// Regions are tested against the baked bits instead of physics
+		auto isRegionBlocked = [this, &occupancy](const FIntVector& min_coordinates, int32 size)
 		{
-			start.X = end.X = (x * DivisionSize);
-			end.Y = GetGridSizeY();
+			const FIntVector maxCoordinates(FMath::Min(min_coordinates.X + size, DivisionsX), FMath::Min(min_coordinates.Y + size, DivisionsY), FMath::Min(min_coordinates.Z + size, DivisionsZ));
+			for (int32 z = min_coordinates.Z; z < maxCoordinates.Z; ++z)
+				for (int32 y = min_coordinates.Y; y < maxCoordinates.Y; ++y)
+					for (int32 x = min_coordinates.X; x < maxCoordinates.X; ++x)
+						if (occupancy->IsBlocked(GetNodeIndex(FIntVector(x, y, z))))
+							return true;
+			return false;
+		};
 
-			CreateLine(start, end, FVector::UpVector, vertices, triangles);
-		}
+		TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> octree = MakeShared<NavSparseOctree, ESPMode::ThreadSafe>();
+		octree->Build(divisions, isRegionBlocked);
+		PendingOctreeRegions.Reset();
+
+		FScopeLock lock(&OccupancyLock);
+		Octree = octree;
+		return true;
 	}
 
-	// Reset start and end variables
-	start = FVector::ZeroVector;
-	end = FVector::ZeroVector;
+	PublishOccupancy(occupancy);
+	return true;
+}
+
+uint64 ANavigationVolume3D::ComputeLevelChecksum() const
+{
+	// The settings the occupancy depends on
+	const FIntVector divisions(DivisionsX, DivisionsY, DivisionsZ);
+	const FTransform& transform = GetActorTransform();
+	uint64 checksum = NavBakedData::Hash(&divisions, sizeof(divisions));
+	checksum = NavBakedData::Hash(&DivisionSize, sizeof(DivisionSize), checksum);
+	checksum = HashTransform(transform, checksum);
+	checksum = NavBakedData::Hash(OccupancyObjectTypes.GetData(), OccupancyObjectTypes.Num() * sizeof(TEnumAsByte<EObjectTypeQuery>), checksum);
+	const FString classFilterName = OccupancyActorClassFilter != nullptr ? OccupancyActorClassFilter->GetPathName() : FString();
+	checksum = NavBakedData::Hash(*classFilterName, classFilterName.Len() * sizeof(TCHAR), checksum);
+
+	TArray<UPrimitiveComponent*> components;
+	GatherOccupancyComponents(FIntVector::ZeroValue, FIntVector(DivisionsX - 1, DivisionsY - 1, DivisionsZ - 1), GetCellOverlapHalfExtent(), components);
 
-	// Create the Y lines geometry
-	for (int32 z = 0; z <= DivisionsZ; ++z)
+	// Components are hashed on their own and sorted, so the order physics reports them in doesn't matter
+	TArray<uint64> componentChecksums;
+	componentChecksums.Reserve(components.Num());
+	for (const UPrimitiveComponent* component : components)
 	{
-		start.Z = end.Z = z * DivisionSize;
-		for (int32 y = 0; y <= DivisionsY; ++y)
-		{
-			start.Y = end.Y = (y * DivisionSize);
-			end.X = GetGridSizeX();
+		// Names rather than paths, which differ between the editor and play in editor worlds
+		const FString name = component->GetOwner()->GetName() + TEXT(".") + component->GetName();
+		const FBox bounds = component->Bounds.GetBox();
+		uint64 componentChecksum = NavBakedData::Hash(*name, name.Len() * sizeof(TCHAR));
+		componentChecksum = HashTransform(component->GetComponentTransform(), componentChecksum);
+		componentChecksum = NavBakedData::Hash(&bounds.Min, sizeof(bounds.Min), componentChecksum);
+		componentChecksum = NavBakedData::Hash(&bounds.Max, sizeof(bounds.Max), componentChecksum);
+		componentChecksums.Add(componentChecksum);
+	}
+	componentChecksums.Sort();
+
+	return NavBakedData::Hash(componentChecksums.GetData(), componentChecksums.Num() * sizeof(uint64), checksum);
+}
 
-			CreateLine(start, end, FVector::UpVector, vertices, triangles);
+void ANavigationVolume3D::GatherOccupancyComponents(const FIntVector& min_coordinates, const FIntVector& max_coordinates, const FVector& cell_half_extent, TArray<UPrimitiveComponent*>& out_components) const
+{
+	const UWorld* world = GetWorld();
+	if (world == nullptr || OccupancyObjectTypes.Num() == 0)
+		return;
+
+	// Every component that can block a cell of the region overlaps the region, grown by how far the overlap tests of its cells reach
+	const FTransform& transform = GetActorTransform();
+	const FVector reach = cell_half_extent - FVector(0.5f);
+	const FVector minLocation = (FVector(min_coordinates) - reach) * DivisionSize;
+	const FVector maxLocation = (FVector(max_coordinates + FIntVector(1, 1, 1)) + reach) * DivisionSize;
+	const FVector halfSize = (maxLocation - minLocation) / 2.0f;
+	TArray<FOverlapResult> overlaps;
+	world->OverlapMultiByObjectType(overlaps, transform.TransformPosition(minLocation + halfSize), transform.GetRotation(), FCollisionObjectQueryParams(OccupancyObjectTypes), FCollisionShape::MakeBox(halfSize * transform.GetScale3D()));
+
+	for (const FOverlapResult& overlap : overlaps)
+	{
+		UPrimitiveComponent* component = overlap.GetComponent();
+		const AActor* actor = overlap.GetActor();
+		if (component != nullptr && actor != nullptr && (OccupancyActorClassFilter == nullptr || actor->IsA(OccupancyActorClassFilter)))
+		{
+			out_components.AddUnique(component);
 		}
 	}
+}
+
+bool ANavigationVolume3D::HasOccupancyFor(const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter) const
+{
+	return IsNavigationDataBuilt() && OccupancyActorClassFilter == actor_class_filter && GetObjectTypeMask(OccupancyObjectTypes) == GetObjectTypeMask(object_types);
+}
 
-	// Reset start and end variables
-	start = FVector::ZeroVector;
-	end = FVector::ZeroVector;
+void ANavigationVolume3D::BuildSparseOctree(const NavSparseOctree* previous)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildOctree);
 
-	// Create the Z lines geometry
-	for (int32 x = 0; x <= DivisionsX; ++x)
+	auto isRegionBlocked = [this](const FIntVector& min_coordinates, int32 size)
 	{
-		start.X = end.X = x * DivisionSize;
-		for (int32 y = 0; y <= DivisionsY; ++y)
-		{
-			start.Y = end.Y = (y * DivisionSize);
-			end.Z = GetGridSizeZ();
+		return IsRegionBlockedByPhysics(min_coordinates, size, OccupancyObjectTypes, OccupancyActorClassFilter);
+	};
 
-			CreateLine(start, end, FVector::ForwardVector, vertices, triangles);
-		}
+	std::vector<NavCellBox> changedRegions;
+	changedRegions.reserve(PendingOctreeRegions.Num());
+	for (const TPair<FIntVector, FIntVector>& region : PendingOctreeRegions)
+	{
+		changedRegions.push_back(NavCellBox{ region.Key, region.Value });
 	}
 
-	// Unused variables that are required to be passed to CreateMeshSection
-	TArray<FVector> Normals;
-	TArray<FVector2D> UVs;
-	TArray<FColor> Colors;
-	TArray<FProcMeshTangent> Tangents;
+	TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> octree = MakeShared<NavSparseOctree, ESPMode::ThreadSafe>();
+	octree->Build(FIntVector(DivisionsX, DivisionsY, DivisionsZ), isRegionBlocked, previous, changedRegions);
+	PendingOctreeRegions.Reset();
 
-	// Add the geometry to the procedural mesh so it will render
-	ProceduralMesh->CreateMeshSection(0, vertices, triangles, Normals, UVs, Colors, Tangents, false);
+	FScopeLock lock(&OccupancyLock);
+	Octree = octree;
+}
+
+TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> ANavigationVolume3D::BuildClusterGraph(const NavOccupancy& occupancy, const NavClusterGraph* previous, const TArray<int32>& changed_cells) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildClusterGraph);
 
-	// Set the material on the procedural mesh so it's color/opacity can be configurable
-	UMaterialInstanceDynamic* dynamicMaterialInstance = UMaterialInstanceDynamic::Create(GridMaterial, this);
-	dynamicMaterialInstance->SetVectorParameterValue("Color", Color);
-	dynamicMaterialInstance->SetScalarParameterValue("Opacity", Color.A);
-	ProceduralMesh->SetMaterial(0, dynamicMaterialInstance);
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> clusterGraph = MakeShared<NavClusterGraph, ESPMode::ThreadSafe>();
+	clusterGraph->Build(*Grid, occupancy, ClusterSize, previous, std::vector<int32>(changed_cells.GetData(), changed_cells.GetData() + changed_cells.Num()));
+	return clusterGraph;
 }
 
-// Called when the game starts or when spawned
-void ANavigationVolume3D::BeginPlay()
+TSharedPtr<NavComponents, ESPMode::ThreadSafe> ANavigationVolume3D::BuildComponents(const NavOccupancy& occupancy, const NavComponents* previous, const TArray<int32>& changed_cells) const
 {
-	Super::BeginPlay();
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildComponents);
 
-	// Allocate nodes used for pathfinding
-	Nodes = new NavNode[GetTotalDivisions()];
-
-	// Helper lambda for adding a neighbor
-	auto addNeighborIfValid = [&](NavNode* node, const FIntVector& neighbor_coordinates)
-	{
-		// Make sure the neighboring coordinates are valid
-		if (AreCoordinatesValid(neighbor_coordinates))
-		{
-			int32 sharedAxes = 0;
-			if (node->Coordinates.X == neighbor_coordinates.X)
-				++sharedAxes;
-			if (node->Coordinates.Y == neighbor_coordinates.Y)
-				++sharedAxes;
-			if (node->Coordinates.Z == neighbor_coordinates.Z)
-				++sharedAxes;
-		
-			// Only add the neighbor if we share more axes with it then the required min shared neighbor axes and it isn't the same node as us
-			if (sharedAxes >= MinSharedNeighborAxes && sharedAxes < 3)
-			{
-				node->Neighbors.push_back(GetNode(neighbor_coordinates));
-			}
-		}
-	};
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> components = MakeShared<NavComponents, ESPMode::ThreadSafe>();
+	components->Build(*Grid, occupancy, previous, std::vector<int32>(changed_cells.GetData(), changed_cells.GetData() + changed_cells.Num()));
+	return components;
+}
 
-	// For each node, find its neighbors and assign its coordinates
-	for (int32 z = 0; z < DivisionsZ; ++z)
+TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> ANavigationVolume3D::BuildClearanceField(const NavOccupancy& occupancy) const
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_BuildClearance);
+
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField = MakeShared<NavClearanceField, ESPMode::ThreadSafe>();
+	clearanceField->Build(*Grid, occupancy, RunParallelFor);
+	return clearanceField;
+}
+
+void ANavigationVolume3D::RefreshPortals(const TArray<int32>& changed_cells)
+{
+	UWorld* world = GetWorld();
+	UNavigationSubsystem3D* navigation = world != nullptr ? world->GetSubsystem<UNavigationSubsystem3D>() : nullptr;
+	if (navigation == nullptr)
+		return;
+
+	// Portals are only on the border of the grid, changes inside of it don't move them
+	bool borderChanged = changed_cells.Num() == 0;
+	for (int32 i = 0; i < changed_cells.Num() && borderChanged == false; ++i)
 	{
-		for (int32 y = 0; y < DivisionsY; ++y)
-		{
-			for (int32 x = 0; x < DivisionsX; ++x)
-			{
-				NavNode* node = GetNode(FIntVector(x, y, z));
-				node->Coordinates = FIntVector(x, y, z);
+		const FIntVector coordinates = Grid->GetCoordinates(changed_cells[i]);
+		borderChanged = coordinates.X == 0 || coordinates.Y == 0 || coordinates.Z == 0 ||
+			coordinates.X == DivisionsX - 1 || coordinates.Y == DivisionsY - 1 || coordinates.Z == DivisionsZ - 1;
+	}
 
-				// Above neighbors
-				{
-					// front
-					{
-						addNeighborIfValid(node, FIntVector(x + 1, y - 1, z + 1));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 0, z + 1));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 1, z + 1));
-					}
-					// middle
-					{
-						addNeighborIfValid(node, FIntVector(x + 0, y - 1, z + 1));
-						addNeighborIfValid(node, FIntVector(x + 0, y + 0, z + 1));
-						addNeighborIfValid(node, FIntVector(x + 0, y + 1, z + 1));
-					}
-					// back
-					{
-						addNeighborIfValid(node, FIntVector(x - 1, y - 1, z + 1));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 0, z + 1));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 1, z + 1));
-					}
-				}
+	if (borderChanged)
+	{
+		navigation->RefreshVolume(this);
+	}
+}
 
-				// Middle neighbors
-				{
-					// front
-					{
-						addNeighborIfValid(node, FIntVector(x + 1, y - 1, z + 0));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 0, z + 0));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 1, z + 0));
-					}
-					// middle
-					{
-						addNeighborIfValid(node, FIntVector(x + 0, y - 1, z + 0));
-						addNeighborIfValid(node, FIntVector(x + 0, y + 1, z + 0));
-					}
-					// back
-					{
-						addNeighborIfValid(node, FIntVector(x - 1, y - 1, z + 0));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 0, z + 0));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 1, z + 0));
-					}
-				}
+bool ANavigationVolume3D::IsNavigationDataBuilt() const
+{
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
+		return Octree.IsValid() && Octree->GetDivisions() == FIntVector(DivisionsX, DivisionsY, DivisionsZ);
+
+	return Occupancy.IsValid() && Occupancy->Num() == GetTotalDivisions();
+}
+
+void ANavigationVolume3D::MarkOccupancyDirty(const FBox& world_bounds)
+{
+	// Nothing to update until the occupancy has been built
+	if (IsNavigationDataBuilt() == false || world_bounds.IsValid == 0)
+		return;
+
+	FIntVector minCoordinates;
+	FIntVector maxCoordinates;
+	if (GetCellRange(world_bounds, minCoordinates, maxCoordinates) == false)
+		return;
+
+	// The octree is rebuilt by region, so there are no cells to queue
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
+	{
+		PendingOctreeRegions.Add(TPair<FIntVector, FIntVector>(minCoordinates, maxCoordinates));
+		return;
+	}
 
-				// Below neighbors
+	// Voxelized collision geometry is rasterized again over the whole region, the same way the occupancy was built
+	if (bVoxelizeCollisionGeometry)
+	{
+		PendingDirtyRegions.Add(TPair<FIntVector, FIntVector>(minCoordinates, maxCoordinates));
+		return;
+	}
+
+	// Queue each cell once, even if several regions touch it
+	for (int32 z = minCoordinates.Z; z <= maxCoordinates.Z; ++z)
+	{
+		for (int32 y = minCoordinates.Y; y <= maxCoordinates.Y; ++y)
+		{
+			for (int32 x = minCoordinates.X; x <= maxCoordinates.X; ++x)
+			{
+				const int32 index = GetNodeIndex(FIntVector(x, y, z));
+				if (DirtyCellMask[index] == false)
 				{
-					// front
-					{
-						addNeighborIfValid(node, FIntVector(x + 1, y - 1, z - 1));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 0, z - 1));
-						addNeighborIfValid(node, FIntVector(x + 1, y + 1, z - 1));
-					}
-					// middle
-					{
-						addNeighborIfValid(node, FIntVector(x + 0, y - 1, z - 1));
-						addNeighborIfValid(node, FIntVector(x + 0, y + 0, z - 1));
-						addNeighborIfValid(node, FIntVector(x + 0, y + 1, z - 1));
-					}
-					// back
-					{
-						addNeighborIfValid(node, FIntVector(x - 1, y - 1, z - 1));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 0, z - 1));
-						addNeighborIfValid(node, FIntVector(x - 1, y + 1, z - 1));
-					}
+					DirtyCellMask[index] = true;
+					PendingDirtyCells.Add(index);
 				}
 			}
 		}
 	}
 }
 
-void ANavigationVolume3D::EndPlay(const EEndPlayReason::Type EndPlayReason)
+bool ANavigationVolume3D::GetCellRange(const FBox& world_bounds, FIntVector& out_min, FIntVector& out_max) const
 {
-	// Delete the nodes
-	delete [] Nodes;
-	Nodes = nullptr;
+	// Convert the corners of the box into grid space and find the range of cells they cover
+	const FTransform& transform = GetActorTransform();
+	FVector gridMin(FLT_MAX);
+	FVector gridMax(-FLT_MAX);
+	for (int32 corner = 0; corner < 8; ++corner)
+	{
+		const FVector worldCorner((corner & 1) ? world_bounds.Max.X : world_bounds.Min.X,
+			(corner & 2) ? world_bounds.Max.Y : world_bounds.Min.Y,
+			(corner & 4) ? world_bounds.Max.Z : world_bounds.Min.Z);
+		const FVector gridCorner = transform.InverseTransformPosition(worldCorner);
+		gridMin = gridMin.ComponentMin(gridCorner);
+		gridMax = gridMax.ComponentMax(gridCorner);
+	}
 
-	Super::EndPlay(EndPlayReason);
+	// Grow the range by a cell since the overlap test of a cell also touches its faces
+	out_min = FIntVector(FMath::FloorToInt(gridMin.X / DivisionSize) - 1, FMath::FloorToInt(gridMin.Y / DivisionSize) - 1, FMath::FloorToInt(gridMin.Z / DivisionSize) - 1);
+	out_max = FIntVector(FMath::FloorToInt(gridMax.X / DivisionSize) + 1, FMath::FloorToInt(gridMax.Y / DivisionSize) + 1, FMath::FloorToInt(gridMax.Z / DivisionSize) + 1);
+
+	// Ignore boxes that are completely outside of the grid
+	if (out_max.X < 0 || out_max.Y < 0 || out_max.Z < 0 ||
+		out_min.X >= DivisionsX || out_min.Y >= DivisionsY || out_min.Z >= DivisionsZ)
+		return false;
+
+	ClampCoordinates(out_min);
+	ClampCoordinates(out_max);
+	return true;
 }
 
-// Called every frame
-void ANavigationVolume3D::Tick(float DeltaTime)
+void ANavigationVolume3D::RegisterDynamicObstacle(AActor* actor)
 {
-	Super::Tick(DeltaTime);
+	if (actor == nullptr || DynamicObstacles.Contains(actor))
+		return;
+
+	// The obstacle may have moved since the occupancy was built, so refresh the cells it currently covers
+	const FBox bounds = actor->GetComponentsBoundingBox();
+	DynamicObstacles.Add(actor, bounds);
+	MarkOccupancyDirty(bounds);
 }
 
-bool ANavigationVolume3D::FindPath(const FVector& start, const FVector& destination, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter, TArray<FVector>& out_path)
+void ANavigationVolume3D::UnregisterDynamicObstacle(AActor* actor)
 {
-	// Clear the out path
-	out_path.Empty();
+	FBox bounds;
+	if (DynamicObstacles.RemoveAndCopyValue(actor, bounds))
+	{
+		MarkOccupancyDirty(bounds);
+	}
+}
+
+bool ANavigationVolume3D::IsOccupancyUpdatePending() const
+{
+	return PendingDirtyCells.Num() > 0 || ActiveDirtyCells.Num() > 0 || PendingDirtyRegions.Num() > 0 || ActiveDirtyRegions.Num() > 0 || PendingOctreeRegions.Num() > 0;
+}
+
+void ANavigationVolume3D::UpdateDynamicObstacles()
+{
+	for (auto iter = DynamicObstacles.CreateIterator(); iter; ++iter)
+	{
+		AActor* actor = iter.Key().Get();
 
-	std::multiset<NavNode*, NodeCompare> openSet;
-	std::unordered_map<NavNode*, NavNode*> cameFrom;
-	std::unordered_map<NavNode*, float> gScores;
+		// Free the cells of obstacles that have been destroyed
+		if (actor == nullptr)
+		{
+			MarkOccupancyDirty(iter.Value());
+			iter.RemoveCurrent();
+			continue;
+		}
 
-	NavNode* startNode = GetNode(ConvertLocationToCoordinates(start));
-	NavNode* endNode = GetNode(ConvertLocationToCoordinates(destination));
+		// Refresh both the cells the obstacle left and the cells it moved into
+		const FBox bounds = actor->GetComponentsBoundingBox();
+		if (bounds.Min.Equals(iter.Value().Min) == false || bounds.Max.Equals(iter.Value().Max) == false)
+		{
+			MarkOccupancyDirty(iter.Value());
+			MarkOccupancyDirty(bounds);
+			iter.Value() = bounds;
+		}
+	}
+}
 
-	auto h = [endNode](NavNode* node)
+void ANavigationVolume3D::ProcessDirtyOccupancy()
+{
+	// Rebuild the dirty regions of the octree all at once, reusing the nodes outside of them
+	if (Representation == ENavVolumeRepresentation::SparseOctree)
 	{
-		return FVector::Distance(FVector(endNode->Coordinates), FVector(node->Coordinates));
-	};
-	auto distance = [](NavNode* node1, NavNode* node2)
+		if (Octree.IsValid() && PendingOctreeRegions.Num() > 0)
+		{
+			BuildSparseOctree(Octree.Get());
+		}
+		return;
+	}
+
+	if (Occupancy.IsValid() == false)
+		return;
+
+	// Start a new batch from the cells and regions queued so far. Those dirtied while the batch is in progress go into the next one.
+	if (ActiveDirtyCells.Num() == 0 && ActiveDirtyRegions.Num() == 0)
 	{
-		return FVector::Distance(FVector(node1->Coordinates), FVector(node2->Coordinates));
-	};
-	auto gScore = [&gScores](NavNode* node)
+		if (PendingDirtyCells.Num() == 0 && PendingDirtyRegions.Num() == 0)
+			return;
+
+		Swap(ActiveDirtyCells, PendingDirtyCells);
+		Swap(ActiveDirtyRegions, PendingDirtyRegions);
+		ActiveDirtyCursor = 0;
+		ActiveDirtyRegionCursor = 0;
+		for (const int32 index : ActiveDirtyCells)
+		{
+			DirtyCellMask[index] = false;
+		}
+
+		// Work on a copy so queries keep seeing the last published occupancy until the batch is complete
+		StagingOccupancy = MakeShared<NavOccupancy, ESPMode::ThreadSafe>(*Occupancy);
+	}
+
+	auto setBlocked = [this](int32 index, bool blocked)
 	{
-		auto iter = gScores.find(node);
-		if (iter != gScores.end())
-			return iter->second;
-		return FLT_MAX;
+		if (blocked != StagingOccupancy->IsBlocked(index))
+		{
+			StagingOccupancy->SetBlocked(index, blocked);
+			StagingOccupancy->UpdateNearBlocked(*Grid, index);
+			ChangedDirtyCells.Add(index);
+		}
 	};
 
-	startNode->FScore = h(startNode);
-	openSet.insert(startNode);
-	gScores[startNode] = 0.0f;
-
-	while (openSet.empty() == false)
+	// Revoxelize regions, a whole region at a time, then cells, until the time budget runs out
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_Revoxelize);
+	const double endTime = FPlatformTime::Seconds() + (OccupancyUpdateBudgetMs / 1000.0);
+	bool outOfTime = false;
+	while (outOfTime == false && ActiveDirtyRegionCursor < ActiveDirtyRegions.Num())
 	{
-		NavNode* current = *openSet.begin();
+		const TPair<FIntVector, FIntVector> region = ActiveDirtyRegions[ActiveDirtyRegionCursor++];
+		const FIntVector size = region.Value - region.Key + FIntVector(1, 1, 1);
+		NavOccupancy regionOccupancy;
+		regionOccupancy.Init(size.X * size.Y * size.Z);
+		VoxelizeCollisionGeometry(regionOccupancy, region.Key, region.Value);
 
-		if (current == endNode)
+		int32 regionIndex = 0;
+		for (int32 z = region.Key.Z; z <= region.Value.Z; ++z)
 		{
-			// Rebuild the path
-			out_path.Add(ConvertCoordinatesToLocation(current->Coordinates));
-
-			while (true)
+			for (int32 y = region.Key.Y; y <= region.Value.Y; ++y)
 			{
-				auto iter = cameFrom.find(current);
-				if (iter != cameFrom.end())
-				{
-					current = iter->second;
-					out_path.Insert(ConvertCoordinatesToLocation(current->Coordinates), 0);
-				}
-				else
+				for (int32 x = region.Key.X; x <= region.Value.X; ++x)
 				{
-					return true;
+					setBlocked(GetNodeIndex(FIntVector(x, y, z)), regionOccupancy.IsBlocked(regionIndex++));
 				}
 			}
 		}
+		outOfTime = FPlatformTime::Seconds() >= endTime;
+	}
+	while (outOfTime == false && ActiveDirtyCursor < ActiveDirtyCells.Num())
+	{
+		const int32 index = ActiveDirtyCells[ActiveDirtyCursor++];
+		setBlocked(index, IsCellBlockedByPhysics(Grid->GetCoordinates(index), OccupancyObjectTypes, OccupancyActorClassFilter));
+		outOfTime = FPlatformTime::Seconds() >= endTime;
+	}
+
+	int32 pendingCellNum = PendingDirtyCells.Num() + ActiveDirtyCells.Num() - ActiveDirtyCursor;
+	for (int32 i = ActiveDirtyRegionCursor; i < ActiveDirtyRegions.Num(); ++i)
+	{
+		const FIntVector size = ActiveDirtyRegions[i].Value - ActiveDirtyRegions[i].Key + FIntVector(1, 1, 1);
+		pendingCellNum += size.X * size.Y * size.Z;
+	}
+	for (const TPair<FIntVector, FIntVector>& region : PendingDirtyRegions)
+	{
+		const FIntVector size = region.Value - region.Key + FIntVector(1, 1, 1);
+		pendingCellNum += size.X * size.Y * size.Z;
+	}
+	SET_DWORD_STAT(STAT_Navigation3D_PendingDirtyCells, pendingCellNum);
+
+	// Publish the updated occupancy once the whole batch has been revoxelized
+	if (ActiveDirtyCursor >= ActiveDirtyCells.Num() && ActiveDirtyRegionCursor >= ActiveDirtyRegions.Num())
+	{
+		// Rebuild the clusters the changed cells touch, the others are copied from the published graph
+		TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> clusterGraph;
+		if (SearchAlgorithm == ENavSearchAlgorithm::Hierarchical)
+		{
+			clusterGraph = BuildClusterGraph(*StagingOccupancy, ClusterGraph.Get(), ChangedDirtyCells);
+		}
 
-		openSet.erase(openSet.begin());
+		// Freed cells merge the components they touch, the labels are only rebuilt once enough cells have changed
+		TSharedPtr<NavComponents, ESPMode::ThreadSafe> components;
+		if (bRejectUnreachableQueries)
+		{
+			components = BuildComponents(*StagingOccupancy, Components.Get(), ChangedDirtyCells);
+		}
 
-		for (NavNode* neighbor : current->Neighbors)
+		// A changed cell moves the clearance of cells far away from it, the field is computed again, in parallel
+		TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> clearanceField = ClearanceField;
+		if (bBuildClearanceField && (clearanceField.IsValid() == false || ChangedDirtyCells.Num() > 0))
 		{
-			const float tentative_gScore = gScore(current) + distance(current, neighbor);
+			clearanceField = BuildClearanceField(*StagingOccupancy);
+		}
 
-			if (tentative_gScore < gScore(neighbor))
+		// Only the cells of the flow fields whose shortest path to a goal changed are recomputed
+		if (FlowFields.Num() > 0 && ChangedDirtyCells.Num() > 0)
+		{
+			SCOPE_CYCLE_COUNTER(STAT_Navigation3D_UpdateFlowFields);
+			const std::vector<int32> changedCells(ChangedDirtyCells.GetData(), ChangedDirtyCells.GetData() + ChangedDirtyCells.Num());
+			for (const TPair<int32, TSharedPtr<NavFlowField> >& flowField : FlowFields)
 			{
-				TArray<AActor*> outActors;
-				const FVector worldLocation = ConvertCoordinatesToLocation(neighbor->Coordinates);
-				bool traversable = !(UKismetSystemLibrary::BoxOverlapActors(GWorld, worldLocation, FVector(GetDivisionSize() / 2.0f), object_types, actor_class_filter, TArray<AActor*>(), outActors));
-				if (traversable == true)
-				{
-					cameFrom[neighbor] = current;
-					gScores[neighbor] = tentative_gScore;
-					const float fScore = tentative_gScore + h(neighbor);
-					neighbor->FScore = fScore;
-					openSet.insert(neighbor);
-				}
+				flowField.Value->UpdateOccupancy(*Grid, *StagingOccupancy, changedCells, RunParallelFor);
+			}
+		}
+
+		{
+			FScopeLock lock(&OccupancyLock);
+			Occupancy = StagingOccupancy;
+			ClusterGraph = clusterGraph;
+			Components = components;
+			ClearanceField = bBuildClearanceField ? clearanceField : nullptr;
+			if (PathCache != nullptr)
+			{
+				FScopeLock cacheLock(&PathCacheLock);
+				PathCache->Invalidate(std::vector<int32>(ChangedDirtyCells.GetData(), ChangedDirtyCells.GetData() + ChangedDirtyCells.Num()));
 			}
 		}
-	}
 
-	// Failed to find path
-	return false;
+		if (DebugDrawMode == ENavDebugDrawMode::OccupiedCells && ChangedDirtyCells.Num() > 0)
+		{
+			UpdateDebugMesh(true);
+		}
+		if (ChangedDirtyCells.Num() > 0)
+		{
+			RefreshPortals(ChangedDirtyCells);
+		}
+		StagingOccupancy.Reset();
+		ActiveDirtyCells.Reset();
+		ActiveDirtyRegions.Reset();
+		ChangedDirtyCells.Reset();
+		ActiveDirtyCursor = 0;
+		ActiveDirtyRegionCursor = 0;
+	}
 }
 
-FIntVector ANavigationVolume3D::ConvertLocationToCoordinates(const FVector& location)
+FIntVector ANavigationVolume3D::ConvertLocationToCoordinates(const FVector& location) const
 {
 	FIntVector coordinates;
 
@@ -340,7 +2126,7 @@ FIntVector ANavigationVolume3D::ConvertLocationToCoordinates(const FVector& loca
 	return coordinates;
 }
 
-FVector ANavigationVolume3D::ConvertCoordinatesToLocation(const FIntVector& coordinates)
+FVector ANavigationVolume3D::ConvertCoordinatesToLocation(const FIntVector& coordinates) const
 {
 	FIntVector clampedCoordinates(coordinates);
 	ClampCoordinates(clampedCoordinates);
@@ -394,6 +2180,48 @@ void ANavigationVolume3D::CreateLine(const FVector& start, const FVector& end, c
 	createFlatLine(direction2);
 }
 
+void ANavigationVolume3D::CreateBox(const FVector& min, const FVector& max, TArray<FVector>& vertices, TArray<int32>& triangles)
+{
+	// The 4 edges along X and Y on the bottom and top faces
+	for (const auto z : { min.Z, max.Z })
+	{
+		CreateLine(FVector(min.X, min.Y, z), FVector(max.X, min.Y, z), FVector::UpVector, vertices, triangles);
+		CreateLine(FVector(min.X, max.Y, z), FVector(max.X, max.Y, z), FVector::UpVector, vertices, triangles);
+		CreateLine(FVector(min.X, min.Y, z), FVector(min.X, max.Y, z), FVector::UpVector, vertices, triangles);
+		CreateLine(FVector(max.X, min.Y, z), FVector(max.X, max.Y, z), FVector::UpVector, vertices, triangles);
+	}
+
+	// The 4 vertical edges
+	CreateLine(FVector(min.X, min.Y, min.Z), FVector(min.X, min.Y, max.Z), FVector::ForwardVector, vertices, triangles);
+	CreateLine(FVector(max.X, min.Y, min.Z), FVector(max.X, min.Y, max.Z), FVector::ForwardVector, vertices, triangles);
+	CreateLine(FVector(min.X, max.Y, min.Z), FVector(min.X, max.Y, max.Z), FVector::ForwardVector, vertices, triangles);
+	CreateLine(FVector(max.X, max.Y, min.Z), FVector(max.X, max.Y, max.Z), FVector::ForwardVector, vertices, triangles);
+}
+
+void ANavigationVolume3D::CreateSlice(int32 axis, int32 index, TArray<FVector>& vertices, TArray<int32>& triangles)
+{
+	const FIntVector divisions(DivisionsX, DivisionsY, DivisionsZ);
+	const FVector size(GetGridSizeX(), GetGridSizeY(), GetGridSizeZ());
+	const int32 firstAxis = (axis + 1) % 3;
+	const int32 secondAxis = (axis + 2) % 3;
+
+	// Lines along each of the two other axes, spaced along the remaining one. Lines along Z are thickened sideways, the others upwards.
+	for (const int32 lineAxis : { firstAxis, secondAxis })
+	{
+		const int32 spacingAxis = lineAxis == firstAxis ? secondAxis : firstAxis;
+		const FVector normal = lineAxis == 2 ? FVector::ForwardVector : FVector::UpVector;
+		for (int32 i = 0; i <= divisions[spacingAxis]; ++i)
+		{
+			FVector start = FVector::ZeroVector;
+			start[axis] = index * DivisionSize;
+			start[spacingAxis] = i * DivisionSize;
+			FVector end = start;
+			end[lineAxis] = size[lineAxis];
+			CreateLine(start, end, normal, vertices, triangles);
+		}
+	}
+}
+
 bool ANavigationVolume3D::AreCoordinatesValid(const FIntVector& coordinates) const
 {
 	return coordinates.X >= 0 && coordinates.X < DivisionsX &&
@@ -408,12 +2236,29 @@ void ANavigationVolume3D::ClampCoordinates(FIntVector& coordinates) const
 	coordinates.Z = FMath::Clamp(coordinates.Z, 0, DivisionsZ - 1);
 }
 
-NavNode* ANavigationVolume3D::GetNode(FIntVector coordinates) const
+int32 ANavigationVolume3D::GetNodeIndex(const FIntVector& coordinates) const
 {
-	ClampCoordinates(coordinates);
-
 	const int32 divisionPerLevel = DivisionsX * DivisionsY;
-	const int32 index = (coordinates.Z * divisionPerLevel) + (coordinates.Y * DivisionsX) + coordinates.X;
-	return &Nodes[index];
+	return (coordinates.Z * divisionPerLevel) + (coordinates.Y * DivisionsX) + coordinates.X;
+}
+
+bool ANavigationVolume3D::IsCellBlockedByPhysics(const FIntVector& coordinates, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PhysicsOverlap);
+	INC_DWORD_STAT(STAT_Navigation3D_OverlapQueries);
+
+	TArray<AActor*> outActors;
+	const FVector worldLocation = ConvertCoordinatesToLocation(coordinates);
+	return UKismetSystemLibrary::BoxOverlapActors(GWorld, worldLocation, FVector(GetDivisionSize() / 2.0f), object_types, actor_class_filter, TArray<AActor*>(), outActors);
 }
 
+bool ANavigationVolume3D::IsRegionBlockedByPhysics(const FIntVector& min_coordinates, int32 size, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter)
+{
+	SCOPE_CYCLE_COUNTER(STAT_Navigation3D_PhysicsOverlap);
+	INC_DWORD_STAT(STAT_Navigation3D_OverlapQueries);
+
+	TArray<AActor*> outActors;
+	const FVector gridSpaceCenter = (FVector(min_coordinates) + FVector(size * 0.5f)) * DivisionSize;
+	const FVector worldLocation = UKismetMathLibrary::TransformLocation(GetActorTransform(), gridSpaceCenter);
+	return UKismetSystemLibrary::BoxOverlapActors(GWorld, worldLocation, FVector(size * DivisionSize / 2.0f), object_types, actor_class_filter, TArray<AActor*>(), outActors);
+}
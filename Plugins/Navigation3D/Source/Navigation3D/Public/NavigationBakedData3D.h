@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "NavigationBakedData3D.generated.h"
+
+// How the occupancy bits of a navigation volume are stored when baked
+UENUM(BlueprintType)
+enum class ENavBakedDataCompression : uint8
+{
+	// One bit per cell. Loads with a single copy.
+	BitPacked,
+
+	// Runs of free and blocked cells. Much smaller when obstacles are large and few, stored as bits when it isn't smaller.
+	RunLength
+};
+
+/**
+* The occupancy of a navigation volume baked in the editor, so it can be loaded at the start of play instead of being
+* queried from physics cell by cell. Create one in the content browser, assign it to the volume and click Bake Navigation Data.
+* The bytes are serialized as a single block, so loading the asset reads them with one bulk read and the volume decodes
+* them straight into its occupancy bitfield.
+*/
+UCLASS(BlueprintType)
+class NAVIGATION3D_API UNavigationBakedData3D : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	// Serializes the baked bytes after the properties
+	virtual void Serialize(FArchive& Ar) override;
+
+	// Gets the baked bytes, in the format read by NavBakedData
+	FORCEINLINE const TArray<uint8>& GetData() const { return Data; }
+
+	// Replaces the baked bytes and the summary shown in the editor
+	void SetData(TArray<uint8>&& data, const FIntVector& divisions, int32 blocked_cell_count, ENavBakedDataCompression compression);
+
+	// The number of cells along each axis of the grid that was baked
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "NavigationBakedData3D")
+	FIntVector Divisions = FIntVector::ZeroValue;
+
+	// The number of blocked cells
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "NavigationBakedData3D")
+	int32 BlockedCellCount = 0;
+
+	// How the occupancy bits are stored
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "NavigationBakedData3D")
+	ENavBakedDataCompression Compression = ENavBakedDataCompression::BitPacked;
+
+	// The size of the baked bytes
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "NavigationBakedData3D")
+	int32 DataSize = 0;
+
+private:
+	// The header and payload written by NavBakedData::Write
+	TArray<uint8> Data;
+};
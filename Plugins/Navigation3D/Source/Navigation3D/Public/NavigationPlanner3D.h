@@ -0,0 +1,69 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include <vector>
+#include "NavigationPlanner3D.generated.h"
+
+class ANavigationVolume3D;
+class NavDStarLite;
+class NavOccupancy;
+
+/**
+* A path planner owned by a single agent, which keeps its search between queries (D* Lite) so that asking again for a path to
+* the same destination as the agent moves and obstacles change only repairs the part of the search they affect, instead of
+* searching from scratch. Create one per agent with ANavigationVolume3D::CreatePlanner. Searches the occupancy cache of the
+* volume, moving the same way as A*. Not available with the sparse octree representation. Must be used on the game thread.
+*/
+UCLASS(BlueprintType)
+class NAVIGATION3D_API UNavigationPlanner3D : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	// Releases the search state
+	virtual void BeginDestroy() override;
+
+	// Ties the planner to the volume it plans in, forgetting any previous search
+	void Init(ANavigationVolume3D* volume);
+
+	/**
+	* Finds a path from the agent's location to the destination. The search is only started over when the destination cell
+	* changes, otherwise the previous one is repaired for the cells the agent moved through and the cells that changed since.
+	* @param	start				The world space location of the agent
+	* @param	destination			The world space location to reach
+	* @param	out_path			The world space locations of the cells along the path
+	* @return	Whether a path was found
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationPlanner3D")
+	bool FindPath(const FVector& start, const FVector& destination, TArray<FVector>& out_path);
+
+	// Forgets the search, so the next query starts over
+	UFUNCTION(BlueprintCallable, Category = "NavigationPlanner3D")
+	void Reset();
+
+	// Gets the number of cells expanded by the last query, a measure of its cost
+	UFUNCTION(BlueprintPure, Category = "NavigationPlanner3D")
+	int32 GetLastExpandedNodes() const;
+
+	// Gets the volume the planner plans in
+	UFUNCTION(BlueprintPure, Category = "NavigationPlanner3D")
+	ANavigationVolume3D* GetVolume() const { return Volume.Get(); }
+
+private:
+	// The volume the planner plans in
+	UPROPERTY()
+	TWeakObjectPtr<ANavigationVolume3D> Volume;
+
+	// The search kept between queries
+	NavDStarLite* Planner = nullptr;
+
+	// The occupancy snapshot the search was last updated for, compared with the published one to find the cells that changed
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> PlannedOccupancy;
+
+	// Scratch storage for the cells along the path and the cells that changed, reused between queries
+	std::vector<int32> PathCells;
+	std::vector<int32> ChangedCells;
+};
@@ -0,0 +1,86 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "NavigationSubsystem3D.generated.h"
+
+class ANavigationVolume3D;
+class NavPortalGraph;
+
+/**
+* Routes path queries across every navigation volume of the world. Volumes register themselves in BeginPlay and unregister in
+* EndPlay, so the volumes of streamed levels come and go with their level, and only the grids of the resident volumes are
+* allocated. Where the border of a volume faces a free cell of another volume, touching or overlapping it, the two are linked
+* by portals, one per contiguous span of facing cells. A query between volumes finds the shortest route through the portals,
+* only searching inside a volume the segments the route may take, then joins the paths of its segments. Routes go through the
+* middle of the portals, so they may be a little longer than the shortest path. Needs the occupancy cache of the volumes. Must
+* be used on the game thread.
+*/
+UCLASS()
+class NAVIGATION3D_API UNavigationSubsystem3D : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	// Creates the portal graph
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+
+	// Releases the portal graph
+	virtual void Deinitialize() override;
+
+	// Adds a volume to the routing and links it with the volumes around it. Called by the volume in BeginPlay, once its occupancy is built.
+	void RegisterVolume(ANavigationVolume3D* volume);
+
+	// Removes a volume and its portals. Called by the volume in EndPlay, when its level is unloaded.
+	void UnregisterVolume(ANavigationVolume3D* volume);
+
+	// Links a volume with the volumes around it again, after cells on its border changed
+	void RefreshVolume(ANavigationVolume3D* volume);
+
+	/**
+	* Finds a path between two locations which may be in different volumes, going through the portals between them.
+	* @param	start				The world space location to start from
+	* @param	destination			The world space location to reach
+	* @param	out_path			The world space locations along the path, through every volume crossed
+	* @return	Whether a path was found. Fails if either location isn't inside a registered volume.
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationSubsystem3D")
+	bool FindPath(const FVector& start, const FVector& destination, TArray<FVector>& out_path);
+
+	// Gets the registered volume whose grid contains a location, or null if there is none
+	UFUNCTION(BlueprintPure, Category = "NavigationSubsystem3D")
+	ANavigationVolume3D* FindVolumeAt(const FVector& location) const;
+
+	// Gets the number of registered volumes
+	UFUNCTION(BlueprintPure, Category = "NavigationSubsystem3D")
+	int32 GetVolumeNum() const { return Volumes.Num(); }
+
+	// Gets the number of portals between the registered volumes
+	UFUNCTION(BlueprintPure, Category = "NavigationSubsystem3D")
+	int32 GetPortalNum() const;
+
+	// Gets the number of portals of a volume
+	UFUNCTION(BlueprintPure, Category = "NavigationSubsystem3D")
+	int32 GetVolumePortalNum(const ANavigationVolume3D* volume) const;
+
+private:
+	// Helper function getting the id a volume was registered with, or INDEX_NONE
+	int32 GetVolumeId(const ANavigationVolume3D* volume) const;
+
+	// Helper function linking the cells on the border of the first volume with the free cells of the second that they face, returning the number of portals added
+	int32 LinkVolumes(int32 volume_id, int32 other_id);
+
+	// Helper function linking a volume with every registered volume around it, each pair through the border of only one of them
+	void LinkVolume(int32 volume_id);
+
+	// The registered volumes by id
+	TMap<int32, TWeakObjectPtr<ANavigationVolume3D> > Volumes;
+
+	// The id given to the next volume
+	int32 NextVolumeId = 0;
+
+	// The portals between the registered volumes
+	NavPortalGraph* Portals = nullptr;
+};
@@ -4,10 +4,255 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "HAL/CriticalSection.h"
+#include "NavigationBakedData3D.h"
+#include <vector>
 #include "NavigationVolume3D.generated.h"
 
 class UProceduralMeshComponent;
-class NavNode;
+class UMaterialInstanceDynamic;
+class NavOccupancy;
+class NavGrid;
+class NavSearchContext;
+class NavPathQueue;
+class NavSparseOctree;
+class NavClusterGraph;
+class NavComponents;
+class NavClearanceField;
+class NavCostLayers;
+class NavCooperativePlanner;
+class NavGridTransform;
+class NavPathCache;
+class NavFlowField;
+class UNavigationPlanner3D;
+struct NavVoxelShapes;
+
+// How the volume stores which cells are blocked
+UENUM(BlueprintType)
+enum class ENavVolumeRepresentation : uint8
+{
+	// One bit per cell, allocated for the whole grid
+	DenseGrid,
+
+	// A sparse voxel octree where empty and solid regions collapse into single nodes. Paths cross open space through the
+	// centers of large nodes and follow obstacles cell by cell. Meant for large volumes with mostly open space. Always
+	// built ahead of queries, dirty regions are rebuilt in a single tick.
+	SparseOctree
+};
+
+// What the grid mesh of the volume shows
+UENUM(BlueprintType)
+enum class ENavDebugDrawMode : uint8
+{
+	// Every line of the grid. Slow to build and draw for large volumes.
+	FullGrid,
+
+	// The outline of the volume
+	BoundingBox,
+
+	// The lines of the grid on a single plane across the volume
+	Slice,
+
+	// The outline of each blocked cell of the occupancy, once it's built
+	OccupiedCells,
+
+	// The outline of each cell of the last path found on the game thread
+	PathCells
+};
+
+// The axis the slice drawn by the grid mesh is perpendicular to
+UENUM(BlueprintType)
+enum class ENavDebugSliceAxis : uint8
+{
+	X,
+	Y,
+	Z
+};
+
+// The algorithm used to search for paths
+UENUM(BlueprintType)
+enum class ENavSearchAlgorithm : uint8
+{
+	// A* expanding every neighbor of each cell
+	AStar,
+
+	// Jump Point Search, which skips over straight runs of empty cells and only expands the cells where the path may turn.
+	// Finds paths as short as A*. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	JumpPointSearch,
+
+	// Hierarchical A* (HPA*), which first searches a cached graph of the entrances between clusters of cells, then refines
+	// the result inside each cluster. Much faster on long queries, with paths a little longer than A*. Requires the
+	// occupancy cache of the dense grid, queries fall back to A* otherwise.
+	Hierarchical,
+
+	// Theta*, which links each cell to the farthest cell along the path it can see, so paths go straight between the cells where
+	// they bend instead of following the grid. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	ThetaStar,
+
+	// Lazy Theta*, which only tests line of sight when a cell is expanded rather than for each of its neighbors. Faster than
+	// Theta*, with paths that are sometimes a little longer. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	LazyThetaStar,
+
+	// A* growing a search from each end of the query and stopping where they meet. Finds paths as short as A*, and gives up after
+	// flooding only the small region around whichever end is walled in. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	BidirectionalAStar,
+
+	// A* with its heuristic scaled by the heuristic weight, which heads straight for the destination and expands far fewer cells,
+	// with paths up to that many times longer. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	WeightedAStar,
+
+	// Weighted A* run again with lower and lower weights, keeping the shortest path found until the weight reaches one or the
+	// anytime budget runs out. Requires the occupancy cache of the dense grid, queries fall back to A* otherwise.
+	AnytimeAStar
+};
+
+// The measurements of a single path query
+USTRUCT(BlueprintType)
+struct FNavPathQueryStats
+{
+	GENERATED_BODY()
+
+	// Whether a path was found
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	bool bFoundPath = false;
+
+	// The number of nodes taken off the open list and expanded, over every step of hierarchical queries
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 NodesExpanded = 0;
+
+	// The number of physics overlap queries issued to test cells
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 OverlapQueries = 0;
+
+	// The number of cell tests answered by the occupancy cache instead of physics. Only counted by A*, the other
+	// algorithms read the cache directly.
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 CacheHits = 0;
+
+	// The largest number of nodes waiting on the open list at once
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 OpenListPeak = 0;
+
+	// The number of locations in the path
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 PathLength = 0;
+
+	// Whether the path was taken from the path cache instead of being searched
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	bool bPathCacheHit = false;
+
+	// The time spent on the query in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float WallTimeMs = 0.0f;
+};
+
+// Aggregates of the most recent path queries of a volume
+USTRUCT(BlueprintType)
+struct FNavPathQueryStatsSummary
+{
+	GENERATED_BODY()
+
+	// The number of queries made since play began or the stats were reset
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 TotalQueries = 0;
+
+	// The number of recent queries the other values are computed from
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 SampleCount = 0;
+
+	// The fraction of the recent queries that found a path
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float FoundRatio = 0.0f;
+
+	// The mean time spent on a recent query, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float AverageWallTimeMs = 0.0f;
+
+	// The median time spent on a recent query, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float P50WallTimeMs = 0.0f;
+
+	// The time 99% of the recent queries took at most, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float P99WallTimeMs = 0.0f;
+
+	// The longest time spent on a recent query, in milliseconds
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float MaxWallTimeMs = 0.0f;
+
+	// The mean number of nodes expanded by a recent query
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float AverageNodesExpanded = 0.0f;
+
+	// The largest number of nodes expanded by a recent query
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 MaxNodesExpanded = 0;
+
+	// The mean number of physics overlap queries issued by a recent query
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float AverageOverlapQueries = 0.0f;
+
+	// The mean number of cell tests a recent query answered from the occupancy cache
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float AverageCacheHits = 0.0f;
+
+	// The largest number of nodes waiting on the open list at once during a recent query
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 MaxOpenListPeak = 0;
+
+	// The fraction of the recent queries answered by the path cache
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float PathCacheHitRatio = 0.0f;
+};
+
+// The counts of the path cache of a volume since play began or the cache was cleared
+USTRUCT(BlueprintType)
+struct FNavPathCacheStats
+{
+	GENERATED_BODY()
+
+	// The number of queries answered with a path cached for the same cells
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 Hits = 0;
+
+	// The number of queries answered with the tail of a cached path to the same cell
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 TailHits = 0;
+
+	// The number of queries that had to be searched
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 Misses = 0;
+
+	// The fraction of the queries answered by the cache
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	float HitRatio = 0.0f;
+
+	// The number of paths dropped because a cell along them changed
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 Invalidated = 0;
+
+	// The number of least recently used paths dropped to make room for new ones
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 Evicted = 0;
+
+	// The number of paths currently cached
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	int32 CachedPaths = 0;
+};
+
+// The cells an agent moves through over a window of cooperative planning
+USTRUCT(BlueprintType)
+struct FNavCooperativePath
+{
+	GENERATED_BODY()
+
+	// The world space location of the agent at each time step of the window, from its start. Repeated while the agent waits.
+	UPROPERTY(BlueprintReadOnly, Category = "NavigationVolume3D")
+	TArray<FVector> Locations;
+};
+
+// Called on the game thread when an asynchronous path request completes
+DECLARE_DYNAMIC_DELEGATE_ThreeParams(FNavPathQueryDelegate, int32, RequestId, bool, bFoundPath, const TArray<FVector>&, Path);
 
 UCLASS()
 class NAVIGATION3D_API ANavigationVolume3D : public AActor
@@ -47,6 +292,125 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 0, ClampMax = 2))
 	int32 MinSharedNeighborAxes = 0;
 
+	// The algorithm used to search for paths
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	ENavSearchAlgorithm SearchAlgorithm = ENavSearchAlgorithm::AStar;
+
+	// The number of cells along each axis of the clusters used by hierarchical search
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 2, EditCondition = "SearchAlgorithm == ENavSearchAlgorithm::Hierarchical"))
+	int32 ClusterSize = 16;
+
+	// The factor applied to the heuristic by weighted A*, paths are at most that many times longer than the shortest. The first
+	// weight of anytime A*.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 1, EditCondition = "SearchAlgorithm == ENavSearchAlgorithm::WeightedAStar || SearchAlgorithm == ENavSearchAlgorithm::AnytimeAStar"))
+	float HeuristicWeight = 2.0f;
+
+	// The number of cells anytime A* may expand for a query over all of its searches, 0 for no limit
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 0, EditCondition = "SearchAlgorithm == ENavSearchAlgorithm::AnytimeAStar"))
+	int32 AnytimeMaxExpansions = 20000;
+
+	// The time in milliseconds anytime A* may spend on a query over all of its searches, 0 for no limit
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 0, EditCondition = "SearchAlgorithm == ENavSearchAlgorithm::AnytimeAStar"))
+	float AnytimeBudgetMs = 2.0f;
+
+	// Whether the connected components of the free cells are labeled with the occupancy, so queries between cells that can't
+	// reach each other fail right away instead of flooding every cell reachable from the start. Costs 4 bytes per cell.
+	// Doesn't apply to the sparse octree or to paths queried from physics.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	bool bRejectUnreachableQueries = false;
+
+	// Whether the distance from every cell to the closest blocked cell is computed with the occupancy, so FindPathForAgent can keep
+	// agents of any radius clear of the geometry over the same grid. Costs 2 bytes per cell. Doesn't apply to the sparse octree.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	bool bBuildClearanceField = false;
+
+	// The number of per cell cost layers, such as danger, noise or congestion, that FindPathWithCosts weighs to steer paths
+	// away from cells without blocking them. Set with SetCostInBox. Costs 1 byte per cell per layer. Doesn't apply to the sparse octree.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 0, ClampMax = 4))
+	int32 CostLayerCount = 0;
+
+	// The number of time steps PlanCooperativePaths plans for each agent. Longer windows see conflicts coming from further away
+	// but cost more per agent, agents are meant to follow about half of their window before planning the next one.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 2, ClampMax = 64))
+	int32 CooperativeWindow = 16;
+
+	// Whether the waypoints of paths found over the occupancy cache that can be skipped by flying straight to a later waypoint
+	// are removed, testing line of sight against the occupancy. Doesn't apply to the sparse octree or to paths queried from physics.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	bool bSmoothPaths = false;
+
+	// Whether paths found over the occupancy cache are kept, so the same query made again skips the search. A path is dropped
+	// when a cell along it changes. Doesn't apply to the sparse octree or to paths queried from physics.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	bool bCachePaths = false;
+
+	// The maximum number of paths kept by the path cache, the least recently used are dropped first
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", ClampMin = 1, EditCondition = "bCachePaths"))
+	int32 PathCacheCapacity = 256;
+
+	// Whether a query starting next to a cached path to the same destination follows that path from there instead of searching.
+	// Much cheaper for agents spread around a shared route, but the path may be a little longer than the one a search would find.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true", EditCondition = "bCachePaths"))
+	bool bReusePathTails = false;
+
+	// How the volume stores which cells are blocked
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Pathfinding", meta = (AllowPrivateAccess = "true"))
+	ENavVolumeRepresentation Representation = ENavVolumeRepresentation::DenseGrid;
+
+	// Whether blocked cells are looked up in a precomputed occupancy bitfield instead of being queried from physics while pathfinding
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true"))
+	bool bUseOccupancyCache = true;
+
+	// Whether the occupancy bitfield is built in BeginPlay using the occupancy object types and actor class filter, when object types are set
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	bool bBuildOccupancyOnBeginPlay = true;
+
+	// The occupancy baked in the editor with Bake Navigation Data, loaded in BeginPlay instead of building the occupancy from physics
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	UNavigationBakedData3D* BakedData = nullptr;
+
+	// How the occupancy bits are stored when baked
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	ENavBakedDataCompression BakedDataCompression = ENavBakedDataCompression::RunLength;
+
+	// Whether baked data is ignored, and the occupancy built from physics instead, when the actors overlapping the volume
+	// have changed since the bake. Checking costs a single overlap query over the whole volume.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	bool bRejectStaleBakedData = true;
+
+	// The object types that block a cell when building the occupancy bitfield
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	TArray<TEnumAsByte<EObjectTypeQuery> > OccupancyObjectTypes;
+
+	// The actor class filter used when building the occupancy bitfield
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	UClass* OccupancyActorClassFilter = nullptr;
+
+	// Whether the occupancy is built by rasterizing the collision shapes of the overlapping components in parallel, instead of
+	// querying physics once per cell. Components whose collision shapes can't be read are still queried over their bounds.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", EditCondition = "bUseOccupancyCache"))
+	bool bVoxelizeCollisionGeometry = true;
+
+	// The maximum time in milliseconds spent each tick revoxelizing cells marked dirty by moving obstacles
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Occupancy", meta = (AllowPrivateAccess = "true", ClampMin = 0, EditCondition = "bUseOccupancyCache"))
+	float OccupancyUpdateBudgetMs = 1.0f;
+
+	// The maximum number of asynchronous path requests searched by a single worker task
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Async", meta = (AllowPrivateAccess = "true", ClampMin = 1))
+	int32 MaxPathRequestsPerBatch = 8;
+
+	// The maximum number of worker tasks searching asynchronous path requests at the same time
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Async", meta = (AllowPrivateAccess = "true", ClampMin = 1))
+	int32 MaxConcurrentPathBatches = 4;
+
+	// The maximum number of asynchronous path request delegates called each tick
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Async", meta = (AllowPrivateAccess = "true", ClampMin = 1))
+	int32 MaxPathCompletionsPerTick = 32;
+
+	// The number of recent path queries kept to compute the rolling stats
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Stats", meta = (AllowPrivateAccess = "true", ClampMin = 1))
+	int32 QueryStatsHistorySize = 256;
+
 	// The thickness of the grid lines
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true", ClampMin = 0))
 	float LineThickness = 2.0f;
@@ -55,6 +419,26 @@ private:
 	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true"))
 	FLinearColor Color = FLinearColor(0.0f, 0.0f, 0.0f, 0.5f);
 
+	// What the grid mesh shows. Anything but the full grid keeps editing large volumes interactive.
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true"))
+	ENavDebugDrawMode DebugDrawMode = ENavDebugDrawMode::FullGrid;
+
+	// The axis the drawn slice is perpendicular to
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true", EditCondition = "DebugDrawMode == ENavDebugDrawMode::Slice"))
+	ENavDebugSliceAxis DebugSliceAxis = ENavDebugSliceAxis::Z;
+
+	// The grid line along the slice axis the drawn slice goes through, clamped to the volume
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true", ClampMin = 0, EditCondition = "DebugDrawMode == ENavDebugDrawMode::Slice"))
+	int32 DebugSliceIndex = 0;
+
+	// The maximum number of cells outlined when drawing the occupied or path cells
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "NavigationVolume3D|Aesthetics", meta = (AllowPrivateAccess = "true", ClampMin = 1, EditCondition = "DebugDrawMode == ENavDebugDrawMode::OccupiedCells || DebugDrawMode == ENavDebugDrawMode::PathCells"))
+	int32 MaxDebugCells = 4096;
+
+	// The material instance of the grid mesh, created once and recolored afterwards
+	UPROPERTY(Transient)
+	UMaterialInstanceDynamic* DebugMaterial = nullptr;
+
 public:
 
 	/**
@@ -66,30 +450,299 @@ public:
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
 
-	// Gets the node at the specified coordinates
-	NavNode* GetNode(FIntVector coordinates) const;
-
-	// Finds a path from the starting location to the destination
+	/**
+	* Finds a path from the starting location to the destination. When the occupancy cache is enabled, blocked cells are
+	* looked up in the occupancy bitfield, which is built first for the object types and actor class filter if it hasn't been built yet.
+	* Once built, queries for another profile query physics for each cell reached rather than rebuilding it; call BuildOccupancy to switch profiles.
+	* The sparse octree representation is always used this way, whether or not the occupancy cache is enabled.
+	*/
 	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
 	bool FindPath(const FVector& start, const FVector& destination, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter, TArray<FVector>& out_path);
 
+	// Same as FindPath, also returning the measurements of the query
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	bool FindPathWithStats(const FVector& start, const FVector& destination, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter, TArray<FVector>& out_path, FNavPathQueryStats& out_stats);
+
+	/**
+	* Finds a path from the starting location to the destination using the published occupancy bitfield. This is safe to call
+	* from any thread as long as each thread passes its own search context, and fails if the occupancy hasn't been built yet.
+	* @param	start				The world space location to start from
+	* @param	destination			The world space location to reach
+	* @param	context				The search state to use, reset at the start of the search
+	* @param	out_path			The world space locations of the cells along the path
+	* @param	out_stats			Receives the measurements of the query (optional)
+	* @return	Whether a path was found
+	*/
+	bool FindPathWithContext(const FVector& start, const FVector& destination, NavSearchContext& context, TArray<FVector>& out_path, FNavPathQueryStats* out_stats = nullptr) const;
+
+	/**
+	* Queues a path request that is searched on a worker thread using the occupancy bitfield, building it first for the
+	* occupancy object types and actor class filter if needed. The delegate is called on the game thread once the search completes.
+	* @param	start				The world space location to start from
+	* @param	destination			The world space location to reach
+	* @param	priority			Requests with a higher priority are searched first
+	* @param	on_complete			Called with the request id and the result
+	* @return	The id of the request, or -1 if the occupancy cache is disabled or play hasn't begun
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	int32 RequestPathAsync(const FVector& start, const FVector& destination, int32 priority, const FNavPathQueryDelegate& on_complete);
+
+	// Cancels an asynchronous path request so its delegate won't be called. Returns false if the request already completed.
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	bool CancelPathRequest(int32 request_id);
+
+	// Checks if an asynchronous path request hasn't completed yet
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	bool IsPathRequestPending(int32 request_id) const;
+
+	// Gets the aggregates of the most recent path queries, synchronous and asynchronous. Safe to call from any thread.
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	FNavPathQueryStatsSummary GetPathQueryStatsSummary() const;
+
+	// Forgets the recorded path query stats
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void ResetPathQueryStats();
+
+	// Writes the path query stats summary to the log. Also available as the Navigation3D.DumpStats console command.
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void DumpPathQueryStats() const;
+
+	// Gets the hit, miss and invalidation counts of the path cache. Safe to call from any thread.
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	FNavPathCacheStats GetPathCacheStats() const;
+
+	// Drops every cached path and forgets the path cache counts
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void ClearPathCache();
+
+	/**
+	* Creates a planner for an agent that keeps its search between queries, so asking again for a path as the agent moves and
+	* obstacles change only repairs the search. Uses the occupancy cache, which must be built before the planner finds paths.
+	* @param	owner					The object the planner belongs to, usually the agent (optional, the volume otherwise)
+	* @return	The planner
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	UNavigationPlanner3D* CreatePlanner(UObject* owner);
+
+	/**
+	* Creates a flow field leading from every cell of the grid to the closest of the goals, so any number of agents heading to
+	* them read their next step instead of each finding a path. The field is updated along with the occupancy, only recomputing
+	* the cells whose distance changes. Builds the occupancy first if needed. Not available with the sparse octree representation.
+	* @param	goals					The world space locations to lead to
+	* @return	The id of the flow field, or INDEX_NONE if it couldn't be created
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	UPARAM(DisplayName = "Flow Field") int32 CreateFlowField(const TArray<FVector>& goals);
+
+	// Changes the goals of a flow field, only recomputing the cells whose distance changes. Returns false if the flow field doesn't exist.
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	bool SetFlowFieldGoals(int32 flow_field, const TArray<FVector>& goals);
+
+	// Releases a flow field
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void DestroyFlowField(int32 flow_field);
+
+	/**
+	* Gets the next step towards the closest goal of a flow field from a location.
+	* @param	flow_field				The id returned by CreateFlowField
+	* @param	location				The world space location of the agent
+	* @param	out_next_location		The center of the cell to move to, or of the cell of the location once it reached a goal
+	* @param	out_distance			The length of the shortest path from the cell of the location to the closest goal, in world units
+	* @return	Whether a goal can be reached from the location
+	*/
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "NavigationVolume3D")
+	bool GetFlowFieldStep(int32 flow_field, const FVector& location, FVector& out_next_location, float& out_distance) const;
+
+	/**
+	* Finds a path for an agent of a given size from the starting location to the destination, only going through the cells far
+	* enough from the blocked cells for the agent to fit, searched with A*. The room around a cell is measured to the closest
+	* corner a blocked cell could have, so agents never clip diagonal obstacles, at the cost of avoiding some gaps they would fit
+	* through. Needs the clearance field, built with the occupancy when Build Clearance Field is enabled. Paths aren't smoothed or cached.
+	* @param	start					The world space location to start from
+	* @param	destination				The world space location to reach
+	* @param	agent_radius			The radius of the agent in world units, 0 uses every free cell
+	* @param	out_path				The world space locations of the cells along the path
+	* @return	Whether a path was found
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	bool FindPathForAgent(const FVector& start, const FVector& destination, float agent_radius, TArray<FVector>& out_path);
+
+	// Gets the distance in world units between the center of the cell at a location and the closest blocked cell, or -1 if the clearance field isn't built
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	float GetClearance(const FVector& location) const;
+
+	/**
+	* Finds the cheapest path from the starting location to the destination over the occupancy cache, weighing the cost layers
+	* with the weights of the query. Moving through a cell costs the distance times 1 plus the sum of each layer's weight times
+	* its cost over 255, so a weight of 4 makes the cells at 255 in that layer 5 times as expensive to cross. Searched with A*,
+	* whose heuristic is scaled by the lowest cost of any cell so paths stay the cheapest. Paths aren't smoothed or cached.
+	* @param	start					The world space location to start from
+	* @param	destination				The world space location to reach
+	* @param	layer_weights			The weight of each cost layer, layers without a weight don't add to the cost
+	* @param	out_path				The world space locations of the cells along the path
+	* @return	Whether a path was found
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	bool FindPathWithCosts(const FVector& start, const FVector& destination, const TArray<float>& layer_weights, TArray<FVector>& out_path);
+
+	/**
+	* Sets the cost of the cells whose center is inside a world space box in a cost layer.
+	* @param	layer					The cost layer, below Cost Layer Count
+	* @param	world_bounds			The world space box to fill
+	* @param	cost					The cost, from 0 (no extra cost) to 255 (the full weight of the layer)
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void SetCostInBox(int32 layer, const FBox& world_bounds, uint8 cost);
+
+	// Sets the cost of every cell of a cost layer back to 0
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void ClearCostLayer(int32 layer);
+
+	// Gets the cost of the cell at a location in a cost layer, 0 if there is no such layer
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	uint8 GetCellCost(const FVector& location, int32 layer) const;
+
+	/**
+	* Plans the next window of many agents together so they don't run into each other, each moving to a neighboring cell or
+	* waiting at every time step without entering a cell another agent holds at that step or swapping cells with it. Agents are
+	* identified by their position in the arrays, keep it between windows so the distances to their goals computed by the previous
+	* windows are reused. Agents out of reach of each other within a window are planned in parallel. Uses the occupancy cache,
+	* the distances to the goals are computed again when it changes. Not available with the sparse octree representation.
+	* @param	starts					The world space location of each agent
+	* @param	destinations			The world space location each agent heads to
+	* @param	out_paths				The location of each agent at each of the Cooperative Window time steps, and its start
+	* @return	The number of agents that found no way through the others and wait in place, or INDEX_NONE if nothing could be planned
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	UPARAM(DisplayName = "Waiting Agents") int32 PlanCooperativePaths(const TArray<FVector>& starts, const TArray<FVector>& destinations, TArray<FNavCooperativePath>& out_paths);
+
+	/**
+	* Finds a path between two cells of the grid, searching the published occupancy with the search algorithm on the game
+	* thread. Used by the navigation subsystem to route queries through several volumes. Paths aren't smoothed or cached.
+	* @param	start_index				The flat index of the cell to start from
+	* @param	end_index				The flat index of the cell to reach
+	* @param	out_path				The world space locations of the cells along the path
+	* @return	Whether a path was found, false if the occupancy hasn't been built
+	*/
+	bool FindPathBetweenCells(int32 start_index, int32 end_index, TArray<FVector>& out_path);
+
+	// Checks if a world space location is inside the grid, where ConvertLocationToCoordinates doesn't clamp it
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	bool IsLocationInside(const FVector& location) const;
+
+	// Gets the flat index of the cell at a world space location, or INDEX_NONE if the location is outside of the grid
+	int32 GetCellIndex(const FVector& location) const;
+
+	// Checks if a cell is blocked in the published occupancy. Cells are reported blocked until the occupancy is built.
+	bool IsCellBlocked(int32 index) const;
+
+	// Gets the world space box bounding the grid
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	FBox GetGridBounds() const;
+
+	/**
+	* Gets the flat index of the cell at each world space location, converting them four at a time with the transform of the
+	* volume cached when play began or the volume last moved. Safe to call from any thread, such as a parallel agent update.
+	* Like the other batched queries, the occupancy lock is taken once per call to copy the snapshots, not once per location.
+	* @param	locations				The world space locations to convert
+	* @param	out_cells				The flat index of the cell of each location, INDEX_NONE for the locations outside of the grid
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void GetCellIndices(const TArray<FVector>& locations, TArray<int32>& out_cells) const;
+
+	// Checks if the cell at each world space location is blocked in the published occupancy or octree. Locations outside of the
+	// grid, or queried before it's built, are blocked. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void AreLocationsBlocked(const TArray<FVector>& locations, TArray<bool>& out_blocked) const;
+
+	// Gets the clearance of the cell at each world space location in world units, clamping the locations into the grid like
+	// GetClearance, or -1 for every location if the clearance field isn't built. Safe to call from any thread.
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void GetClearances(const TArray<FVector>& locations, TArray<float>& out_clearances) const;
+
+	/**
+	* Finds the center of the free cell closest to the cell at each world space location, such as a spot to move an agent
+	* pushed into geometry to. Locations are clamped into the grid. Uses the occupancy cache, not available with the sparse
+	* octree representation. Safe to call from any thread.
+	* @param	locations				The world space locations to search around
+	* @param	max_distance			The largest distance searched around each location, in world units
+	* @param	out_locations			The center of the closest free cell to each location, the location itself if none was found
+	* @param	out_found				Whether a free cell was found within max_distance of each location
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void FindNearestFreeLocations(const TArray<FVector>& locations, float max_distance, TArray<FVector>& out_locations, TArray<bool>& out_found) const;
+
+	// Gets the transform between world space and the cells of the grid, cached when play began or the volume last moved. Safe to call from any thread.
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> GetGridTransformSnapshot() const;
+
+	// Gets the grid used for pathfinding, valid between BeginPlay and EndPlay
+	FORCEINLINE const NavGrid* GetGrid() const { return Grid; }
+
+	// Gets the occupancy bitfield currently published to path queries. Safe to call from any thread.
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> GetOccupancySnapshot() const;
+
+	// Gets the sparse octree currently published to path queries. Safe to call from any thread.
+	TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> GetOctreeSnapshot() const;
+
+	/**
+	* Builds the occupancy bitfield by testing every cell of the grid for overlapping actors. With the sparse octree
+	* representation, builds the octree instead, only testing the cells of the regions that overlap actors.
+	* @param	object_types			The object types that block a cell
+	* @param	actor_class_filter		Only actors of this class block a cell (optional)
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void BuildOccupancy(const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter);
+
+	/**
+	* Builds the occupancy from physics for the occupancy object types and actor class filter and stores it in the baked
+	* data asset, along with a checksum of the actors overlapping the volume. Save the asset to keep the result.
+	*/
+	UFUNCTION(CallInEditor, Category = "NavigationVolume3D|Occupancy")
+	void BakeNavigationData();
+
+	// Checks if the occupancy bitfield has been built for the specified object types, in any order, and actor class filter
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	bool HasOccupancyFor(const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter) const;
+
+	/**
+	* Queues every cell overlapping a world space box to be revoxelized. Cells are updated over the next ticks within
+	* the occupancy update budget, and path queries keep using the previous occupancy until the update is complete.
+	* When collision geometry is voxelized, the cells of each box are rasterized again together, as when the occupancy was built.
+	* @param	world_bounds			The world space box that changed
+	*/
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void MarkOccupancyDirty(const FBox& world_bounds);
+
+	// Starts tracking an actor whose bounds are checked every tick, and whose old and new cells are revoxelized when it moves
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void RegisterDynamicObstacle(AActor* actor);
+
+	// Stops tracking a dynamic obstacle and revoxelizes the cells it was covering
+	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
+	void UnregisterDynamicObstacle(AActor* actor);
+
+	// Checks if there are dirty cells that haven't been revoxelized and published yet
+	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
+	bool IsOccupancyUpdatePending() const;
+
 	/**
 	* Converts a world space location to a coordinate in the grid. If the location is not located within the grid,
-	* the coordinate will be clamped to the closest coordinate.
+	* the coordinate will be clamped to the closest coordinate. Use IsLocationInside to tell those locations apart. Reads the
+	* actor transform, so it must be called on the game thread, other threads use GetCellIndices or GetGridTransformSnapshot.
 	* @param	location			The location to convert
 	* @return	The converted coordinates
 	*/
-	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
-	UPARAM(DisplayName = "Coordinates") FIntVector ConvertLocationToCoordinates(const FVector& location);
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "NavigationVolume3D")
+	UPARAM(DisplayName = "Coordinates") FIntVector ConvertLocationToCoordinates(const FVector& location) const;
 
 	/**
 	* Converts a coordinate into a world space location. If the coordinate is not within the bounds of the grid,
-	* the coordinate will be clamped to the closest coordinate.
+	* the coordinate will be clamped to the closest coordinate. Reads the actor transform, so it must be called on the game thread.
 	* @param	coordinates			The coordinates to convert into world space
 	* @return	The converted location in world space
 	*/
-	UFUNCTION(BlueprintCallable, Category = "NavigationVolume3D")
-	UPARAM(DisplayName = "World Location") FVector ConvertCoordinatesToLocation(const FIntVector& coordinates);
+	UFUNCTION(BlueprintCallable, BlueprintPure = false, Category = "NavigationVolume3D")
+	UPARAM(DisplayName = "World Location") FVector ConvertCoordinatesToLocation(const FIntVector& coordinates) const;
 
 	// Gets the total number of divisions in the grid
 	UFUNCTION(BlueprintPure, Category = "NavigationVolume3D")
@@ -131,12 +784,230 @@ private:
 	// Helper function for creating the geometry for a single line of the grid
 	void CreateLine(const FVector& start, const FVector& end, const FVector& normal, TArray<FVector>& vertices, TArray<int32>& triangles);
 
+	// Helper function for creating the geometry of the 12 edges of a box
+	void CreateBox(const FVector& min, const FVector& max, TArray<FVector>& vertices, TArray<int32>& triangles);
+
+	// Helper function for creating the geometry of the grid lines on the plane at a line index along an axis
+	void CreateSlice(int32 axis, int32 index, TArray<FVector>& vertices, TArray<int32>& triangles);
+
+	/**
+	* Rebuilds the grid mesh for the debug draw mode. Skipped when the settings it's built from haven't changed since the last
+	* rebuild, so moving the volume or tweaking unrelated properties in the editor doesn't regenerate it.
+	* @param	force				Whether to rebuild anyway, when the occupancy or the path drawn changed
+	*/
+	void UpdateDebugMesh(bool force);
+
+	// Helper function remembering the cells of the last path found on the game thread, redrawing them when they're shown
+	void SetDebugPath(const std::vector<int32>& cells);
+
 	// Helper function to check if a coordinate is valid
 	bool AreCoordinatesValid(const FIntVector& coordinates) const;
 
 	// Helper function to clamp the coordinate to a valid one inside the grid
 	void ClampCoordinates(FIntVector& coordinates) const;
 
-	// The nodes used for pathfinding
-	NavNode* Nodes = nullptr;
+	// Helper function to convert valid coordinates into a flat node index
+	int32 GetNodeIndex(const FIntVector& coordinates) const;
+
+	// Helper function to check if a cell is blocked by querying physics for overlapping actors
+	bool IsCellBlockedByPhysics(const FIntVector& coordinates, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter);
+
+	// Helper function to check if a cube of cells is blocked by querying physics for overlapping actors
+	bool IsRegionBlockedByPhysics(const FIntVector& min_coordinates, int32 size, const TArray<TEnumAsByte<EObjectTypeQuery> >& object_types, UClass* actor_class_filter);
+
+	// Helper function to set the blocked bits of the occupancy for every cell of the grid
+	void VoxelizeOccupancy(NavOccupancy& occupancy);
+
+	// Helper function to get the half extent, in cells, of the grid aligned box containing the overlap test of a cell
+	FVector GetCellOverlapHalfExtent() const;
+
+	// Helper function to rasterize the collision shapes of the components overlapping a region of cells into an occupancy covering only that region
+	void VoxelizeCollisionGeometry(NavOccupancy& occupancy, const FIntVector& min_coordinates, const FIntVector& max_coordinates);
+
+	// Helper function to add the collision shapes of a component in grid space, in cells from grid_origin, returning false if they can't be read
+	bool AddCollisionShapes(UPrimitiveComponent* component, const FIntVector& grid_origin, NavVoxelShapes& shapes) const;
+
+	// Helper function to get the components that may block the cells of a region according to the occupancy object types and actor class filter
+	void GatherOccupancyComponents(const FIntVector& min_coordinates, const FIntVector& max_coordinates, const FVector& cell_half_extent, TArray<UPrimitiveComponent*>& out_components) const;
+
+	// Helper function to get the range of cells whose overlap tests may touch a world space box, returning false if there are none
+	bool GetCellRange(const FBox& world_bounds, FIntVector& out_min, FIntVector& out_max) const;
+
+	// Helper function to publish a fully built occupancy, dropping any pending incremental update and building what is derived from it
+	void PublishOccupancy(const TSharedPtr<NavOccupancy, ESPMode::ThreadSafe>& occupancy);
+
+	// Helper function to publish the baked occupancy (or an octree built from it), returning false if it is missing, stale or invalid
+	bool LoadBakedData();
+
+	// Helper function to hash the settings the occupancy depends on and the actors overlapping the volume, used to detect stale baked data
+	uint64 ComputeLevelChecksum() const;
+
+	// Helper function to build and publish the sparse octree, copying the nodes outside of the pending dirty regions from previous (optional)
+	void BuildSparseOctree(const NavSparseOctree* previous);
+
+	// Helper function to build the cluster graph for an occupancy, copying the clusters the changed cells don't touch from previous (optional)
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> BuildClusterGraph(const NavOccupancy& occupancy, const NavClusterGraph* previous, const TArray<int32>& changed_cells) const;
+
+	// Helper function to label the connected components of an occupancy, updating previous for the changed cells (optional)
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> BuildComponents(const NavOccupancy& occupancy, const NavComponents* previous, const TArray<int32>& changed_cells) const;
+
+	// Helper function to compute the clearance field of an occupancy
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> BuildClearanceField(const NavOccupancy& occupancy) const;
+
+	// Helper function to link the portals of the volume again when cells on the border of the grid changed
+	void RefreshPortals(const TArray<int32>& changed_cells);
+
+	// Helper function to publish the transform between world space and the cells of the grid, for the current actor transform
+	void UpdateGridTransform();
+
+	// Called when the root component moves, to publish the grid transform again
+	void OnRootTransformUpdated(USceneComponent* updated_component, EUpdateTransformFlags update_transform_flags, ETeleportType teleport);
+
+	// Helper function to check if the occupancy bitfield or sparse octree read by path queries has been built
+	bool IsNavigationDataBuilt() const;
+
+	// Helper function to mark the cells of registered obstacles that moved or were destroyed as dirty
+	void UpdateDynamicObstacles();
+
+	// Helper function to revoxelize dirty cells within the time budget, publishing the result once a batch is complete
+	void ProcessDirtyOccupancy();
+
+	// Helper function converting world space locations into the flat index of their cells
+	std::vector<int32> ConvertLocationsToCells(const TArray<FVector>& locations) const;
+
+	// Helper function appending the world location of each cell along a path found by the core searches, converted with a grid transform snapshot
+	void ConvertCellsToLocations(const NavGridTransform& grid_transform, const std::vector<int32>& cells, TArray<FVector>& out_locations) const;
+
+	// Helper function searching the published navigation data, or the path cache, recording how the query was answered
+	bool SearchNavigationData(const FVector& start, const FVector& destination, NavSearchContext& context, TArray<FVector>& out_path, FNavPathQueryStats& out_stats) const;
+
+	// Helper function searching an occupancy snapshot with the search algorithm into the path cells of the context, counting the cell tests answered by the occupancy cache
+	bool SearchOccupancy(const NavOccupancy& occupancy, const NavClusterGraph* cluster_graph, int32 start_index, int32 end_index, NavSearchContext& context, int32& out_cache_hits) const;
+
+	// Helper function identifying the settings that change the paths found, so paths cached with other settings aren't reused
+	uint32 GetPathCacheProfile() const;
+
+	// Helper function completing the measurements of a query started at start_time and adding them to the rolling stats
+	void FinishPathQueryStats(const NavSearchContext& context, double start_time, uint64 start_expanded, FNavPathQueryStats& stats) const;
+
+	// The grid dimensions and neighbor offsets used for pathfinding
+	NavGrid* Grid = nullptr;
+
+	// The per cell cost layers, allocated in BeginPlay when Cost Layer Count isn't 0, set and read on the game thread
+	NavCostLayers* CostLayers = nullptr;
+
+	// The cooperative planner, created by the first PlanCooperativePaths call and kept for the distances to the goals of the agents
+	NavCooperativePlanner* CooperativePlanner = nullptr;
+
+	// The occupancy snapshot the cooperative planner's distances were computed for
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> CooperativeOccupancy;
+
+	// The search state used by path queries made on the game thread
+	NavSearchContext* GameThreadContext = nullptr;
+
+	// The asynchronous path requests
+	NavPathQueue* PathQueue = nullptr;
+
+	// The paths found by recent queries
+	NavPathCache* PathCache = nullptr;
+
+	// Guards the path cache, which is read and written by queries on any thread. Taken after OccupancyLock when both are needed.
+	mutable FCriticalSection PathCacheLock;
+
+	// The flow fields by id, built and updated on the game thread along with the occupancy
+	TMap<int32, TSharedPtr<NavFlowField> > FlowFields;
+
+	// The id given to the next flow field
+	int32 NextFlowFieldId = 0;
+
+	// Guards publishing and reading the occupancy and octree snapshots
+	mutable FCriticalSection OccupancyLock;
+
+	// The published occupancy bitfield, valid once BuildOccupancy has been called. Replaced, never modified, once published.
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> Occupancy;
+
+	// The copy of the occupancy the current batch of dirty cells is written into
+	TSharedPtr<NavOccupancy, ESPMode::ThreadSafe> StagingOccupancy;
+
+	// One bit per cell, set while the cell is queued in PendingDirtyCells
+	TBitArray<> DirtyCellMask;
+
+	// The cells marked dirty since the current batch started
+	TArray<int32> PendingDirtyCells;
+
+	// The cells of the batch currently being revoxelized
+	TArray<int32> ActiveDirtyCells;
+
+	// The cells of the active batch whose occupancy changed
+	TArray<int32> ChangedDirtyCells;
+
+	// The next cell of the active batch to revoxelize
+	int32 ActiveDirtyCursor = 0;
+
+	// The regions of cells, as their min and max coordinates, marked dirty since the current batch started when collision geometry is voxelized
+	TArray<TPair<FIntVector, FIntVector> > PendingDirtyRegions;
+
+	// The regions of the batch currently being revoxelized
+	TArray<TPair<FIntVector, FIntVector> > ActiveDirtyRegions;
+
+	// The next region of the active batch to revoxelize
+	int32 ActiveDirtyRegionCursor = 0;
+
+	// The cluster graph used by hierarchical search, published together with the occupancy it was built for
+	TSharedPtr<NavClusterGraph, ESPMode::ThreadSafe> ClusterGraph;
+
+	// The connected components used to reject unreachable queries, published together with the occupancy they were built for
+	TSharedPtr<NavComponents, ESPMode::ThreadSafe> Components;
+
+	// The settings the grid mesh was last built from, compared to skip rebuilding it when nothing it depends on changed
+	struct FDebugMeshSettings
+	{
+		FIntVector Divisions = FIntVector::ZeroValue;
+		float DivisionSize = 0.0f;
+		float LineThickness = 0.0f;
+		ENavDebugDrawMode Mode = ENavDebugDrawMode::FullGrid;
+		ENavDebugSliceAxis SliceAxis = ENavDebugSliceAxis::Z;
+		int32 SliceIndex = INDEX_NONE;
+		int32 MaxCells = 0;
+
+		bool operator==(const FDebugMeshSettings& other) const
+		{
+			return Divisions == other.Divisions && DivisionSize == other.DivisionSize && LineThickness == other.LineThickness && Mode == other.Mode &&
+				SliceAxis == other.SliceAxis && SliceIndex == other.SliceIndex && MaxCells == other.MaxCells;
+		}
+	};
+	FDebugMeshSettings DebugMeshSettings;
+
+	// The number of vertices of the grid mesh when it was last built, to notice the mesh section was lost with the components
+	int32 DebugMeshVertexCount = INDEX_NONE;
+
+	// The cells of the last path found on the game thread, drawn by the path cells mode
+	TArray<int32> DebugPathCells;
+
+	// The clearance of every cell used by agent size queries, published together with the occupancy it was built for
+	TSharedPtr<NavClearanceField, ESPMode::ThreadSafe> ClearanceField;
+
+	// The published sparse octree, valid once BuildOccupancy has been called with the sparse octree representation
+	TSharedPtr<NavSparseOctree, ESPMode::ThreadSafe> Octree;
+
+	// The published transform between world space and the cells of the grid, valid between BeginPlay and EndPlay
+	TSharedPtr<NavGridTransform, ESPMode::ThreadSafe> GridTransform;
+
+	// The inclusive min and max coordinates of the regions to rebuild in the sparse octree
+	TArray<TPair<FIntVector, FIntVector> > PendingOctreeRegions;
+
+	// The registered dynamic obstacles and their bounds when their cells were last marked dirty
+	TMap<TWeakObjectPtr<AActor>, FBox> DynamicObstacles;
+
+	// Guards the recorded query stats, which are written by queries on any thread
+	mutable FCriticalSection QueryStatsLock;
+
+	// The stats of the most recent queries, as a ring buffer of up to QueryStatsHistorySize entries
+	mutable TArray<FNavPathQueryStats> RecentQueryStats;
+
+	// The position in RecentQueryStats the next query is recorded at
+	mutable int32 NextQueryStatsIndex = 0;
+
+	// The number of queries recorded since play began or the stats were reset
+	mutable int32 TotalQueryCount = 0;
 };
@@ -0,0 +1,61 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavAStar.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavAStar, StraightLineInEmptyGrid)
+{
+	NavTestScene scene(FIntVector(10, 10, 10), 0, 1, 0, 0);
+	NavSearchContext context;
+	std::vector<int32> path;
+
+	const int32 start = scene.Grid.GetIndex(FIntVector(0, 0, 0));
+	const int32 end = scene.Grid.GetIndex(FIntVector(9, 9, 9));
+	ASSERT_TRUE(NavAStar::FindPath(scene.Grid, start, end, [&](int32 index) { return scene.Occupancy.IsBlocked(index); }, context, path));
+	EXPECT_EQ(path.size(), 10u);
+	EXPECT_EQ(path.front(), start);
+	EXPECT_EQ(path.back(), end);
+}
+
+TEST(NavAStar, FailsWhenTheGoalIsWalledOff)
+{
+	NavTestScene scene(FIntVector(8, 8, 8), 0, 1, 0, 0);
+	scene.FillBox(FIntVector(4, 0, 0), FIntVector(4, 7, 7), true);
+	NavSearchContext context;
+	std::vector<int32> path;
+
+	auto isBlocked = [&](int32 index) { return scene.Occupancy.IsBlocked(index); };
+	EXPECT_FALSE(NavAStar::FindPath(scene.Grid, scene.Grid.GetIndex(FIntVector(1, 1, 1)), scene.Grid.GetIndex(FIntVector(6, 6, 6)), isBlocked, context, path));
+	EXPECT_TRUE(path.empty());
+}
+
+TEST(NavAStar, MatchesDijkstraOnRandomGrids)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		const int32 axes = seed % 3;
+		NavTestScene scene(FIntVector(6 + seed % 9, 5 + seed % 7, 4 + seed % 11), axes, seed);
+		NavSearchContext context;
+		std::vector<int32> path;
+		auto isBlocked = [&](int32 index) { return scene.Occupancy.IsBlocked(index); };
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end))
+				continue;
+
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+			const bool found = NavAStar::FindPath(scene.Grid, start, end, isBlocked, context, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed;
+			if (found)
+			{
+				EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, path));
+				EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f);
+			}
+		}
+	}
+}
@@ -0,0 +1,106 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavBakedData.h"
+#include "NavOccupancy.h"
+#include "NavTestHelpers.h"
+#include <cstddef>
+#include <gtest/gtest.h>
+
+namespace
+{
+	void ExpectSameOccupancy(const NavOccupancy& expected, const NavOccupancy& actual)
+	{
+		ASSERT_EQ(expected.Num(), actual.Num());
+		for (int32 index = 0; index < expected.Num(); ++index)
+		{
+			ASSERT_EQ(expected.IsBlocked(index), actual.IsBlocked(index)) << "cell " << index;
+		}
+	}
+}
+
+TEST(NavBakedData, RoundTripsBothEncodings)
+{
+	// A few boxes compress well, scattered cells don't and fall back to packed bits
+	const int32 scatterDivisors[] = { 1000000, 3 };
+	for (const int32 scatterDivisor : scatterDivisors)
+	{
+		NavTestScene scene(FIntVector(37, 21, 13), 0, 11, 6, scatterDivisor);
+
+		for (const ENavBakedCompression compression : { ENavBakedCompression::BitPacked, ENavBakedCompression::RunLength })
+		{
+			std::vector<uint8> data;
+			NavBakedData::Write(scene.Grid.GetDivisions(), scene.Occupancy, 1234, compression, data);
+
+			NavOccupancy loaded;
+			NavBakedDataHeader header;
+			ASSERT_EQ(NavBakedData::Read(data.data(), data.size(), loaded, &header), ENavBakedDataResult::Success);
+			EXPECT_EQ(header.GetDivisions(), scene.Grid.GetDivisions());
+			EXPECT_EQ(header.LevelChecksum, 1234u);
+			EXPECT_EQ(header.PayloadSize + sizeof(NavBakedDataHeader), data.size());
+			ExpectSameOccupancy(scene.Occupancy, loaded);
+
+			int32 blockedCount = 0;
+			for (int32 index = 0; index < loaded.Num(); ++index)
+			{
+				blockedCount += loaded.IsBlocked(index) ? 1 : 0;
+			}
+			EXPECT_EQ(header.BlockedCellCount, static_cast<uint32>(blockedCount));
+
+			if (compression == ENavBakedCompression::RunLength && scatterDivisor > 3)
+			{
+				EXPECT_EQ(header.Compression, static_cast<uint8>(ENavBakedCompression::RunLength));
+				EXPECT_LT(header.PayloadSize, static_cast<uint32>(scene.Occupancy.GetWordCount() * sizeof(uint32)));
+			}
+		}
+	}
+}
+
+TEST(NavBakedData, RunsCrossingWordBoundaries)
+{
+	NavOccupancy occupancy;
+	occupancy.Init(200);
+	occupancy.SetBlockedRange(0, 1);
+	occupancy.SetBlockedRange(30, 70);
+	occupancy.SetBlockedRange(128, 32);
+	occupancy.SetBlockedRange(199, 1);
+
+	std::vector<uint8> data;
+	NavBakedData::Write(FIntVector(200, 1, 1), occupancy, 0, ENavBakedCompression::RunLength, data);
+
+	NavOccupancy loaded;
+	ASSERT_EQ(NavBakedData::Read(data.data(), data.size(), loaded), ENavBakedDataResult::Success);
+	for (int32 index = 0; index < 200; ++index)
+	{
+		const bool blocked = index == 0 || (index >= 30 && index < 100) || (index >= 128 && index < 160) || index == 199;
+		EXPECT_EQ(loaded.IsBlocked(index), blocked) << "cell " << index;
+	}
+}
+
+TEST(NavBakedData, RejectsDamagedData)
+{
+	NavTestScene scene(FIntVector(16, 16, 16), 0, 5);
+	std::vector<uint8> data;
+	NavBakedData::Write(scene.Grid.GetDivisions(), scene.Occupancy, 0, ENavBakedCompression::RunLength, data);
+
+	NavOccupancy loaded;
+	EXPECT_EQ(NavBakedData::Read(data.data(), sizeof(NavBakedDataHeader) - 1, loaded), ENavBakedDataResult::Truncated);
+	EXPECT_EQ(NavBakedData::Read(data.data(), data.size() - 1, loaded), ENavBakedDataResult::Truncated);
+	EXPECT_FALSE(loaded.IsValid());
+
+	std::vector<uint8> damaged = data;
+	damaged[0] ^= 0xFF;
+	EXPECT_EQ(NavBakedData::Read(damaged.data(), damaged.size(), loaded), ENavBakedDataResult::InvalidFormat);
+
+	damaged = data;
+	damaged[offsetof(NavBakedDataHeader, Version)] += 1;
+	EXPECT_EQ(NavBakedData::Read(damaged.data(), damaged.size(), loaded), ENavBakedDataResult::UnsupportedVersion);
+
+	damaged = data;
+	damaged.back() ^= 0x01;
+	EXPECT_EQ(NavBakedData::Read(damaged.data(), damaged.size(), loaded), ENavBakedDataResult::Corrupt);
+
+	damaged = data;
+	damaged[offsetof(NavBakedDataHeader, LevelChecksum)] ^= 0x01;
+	EXPECT_EQ(NavBakedData::Read(damaged.data(), damaged.size(), loaded), ENavBakedDataResult::Corrupt);
+	EXPECT_FALSE(loaded.IsValid());
+}
@@ -0,0 +1,56 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavBidirectionalAStar.h"
+#include "NavAStar.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavBidirectionalAStar, FindsShortestPaths)
+{
+	for (uint32 seed = 0; seed < 40; ++seed)
+	{
+		NavTestScene scene(FIntVector(6 + seed % 13, 5 + seed % 9, 4 + seed % 7), seed % 3, seed * 19 + 4);
+		NavSearchContext context;
+		std::vector<int32> path;
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			// Blocked starts included, the search leaves the start untested like A*
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+			const bool found = NavBidirectionalAStar::FindPath(scene.Grid, scene.Occupancy, start, end, context, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", query " << query;
+			if (found)
+			{
+				EXPECT_EQ(path.front(), start);
+				EXPECT_EQ(path.back(), end);
+				EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, std::vector<int32>(path.begin() + 1, path.end()))) << "seed " << seed;
+				EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed << ", query " << query;
+			}
+		}
+	}
+}
+
+TEST(NavBidirectionalAStar, StopsEarlyWhenTheGoalIsWalledIn)
+{
+	NavTestScene scene(FIntVector(32, 32, 32), 0, 1, 0, 0);
+	scene.FillBox(FIntVector(25, 25, 25), FIntVector(29, 29, 29), true);
+	const int32 start = scene.Grid.GetIndex(FIntVector(1, 1, 1));
+	const int32 end = scene.Grid.GetIndex(FIntVector(27, 27, 27));
+	scene.FillBox(FIntVector(26, 26, 26), FIntVector(28, 28, 28), false);
+
+	NavSearchContext context;
+	std::vector<int32> path;
+	EXPECT_FALSE(NavBidirectionalAStar::FindPath(scene.Grid, scene.Occupancy, start, end, context, path));
+	const uint64 bidirectionalExpanded = context.GetTotalExpandedNum();
+
+	NavSearchContext aStarContext;
+	auto isBlocked = [&](int32 index) { return scene.Occupancy.IsBlocked(index); };
+	EXPECT_FALSE(NavAStar::FindPath(scene.Grid, start, end, isBlocked, aStarContext, path));
+
+	// The pocket around the goal holds 27 cells, A* floods the rest of the grid
+	EXPECT_LT(bidirectionalExpanded, 100u);
+	EXPECT_GT(aStarContext.GetTotalExpandedNum(), 30000u);
+}
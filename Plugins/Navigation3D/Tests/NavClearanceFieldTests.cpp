@@ -0,0 +1,154 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavClearanceField.h"
+#include "NavAStar.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace
+{
+	// Runs the body on 4 threads, each taking every 4th index
+	void ThreadedParallelFor(int32 count, const std::function<void(int32)>& body)
+	{
+		std::vector<std::thread> threads;
+		for (int32 thread = 0; thread < 4; ++thread)
+		{
+			threads.emplace_back([&body, count, thread]()
+			{
+				for (int32 index = thread; index < count; index += 4)
+				{
+					body(index);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Gets the squared distance to the closest blocked cell by checking every one
+	uint16 GetBruteForceClearanceSq(const NavGrid& grid, const NavOccupancy& occupancy, int32 index)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		int64 best = NavClearanceField::MaxClearanceSq;
+		for (int32 other = 0; other < grid.Num(); ++other)
+		{
+			if (occupancy.IsBlocked(other))
+			{
+				const FIntVector delta = grid.GetCoordinates(other) - coordinates;
+				best = FMath::Min<int64>(best, (static_cast<int64>(delta.X) * delta.X) + (static_cast<int64>(delta.Y) * delta.Y) + (static_cast<int64>(delta.Z) * delta.Z));
+			}
+		}
+		return static_cast<uint16>(best);
+	}
+}
+
+TEST(NavClearanceField, MatchesTheDistanceToTheClosestBlockedCell)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		// Sparse scenes too, so some cells are far from anything
+		NavTestScene scene(FIntVector(5 + seed % 13, 4 + seed % 9, 3 + seed % 11), 0, seed * 29 + 7, 1 + seed % 4, seed % 2 == 0 ? 0 : 40);
+		NavClearanceField sequential;
+		sequential.Build(scene.Grid, scene.Occupancy);
+		NavClearanceField parallel;
+		parallel.Build(scene.Grid, scene.Occupancy, ThreadedParallelFor);
+
+		for (int32 index = 0; index < scene.Grid.Num(); ++index)
+		{
+			const uint16 expected = GetBruteForceClearanceSq(scene.Grid, scene.Occupancy, index);
+			ASSERT_EQ(sequential.GetClearanceSq(index), expected) << "seed " << seed << ", cell " << index;
+			ASSERT_EQ(parallel.GetClearanceSq(index), expected) << "seed " << seed << ", cell " << index;
+		}
+	}
+
+	// Nothing blocked, everything is as far as the field measures
+	NavTestScene empty(FIntVector(6, 6, 6), 0, 1, 0, 0);
+	NavClearanceField field;
+	field.Build(empty.Grid, empty.Occupancy);
+	EXPECT_EQ(field.GetClearanceSq(0), NavClearanceField::MaxClearanceSq);
+}
+
+TEST(NavClearanceField, SmallAgentsTakeGapsLargeAgentsGoAround)
+{
+	// A wall across X with a single cell hole near one side and a 3 by 3 hole near the other
+	NavTestScene scene(FIntVector(12, 16, 9), 0, 1, 0, 0);
+	scene.FillBox(FIntVector(6, 0, 0), FIntVector(6, 15, 8), true);
+	scene.Occupancy.SetBlocked(scene.Grid.GetIndex(FIntVector(6, 2, 4)), false);
+	scene.FillBox(FIntVector(6, 11, 3), FIntVector(6, 13, 5), false);
+
+	NavClearanceField field;
+	field.Build(scene.Grid, scene.Occupancy);
+	EXPECT_EQ(NavClearanceField::GetRequiredClearanceSq(0.0f), 1);
+	EXPECT_EQ(NavClearanceField::GetRequiredClearanceSq(0.1f), 1);
+	EXPECT_EQ(NavClearanceField::GetRequiredClearanceSq(0.5f), 2);
+	EXPECT_EQ(NavClearanceField::GetRequiredClearanceSq(1.0f), 4);
+
+	const int32 start = scene.Grid.GetIndex(FIntVector(2, 2, 4));
+	const int32 end = scene.Grid.GetIndex(FIntVector(10, 2, 4));
+	NavSearchContext context;
+	std::vector<int32> path;
+	auto findPath = [&](float agent_radius)
+	{
+		const uint16 required = NavClearanceField::GetRequiredClearanceSq(agent_radius);
+		return NavAStar::FindPath(scene.Grid, start, end, [&](int32 index) { return field.IsClear(index, required) == false; }, context, path);
+	};
+
+	// Through the small hole
+	ASSERT_TRUE(findPath(0.1f));
+	EXPECT_NEAR(GetPathCost(scene.Grid, path), 8.0f, 1.e-3f);
+
+	// Around through the large one, never closer to the wall than the radius
+	ASSERT_TRUE(findPath(1.0f));
+	EXPECT_GT(GetPathCost(scene.Grid, path), 16.0f);
+	for (const int32 cell : path)
+	{
+		EXPECT_GE(field.GetClearance(cell), 1.0f + 0.866f);
+	}
+
+	// Nothing wide enough
+	EXPECT_FALSE(findPath(1.2f));
+}
+
+TEST(NavClearanceField, AgentsNeverOverlapDiagonalBlockedCells)
+{
+	// A single blocked cell diagonal to a free one: its closest edge is 0.707 cells from the center, not the 0.5 of a face
+	NavTestScene diagonal(FIntVector(3, 3, 3), 0, 1, 0, 0);
+	diagonal.Occupancy.SetBlocked(diagonal.Grid.GetIndex(FIntVector(2, 2, 1)), true);
+	NavClearanceField diagonalField;
+	diagonalField.Build(diagonal.Grid, diagonal.Occupancy);
+	const int32 center = diagonal.Grid.GetIndex(FIntVector(1, 1, 1));
+	EXPECT_TRUE(diagonalField.IsClear(center, NavClearanceField::GetRequiredClearanceSq(0.5f)));
+	EXPECT_FALSE(diagonalField.IsClear(center, NavClearanceField::GetRequiredClearanceSq(0.9f)));
+
+	// In any scene, an agent at the center of a clear cell is further than its radius from every point of every blocked cell
+	for (uint32 seed = 0; seed < 10; ++seed)
+	{
+		NavTestScene scene(FIntVector(6 + seed % 5, 5 + seed % 4, 4 + seed % 3), 0, seed * 31 + 11, 1 + seed % 3, 0);
+		NavClearanceField field;
+		field.Build(scene.Grid, scene.Occupancy);
+		for (const float agentRadius : { 0.0f, 0.3f, 0.9f, 1.4f })
+		{
+			const uint16 required = NavClearanceField::GetRequiredClearanceSq(agentRadius);
+			for (int32 index = 0; index < scene.Grid.Num(); ++index)
+			{
+				if (field.IsClear(index, required) == false)
+					continue;
+
+				const FIntVector coordinates = scene.Grid.GetCoordinates(index);
+				for (int32 other = 0; other < scene.Grid.Num(); ++other)
+				{
+					if (scene.Occupancy.IsBlocked(other) == false)
+						continue;
+
+					// The distance from the center of the cell to the closest point of the blocked cell's box
+					const FIntVector delta = scene.Grid.GetCoordinates(other) - coordinates;
+					const FVector gap(FMath::Max(FMath::Abs(delta.X) - 0.5f, 0.0f), FMath::Max(FMath::Abs(delta.Y) - 0.5f, 0.0f), FMath::Max(FMath::Abs(delta.Z) - 0.5f, 0.0f));
+					ASSERT_GE(FVector::Distance(gap, FVector::ZeroVector), agentRadius) << "seed " << seed << ", cell " << index << ", blocked " << other;
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavClusterGraph.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavClusterGraph, PathsAreValidAndNearOptimal)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		const int32 axes = seed % 3;
+		NavTestScene scene(FIntVector(8 + seed % 17, 6 + seed % 13, 5 + seed % 11), axes, seed + 50);
+		NavClusterGraph graph;
+		graph.Build(scene.Grid, scene.Occupancy, 2 + seed % 6);
+		ASSERT_TRUE(graph.IsValid());
+
+		NavSearchContext context;
+		std::vector<int32> path;
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end))
+				continue;
+
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+			const bool found = graph.FindPath(scene.Grid, scene.Occupancy, start, end, context, path);
+			if (found == false)
+			{
+				// Only diagonal moves across cluster borders can be missed by the graph
+				EXPECT_TRUE(reference < 0.0f || axes < 2) << "seed " << seed;
+				continue;
+			}
+
+			ASSERT_GE(reference, 0.0f);
+			EXPECT_EQ(path.front(), start);
+			EXPECT_EQ(path.back(), end);
+			EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, path));
+			EXPECT_GE(GetPathCost(scene.Grid, path), reference - 1.e-3f);
+		}
+	}
+}
+
+TEST(NavClusterGraph, IncrementalBuildMatchesFullBuild)
+{
+	for (uint32 seed = 0; seed < 10; ++seed)
+	{
+		NavTestScene scene(FIntVector(20, 17, 14), seed % 3, seed + 7);
+		// Single cell clusters too, where every cell lies on both faces of its cluster along each axis
+		const int32 clusterSize = 1 + seed % 7;
+		NavClusterGraph previous;
+		previous.Build(scene.Grid, scene.Occupancy, clusterSize);
+
+		std::vector<int32> changed;
+		std::mt19937 rng(seed);
+		for (int32 i = 0; i < 30; ++i)
+		{
+			const int32 index = rng() % scene.Grid.Num();
+			scene.Occupancy.SetBlocked(index, scene.Occupancy.IsBlocked(index) == false);
+			changed.push_back(index);
+		}
+
+		NavClusterGraph incremental;
+		incremental.Build(scene.Grid, scene.Occupancy, clusterSize, &previous, changed);
+		NavClusterGraph full;
+		full.Build(scene.Grid, scene.Occupancy, clusterSize);
+		EXPECT_EQ(incremental.GetEntranceCount(), full.GetEntranceCount());
+
+		NavSearchContext context;
+		std::vector<int32> incrementalPath;
+		std::vector<int32> fullPath;
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start))
+				continue;
+
+			ASSERT_EQ(incremental.FindPath(scene.Grid, scene.Occupancy, start, end, context, incrementalPath), full.FindPath(scene.Grid, scene.Occupancy, start, end, context, fullPath));
+			EXPECT_EQ(incrementalPath, fullPath);
+		}
+	}
+}
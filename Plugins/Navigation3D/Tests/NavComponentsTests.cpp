@@ -0,0 +1,88 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavComponents.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavComponents, RejectsExactlyTheUnreachableQueries)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		// Dense scatter so the free cells break up into many components
+		NavTestScene scene(FIntVector(5 + seed % 9, 4 + seed % 7, 3 + seed % 6), seed % 3, seed * 7 + 3, 8, 2 + seed % 3);
+		NavComponents components;
+		components.Build(scene.Grid, scene.Occupancy);
+		ASSERT_TRUE(components.IsValid());
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 40; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			const bool reachable = GetReferenceCost(scene.Grid, scene.Occupancy, start, end) >= 0.0f;
+			EXPECT_EQ(components.IsReachable(scene.Grid, start, end), reachable) << "seed " << seed << ", query " << query;
+		}
+	}
+}
+
+TEST(NavComponents, UpdatesNeverRejectReachableQueries)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		NavTestScene scene(FIntVector(12, 10, 8), seed % 3, seed * 13 + 1, 8, 3);
+		NavComponents components;
+		components.Build(scene.Grid, scene.Occupancy);
+
+		std::mt19937 rng(seed);
+		for (int32 batch = 0; batch < 10; ++batch)
+		{
+			// Flip a few cells, then update the previous components rather than labeling again
+			std::vector<int32> changed;
+			for (int32 i = 0; i < 3; ++i)
+			{
+				const int32 cell = rng() % scene.Grid.Num();
+				scene.Occupancy.SetBlocked(cell, scene.Occupancy.IsBlocked(cell) == false);
+				changed.push_back(cell);
+			}
+
+			NavComponents updated;
+			updated.Build(scene.Grid, scene.Occupancy, &components, changed);
+			components = updated;
+
+			NavComponents rebuilt;
+			rebuilt.Build(scene.Grid, scene.Occupancy);
+			for (int32 query = 0; query < 30; ++query)
+			{
+				const int32 start = rng() % scene.Grid.Num();
+				const int32 end = rng() % scene.Grid.Num();
+				const bool reachable = GetReferenceCost(scene.Grid, scene.Occupancy, start, end) >= 0.0f;
+				EXPECT_EQ(rebuilt.IsReachable(scene.Grid, start, end), reachable) << "seed " << seed;
+				if (reachable)
+				{
+					EXPECT_TRUE(components.IsReachable(scene.Grid, start, end)) << "seed " << seed << ", batch " << batch;
+				}
+			}
+		}
+	}
+}
+
+TEST(NavComponents, MergesComponentsWhenAWallOpens)
+{
+	NavTestScene scene(FIntVector(9, 6, 6), 0, 1, 0, 0);
+	scene.FillBox(FIntVector(4, 0, 0), FIntVector(4, 5, 5), true);
+	const int32 left = scene.Grid.GetIndex(FIntVector(1, 2, 2));
+	const int32 right = scene.Grid.GetIndex(FIntVector(7, 3, 3));
+	const int32 door = scene.Grid.GetIndex(FIntVector(4, 3, 3));
+
+	NavComponents components;
+	components.Build(scene.Grid, scene.Occupancy);
+	EXPECT_FALSE(components.IsReachable(scene.Grid, left, right));
+	EXPECT_TRUE(components.IsReachable(scene.Grid, door, right)) << "a blocked start steps out to its neighbors";
+
+	scene.Occupancy.SetBlocked(door, false);
+	NavComponents opened;
+	opened.Build(scene.Grid, scene.Occupancy, &components, { door });
+	EXPECT_TRUE(opened.IsReachable(scene.Grid, left, right));
+	EXPECT_EQ(opened.GetComponent(left), opened.GetComponent(right));
+	EXPECT_EQ(opened.GetStaleChangeNum(), 1);
+}
@@ -0,0 +1,180 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavCooperativePlanner.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace
+{
+	// Runs the body on 4 threads, each taking every 4th index
+	void ThreadedParallelFor(int32 count, const std::function<void(int32)>& body)
+	{
+		std::vector<std::thread> threads;
+		for (int32 thread = 0; thread < 4; ++thread)
+		{
+			threads.emplace_back([&body, count, thread]()
+			{
+				for (int32 index = thread; index < count; index += 4)
+				{
+					body(index);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	// Checks that every path starts at its agent, takes valid steps, and that no two agents share a cell or swap cells
+	void ExpectPathsValid(const NavTestScene& scene, const std::vector<NavCooperativeAgent>& agents, const std::vector<std::vector<int32> >& paths, int32 window, bool conflict_free)
+	{
+		std::unordered_map<uint64, int32> holders;
+		for (size_t agent = 0; agent < agents.size(); ++agent)
+		{
+			const std::vector<int32>& path = paths[agent];
+			ASSERT_EQ(static_cast<int32>(path.size()), window + 1);
+			EXPECT_EQ(path[0], agents[agent].Start);
+			for (int32 time = 1; time <= window; ++time)
+			{
+				if (path[time] != path[time - 1])
+				{
+					EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, { path[time - 1], path[time] })) << "agent " << agent << ", step " << time;
+				}
+			}
+
+			for (int32 time = 0; time <= window && conflict_free; ++time)
+			{
+				const auto inserted = holders.emplace((static_cast<uint64>(time) << 32) | static_cast<uint32>(path[time]), static_cast<int32>(agent));
+				EXPECT_TRUE(inserted.second) << "agents " << inserted.first->second << " and " << agent << " share a cell at step " << time;
+			}
+		}
+
+		// Swaps: an agent moving into the cell another one leaves for its own
+		for (size_t agent = 0; agent < agents.size() && conflict_free; ++agent)
+		{
+			for (int32 time = 0; time < window; ++time)
+			{
+				const int32 from = paths[agent][time];
+				const int32 to = paths[agent][time + 1];
+				const auto other = holders.find((static_cast<uint64>(time) << 32) | static_cast<uint32>(to));
+				if (from != to && other != holders.end() && other->second != static_cast<int32>(agent))
+				{
+					EXPECT_NE(paths[other->second][time + 1], from) << "agents " << agent << " and " << other->second << " swap at step " << time;
+				}
+			}
+		}
+	}
+
+	// Picks distinct free cells
+	std::vector<int32> PickFreeCells(const NavTestScene& scene, int32 count, std::mt19937& rng, std::vector<bool>& used)
+	{
+		std::vector<int32> cells;
+		while (static_cast<int32>(cells.size()) < count)
+		{
+			const int32 cell = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(cell) == false && used[cell] == false)
+			{
+				used[cell] = true;
+				cells.push_back(cell);
+			}
+		}
+		return cells;
+	}
+}
+
+TEST(NavCooperativePlanner, PlansConflictFreeWindowsForManyAgents)
+{
+	int32 failedNum = 0;
+	int32 reachedNum = 0;
+	int32 agentNum = 0;
+	for (uint32 seed = 0; seed < 6; ++seed)
+	{
+		NavTestScene scene(FIntVector(40, 40, 6), seed % 3, seed * 31 + 3, 12, 20);
+		std::mt19937 rng(seed);
+		std::vector<bool> usedStarts(scene.Grid.Num(), false);
+		std::vector<bool> usedGoals(scene.Grid.Num(), false);
+		const std::vector<int32> starts = PickFreeCells(scene, 80, rng, usedStarts);
+		const std::vector<int32> goals = PickFreeCells(scene, 80, rng, usedGoals);
+		std::vector<NavCooperativeAgent> agents;
+		for (size_t i = 0; i < starts.size(); ++i)
+		{
+			agents.push_back(NavCooperativeAgent{ starts[i], goals[i] });
+		}
+
+		NavCooperativePlanner sequential;
+		NavCooperativePlanner parallel;
+		sequential.SetWindow(8);
+		parallel.SetWindow(8);
+		std::vector<std::vector<int32> > paths;
+		std::vector<std::vector<int32> > parallelPaths;
+		for (int32 window = 0; window < 16; ++window)
+		{
+			const int32 failed = sequential.PlanWindow(scene.Grid, scene.Occupancy, agents, paths);
+			EXPECT_EQ(parallel.PlanWindow(scene.Grid, scene.Occupancy, agents, parallelPaths, ThreadedParallelFor), failed);
+			EXPECT_EQ(paths, parallelPaths) << "seed " << seed << ", window " << window;
+			ExpectPathsValid(scene, agents, paths, 8, failed == 0);
+			failedNum += failed;
+
+			// Follow the first half of the window
+			for (size_t agent = 0; agent < agents.size(); ++agent)
+			{
+				agents[agent].Start = paths[agent][4];
+			}
+		}
+
+		for (const NavCooperativeAgent& agent : agents)
+		{
+			reachedNum += agent.Start == agent.Goal || GetReferenceCost(scene.Grid, scene.Occupancy, agent.Start, agent.Goal) < 0.0f;
+		}
+		agentNum += static_cast<int32>(agents.size());
+	}
+	EXPECT_LE(failedNum, 2);
+	EXPECT_GE(reachedNum * 10, agentNum * 9) << reachedNum << " of " << agentNum << " agents reached their goal";
+}
+
+TEST(NavCooperativePlanner, FollowsShortestPathsAndCrossesNarrowPassages)
+{
+	// Alone, an agent takes a shortest path and waits at its goal
+	NavTestScene open(FIntVector(16, 16, 4), 0, 2, 4, 0);
+	const int32 start = open.Grid.GetIndex(FIntVector(1, 1, 1));
+	const int32 goal = open.Grid.GetIndex(FIntVector(9, 12, 2));
+	open.Occupancy.SetBlocked(start, false);
+	open.Occupancy.SetBlocked(goal, false);
+	NavCooperativePlanner planner;
+	planner.SetWindow(24);
+	std::vector<std::vector<int32> > paths;
+	ASSERT_EQ(planner.PlanWindow(open.Grid, open.Occupancy, { NavCooperativeAgent{ start, goal } }, paths), 0);
+	ASSERT_EQ(paths[0].back(), goal);
+	std::vector<int32> moves(paths[0].begin(), std::find(paths[0].begin(), paths[0].end(), goal) + 1);
+	EXPECT_NEAR(GetPathCost(open.Grid, moves), GetReferenceCost(open.Grid, open.Occupancy, start, goal), 1.e-3f);
+
+	// Two groups of agents on either side of a wall trade sides through a gap two cells wide
+	NavTestScene wall(FIntVector(12, 8, 1), 2, 0, 0, 0);
+	wall.FillBox(FIntVector(6, 0, 0), FIntVector(6, 7, 0), true);
+	wall.FillBox(FIntVector(6, 3, 0), FIntVector(6, 4, 0), false);
+	std::vector<NavCooperativeAgent> agents;
+	for (int32 y = 2; y < 6; ++y)
+	{
+		agents.push_back(NavCooperativeAgent{ wall.Grid.GetIndex(FIntVector(3, y, 0)), wall.Grid.GetIndex(FIntVector(9, y, 0)) });
+		agents.push_back(NavCooperativeAgent{ wall.Grid.GetIndex(FIntVector(9, y, 0)), wall.Grid.GetIndex(FIntVector(3, y, 0)) });
+	}
+
+	NavCooperativePlanner crossing;
+	crossing.SetWindow(12);
+	for (int32 window = 0; window < 12; ++window)
+	{
+		const int32 failed = crossing.PlanWindow(wall.Grid, wall.Occupancy, agents, paths);
+		EXPECT_EQ(failed, 0) << "window " << window;
+		ExpectPathsValid(wall, agents, paths, 12, true);
+		for (size_t agent = 0; agent < agents.size(); ++agent)
+		{
+			agents[agent].Start = paths[agent][6];
+		}
+	}
+	for (size_t agent = 0; agent < agents.size(); ++agent)
+	{
+		EXPECT_EQ(agents[agent].Start, agents[agent].Goal) << "agent " << agent;
+	}
+}
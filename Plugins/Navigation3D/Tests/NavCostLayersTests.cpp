@@ -0,0 +1,144 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavCostLayers.h"
+#include "NavAStar.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Gets the cost of the cheapest path between two cells with a plain Dijkstra search, or a negative value when there is none
+	float GetReferenceCostWithProfile(const NavGrid& grid, const NavOccupancy& occupancy, const NavCostProfile& profile, int32 start_index, int32 end_index)
+	{
+		using Entry = std::pair<float, int32>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+		std::vector<float> costs(grid.Num(), FLT_MAX);
+
+		costs[start_index] = 0.0f;
+		open.push(Entry(0.0f, start_index));
+		while (open.empty() == false)
+		{
+			const Entry current = open.top();
+			open.pop();
+			if (current.first > costs[current.second])
+				continue;
+
+			if (current.second == end_index)
+				return current.first;
+
+			grid.ForEachNeighbor(grid.GetCoordinates(current.second), [&](int32 neighbor, int32)
+			{
+				const float move = GetCellDistance(grid, current.second, neighbor) * 0.5f * (profile.GetCellCost(current.second) + profile.GetCellCost(neighbor));
+				const float cost = current.first + move;
+				if (occupancy.IsBlocked(neighbor) == false && cost < costs[neighbor])
+				{
+					costs[neighbor] = cost;
+					open.push(Entry(cost, neighbor));
+				}
+			});
+		}
+		return -1.0f;
+	}
+
+	float GetPathCostWithProfile(const NavGrid& grid, const NavCostProfile& profile, const std::vector<int32>& path)
+	{
+		float cost = 0.0f;
+		for (size_t i = 1; i < path.size(); ++i)
+		{
+			cost += GetCellDistance(grid, path[i - 1], path[i]) * 0.5f * (profile.GetCellCost(path[i - 1]) + profile.GetCellCost(path[i]));
+		}
+		return cost;
+	}
+}
+
+TEST(NavCostLayers, FindsCheapestPathsForAnyProfile)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		NavTestScene scene(FIntVector(6 + seed % 11, 5 + seed % 9, 4 + seed % 7), seed % 3, seed * 23 + 1);
+		std::mt19937 rng(seed);
+
+		// Smooth layers with a floor above 0, so the heuristic is scaled up, plus a layer of scattered spikes
+		NavCostLayers layers;
+		layers.Init(scene.Grid.Num(), 3);
+		for (int32 index = 0; index < scene.Grid.Num(); ++index)
+		{
+			const FIntVector coordinates = scene.Grid.GetCoordinates(index);
+			layers.SetCost(index, 0, static_cast<uint8>(40 + (coordinates.Z * 20) % 200));
+			layers.SetCost(index, 1, static_cast<uint8>(60 + (coordinates.X * 37) % 150));
+			layers.SetCost(index, 2, rng() % 4 == 0 ? 255 : 0);
+		}
+
+		const float weights[3] = { (rng() % 5) * 0.5f, (rng() % 5) * 0.5f, static_cast<float>(rng() % 8) };
+		const NavCostProfile profile(layers, weights, 3);
+		EXPECT_GE(profile.GetMinCellCost(), 1.0f);
+
+		NavSearchContext context;
+		std::vector<int32> path;
+		auto isBlocked = [&scene](int32 index) { return scene.Occupancy.IsBlocked(index); };
+		auto getCellCost = [&profile](int32 index) { return profile.GetCellCost(index); };
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			const float reference = GetReferenceCostWithProfile(scene.Grid, scene.Occupancy, profile, start, end);
+			const bool found = NavAStar::FindPathWithCosts(scene.Grid, start, end, isBlocked, getCellCost, profile.GetMinCellCost(), context, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", query " << query;
+			if (found)
+			{
+				EXPECT_EQ(path.front(), start);
+				EXPECT_EQ(path.back(), end);
+				EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, std::vector<int32>(path.begin() + 1, path.end()))) << "seed " << seed;
+				EXPECT_NEAR(GetPathCostWithProfile(scene.Grid, profile, path), reference, 1.e-3f * FMath::Max(reference, 1.0f)) << "seed " << seed << ", query " << query;
+			}
+		}
+	}
+}
+
+TEST(NavCostLayers, TracksLowestCostsAndIgnoresUnweightedLayers)
+{
+	NavCostLayers layers;
+	layers.Init(1000, 2);
+	EXPECT_EQ(layers.GetMinCost(0), 0);
+
+	layers.FillLayer(0, 100);
+	layers.FillLayer(1, 51);
+	EXPECT_EQ(layers.GetMinCost(0), 100);
+	layers.SetCost(7, 0, 20);
+	EXPECT_EQ(layers.GetMinCost(0), 20);
+	layers.SetCost(7, 0, 200);
+	EXPECT_EQ(layers.GetMinCost(0), 100);
+	EXPECT_EQ(layers.GetCost(7, 0), 200);
+	EXPECT_EQ(layers.GetCost(7, 1), 51);
+
+	// No weight, or a negative one, leaves the uniform cost
+	const float noWeights[2] = { 0.0f, -3.0f };
+	const NavCostProfile uniform(layers, noWeights, 2);
+	EXPECT_EQ(uniform.GetCellCost(7), 1.0f);
+	EXPECT_EQ(uniform.GetMinCellCost(), 1.0f);
+
+	// Weights past the last layer are ignored
+	const float weights[3] = { 0.0f, 5.0f, 100.0f };
+	const NavCostProfile profile(layers, weights, 3);
+	EXPECT_NEAR(profile.GetCellCost(7), 2.0f, 1.e-5f);
+	EXPECT_NEAR(profile.GetMinCellCost(), 2.0f, 1.e-5f);
+
+	// A wall of costly cells across the grid is gone around when there is a way around
+	NavTestScene scene(FIntVector(20, 20, 1), 0, 0, 0, 0);
+	NavCostLayers wall;
+	wall.Init(scene.Grid.Num(), 1);
+	for (int32 y = 0; y < 16; ++y)
+	{
+		wall.SetCost(scene.Grid.GetIndex(FIntVector(10, y, 0)), 0, 255);
+	}
+	const float wallWeight = 50.0f;
+	const NavCostProfile wallProfile(wall, &wallWeight, 1);
+	NavSearchContext context;
+	std::vector<int32> path;
+	ASSERT_TRUE(NavAStar::FindPathWithCosts(scene.Grid, scene.Grid.GetIndex(FIntVector(2, 2, 0)), scene.Grid.GetIndex(FIntVector(18, 2, 0)),
+		[](int32) { return false; }, [&wallProfile](int32 index) { return wallProfile.GetCellCost(index); }, wallProfile.GetMinCellCost(), context, path));
+	for (const int32 cell : path)
+	{
+		EXPECT_EQ(wall.GetCost(cell, 0), 0);
+	}
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavDStarLite.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavDStarLite, ReplansShortestPathsAsTheAgentMovesAndCellsChange)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		NavTestScene scene(FIntVector(8 + seed % 11, 7 + seed % 8, 6 + seed % 6), seed % 3, seed * 17 + 5);
+		std::mt19937 rng(seed);
+		const int32 start = rng() % scene.Grid.Num();
+		const int32 goal = rng() % scene.Grid.Num();
+		scene.Occupancy.SetBlocked(start, false);
+		scene.Occupancy.SetBlocked(goal, false);
+
+		NavDStarLite planner;
+		planner.Init(scene.Grid, start, goal);
+		std::vector<int32> path;
+		for (int32 step = 0; step < 8; ++step)
+		{
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, planner.GetStart(), goal);
+			const bool found = planner.FindPath(scene.Grid, scene.Occupancy, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", step " << step;
+			if (found == false)
+				break;
+
+			EXPECT_EQ(path.front(), planner.GetStart());
+			EXPECT_EQ(path.back(), goal);
+			EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, path)) << "seed " << seed << ", step " << step;
+			EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed << ", step " << step;
+
+			// Move a few cells along the path, then flip cells around, sometimes on the path ahead
+			const int32 moved = static_cast<int32>(FMath::Min<size_t>(path.size() - 1, 1 + rng() % 3));
+			planner.SetStart(scene.Grid, path[moved]);
+			std::vector<int32> changed;
+			for (int32 i = 0; i < 10; ++i)
+			{
+				const int32 cell = (i < 2 && path.size() > 2) ? path[1 + rng() % (path.size() - 2)] : static_cast<int32>(rng() % scene.Grid.Num());
+				if (cell == planner.GetStart() || cell == goal)
+					continue;
+
+				scene.Occupancy.SetBlocked(cell, scene.Occupancy.IsBlocked(cell) == false);
+				changed.push_back(cell);
+			}
+			planner.UpdateCells(scene.Grid, scene.Occupancy, changed);
+		}
+	}
+}
+
+TEST(NavDStarLite, RepairsLocalChangesWithFewerExpansionsThanPlanningAgain)
+{
+	uint64 repairedNum = 0;
+	uint64 freshNum = 0;
+	for (uint32 seed = 0; seed < 8; ++seed)
+	{
+		NavTestScene scene(FIntVector(40, 40, 20), 0, seed, 40, 8);
+		std::mt19937 rng(seed);
+		const int32 start = scene.Grid.GetIndex(FIntVector(2, 2 + rng() % 36, 2 + rng() % 16));
+		const int32 goal = scene.Grid.GetIndex(FIntVector(37, 2 + rng() % 36, 2 + rng() % 16));
+		scene.Occupancy.SetBlocked(start, false);
+		scene.Occupancy.SetBlocked(goal, false);
+
+		NavDStarLite planner;
+		planner.Init(scene.Grid, start, goal);
+		std::vector<int32> path;
+		if (planner.FindPath(scene.Grid, scene.Occupancy, path) == false || path.size() < 6)
+			continue;
+
+		// Nothing changed, nothing to expand
+		ASSERT_TRUE(planner.FindPath(scene.Grid, scene.Occupancy, path));
+		EXPECT_EQ(planner.GetLastExpandedNum(), 0);
+
+		// Take a step and find the path blocked just ahead, where the agent would notice obstacles
+		planner.SetStart(scene.Grid, path[1]);
+		const std::vector<int32> changed = { path[3] };
+		scene.Occupancy.SetBlocked(path[3], true);
+		planner.UpdateCells(scene.Grid, scene.Occupancy, changed);
+		const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, path[1], goal);
+		const bool found = planner.FindPath(scene.Grid, scene.Occupancy, path);
+		ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed;
+		if (found == false)
+			continue;
+
+		EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, path)) << "seed " << seed;
+		EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed;
+		repairedNum += planner.GetLastExpandedNum();
+
+		NavDStarLite freshPlanner;
+		freshPlanner.Init(scene.Grid, path.front(), goal);
+		std::vector<int32> freshPath;
+		ASSERT_TRUE(freshPlanner.FindPath(scene.Grid, scene.Occupancy, freshPath));
+		freshNum += freshPlanner.GetLastExpandedNum();
+	}
+	EXPECT_GT(freshNum, 0u);
+	EXPECT_LT(repairedNum * 4, freshNum) << "repaired " << repairedNum << ", fresh " << freshNum;
+}
+
+TEST(NavDStarLite, LeavesABlockedStartLikeAStar)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		NavTestScene scene(FIntVector(10, 9, 7), seed % 3, seed * 13 + 3);
+		std::mt19937 rng(seed);
+		const int32 goal = rng() % scene.Grid.Num();
+		scene.Occupancy.SetBlocked(goal, false);
+
+		NavDStarLite planner;
+		int32 start = rng() % scene.Grid.Num();
+		for (int32 step = 0; step < 3; ++step)
+		{
+			if (start == goal)
+				break;
+
+			// The start is blocked, but not the rest of the path
+			scene.Occupancy.SetBlocked(start, true);
+			if (step == 0)
+			{
+				planner.Init(scene.Grid, start, goal);
+			}
+			else
+			{
+				planner.SetStart(scene.Grid, start);
+				planner.UpdateCells(scene.Grid, scene.Occupancy, { start });
+			}
+
+			std::vector<int32> path;
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, goal);
+			const bool found = planner.FindPath(scene.Grid, scene.Occupancy, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", step " << step;
+			if (found == false)
+				break;
+
+			EXPECT_EQ(path.front(), start);
+			EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, std::vector<int32>(path.begin() + 1, path.end()))) << "seed " << seed << ", step " << step;
+			EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed << ", step " << step;
+			start = path[FMath::Min<size_t>(path.size() - 1, 2)];
+		}
+	}
+}
@@ -0,0 +1,191 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavFlowField.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+#include <thread>
+
+namespace
+{
+	// Gets the distance from every cell to the closest goal with a plain multi-source Dijkstra search, FLT_MAX when there is none
+	std::vector<float> GetReferenceDistances(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& goals)
+	{
+		using Entry = std::pair<float, int32>;
+		std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+		std::vector<float> distances(grid.Num(), FLT_MAX);
+		for (const int32 goal : goals)
+		{
+			if (occupancy.IsBlocked(goal) == false)
+			{
+				distances[goal] = 0.0f;
+				open.push(Entry(0.0f, goal));
+			}
+		}
+
+		while (open.empty() == false)
+		{
+			const Entry current = open.top();
+			open.pop();
+			if (current.first > distances[current.second])
+				continue;
+
+			grid.ForEachNeighbor(grid.GetCoordinates(current.second), [&](int32 neighbor, int32)
+			{
+				const float distance = current.first + GetCellDistance(grid, current.second, neighbor);
+				if (occupancy.IsBlocked(neighbor) == false && distance < distances[neighbor])
+				{
+					distances[neighbor] = distance;
+					open.push(Entry(distance, neighbor));
+				}
+			});
+		}
+		return distances;
+	}
+
+	// Checks the distances against the reference, and that following the moves from any cell reaches a goal along a free path
+	void ExpectFieldMatches(const NavGrid& grid, const NavOccupancy& occupancy, const NavFlowField& field, const std::vector<int32>& goals, uint32 seed)
+	{
+		const std::vector<float> reference = GetReferenceDistances(grid, occupancy, goals);
+		for (int32 index = 0; index < grid.Num(); ++index)
+		{
+			const float distance = field.GetDistance(index);
+			if (reference[index] == FLT_MAX)
+			{
+				ASSERT_EQ(distance, FLT_MAX) << "seed " << seed << ", cell " << index;
+				ASSERT_EQ(field.GetNextCell(grid, index), INDEX_NONE) << "seed " << seed << ", cell " << index;
+				continue;
+			}
+			ASSERT_NEAR(distance, reference[index], 1.e-3f) << "seed " << seed << ", cell " << index;
+
+			// Each move goes down by its own length, so the moves lead to a goal along a shortest path
+			const int32 next = field.GetNextCell(grid, index);
+			if (distance == 0.0f)
+			{
+				ASSERT_EQ(next, INDEX_NONE) << "seed " << seed << ", cell " << index;
+				continue;
+			}
+			ASSERT_NE(next, INDEX_NONE) << "seed " << seed << ", cell " << index;
+			const std::vector<int32> move = { index, next };
+			ASSERT_TRUE(IsPathValid(grid, occupancy, move)) << "seed " << seed << ", cell " << index;
+			ASSERT_NEAR(distance, field.GetDistance(next) + GetCellDistance(grid, index, next), 1.e-3f) << "seed " << seed << ", cell " << index;
+		}
+	}
+
+	std::vector<int32> GetRandomGoals(const NavGrid& grid, std::mt19937& rng, int32 count)
+	{
+		std::vector<int32> goals;
+		for (int32 i = 0; i < count; ++i)
+		{
+			goals.push_back(rng() % grid.Num());
+		}
+		return goals;
+	}
+
+	// Runs the chunks of each wave on a few threads
+	void ThreadedParallelFor(int32 count, const std::function<void(int32)>& body)
+	{
+		std::vector<std::thread> threads;
+		for (int32 thread = 0; thread < 4; ++thread)
+		{
+			threads.emplace_back([&body, count, thread]()
+			{
+				for (int32 index = thread; index < count; index += 4)
+				{
+					body(index);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+}
+
+TEST(NavFlowField, MatchesMultiSourceDijkstra)
+{
+	for (uint32 seed = 0; seed < 24; ++seed)
+	{
+		NavTestScene scene(FIntVector(6 + seed % 11, 5 + seed % 7, 6 + seed % 5), seed % 3, seed * 7 + 3);
+		std::mt19937 rng(seed);
+		const std::vector<int32> goals = GetRandomGoals(scene.Grid, rng, 1 + seed % 4);
+
+		NavFlowField field;
+		field.Build(scene.Grid, scene.Occupancy, goals);
+		ExpectFieldMatches(scene.Grid, scene.Occupancy, field, goals, seed);
+	}
+}
+
+TEST(NavFlowField, IncrementalUpdatesMatchRebuilding)
+{
+	for (uint32 seed = 0; seed < 24; ++seed)
+	{
+		NavTestScene scene(FIntVector(8 + seed % 9, 7 + seed % 6, 6 + seed % 5), seed % 3, seed * 13 + 1);
+		std::mt19937 rng(seed);
+		std::vector<int32> goals = GetRandomGoals(scene.Grid, rng, 1 + seed % 3);
+
+		NavFlowField field;
+		field.Build(scene.Grid, scene.Occupancy, goals);
+		for (int32 step = 0; step < 6; ++step)
+		{
+			if (step % 2 == 0)
+			{
+				// Flip a few cells, including cells on the way to the goals and the goals themselves
+				std::vector<int32> changed;
+				for (int32 i = 0; i < 12; ++i)
+				{
+					const int32 cell = (i == 0) ? goals[rng() % goals.size()] : static_cast<int32>(rng() % scene.Grid.Num());
+					scene.Occupancy.SetBlocked(cell, scene.Occupancy.IsBlocked(cell) == false);
+					changed.push_back(cell);
+				}
+				field.UpdateOccupancy(scene.Grid, scene.Occupancy, changed);
+			}
+			else
+			{
+				// Keep some goals, drop others and add new ones
+				goals.erase(goals.begin() + (rng() % goals.size()));
+				const std::vector<int32> added = GetRandomGoals(scene.Grid, rng, 1 + rng() % 2);
+				goals.insert(goals.end(), added.begin(), added.end());
+				field.SetGoals(scene.Grid, scene.Occupancy, goals);
+			}
+			ExpectFieldMatches(scene.Grid, scene.Occupancy, field, goals, seed);
+		}
+	}
+}
+
+TEST(NavFlowField, ParallelWavesMatchSequential)
+{
+	NavTestScene scene(FIntVector(48, 40, 32), 0, 5, 30);
+	std::mt19937 rng(5);
+	const std::vector<int32> goals = GetRandomGoals(scene.Grid, rng, 3);
+
+	NavFlowField sequential;
+	sequential.Build(scene.Grid, scene.Occupancy, goals);
+	NavFlowField parallel;
+	parallel.Build(scene.Grid, scene.Occupancy, goals, ThreadedParallelFor);
+	for (int32 index = 0; index < scene.Grid.Num(); ++index)
+	{
+		ASSERT_EQ(sequential.GetDistance(index), parallel.GetDistance(index)) << "cell " << index;
+		ASSERT_EQ(sequential.GetMove(index), parallel.GetMove(index)) << "cell " << index;
+	}
+
+	// Blocking a wall across the grid reroutes most cells, in many waves
+	std::vector<int32> changed;
+	for (int32 z = 0; z < 32; ++z)
+		for (int32 y = 0; y < 39; ++y)
+		{
+			const int32 cell = scene.Grid.GetIndex(FIntVector(24, y, z));
+			if (scene.Occupancy.IsBlocked(cell) == false)
+			{
+				scene.Occupancy.SetBlocked(cell, true);
+				changed.push_back(cell);
+			}
+		}
+	sequential.UpdateOccupancy(scene.Grid, scene.Occupancy, changed);
+	parallel.UpdateOccupancy(scene.Grid, scene.Occupancy, changed, ThreadedParallelFor);
+	ExpectFieldMatches(scene.Grid, scene.Occupancy, parallel, goals, 0);
+	for (int32 index = 0; index < scene.Grid.Num(); ++index)
+	{
+		ASSERT_EQ(sequential.GetDistance(index), parallel.GetDistance(index)) << "cell " << index;
+	}
+}
@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavGrid.h"
+#include <gtest/gtest.h>
+#include <set>
+
+TEST(NavGrid, IndexAndCoordinatesRoundTrip)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(7, 5, 3), 0);
+	ASSERT_EQ(grid.Num(), 105);
+
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		EXPECT_TRUE(grid.AreCoordinatesValid(coordinates));
+		EXPECT_EQ(grid.GetIndex(coordinates), index);
+	}
+
+	EXPECT_FALSE(grid.AreCoordinatesValid(FIntVector(-1, 0, 0)));
+	EXPECT_FALSE(grid.AreCoordinatesValid(FIntVector(0, 5, 0)));
+}
+
+TEST(NavGrid, NeighborCountFollowsMinSharedAxes)
+{
+	for (int32 axes = 0; axes < 3; ++axes)
+	{
+		NavGrid grid;
+		grid.Init(FIntVector(5, 5, 5), axes);
+		EXPECT_EQ(grid.GetNeighborCount(), NavNeighborCounts[axes]);
+
+		int32 count = 0;
+		grid.ForEachNeighbor(FIntVector(2, 2, 2), [&count](int32, int32) { ++count; });
+		EXPECT_EQ(count, NavNeighborCounts[axes]);
+	}
+}
+
+TEST(NavGrid, BorderNeighborsStayInsideTheGrid)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(4, 3, 2), 0);
+
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		std::set<int32> expected;
+		for (int32 z = -1; z <= 1; ++z)
+			for (int32 y = -1; y <= 1; ++y)
+				for (int32 x = -1; x <= 1; ++x)
+				{
+					const FIntVector neighbor(coordinates.X + x, coordinates.Y + y, coordinates.Z + z);
+					if ((x != 0 || y != 0 || z != 0) && grid.AreCoordinatesValid(neighbor))
+					{
+						expected.insert(grid.GetIndex(neighbor));
+					}
+				}
+
+		std::set<int32> found;
+		grid.ForEachNeighbor(coordinates, [&](int32 neighbor, int32 offset_index)
+		{
+			const NavNeighborOffset& offset = NavNeighborOffsets[offset_index];
+			EXPECT_EQ(neighbor, grid.GetIndex(FIntVector(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z)));
+			found.insert(neighbor);
+		});
+		EXPECT_EQ(found, expected);
+	}
+}
+
+TEST(NavGrid, OffsetIndexLookupMatchesOffsets)
+{
+	for (int32 i = 0; i < 26; ++i)
+	{
+		const NavNeighborOffset& offset = NavNeighborOffsets[i];
+		EXPECT_EQ(GetNavNeighborOffsetIndex(offset.X, offset.Y, offset.Z), i);
+	}
+	EXPECT_EQ(GetNavNeighborOffsetIndex(0, 0, 0), INDEX_NONE);
+}
@@ -0,0 +1,85 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavGridTransform.h"
+#include "NavGrid.h"
+#include <gtest/gtest.h>
+#include <cmath>
+#include <random>
+
+namespace
+{
+	// A grid rotated about Z and scaled non uniformly, away from the origin
+	NavGridTransform MakeRotatedTransform(const FIntVector& divisions)
+	{
+		const float angle = 0.6f;
+		const FVector axes[3] =
+		{
+			FVector(std::cos(angle), std::sin(angle), 0.0f) * 2.0f,
+			FVector(-std::sin(angle), std::cos(angle), 0.0f) * 0.5f,
+			FVector(0.0f, 0.0f, 1.5f),
+		};
+		NavGridTransform transform;
+		transform.Init(divisions, FVector(120.0f, -40.0f, 15.0f), axes, 10.0f);
+		return transform;
+	}
+}
+
+TEST(NavGridTransform, CellCentersMapBackToTheirCells)
+{
+	const FIntVector divisions(9, 7, 5);
+	const NavGridTransform transform = MakeRotatedTransform(divisions);
+	ASSERT_TRUE(transform.IsValid());
+
+	NavGrid grid;
+	grid.Init(divisions, 0);
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		const FVector center = transform.GetCellCenter(coordinates);
+		const FVector cellSpaceCenter = transform.GetCellSpaceLocation(center);
+		EXPECT_NEAR(cellSpaceCenter.X, coordinates.X + 0.5f, 1.e-3f);
+		EXPECT_NEAR(cellSpaceCenter.Y, coordinates.Y + 0.5f, 1.e-3f);
+		EXPECT_NEAR(cellSpaceCenter.Z, coordinates.Z + 0.5f, 1.e-3f);
+		EXPECT_EQ(transform.GetCellIndex(center), index);
+		EXPECT_EQ(transform.GetClampedCoordinates(center), coordinates);
+	}
+}
+
+TEST(NavGridTransform, BatchesMatchSingleLocations)
+{
+	const FIntVector divisions(9, 7, 5);
+	const NavGridTransform transform = MakeRotatedTransform(divisions);
+	NavGrid grid;
+	grid.Init(divisions, 0);
+
+	// Around the cells of the grid and of two layers of cells beyond it, some crossing into the next cell, with an odd count so
+	// the last locations don't fill a batch
+	std::mt19937 rng(3);
+	std::uniform_real_distribution<float> jitter(-3.0f, 3.0f);
+	std::vector<FVector> locations;
+	for (int32 i = 0; i < 1001; ++i)
+	{
+		const FIntVector coordinates(static_cast<int32>(rng() % (divisions.X + 4)) - 2, static_cast<int32>(rng() % (divisions.Y + 4)) - 2, static_cast<int32>(rng() % (divisions.Z + 4)) - 2);
+		locations.push_back(transform.GetCellCenter(coordinates) + FVector(jitter(rng), jitter(rng), jitter(rng)));
+	}
+
+	std::vector<int32> cells(locations.size());
+	std::vector<int32> clampedCells(locations.size());
+	transform.GetCellIndices(locations.data(), static_cast<int32>(locations.size()), false, cells.data());
+	transform.GetCellIndices(locations.data(), static_cast<int32>(locations.size()), true, clampedCells.data());
+	int32 insideNum = 0;
+	for (size_t i = 0; i < locations.size(); ++i)
+	{
+		EXPECT_EQ(cells[i], transform.GetCellIndex(locations[i])) << "location " << i;
+		EXPECT_EQ(clampedCells[i], grid.GetIndex(transform.GetClampedCoordinates(locations[i]))) << "location " << i;
+		if (cells[i] != INDEX_NONE)
+		{
+			EXPECT_EQ(clampedCells[i], cells[i]);
+			++insideNum;
+		}
+	}
+
+	// Both sides of the border are covered
+	EXPECT_GT(insideNum, 100);
+	EXPECT_LT(insideNum, 900);
+}
@@ -0,0 +1,37 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavJumpPointSearch.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavJumpPointSearch, MatchesDijkstraOnRandomGrids)
+{
+	for (uint32 seed = 0; seed < 45; ++seed)
+	{
+		const int32 axes = seed % 3;
+		NavTestScene scene(FIntVector(5 + seed % 13, 4 + seed % 9, 6 + seed % 7), axes, seed * 7 + 1);
+		NavSearchContext context;
+		std::vector<int32> path;
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end))
+				continue;
+
+			const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+			const bool found = NavJumpPointSearch::FindPath(scene.Grid, scene.Occupancy, start, end, context, path);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed;
+			if (found)
+			{
+				EXPECT_EQ(path.front(), start);
+				EXPECT_EQ(path.back(), end);
+				EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, path));
+				EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed;
+			}
+		}
+	}
+}
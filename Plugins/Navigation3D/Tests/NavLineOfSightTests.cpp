@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavAStar.h"
+#include "NavLineOfSight.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Checks if the segment between two cell centers touches a cell, with a slab test against its slightly grown box
+	bool DoesSegmentTouchCell(const FIntVector& from, const FIntVector& to, const FIntVector& cell)
+	{
+		const float margin = 1.e-4f;
+		float enter = 0.0f;
+		float exit = 1.0f;
+		for (int32 axis = 0; axis < 3; ++axis)
+		{
+			const float origin = from[axis] + 0.5f;
+			const float delta = static_cast<float>(to[axis] - from[axis]);
+			const float min = cell[axis] - margin;
+			const float max = cell[axis] + 1.0f + margin;
+			if (delta == 0.0f)
+			{
+				if (origin < min || origin > max)
+					return false;
+				continue;
+			}
+
+			float t0 = (min - origin) / delta;
+			float t1 = (max - origin) / delta;
+			if (t0 > t1)
+			{
+				std::swap(t0, t1);
+			}
+			enter = FMath::Max(enter, t0);
+			exit = FMath::Min(exit, t1);
+		}
+		return enter <= exit;
+	}
+
+	// Checks that every segment of a smoothed path has line of sight, or is a straight run of free grid moves
+	bool IsSmoothedPathValid(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& path)
+	{
+		for (size_t i = 1; i < path.size(); ++i)
+		{
+			if (NavLineOfSight::HasLineOfSight(grid, occupancy, path[i - 1], path[i]))
+				continue;
+
+			const FIntVector from = grid.GetCoordinates(path[i - 1]);
+			const FIntVector delta = grid.GetCoordinates(path[i]) - from;
+			const int32 length = FMath::Max3(FMath::Abs(delta.X), FMath::Abs(delta.Y), FMath::Abs(delta.Z));
+			const FIntVector step(delta.X / length, delta.Y / length, delta.Z / length);
+			if (step * length != delta)
+				return false;
+
+			std::vector<int32> run;
+			for (int32 j = 0; j <= length; ++j)
+			{
+				run.push_back(grid.GetIndex(from + step * j));
+			}
+			if (IsPathValid(grid, occupancy, run) == false)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(NavLineOfSight, MatchesCellsTouchedBySegment)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		NavTestScene scene(FIntVector(6 + seed % 11, 5 + seed % 7, 4 + seed % 9), 0, seed * 13 + 5, 4, 6);
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 200; ++query)
+		{
+			const int32 from = rng() % scene.Grid.Num();
+			const int32 to = rng() % scene.Grid.Num();
+			const FIntVector fromCoordinates = scene.Grid.GetCoordinates(from);
+			const FIntVector toCoordinates = scene.Grid.GetCoordinates(to);
+
+			bool expected = true;
+			for (int32 index = 0; index < scene.Grid.Num() && expected; ++index)
+			{
+				if (index != from && scene.Occupancy.IsBlocked(index) && DoesSegmentTouchCell(fromCoordinates, toCoordinates, scene.Grid.GetCoordinates(index)))
+				{
+					expected = false;
+				}
+			}
+
+			ASSERT_EQ(NavLineOfSight::HasLineOfSight(scene.Grid, scene.Occupancy, from, to), expected) << "seed " << seed << ", query " << query;
+			if (scene.Occupancy.IsBlocked(from) == false && scene.Occupancy.IsBlocked(to) == false)
+			{
+				EXPECT_EQ(NavLineOfSight::HasLineOfSight(scene.Grid, scene.Occupancy, to, from), expected);
+			}
+		}
+	}
+}
+
+TEST(NavLineOfSight, DiagonalsThroughCornersAreConservative)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(3, 3, 3), 0);
+	NavOccupancy occupancy;
+	occupancy.Init(grid.Num());
+
+	const int32 from = grid.GetIndex(FIntVector(0, 0, 0));
+	const int32 to = grid.GetIndex(FIntVector(2, 2, 2));
+	EXPECT_TRUE(NavLineOfSight::HasLineOfSight(grid, occupancy, from, to));
+
+	// The segment only touches the corner of this cell
+	occupancy.SetBlocked(grid.GetIndex(FIntVector(0, 1, 1)), true);
+	EXPECT_FALSE(NavLineOfSight::HasLineOfSight(grid, occupancy, from, to));
+	EXPECT_TRUE(NavLineOfSight::HasLineOfSight(grid, occupancy, from, grid.GetIndex(FIntVector(2, 1, 0))));
+}
+
+TEST(NavLineOfSight, SmoothedPathsAreValidAndShorter)
+{
+	for (uint32 seed = 0; seed < 30; ++seed)
+	{
+		const int32 axes = seed % 3;
+		NavTestScene scene(FIntVector(8 + seed % 13, 6 + seed % 9, 7 + seed % 7), axes, seed * 7 + 3);
+		auto isBlocked = [&scene](int32 index) { return scene.Occupancy.IsBlocked(index); };
+		NavSearchContext context;
+		std::vector<int32> path;
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end) ||
+				NavAStar::FindPath(scene.Grid, start, end, isBlocked, context, path) == false)
+				continue;
+
+			const float cost = GetPathCost(scene.Grid, path);
+			const size_t count = path.size();
+			NavLineOfSight::SmoothPath(scene.Grid, scene.Occupancy, path);
+
+			EXPECT_EQ(path.front(), start);
+			EXPECT_EQ(path.back(), end);
+			EXPECT_LE(path.size(), count);
+			EXPECT_LE(GetPathCost(scene.Grid, path), cost + 1.e-3f) << "seed " << seed;
+			EXPECT_TRUE(IsSmoothedPathValid(scene.Grid, scene.Occupancy, path)) << "seed " << seed;
+		}
+	}
+
+	// Across an empty grid only the start and the end are left
+	NavTestScene empty(FIntVector(16, 16, 16), 0, 1, 0, 0);
+	auto isBlocked = [&empty](int32 index) { return empty.Occupancy.IsBlocked(index); };
+	NavSearchContext context;
+	std::vector<int32> path;
+	ASSERT_TRUE(NavAStar::FindPath(empty.Grid, empty.Grid.GetIndex(FIntVector(0, 1, 2)), empty.Grid.GetIndex(FIntVector(15, 9, 4)), isBlocked, context, path));
+	NavLineOfSight::SmoothPath(empty.Grid, empty.Occupancy, path);
+	EXPECT_EQ(path.size(), 2u);
+}
@@ -0,0 +1,150 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include <gtest/gtest.h>
+#include <random>
+
+namespace
+{
+	bool HasBlockedNeighbor(const NavGrid& grid, const NavOccupancy& occupancy, int32 index)
+	{
+		const FIntVector coordinates = grid.GetCoordinates(index);
+		for (int32 i = 0; i < 26; ++i)
+		{
+			const NavNeighborOffset& offset = NavNeighborOffsets[i];
+			const FIntVector neighbor(coordinates.X + offset.X, coordinates.Y + offset.Y, coordinates.Z + offset.Z);
+			if (grid.AreCoordinatesValid(neighbor) && occupancy.IsBlocked(grid.GetIndex(neighbor)))
+				return true;
+		}
+		return false;
+	}
+}
+
+TEST(NavOccupancy, SetAndClearBits)
+{
+	NavOccupancy occupancy;
+	EXPECT_FALSE(occupancy.IsValid());
+
+	occupancy.Init(100);
+	ASSERT_TRUE(occupancy.IsValid());
+	EXPECT_EQ(occupancy.Num(), 100);
+
+	occupancy.SetBlocked(0, true);
+	occupancy.SetBlocked(31, true);
+	occupancy.SetBlocked(32, true);
+	occupancy.SetBlocked(99, true);
+	occupancy.SetBlocked(32, false);
+	for (int32 index = 0; index < 100; ++index)
+	{
+		EXPECT_EQ(occupancy.IsBlocked(index), index == 0 || index == 31 || index == 99);
+	}
+
+	occupancy.Reset();
+	EXPECT_FALSE(occupancy.IsValid());
+}
+
+TEST(NavOccupancy, NearBlockedMatchesNeighbors)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(9, 7, 6), 0);
+	NavOccupancy occupancy;
+	occupancy.Init(grid.Num());
+
+	std::mt19937 rng(3);
+	for (int32 i = 0; i < 25; ++i)
+	{
+		occupancy.SetBlocked(rng() % grid.Num(), true);
+	}
+	occupancy.BuildNearBlocked(grid);
+
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		EXPECT_EQ(occupancy.IsNearBlocked(index), HasBlockedNeighbor(grid, occupancy, index));
+	}
+
+	// Incremental updates agree with a full rebuild
+	for (int32 i = 0; i < 40; ++i)
+	{
+		const int32 index = rng() % grid.Num();
+		occupancy.SetBlocked(index, occupancy.IsBlocked(index) == false);
+		occupancy.UpdateNearBlocked(grid, index);
+	}
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		EXPECT_EQ(occupancy.IsNearBlocked(index), HasBlockedNeighbor(grid, occupancy, index));
+	}
+}
+
+TEST(NavOccupancy, ChangedCellsMatchFlippedBits)
+{
+	NavOccupancy previous;
+	previous.Init(1000);
+	std::mt19937 rng(7);
+	for (int32 i = 0; i < 100; ++i)
+	{
+		previous.SetBlocked(rng() % 1000, true);
+	}
+
+	NavOccupancy current = previous;
+	std::vector<int32> flipped;
+	for (int32 i = 0; i < 30; ++i)
+	{
+		const int32 index = rng() % 1000;
+		current.SetBlocked(index, current.IsBlocked(index) == false);
+	}
+	for (int32 index = 0; index < 1000; ++index)
+	{
+		if (current.IsBlocked(index) != previous.IsBlocked(index))
+		{
+			flipped.push_back(index);
+		}
+	}
+
+	std::vector<int32> changed;
+	current.GetChangedCells(previous, changed);
+	EXPECT_EQ(changed, flipped);
+}
+
+TEST(NavOccupancy, NearestFreeCellMatchesBruteForce)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(12, 9, 7), 0);
+	NavOccupancy occupancy;
+	occupancy.Init(grid.Num());
+	std::mt19937 rng(11);
+
+	// Dense enough that most blocked cells are a few cells away from a free one
+	for (int32 i = 0; i < grid.Num() * 3 / 4; ++i)
+	{
+		occupancy.SetBlocked(rng() % grid.Num(), true);
+	}
+
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		const int32 maxDistance = 1 + index % 4;
+		const FIntVector center = grid.GetCoordinates(index);
+		int32 bestDistanceSq = occupancy.IsBlocked(index) ? INT32_MAX : 0;
+		for (int32 cell = 0; cell < grid.Num() && bestDistanceSq > 0; ++cell)
+		{
+			const FIntVector delta = grid.GetCoordinates(cell) - center;
+			const int32 distanceSq = (delta.X * delta.X) + (delta.Y * delta.Y) + (delta.Z * delta.Z);
+			if (occupancy.IsBlocked(cell) == false && distanceSq <= maxDistance * maxDistance)
+			{
+				bestDistanceSq = FMath::Min(bestDistanceSq, distanceSq);
+			}
+		}
+
+		const int32 nearest = occupancy.FindNearestFreeCell(grid, index, maxDistance);
+		if (bestDistanceSq == INT32_MAX)
+		{
+			EXPECT_EQ(nearest, INDEX_NONE) << "cell " << index;
+			continue;
+		}
+
+		ASSERT_NE(nearest, INDEX_NONE) << "cell " << index;
+		EXPECT_FALSE(occupancy.IsBlocked(nearest));
+		const FIntVector delta = grid.GetCoordinates(nearest) - center;
+		EXPECT_EQ((delta.X * delta.X) + (delta.Y * delta.Y) + (delta.Z * delta.Z), bestDistanceSq) << "cell " << index;
+	}
+}
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavGrid.h"
+#include "NavPathCache.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Gets the flat index of every cell of a straight run, including both ends
+	std::vector<int32> MakeRun(const NavGrid& grid, const FIntVector& from, const FIntVector& step, int32 length)
+	{
+		std::vector<int32> path;
+		for (int32 i = 0; i <= length; ++i)
+		{
+			path.push_back(grid.GetIndex(from + step * i));
+		}
+		return path;
+	}
+}
+
+TEST(NavPathCache, EvictsLeastRecentlyUsed)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(16, 16, 16), 0);
+	NavPathCache cache;
+	cache.SetCapacity(2);
+
+	const std::vector<int32> a = MakeRun(grid, FIntVector(0, 0, 0), FIntVector(1, 0, 0), 5);
+	const std::vector<int32> b = MakeRun(grid, FIntVector(0, 2, 0), FIntVector(1, 0, 0), 5);
+	const std::vector<int32> c = MakeRun(grid, FIntVector(0, 4, 0), FIntVector(1, 0, 0), 5);
+	std::vector<int32> path;
+
+	EXPECT_EQ(cache.Find(grid, a.front(), a.back(), 0, false, path), ENavPathCacheResult::Miss);
+	cache.Add(grid, a.front(), a.back(), 0, a, cache.GetVersion());
+	cache.Add(grid, b.front(), b.back(), 0, b, cache.GetVersion());
+
+	// Using a makes b the least recently used
+	ASSERT_EQ(cache.Find(grid, a.front(), a.back(), 0, false, path), ENavPathCacheResult::Hit);
+	EXPECT_EQ(path, a);
+	cache.Add(grid, c.front(), c.back(), 0, c, cache.GetVersion());
+
+	EXPECT_EQ(cache.Num(), 2);
+	EXPECT_EQ(cache.Find(grid, b.front(), b.back(), 0, false, path), ENavPathCacheResult::Miss);
+	EXPECT_EQ(cache.Find(grid, c.front(), c.back(), 0, false, path), ENavPathCacheResult::Hit);
+	EXPECT_EQ(cache.Find(grid, a.front(), a.back(), 1, false, path), ENavPathCacheResult::Miss);
+	EXPECT_EQ(cache.GetHitNum(), 2u);
+	EXPECT_EQ(cache.GetMissNum(), 3u);
+	EXPECT_EQ(cache.GetEvictedNum(), 1u);
+}
+
+TEST(NavPathCache, InvalidatesPathsThroughChangedCells)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(16, 16, 16), 0);
+	NavPathCache cache;
+	cache.SetCapacity(8);
+
+	// A smoothed path, whose second segment crosses cells that aren't waypoints
+	const std::vector<int32> smoothed = { grid.GetIndex(FIntVector(0, 0, 0)), grid.GetIndex(FIntVector(4, 0, 0)), grid.GetIndex(FIntVector(12, 4, 0)) };
+	const std::vector<int32> other = MakeRun(grid, FIntVector(0, 10, 10), FIntVector(1, 0, 0), 8);
+	cache.Add(grid, smoothed.front(), smoothed.back(), 0, smoothed, cache.GetVersion());
+	cache.Add(grid, other.front(), other.back(), 0, other, cache.GetVersion());
+
+	// A search that read the occupancy before an invalidation doesn't get cached
+	const uint32 staleVersion = cache.GetVersion();
+	cache.Invalidate({ grid.GetIndex(FIntVector(15, 15, 15)) });
+	cache.Add(grid, grid.GetIndex(FIntVector(1, 1, 1)), grid.GetIndex(FIntVector(2, 2, 2)), 0, { grid.GetIndex(FIntVector(1, 1, 1)), grid.GetIndex(FIntVector(2, 2, 2)) }, staleVersion);
+	EXPECT_EQ(cache.Num(), 2);
+
+	cache.Invalidate({ grid.GetIndex(FIntVector(8, 2, 0)) });
+	std::vector<int32> path;
+	EXPECT_EQ(cache.Find(grid, smoothed.front(), smoothed.back(), 0, false, path), ENavPathCacheResult::Miss);
+	EXPECT_EQ(cache.Find(grid, other.front(), other.back(), 0, false, path), ENavPathCacheResult::Hit);
+	EXPECT_EQ(cache.GetInvalidatedNum(), 1u);
+
+	cache.Clear();
+	EXPECT_EQ(cache.Num(), 0);
+}
+
+TEST(NavPathCache, ReusesTailsFromNeighbors)
+{
+	for (int32 axes = 0; axes < 3; ++axes)
+	{
+		NavGrid grid;
+		grid.Init(FIntVector(16, 16, 16), axes);
+		NavPathCache cache;
+		cache.SetCapacity(8);
+
+		const std::vector<int32> cached = MakeRun(grid, FIntVector(0, 5, 5), FIntVector(1, 0, 0), 12);
+		cache.Add(grid, cached.front(), cached.back(), 0, cached, cache.GetVersion());
+
+		// The furthest waypoint the start is next to is used: one step further along the path when edges or corners count
+		std::vector<int32> path;
+		const int32 faceStart = grid.GetIndex(FIntVector(3, 5, 6));
+		ASSERT_EQ(cache.Find(grid, faceStart, cached.back(), 0, true, path), ENavPathCacheResult::TailHit);
+		std::vector<int32> expected = { faceStart };
+		expected.insert(expected.end(), cached.begin() + (axes < 2 ? 4 : 3), cached.end());
+		EXPECT_EQ(path, expected);
+
+		const int32 diagonalStart = grid.GetIndex(FIntVector(3, 6, 6));
+		const ENavPathCacheResult diagonalResult = cache.Find(grid, diagonalStart, cached.back(), 0, true, path);
+		ASSERT_EQ(diagonalResult, axes < 2 ? ENavPathCacheResult::TailHit : ENavPathCacheResult::Miss);
+		if (axes < 2)
+		{
+			EXPECT_EQ(path[1], cached[axes == 0 ? 4 : 3]);
+		}
+
+		// Starting on the path reuses it from there, and only with tail reuse enabled
+		EXPECT_EQ(cache.Find(grid, cached[6], cached.back(), 0, false, path), ENavPathCacheResult::Miss);
+		ASSERT_EQ(cache.Find(grid, cached[6], cached.back(), 0, true, path), ENavPathCacheResult::TailHit);
+		EXPECT_EQ(path, std::vector<int32>(cached.begin() + 6, cached.end()));
+		EXPECT_EQ(cache.Find(grid, faceStart, grid.GetIndex(FIntVector(3, 5, 5)), 0, true, path), ENavPathCacheResult::Miss);
+	}
+}
@@ -0,0 +1,152 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavPortalGraph.h"
+#include "NavAStar.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// A scene cut along X into volumes of the same size, each with its own grid and occupancy, linked by portals between
+	// every pair of free cells facing each other across a cut. Moving only through faces (the default), a route across the
+	// volumes can take every move a path in the whole scene can.
+	struct NavSplitScene
+	{
+		NavTestScene Scene;
+		int32 VolumeSizeX;
+		std::vector<NavTestScene> Volumes;
+		NavPortalGraph Portals;
+
+		NavSplitScene(const FIntVector& volume_divisions, int32 volume_count, uint32 seed, int32 box_count = 6, int32 scatter_divisor = 10, int32 min_shared_neighbor_axes = 2)
+			: Scene(FIntVector(volume_divisions.X * volume_count, volume_divisions.Y, volume_divisions.Z), min_shared_neighbor_axes, seed, box_count, scatter_divisor)
+			, VolumeSizeX(volume_divisions.X)
+		{
+			for (int32 volume = 0; volume < volume_count; ++volume)
+			{
+				Volumes.emplace_back(volume_divisions, min_shared_neighbor_axes, 0, 0, 0);
+				for (int32 cell = 0; cell < Volumes[volume].Grid.Num(); ++cell)
+				{
+					Volumes[volume].Occupancy.SetBlocked(cell, Scene.Occupancy.IsBlocked(GetSceneCell(volume, cell)));
+				}
+			}
+
+			for (int32 volume = 0; volume + 1 < volume_count; ++volume)
+			{
+				for (int32 z = 0; z < volume_divisions.Z; ++z)
+				{
+					for (int32 y = 0; y < volume_divisions.Y; ++y)
+					{
+						const int32 cellA = Volumes[volume].Grid.GetIndex(FIntVector(volume_divisions.X - 1, y, z));
+						const int32 cellB = Volumes[volume + 1].Grid.GetIndex(FIntVector(0, y, z));
+						if (Volumes[volume].Occupancy.IsBlocked(cellA) == false && Volumes[volume + 1].Occupancy.IsBlocked(cellB) == false)
+						{
+							Portals.AddPortal(volume, cellA, GetLocation(volume, cellA), volume + 1, cellB, GetLocation(volume + 1, cellB));
+						}
+					}
+				}
+			}
+		}
+
+		int32 GetSceneCell(int32 volume, int32 cell) const
+		{
+			const FIntVector coordinates = Volumes[volume].Grid.GetCoordinates(cell);
+			return Scene.Grid.GetIndex(FIntVector(coordinates.X + (volume * VolumeSizeX), coordinates.Y, coordinates.Z));
+		}
+
+		FVector GetLocation(int32 volume, int32 cell) const
+		{
+			return FVector(Scene.Grid.GetCoordinates(GetSceneCell(volume, cell)));
+		}
+
+		// Searches each segment of a route with A* and joins them into a path of cells of the whole scene
+		bool StitchRoute(const std::vector<NavRouteSegment>& route, std::vector<int32>& out_path)
+		{
+			NavSearchContext context;
+			std::vector<int32> segment;
+			out_path.clear();
+			for (const NavRouteSegment& step : route)
+			{
+				const NavOccupancy& occupancy = Volumes[step.Volume].Occupancy;
+				if (NavAStar::FindPath(Volumes[step.Volume].Grid, step.FromCell, step.ToCell, [&](int32 index) { return occupancy.IsBlocked(index); }, context, segment) == false)
+					return false;
+
+				for (const int32 cell : segment)
+				{
+					out_path.push_back(GetSceneCell(step.Volume, cell));
+				}
+			}
+			return true;
+		}
+	};
+
+	NavPortalGraph::SegmentFuncType MakeSegmentSearch(NavSplitScene& split, NavSearchContext& context)
+	{
+		return [&split, &context](int32 volume, int32 from_cell, int32 to_cell)
+		{
+			const NavTestScene& scene = split.Volumes[volume];
+			std::vector<int32> path;
+			if (scene.Occupancy.IsBlocked(from_cell) || NavAStar::FindPath(scene.Grid, from_cell, to_cell, [&](int32 index) { return scene.Occupancy.IsBlocked(index); }, context, path) == false)
+				return -1.0f;
+
+			return GetPathCost(scene.Grid, path);
+		};
+	}
+}
+
+TEST(NavPortalGraph, RoutesShortestPathsAcrossVolumes)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		NavSplitScene split(FIntVector(4 + seed % 3, 4 + seed % 4, 3 + seed % 3), 2 + seed % 3, seed * 13 + 7);
+		NavSearchContext context;
+		const NavPortalGraph::SegmentFuncType findSegment = MakeSegmentSearch(split, context);
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 8; ++query)
+		{
+			const int32 startVolume = rng() % split.Volumes.size();
+			const int32 goalVolume = rng() % split.Volumes.size();
+			const int32 startCell = rng() % split.Volumes[startVolume].Grid.Num();
+			const int32 goalCell = rng() % split.Volumes[goalVolume].Grid.Num();
+			if (split.Volumes[startVolume].Occupancy.IsBlocked(startCell) || split.Volumes[goalVolume].Occupancy.IsBlocked(goalCell))
+				continue;
+
+			const float reference = GetReferenceCost(split.Scene.Grid, split.Scene.Occupancy, split.GetSceneCell(startVolume, startCell), split.GetSceneCell(goalVolume, goalCell));
+			std::vector<NavRouteSegment> route;
+			const bool found = split.Portals.FindRoute(startVolume, startCell, split.GetLocation(startVolume, startCell), goalVolume, goalCell, split.GetLocation(goalVolume, goalCell), findSegment, route);
+			ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", query " << query;
+			if (found == false)
+				continue;
+
+			std::vector<int32> path;
+			ASSERT_TRUE(split.StitchRoute(route, path)) << "seed " << seed << ", query " << query;
+			EXPECT_EQ(route.front().Volume, startVolume);
+			EXPECT_EQ(route.back().Volume, goalVolume);
+			EXPECT_TRUE(IsPathValid(split.Scene.Grid, split.Scene.Occupancy, path)) << "seed " << seed << ", query " << query;
+			EXPECT_NEAR(GetPathCost(split.Scene.Grid, path), reference, 1.e-3f) << "seed " << seed << ", query " << query;
+		}
+	}
+}
+
+TEST(NavPortalGraph, SearchesFewSegmentsAndForgetsRemovedVolumes)
+{
+	NavSplitScene split(FIntVector(8, 8, 8), 3, 3, 0, 0, 0);
+	NavSearchContext context;
+	const NavPortalGraph::SegmentFuncType findSegment = MakeSegmentSearch(split, context);
+	EXPECT_EQ(split.Portals.GetPortalNum(), 2 * 64);
+	EXPECT_EQ(split.Portals.GetPortalNum(1), 2 * 64);
+
+	// Through open space, the straight line bounds lead the route through the portals on the way, only those are searched
+	const int32 startCell = split.Volumes[0].Grid.GetIndex(FIntVector(1, 3, 3));
+	const int32 goalCell = split.Volumes[2].Grid.GetIndex(FIntVector(6, 4, 4));
+	std::vector<NavRouteSegment> route;
+	ASSERT_TRUE(split.Portals.FindRoute(0, startCell, split.GetLocation(0, startCell), 2, goalCell, split.GetLocation(2, goalCell), findSegment, route));
+	EXPECT_EQ(route.size(), 3u);
+	EXPECT_LT(split.Portals.GetLastSegmentSearchNum(), 64);
+
+	// Without the middle volume, nothing links the first and the last
+	split.Portals.RemoveVolume(1);
+	EXPECT_EQ(split.Portals.GetPortalNum(), 0);
+	EXPECT_FALSE(split.Portals.FindRoute(0, startCell, split.GetLocation(0, startCell), 2, goalCell, split.GetLocation(2, goalCell), findSegment, route));
+	EXPECT_TRUE(route.empty());
+}
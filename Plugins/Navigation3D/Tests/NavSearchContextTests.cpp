@@ -0,0 +1,83 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavSearchContext.h"
+#include <gtest/gtest.h>
+#include <random>
+
+TEST(NavSearchContext, PopsInScoreOrder)
+{
+	NavSearchContext context;
+	context.Reset(100000);
+
+	std::mt19937 rng(5);
+	for (int32 index = 0; index < 1000; ++index)
+	{
+		const float score = static_cast<float>(rng() % 10000);
+		context.Open(index * 97, INDEX_NONE, score, score);
+	}
+
+	// Lower some of the scores after the nodes were opened
+	for (int32 index = 0; index < 1000; index += 7)
+	{
+		const float score = context.GetGScore(index * 97) * 0.5f;
+		context.Open(index * 97, 1, score, score);
+	}
+
+	float last = -1.0f;
+	int32 count = 0;
+	while (context.IsOpenEmpty() == false)
+	{
+		const int32 index = context.PopOpen();
+		EXPECT_TRUE(context.IsClosed(index));
+		EXPECT_GE(context.GetGScore(index), last);
+		last = context.GetGScore(index);
+		++count;
+	}
+	EXPECT_EQ(count, 1000);
+}
+
+TEST(NavSearchContext, ResetForgetsThePreviousSearch)
+{
+	NavSearchContext context;
+	context.Reset(5000);
+	context.Open(10, INDEX_NONE, 1.0f, 1.0f);
+	context.Open(4999, 10, 2.0f, 2.0f);
+	context.AddDeadEndMove(10, 3);
+	context.PopOpen();
+
+	context.Reset(5000);
+	EXPECT_TRUE(context.IsOpenEmpty());
+	EXPECT_FALSE(context.IsClosed(10));
+	EXPECT_EQ(context.GetGScore(10), FLT_MAX);
+	EXPECT_EQ(context.GetParent(4999), INDEX_NONE);
+	EXPECT_EQ(context.GetDeadEndMoves(10), 0u);
+
+	// Nodes on pages never touched read as unreached
+	EXPECT_EQ(context.GetGScore(3000), FLT_MAX);
+	EXPECT_FALSE(context.IsClosed(3000));
+}
+
+TEST(NavSearchContext, CountsExpansionsAndOpenPeak)
+{
+	NavSearchContext context;
+	context.Reset(100);
+	for (int32 index = 0; index < 10; ++index)
+	{
+		context.Open(index, INDEX_NONE, static_cast<float>(index), static_cast<float>(index));
+	}
+	context.PopOpen();
+	context.PopOpen();
+	EXPECT_EQ(context.GetPeakOpenNum(), 10);
+	EXPECT_EQ(context.GetTotalExpandedNum(), 2u);
+
+	// The expansion count carries over between searches, the peak is only cleared on request
+	context.Reset(100);
+	context.Open(5, INDEX_NONE, 0.0f, 0.0f);
+	context.PopOpen();
+	EXPECT_EQ(context.GetTotalExpandedNum(), 3u);
+	EXPECT_EQ(context.GetPeakOpenNum(), 10);
+
+	context.ResetPeakOpenNum();
+	context.Open(6, INDEX_NONE, 0.0f, 0.0f);
+	EXPECT_EQ(context.GetPeakOpenNum(), 1);
+}
@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavSparseOctree.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	NavSparseOctree::RegionBlockedFuncType MakeRegionTest(const NavTestScene& scene)
+	{
+		return [&scene](const FIntVector& min, int32 size)
+		{
+			for (int32 z = min.Z; z < min.Z + size; ++z)
+				for (int32 y = min.Y; y < min.Y + size; ++y)
+					for (int32 x = min.X; x < min.X + size; ++x)
+						if (scene.Occupancy.IsBlocked(scene.Grid.GetIndex(FIntVector(x, y, z))))
+							return true;
+			return false;
+		};
+	}
+}
+
+TEST(NavSparseOctree, GraphNodesMatchTheOccupancy)
+{
+	NavTestScene scene(FIntVector(21, 13, 17), 0, 2, 5, 40);
+	NavSparseOctree octree;
+	octree.Build(scene.Grid.GetDivisions(), MakeRegionTest(scene));
+	ASSERT_TRUE(octree.IsValid());
+
+	for (int32 index = 0; index < scene.Grid.Num(); ++index)
+	{
+		const FIntVector coordinates = scene.Grid.GetCoordinates(index);
+		const int32 node = octree.FindGraphNode(coordinates);
+		EXPECT_EQ(node == INDEX_NONE, scene.Occupancy.IsBlocked(index));
+		if (node != INDEX_NONE)
+		{
+			FIntVector min;
+			int32 size;
+			octree.GetGraphNodeBounds(node, min, size);
+			EXPECT_TRUE(coordinates.X >= min.X && coordinates.X < min.X + size);
+			EXPECT_TRUE(coordinates.Y >= min.Y && coordinates.Y < min.Y + size);
+			EXPECT_TRUE(coordinates.Z >= min.Z && coordinates.Z < min.Z + size);
+		}
+	}
+}
+
+TEST(NavSparseOctree, ReachabilityMatchesTheGrid)
+{
+	for (uint32 seed = 0; seed < 20; ++seed)
+	{
+		const int32 axes = seed % 3;
+		NavTestScene scene(FIntVector(6 + seed % 19, 5 + seed % 11, 7 + seed % 5), axes, seed + 100, 8, 12);
+		NavSparseOctree octree;
+		octree.Build(scene.Grid.GetDivisions(), MakeRegionTest(scene));
+		NavSearchContext context;
+		std::vector<int32> path;
+
+		std::mt19937 rng(seed);
+		for (int32 query = 0; query < 10; ++query)
+		{
+			const int32 start = rng() % scene.Grid.Num();
+			const int32 end = rng() % scene.Grid.Num();
+			if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end))
+				continue;
+
+			const bool reachable = GetReferenceCost(scene.Grid, scene.Occupancy, start, end) >= 0.0f;
+			EXPECT_EQ(octree.FindPath(scene.Grid.GetCoordinates(start), scene.Grid.GetCoordinates(end), axes, context, path), reachable) << "seed " << seed;
+		}
+	}
+}
+
+TEST(NavSparseOctree, IncrementalBuildMatchesFullBuild)
+{
+	NavTestScene scene(FIntVector(30, 20, 25), 0, 9, 6, 30);
+	NavSparseOctree previous;
+	previous.Build(scene.Grid.GetDivisions(), MakeRegionTest(scene));
+
+	const NavCellBox changed{ FIntVector(3, 4, 5), FIntVector(9, 8, 12) };
+	scene.FillBox(changed.Min, changed.Max, true);
+	scene.FillBox(FIntVector(5, 5, 6), FIntVector(6, 6, 7), false);
+
+	NavSparseOctree incremental;
+	incremental.Build(scene.Grid.GetDivisions(), MakeRegionTest(scene), &previous, std::vector<NavCellBox>(1, changed));
+	NavSparseOctree full;
+	full.Build(scene.Grid.GetDivisions(), MakeRegionTest(scene));
+
+	EXPECT_EQ(incremental.GetGraphNodeCount(), full.GetGraphNodeCount());
+	for (int32 index = 0; index < scene.Grid.Num(); ++index)
+	{
+		const FIntVector coordinates = scene.Grid.GetCoordinates(index);
+		EXPECT_EQ(incremental.FindGraphNode(coordinates), full.FindGraphNode(coordinates));
+	}
+}
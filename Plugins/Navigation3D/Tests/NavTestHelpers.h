@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "NavCoreTypes.h"
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <random>
+#include <vector>
+
+// A grid and an occupancy filled with random boxes and scattered blocked cells
+struct NavTestScene
+{
+	NavGrid Grid;
+	NavOccupancy Occupancy;
+
+	NavTestScene(const FIntVector& divisions, int32 min_shared_neighbor_axes, uint32 seed, int32 box_count = 6, int32 scatter_divisor = 10)
+	{
+		Grid.Init(divisions, min_shared_neighbor_axes);
+		Occupancy.Init(Grid.Num());
+
+		std::mt19937 rng(seed);
+		for (int32 box = 0; box < box_count; ++box)
+		{
+			const FIntVector min(rng() % divisions.X, rng() % divisions.Y, rng() % divisions.Z);
+			const FIntVector size(1 + rng() % 8, 1 + rng() % 8, 1 + rng() % 8);
+			FillBox(min, FIntVector(FMath::Min(divisions.X, min.X + size.X) - 1, FMath::Min(divisions.Y, min.Y + size.Y) - 1, FMath::Min(divisions.Z, min.Z + size.Z) - 1), true);
+		}
+
+		if (scatter_divisor > 0)
+		{
+			for (int32 i = 0; i < Grid.Num() / scatter_divisor; ++i)
+			{
+				Occupancy.SetBlocked(rng() % Grid.Num(), true);
+			}
+		}
+		Occupancy.BuildNearBlocked(Grid);
+	}
+
+	// Blocks or frees every cell of a box, with inclusive max coordinates. The near blocked bits are not updated.
+	void FillBox(const FIntVector& min, const FIntVector& max, bool blocked)
+	{
+		for (int32 z = min.Z; z <= max.Z; ++z)
+			for (int32 y = min.Y; y <= max.Y; ++y)
+				for (int32 x = min.X; x <= max.X; ++x)
+					Occupancy.SetBlocked(Grid.GetIndex(FIntVector(x, y, z)), blocked);
+	}
+};
+
+// Gets the distance between two cells
+inline float GetCellDistance(const NavGrid& grid, int32 a, int32 b)
+{
+	return FVector::Distance(FVector(grid.GetCoordinates(a)), FVector(grid.GetCoordinates(b)));
+}
+
+// Gets the length of a path of cells
+inline float GetPathCost(const NavGrid& grid, const std::vector<int32>& path)
+{
+	float cost = 0.0f;
+	for (size_t i = 1; i < path.size(); ++i)
+	{
+		cost += GetCellDistance(grid, path[i - 1], path[i]);
+	}
+	return cost;
+}
+
+// Checks that every step of a path moves to a free neighbor allowed by the grid
+inline bool IsPathValid(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& path)
+{
+	for (size_t i = 0; i < path.size(); ++i)
+	{
+		if (occupancy.IsBlocked(path[i]))
+			return false;
+
+		if (i == 0)
+			continue;
+
+		bool neighbor = false;
+		grid.ForEachNeighbor(grid.GetCoordinates(path[i - 1]), [&](int32 index, int32)
+		{
+			neighbor |= index == path[i];
+		});
+		if (neighbor == false)
+			return false;
+	}
+	return true;
+}
+
+// Gets the cost of the shortest path between two cells with a plain Dijkstra search, or a negative value when there is none
+inline float GetReferenceCost(const NavGrid& grid, const NavOccupancy& occupancy, int32 start_index, int32 end_index)
+{
+	using Entry = std::pair<float, int32>;
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry> > open;
+	std::vector<float> costs(grid.Num(), FLT_MAX);
+
+	costs[start_index] = 0.0f;
+	open.push(Entry(0.0f, start_index));
+	while (open.empty() == false)
+	{
+		const Entry current = open.top();
+		open.pop();
+		if (current.first > costs[current.second])
+			continue;
+
+		if (current.second == end_index)
+			return current.first;
+
+		grid.ForEachNeighbor(grid.GetCoordinates(current.second), [&](int32 neighbor, int32)
+		{
+			const float cost = current.first + GetCellDistance(grid, current.second, neighbor);
+			if (occupancy.IsBlocked(neighbor) == false && cost < costs[neighbor])
+			{
+				costs[neighbor] = cost;
+				open.push(Entry(cost, neighbor));
+			}
+		});
+	}
+	return -1.0f;
+}
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavLineOfSight.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include "NavThetaStar.h"
+#include <gtest/gtest.h>
+
+namespace
+{
+	// Checks that every segment of an any-angle path is a grid move or has line of sight
+	bool IsAnyAnglePathValid(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<int32>& path)
+	{
+		for (size_t i = 1; i < path.size(); ++i)
+		{
+			const std::vector<int32> move = { path[i - 1], path[i] };
+			if (IsPathValid(grid, occupancy, move) == false && NavLineOfSight::HasLineOfSight(grid, occupancy, path[i - 1], path[i]) == false)
+				return false;
+		}
+		return true;
+	}
+}
+
+TEST(NavThetaStar, FindsAnyAnglePathsNoLongerThanGridPaths)
+{
+	for (const bool lazy : { false, true })
+	{
+		for (uint32 seed = 0; seed < 36; ++seed)
+		{
+			const int32 axes = seed % 3;
+			NavTestScene scene(FIntVector(6 + seed % 13, 5 + seed % 9, 6 + seed % 7), axes, seed * 11 + 2);
+			NavSearchContext context;
+			std::vector<int32> path;
+
+			std::mt19937 rng(seed);
+			for (int32 query = 0; query < 10; ++query)
+			{
+				const int32 start = rng() % scene.Grid.Num();
+				const int32 end = rng() % scene.Grid.Num();
+				if (scene.Occupancy.IsBlocked(start) || scene.Occupancy.IsBlocked(end))
+					continue;
+
+				const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+				const bool found = NavThetaStar::FindPath(scene.Grid, scene.Occupancy, start, end, lazy, context, path);
+				ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed;
+				if (found)
+				{
+					EXPECT_EQ(path.front(), start);
+					EXPECT_EQ(path.back(), end);
+					EXPECT_TRUE(IsAnyAnglePathValid(scene.Grid, scene.Occupancy, path)) << "seed " << seed << (lazy ? ", lazy" : "");
+
+					// A cell that Lazy Theta* relinks keeps the neighbor it finds then, which may not be the best one
+					EXPECT_LE(GetPathCost(scene.Grid, path), reference * (lazy ? 1.25f : 1.0f) + 1.e-3f) << "seed " << seed << (lazy ? ", lazy" : "");
+				}
+			}
+		}
+	}
+}
+
+TEST(NavThetaStar, GoesStraightAcrossOpenSpace)
+{
+	NavTestScene scene(FIntVector(20, 20, 20), 2, 1, 0, 0);
+	NavSearchContext context;
+	std::vector<int32> path;
+
+	const int32 start = scene.Grid.GetIndex(FIntVector(1, 2, 3));
+	const int32 end = scene.Grid.GetIndex(FIntVector(18, 11, 15));
+	ASSERT_TRUE(NavThetaStar::FindPath(scene.Grid, scene.Occupancy, start, end, true, context, path));
+	EXPECT_EQ(path.size(), 2u);
+	EXPECT_NEAR(GetPathCost(scene.Grid, path), GetCellDistance(scene.Grid, start, end), 1.e-3f);
+}
@@ -0,0 +1,219 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavGrid.h"
+#include "NavOccupancy.h"
+#include "NavVoxelizer.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+
+namespace
+{
+	const FVector CellHalfExtent(0.5f);
+
+	float Dot(const FVector& a, const FVector& b)
+	{
+		return (a.X * b.X) + (a.Y * b.Y) + (a.Z * b.Z);
+	}
+
+	FVector GetCellCenter(const NavGrid& grid, int32 index)
+	{
+		return FVector(grid.GetCoordinates(index)) + FVector(0.5f);
+	}
+
+	// Checks that the cell containing each point is blocked
+	void ExpectBlockedAt(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<FVector>& points)
+	{
+		for (const FVector& point : points)
+		{
+			const FIntVector coordinates(FMath::FloorToInt(point.X), FMath::FloorToInt(point.Y), FMath::FloorToInt(point.Z));
+			if (grid.AreCoordinatesValid(coordinates))
+			{
+				EXPECT_TRUE(occupancy.IsBlocked(grid.GetIndex(coordinates))) << "point " << point.X << ", " << point.Y << ", " << point.Z;
+			}
+		}
+	}
+
+	// Checks that every blocked cell is within max_distance of one of the points sampled over a shape
+	void ExpectBlockedNear(const NavGrid& grid, const NavOccupancy& occupancy, const std::vector<FVector>& points, float max_distance)
+	{
+		for (int32 index = 0; index < grid.Num(); ++index)
+		{
+			if (occupancy.IsBlocked(index) == false)
+				continue;
+
+			float distance = FLT_MAX;
+			for (const FVector& point : points)
+			{
+				distance = std::min(distance, FVector::Distance(point, GetCellCenter(grid, index)));
+			}
+			EXPECT_LE(distance, max_distance) << "cell " << index;
+		}
+	}
+
+	// Runs the slabs on a few threads
+	void ThreadedParallelFor(int32 count, const std::function<void(int32)>& body)
+	{
+		std::vector<std::thread> threads;
+		for (int32 thread = 0; thread < 4; ++thread)
+		{
+			threads.emplace_back([&body, count, thread]()
+			{
+				for (int32 index = thread; index < count; index += 4)
+				{
+					body(index);
+				}
+			});
+		}
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+}
+
+TEST(NavVoxelizer, SphereMatchesExactDistance)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(20, 18, 16), 0);
+	NavOccupancy occupancy;
+	occupancy.Init(grid.Num());
+
+	NavVoxelShapes shapes;
+	shapes.Spheres.push_back(NavVoxelShapes::Sphere{ FVector(9.3f, 8.1f, 7.7f), 4.6f });
+	NavVoxelizer::Voxelize(grid.GetDivisions(), shapes, CellHalfExtent, occupancy);
+
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		// The squared distance from the center to the closest point of the cell
+		const FVector center = GetCellCenter(grid, index);
+		const float dx = std::max(std::fabs(center.X - 9.3f) - 0.5f, 0.0f);
+		const float dy = std::max(std::fabs(center.Y - 8.1f) - 0.5f, 0.0f);
+		const float dz = std::max(std::fabs(center.Z - 7.7f) - 0.5f, 0.0f);
+		const float distanceSquared = (dx * dx) + (dy * dy) + (dz * dz);
+		if (std::fabs(distanceSquared - (4.6f * 4.6f)) > 1.e-3f)
+		{
+			EXPECT_EQ(occupancy.IsBlocked(index), distanceSquared < 4.6f * 4.6f) << "cell " << index;
+		}
+	}
+}
+
+TEST(NavVoxelizer, SolidsAndTrianglesAreConservative)
+{
+	NavGrid grid;
+	grid.Init(FIntVector(24, 24, 24), 0);
+	std::mt19937 rng(7);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+	// A rotated box, a capsule, a tetrahedron and a triangle, each checked on its own
+	for (int32 shape = 0; shape < 4; ++shape)
+	{
+		NavVoxelShapes shapes;
+		std::vector<FVector> inside;
+		float maxDistance = 0.0f;
+
+		if (shape == 0)
+		{
+			const float c = std::cos(0.6f);
+			const float s = std::sin(0.6f);
+			const FVector center(11.2f, 12.7f, 10.4f);
+			const FVector axes[3] = { FVector(c, s, 0.0f) * 5.0f, FVector(-s, c, 0.0f) * 2.5f, FVector(0.0f, 0.0f, 3.0f) };
+			shapes.AddBox(center, axes[0], axes[1], axes[2]);
+			for (int32 i = 0; i < 4000; ++i)
+			{
+				inside.push_back(center + axes[0] * (unit(rng) * 2.0f - 1.0f) + axes[1] * (unit(rng) * 2.0f - 1.0f) + axes[2] * (unit(rng) * 2.0f - 1.0f));
+			}
+			maxDistance = 1.3f;
+		}
+		else if (shape == 1)
+		{
+			const FVector a(4.2f, 5.5f, 6.1f);
+			const FVector b(17.9f, 15.3f, 12.6f);
+			shapes.Capsules.push_back(NavVoxelShapes::Capsule{ a, b, 1.7f });
+			for (int32 i = 0; i < 4000; ++i)
+			{
+				const FVector offset(unit(rng) * 2.0f - 1.0f, unit(rng) * 2.0f - 1.0f, unit(rng) * 2.0f - 1.0f);
+				if (Dot(offset, offset) <= 1.0f)
+				{
+					inside.push_back(a + (b - a) * unit(rng) + offset * 1.7f);
+				}
+			}
+			maxDistance = 1.7f * 1.8f;
+		}
+		else if (shape == 2)
+		{
+			const std::vector<FVector> vertices = { FVector(3.3f, 3.1f, 2.2f), FVector(19.6f, 5.4f, 4.1f), FVector(8.2f, 20.5f, 6.3f), FVector(9.1f, 9.7f, 18.8f) };
+			shapes.AddConvex(vertices, { 0, 1, 2, 0, 3, 1, 1, 3, 2, 2, 3, 0 });
+			for (int32 i = 0; i < 4000; ++i)
+			{
+				float weights[4] = { unit(rng), unit(rng), unit(rng), unit(rng) };
+				const float sum = weights[0] + weights[1] + weights[2] + weights[3];
+				inside.push_back(vertices[0] * (weights[0] / sum) + vertices[1] * (weights[1] / sum) + vertices[2] * (weights[2] / sum) + vertices[3] * (weights[3] / sum));
+			}
+			maxDistance = 3.0f;
+		}
+		else
+		{
+			const std::vector<FVector> vertices = { FVector(2.4f, 3.7f, 5.2f), FVector(21.3f, 6.8f, 9.9f), FVector(7.6f, 19.2f, 17.4f) };
+			shapes.AddTriangleMesh(vertices, { 0, 1, 2 });
+			for (int32 i = 0; i < 20000; ++i)
+			{
+				float u = unit(rng);
+				float v = unit(rng);
+				if (u + v > 1.0f)
+				{
+					u = 1.0f - u;
+					v = 1.0f - v;
+				}
+				inside.push_back(vertices[0] + (vertices[1] - vertices[0]) * u + (vertices[2] - vertices[0]) * v);
+			}
+
+			// Only the cells the triangle passes through, within half a cell diagonal of it
+			maxDistance = 0.87f + 0.1f;
+		}
+
+		NavOccupancy occupancy;
+		occupancy.Init(grid.Num());
+		NavVoxelizer::Voxelize(grid.GetDivisions(), shapes, CellHalfExtent, occupancy);
+
+		SCOPED_TRACE(shape);
+		ExpectBlockedAt(grid, occupancy, inside);
+		ExpectBlockedNear(grid, occupancy, inside, maxDistance);
+	}
+}
+
+TEST(NavVoxelizer, ParallelSlabsMatchSequential)
+{
+	// Layers smaller than an occupancy word, so slabs share words
+	NavGrid grid;
+	grid.Init(FIntVector(5, 3, 90), 0);
+
+	std::mt19937 rng(11);
+	std::uniform_real_distribution<float> position(0.0f, 90.0f);
+	std::uniform_real_distribution<float> small(0.0f, 5.0f);
+	NavVoxelShapes shapes;
+	for (int32 i = 0; i < 40; ++i)
+	{
+		shapes.Spheres.push_back(NavVoxelShapes::Sphere{ FVector(small(rng), small(rng) * 0.6f, position(rng)), 0.3f + small(rng) * 0.2f });
+		shapes.Capsules.push_back(NavVoxelShapes::Capsule{ FVector(small(rng), small(rng), position(rng)), FVector(small(rng), small(rng), position(rng)), 0.2f });
+		shapes.Triangles.push_back(NavVoxelShapes::Triangle{ { FVector(small(rng), small(rng), position(rng)), FVector(small(rng), small(rng), position(rng)), FVector(small(rng), small(rng), position(rng)) } });
+	}
+
+	NavOccupancy sequential;
+	sequential.Init(grid.Num());
+	NavVoxelizer::Voxelize(grid.GetDivisions(), shapes, CellHalfExtent, sequential);
+
+	NavOccupancy parallel;
+	parallel.Init(grid.Num());
+	NavVoxelizer::Voxelize(grid.GetDivisions(), shapes, CellHalfExtent, parallel, ThreadedParallelFor);
+
+	int32 blockedCount = 0;
+	for (int32 index = 0; index < grid.Num(); ++index)
+	{
+		EXPECT_EQ(sequential.IsBlocked(index), parallel.IsBlocked(index)) << "cell " << index;
+		blockedCount += sequential.IsBlocked(index) ? 1 : 0;
+	}
+	EXPECT_GT(blockedCount, 0);
+	EXPECT_LT(blockedCount, grid.Num());
+}
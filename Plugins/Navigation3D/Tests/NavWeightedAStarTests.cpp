@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "NavWeightedAStar.h"
+#include "NavSearchContext.h"
+#include "NavTestHelpers.h"
+#include <gtest/gtest.h>
+
+TEST(NavWeightedAStar, PathsStayWithinTheWeightOfTheShortest)
+{
+	for (const float weight : { 1.0f, 1.5f, 3.0f })
+	{
+		for (uint32 seed = 0; seed < 30; ++seed)
+		{
+			NavTestScene scene(FIntVector(6 + seed % 13, 5 + seed % 9, 4 + seed % 7), seed % 3, seed * 23 + 9);
+			NavSearchContext context;
+			std::vector<int32> path;
+
+			std::mt19937 rng(seed);
+			for (int32 query = 0; query < 8; ++query)
+			{
+				const int32 start = rng() % scene.Grid.Num();
+				const int32 end = rng() % scene.Grid.Num();
+				const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+				const bool found = NavWeightedAStar::FindPath(scene.Grid, scene.Occupancy, start, end, weight, context, path);
+				ASSERT_EQ(found, reference >= 0.0f) << "seed " << seed << ", weight " << weight;
+				if (found)
+				{
+					EXPECT_EQ(path.front(), start);
+					EXPECT_EQ(path.back(), end);
+					EXPECT_TRUE(IsPathValid(scene.Grid, scene.Occupancy, std::vector<int32>(path.begin() + 1, path.end()))) << "seed " << seed;
+					EXPECT_LE(GetPathCost(scene.Grid, path), (reference * weight) + 1.e-3f) << "seed " << seed << ", weight " << weight;
+				}
+			}
+		}
+	}
+}
+
+TEST(NavWeightedAStar, AnytimeSearchImprovesTheFirstPathWithinItsBudget)
+{
+	uint64 weightedExpanded = 0;
+	uint64 aStarExpanded = 0;
+	for (uint32 seed = 0; seed < 10; ++seed)
+	{
+		NavTestScene scene(FIntVector(40, 30, 20), 0, seed, 30, 8);
+		std::mt19937 rng(seed);
+		const int32 start = scene.Grid.GetIndex(FIntVector(1, rng() % 30, rng() % 20));
+		const int32 end = scene.Grid.GetIndex(FIntVector(38, rng() % 30, rng() % 20));
+		scene.Occupancy.SetBlocked(end, false);
+		const float reference = GetReferenceCost(scene.Grid, scene.Occupancy, start, end);
+		if (reference < 0.0f)
+			continue;
+
+		// Unbounded, the searches end with the shortest path
+		NavSearchContext context;
+		std::vector<int32> path;
+		float weight = 0.0f;
+		ASSERT_TRUE(NavWeightedAStar::FindPathAnytime(scene.Grid, scene.Occupancy, start, end, 4.0f, 0, 0.0, context, path, weight));
+		EXPECT_EQ(weight, 1.0f);
+		EXPECT_NEAR(GetPathCost(scene.Grid, path), reference, 1.e-3f) << "seed " << seed;
+
+		// A budget too small for anything but the first search keeps its path, within its weight
+		const uint64 startExpanded = context.GetTotalExpandedNum();
+		ASSERT_TRUE(NavWeightedAStar::FindPath(scene.Grid, scene.Occupancy, start, end, 4.0f, context, path));
+		const int32 firstExpanded = static_cast<int32>(context.GetTotalExpandedNum() - startExpanded);
+		weightedExpanded += firstExpanded;
+		ASSERT_TRUE(NavWeightedAStar::FindPathAnytime(scene.Grid, scene.Occupancy, start, end, 4.0f, firstExpanded + 1, 0.0, context, path, weight));
+		EXPECT_EQ(weight, 4.0f);
+		EXPECT_LE(GetPathCost(scene.Grid, path), (reference * 4.0f) + 1.e-3f);
+
+		// Nothing fits in a budget smaller than the first search
+		EXPECT_FALSE(NavWeightedAStar::FindPathAnytime(scene.Grid, scene.Occupancy, start, end, 4.0f, firstExpanded - 1, 0.0, context, path, weight));
+		EXPECT_TRUE(path.empty());
+
+		const uint64 aStarStart = context.GetTotalExpandedNum();
+		ASSERT_TRUE(NavWeightedAStar::FindPath(scene.Grid, scene.Occupancy, start, end, 1.0f, context, path));
+		aStarExpanded += context.GetTotalExpandedNum() - aStarStart;
+	}
+	EXPECT_LT(weightedExpanded * 2, aStarExpanded) << "weighted " << weightedExpanded << ", A* " << aStarExpanded;
+}